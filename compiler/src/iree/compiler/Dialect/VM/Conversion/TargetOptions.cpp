@@ -25,6 +25,10 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
   binder.opt<bool>("iree-vm-target-extension-f64", f64Extension,
                    llvm::cl::desc("Support f64 target opcode extensions."),
                    llvm::cl::cat(vmTargetOptionsCategory));
+  binder.opt<bool>(
+      "iree-vm-target-extension-fused", fusedExtension,
+      llvm::cl::desc("Support fused superinstruction opcode extensions."),
+      llvm::cl::cat(vmTargetOptionsCategory));
   binder.opt<bool>("iree-vm-target-truncate-unsupported-floats",
                    truncateUnsupportedFloats,
                    llvm::cl::desc("Truncate f64 to f32 when unsupported."),
@@ -21,6 +21,9 @@ struct TargetOptions {
   bool f32Extension = true;
   // Whether the f64 extension is enabled in the target VM.
   bool f64Extension = true;
+  // Whether the fused superinstruction extension is enabled in the target VM.
+  // Off by default as runtimes built without it cannot load the modules.
+  bool fusedExtension = false;
 
   // Whether to truncate f64 types to f32 when the f64 extension is not
   // enabled.
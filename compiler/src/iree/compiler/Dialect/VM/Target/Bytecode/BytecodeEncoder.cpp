@@ -10,7 +10,9 @@
 #include "iree/compiler/Dialect/VM/Analysis/RegisterAllocation.h"
 #include "iree/compiler/Dialect/VM/IR/VMDialect.h"
 #include "iree/compiler/Dialect/VM/IR/VMTypes.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/TypeSwitch.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Diagnostics.h"
 
@@ -352,12 +354,177 @@ private:
   std::vector<std::pair<Block *, size_t>> blockOffsetFixups_;
 };
 
+// A superinstruction from the fused opcode extension covering an anchor op
+// and one other op. The fused op is encoded in place of the anchor op.
+struct FusedOpMatch {
+  ExtFusedOpcode opcode;
+  // Op covered by the fused op that is not encoded on its own. This is either
+  // the op consuming the result of the anchor op (cmp+cond_br, load+ext) or
+  // the op producing an operand of the anchor op (const+add).
+  Operation *fusedOp = nullptr;
+};
+
+// Fused ops selected for a function.
+struct FusedOpPlan {
+  // Matches keyed by the anchor op they are encoded in place of.
+  llvm::DenseMap<Operation *, FusedOpMatch> matches;
+  // Ops covered by a fused op that must not be encoded on their own.
+  llvm::DenseSet<Operation *> skippedOps;
+};
+
+// Returns true if the only use of |value| is by |user|.
+static bool isOnlyUsedBy(Value value, Operation *user) {
+  return value.hasOneUse() && *value.user_begin() == user;
+}
+
+// Returns the fused opcode for |op| feeding a vm.cond_br, if any.
+static std::optional<ExtFusedOpcode> getCondBranchFusedOpcode(Operation *op) {
+  return llvm::TypeSwitch<Operation *, std::optional<ExtFusedOpcode>>(op)
+      .Case<CmpEQI32Op>([](auto) { return ExtFusedOpcode::CmpEQI32CondBranch; })
+      .Case<CmpNEI32Op>([](auto) { return ExtFusedOpcode::CmpNEI32CondBranch; })
+      .Case<CmpLTI32SOp>(
+          [](auto) { return ExtFusedOpcode::CmpLTI32SCondBranch; })
+      .Case<CmpLTI32UOp>(
+          [](auto) { return ExtFusedOpcode::CmpLTI32UCondBranch; })
+      .Case<CmpEQI64Op>([](auto) { return ExtFusedOpcode::CmpEQI64CondBranch; })
+      .Case<CmpNEI64Op>([](auto) { return ExtFusedOpcode::CmpNEI64CondBranch; })
+      .Case<CmpLTI64SOp>(
+          [](auto) { return ExtFusedOpcode::CmpLTI64SCondBranch; })
+      .Case<CmpLTI64UOp>(
+          [](auto) { return ExtFusedOpcode::CmpLTI64UCondBranch; })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
+// Returns the vm.const.* op defining an operand of the vm.add.* |addOp| that
+// can be encoded as an immediate, if any.
+static Operation *findImmediateAddOperand(Operation *addOp) {
+  // Canonicalization places constants on the rhs so check that first.
+  for (Value operand : llvm::reverse(addOp->getOperands())) {
+    Operation *definingOp = operand.getDefiningOp();
+    if (isa_and_present<ConstI32Op, ConstI64Op>(definingOp) &&
+        isOnlyUsedBy(operand, addOp)) {
+      return definingOp;
+    }
+  }
+  return nullptr;
+}
+
+// Finds sequences of ops in |funcOp| that can be encoded as fused ops.
+//
+// Only sequences where the intermediate value has no other uses are fused as
+// the value is never written to its register. Sequences that end in a branch
+// or a conversion must be adjacent so that the anchor op operands are read at
+// the same point in the block as they would be if encoded unfused.
+static FusedOpPlan findFusedOps(IREE::VM::FuncOp funcOp) {
+  FusedOpPlan plan;
+  auto addMatch = [&](Operation *anchorOp, ExtFusedOpcode opcode,
+                      Operation *fusedOp) {
+    if (plan.skippedOps.contains(anchorOp) || plan.matches.count(fusedOp)) {
+      return;
+    }
+    plan.matches[anchorOp] = {opcode, fusedOp};
+    plan.skippedOps.insert(fusedOp);
+  };
+  for (auto &block : funcOp.getBlocks()) {
+    for (auto &op : block.getOperations()) {
+      Operation *nextOp = op.getNextNode();
+      if (auto opcode = getCondBranchFusedOpcode(&op)) {
+        // vm.cmp.* + vm.cond_br:
+        auto condBranchOp = dyn_cast_if_present<CondBranchOp>(nextOp);
+        if (condBranchOp && condBranchOp.getCondition() == op.getResult(0) &&
+            isOnlyUsedBy(op.getResult(0), condBranchOp)) {
+          addMatch(&op, *opcode, condBranchOp);
+        }
+      } else if (isa<BufferLoadI32Op>(op)) {
+        // vm.buffer.load.i32 + vm.ext.i32.i64.*:
+        if (!nextOp || !isOnlyUsedBy(op.getResult(0), nextOp)) {
+          continue;
+        }
+        if (isa<ExtI32I64SOp>(nextOp)) {
+          addMatch(&op, ExtFusedOpcode::BufferLoadI32ExtI64S, nextOp);
+        } else if (isa<ExtI32I64UOp>(nextOp)) {
+          addMatch(&op, ExtFusedOpcode::BufferLoadI32ExtI64U, nextOp);
+        }
+      } else if (isa<AddI32Op, AddI64Op>(op)) {
+        // vm.const.* + vm.add.*:
+        // The constant may be anywhere as it has no operands of its own.
+        if (Operation *constOp = findImmediateAddOperand(&op)) {
+          addMatch(&op,
+                   isa<AddI32Op>(op) ? ExtFusedOpcode::AddI32Imm
+                                     : ExtFusedOpcode::AddI64Imm,
+                   constOp);
+        }
+      }
+    }
+  }
+  return plan;
+}
+
+// Encodes the fused op described by |match| in place of |anchorOp|.
+// The operands and results of each original op are encoded with that op as
+// the current op so that register mapping matches unfused encoding.
+static LogicalResult encodeFusedOp(BytecodeEncoder &e, Operation *anchorOp,
+                                   const FusedOpMatch &match) {
+  if (failed(e.encodeOpcode("PrefixExtFused",
+                            static_cast<int>(Opcode::PrefixExtFused))) ||
+      failed(e.encodeOpcode(stringifyExtFusedOpcode(match.opcode),
+                            static_cast<int>(match.opcode)))) {
+    return failure();
+  }
+  switch (match.opcode) {
+  case ExtFusedOpcode::CmpEQI32CondBranch:
+  case ExtFusedOpcode::CmpNEI32CondBranch:
+  case ExtFusedOpcode::CmpLTI32SCondBranch:
+  case ExtFusedOpcode::CmpLTI32UCondBranch:
+  case ExtFusedOpcode::CmpEQI64CondBranch:
+  case ExtFusedOpcode::CmpNEI64CondBranch:
+  case ExtFusedOpcode::CmpLTI64SCondBranch:
+  case ExtFusedOpcode::CmpLTI64UCondBranch: {
+    auto condBranchOp = cast<CondBranchOp>(match.fusedOp);
+    return failure(
+        failed(e.beginOp(anchorOp)) ||
+        failed(e.encodeOperand(anchorOp->getOperand(0), 0)) ||
+        failed(e.encodeOperand(anchorOp->getOperand(1), 1)) ||
+        failed(e.endOp(anchorOp)) || failed(e.beginOp(condBranchOp)) ||
+        failed(e.encodeBranch(condBranchOp.getTrueDest(),
+                              condBranchOp.getTrueOperands(), 0)) ||
+        failed(e.encodeBranch(condBranchOp.getFalseDest(),
+                              condBranchOp.getFalseOperands(), 1)) ||
+        failed(e.endOp(condBranchOp)));
+  }
+  case ExtFusedOpcode::AddI32Imm:
+  case ExtFusedOpcode::AddI64Imm: {
+    unsigned operandIndex =
+        anchorOp->getOperand(0).getDefiningOp() == match.fusedOp ? 1 : 0;
+    return failure(
+        failed(e.beginOp(anchorOp)) ||
+        failed(e.encodeOperand(anchorOp->getOperand(operandIndex),
+                               operandIndex)) ||
+        failed(e.encodePrimitiveAttr(
+            match.fusedOp->getAttrOfType<TypedAttr>("value"))) ||
+        failed(e.encodeResult(anchorOp->getResult(0))) ||
+        failed(e.endOp(anchorOp)));
+  }
+  case ExtFusedOpcode::BufferLoadI32ExtI64S:
+  case ExtFusedOpcode::BufferLoadI32ExtI64U:
+    return failure(failed(e.beginOp(anchorOp)) ||
+                   failed(e.encodeOperand(anchorOp->getOperand(0), 0)) ||
+                   failed(e.encodeOperand(anchorOp->getOperand(1), 1)) ||
+                   failed(e.endOp(anchorOp)) ||
+                   failed(e.beginOp(match.fusedOp)) ||
+                   failed(e.encodeResult(match.fusedOp->getResult(0))) ||
+                   failed(e.endOp(match.fusedOp)));
+  }
+  return anchorOp->emitOpError() << "unhandled fused opcode";
+}
+
 } // namespace
 
 // static
 std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase) {
+    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+    bool emitFusedOps) {
   EncodedBytecodeFunction result;
 
   // Perform register allocation first so that we can quickly lookup values as
@@ -368,6 +535,12 @@ std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     return std::nullopt;
   }
 
+  // Select fused ops up front as some cover ops that precede their anchor.
+  FusedOpPlan fusedOpPlan;
+  if (emitFusedOps) {
+    fusedOpPlan = findFusedOps(funcOp);
+  }
+
   FunctionSourceMap sourceMap;
   sourceMap.localName = funcOp.getName().str();
 
@@ -381,6 +554,19 @@ std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     }
 
     for (auto &op : block.getOperations()) {
+      if (fusedOpPlan.skippedOps.contains(&op)) {
+        continue;
+      }
+      auto fusedOp = fusedOpPlan.matches.find(&op);
+      if (fusedOp != fusedOpPlan.matches.end()) {
+        sourceMap.locations.push_back(
+            {static_cast<int32_t>(encoder.getOffset()), op.getLoc()});
+        if (failed(encodeFusedOp(encoder, &op, fusedOp->second))) {
+          op.emitOpError() << "failed to encode fused op";
+          return std::nullopt;
+        }
+        continue;
+      }
       auto serializableOp = dyn_cast<IREE::VM::VMSerializableOp>(op);
       if (!serializableOp) {
         if (op.hasTrait<OpTrait::IREE::VM::AssignmentOp>()) {
@@ -434,6 +620,7 @@ std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
   result.blockCount = funcOp.getBlocks().size();
   result.i32RegisterCount = registerAllocation.getMaxI32RegisterOrdinal() + 1;
   result.refRegisterCount = registerAllocation.getMaxRefRegisterOrdinal() + 1;
+  result.usesFusedOps = !fusedOpPlan.matches.empty();
   return result;
 }
 
@@ -28,6 +28,10 @@ struct EncodedBytecodeFunction {
   uint16_t i32RegisterCount = 0;
   // Total vm.ref register slots required for execution.
   uint16_t refRegisterCount = 0;
+
+  // True if any ops were encoded as superinstructions from the fused opcode
+  // extension and the function requires the runtime to support it.
+  bool usesFusedOps = false;
 };
 
 // Abstract encoder used for function bytecode encoding.
@@ -40,10 +44,13 @@ public:
   static constexpr uint32_t kVersion = (kVersionMajor << 16) | kVersionMinor;
 
   // Encodes a vm.func to bytecode and returns the result.
+  // If |emitFusedOps| is set then common op sequences will be encoded as
+  // superinstructions from the fused opcode extension.
   // Returns None on failure.
   static std::optional<EncodedBytecodeFunction>
   encodeFunction(IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-                 SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase);
+                 SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+                 bool emitFusedOps = false);
 
   BytecodeEncoder() = default;
   ~BytecodeEncoder() = default;
@@ -363,11 +363,15 @@ buildFlatBufferModule(IREE::VM::TargetOptions vmOptions,
   size_t totalBytecodeLength = 0;
   for (auto [i, funcOp] : llvm::enumerate(internalFuncOps)) {
     auto encodedFunction = BytecodeEncoder::encodeFunction(
-        funcOp, typeOrdinalMap, symbolTable, debugDatabase);
+        funcOp, typeOrdinalMap, symbolTable, debugDatabase,
+        /*emitFusedOps=*/vmOptions.fusedExtension);
     if (!encodedFunction) {
       return funcOp.emitError() << "failed to encode function bytecode";
     }
     auto funcRequirements = findRequiredFeatures(funcOp);
+    if (encodedFunction->usesFusedOps) {
+      funcRequirements |= iree_vm_FeatureBits_EXT_FUSED;
+    }
     moduleRequirements |= funcRequirements;
     iree_vm_FunctionDescriptor_assign(
         &functionDescriptors[i], totalBytecodeLength,
@@ -540,6 +544,8 @@ buildFlatBufferModule(IREE::VM::TargetOptions vmOptions,
     allowedFeatures |= iree_vm_FeatureBits_EXT_F32;
   if (vmOptions.f64Extension)
     allowedFeatures |= iree_vm_FeatureBits_EXT_F64;
+  if (vmOptions.fusedExtension)
+    allowedFeatures |= iree_vm_FeatureBits_EXT_FUSED;
   if ((moduleRequirements & allowedFeatures) != moduleRequirements) {
     return moduleOp.emitError()
            << "module uses features not allowed by flags (requires "
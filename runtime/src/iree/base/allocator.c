@@ -62,6 +62,27 @@ IREE_API_EXPORT void iree_allocator_free(iree_allocator_t allocator,
   }
 }
 
+IREE_API_EXPORT iree_host_size_t iree_allocator_query_alignment(
+    iree_allocator_t allocator, iree_host_size_t byte_length) {
+  void* alignment_ptr = NULL;
+  if (allocator.ctl) {
+    iree_allocator_alloc_params_t params = {
+        .byte_length = byte_length,
+    };
+    iree_status_t status =
+        allocator.ctl(allocator.self, IREE_ALLOCATOR_COMMAND_QUERY_ALIGNMENT,
+                      &params, &alignment_ptr);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      alignment_ptr = NULL;
+    }
+  }
+  const iree_host_size_t alignment = (iree_host_size_t)(uintptr_t)alignment_ptr;
+  return iree_host_size_is_power_of_two(alignment)
+             ? iree_max(alignment, iree_max_align_t)
+             : iree_max_align_t;
+}
+
 //===----------------------------------------------------------------------===//
 // Built-in iree_allocator_t implementations
 //===----------------------------------------------------------------------===//
@@ -172,6 +172,16 @@ typedef enum iree_allocator_command_e {
   //   inout_ptr: pointer to free
   IREE_ALLOCATOR_COMMAND_FREE = 3,
 
+  // Queries the alignment guaranteed for allocations of |byte_length| made
+  // with IREE_ALLOCATOR_COMMAND_MALLOC or IREE_ALLOCATOR_COMMAND_CALLOC.
+  // Optional: allocators that do not support the command are assumed to align
+  // to iree_max_align_t. See iree_allocator_query_alignment.
+  //
+  // iree_allocator_ctl_fn_t:
+  //   params: iree_allocator_alloc_params_t
+  //   inout_ptr: set to the alignment in bytes cast to a pointer
+  IREE_ALLOCATOR_COMMAND_QUERY_ALIGNMENT = 4,
+
   // TODO(benvanik): add optional IREE_ALLOCATOR_COMMAND_BIND like mbind:
   // https://man7.org/linux/man-pages/man2/mbind.2.html
   // This would take a pointer/length and a NUMA node ID to bind the memory to.
@@ -234,6 +244,12 @@ iree_allocator_clone(iree_allocator_t allocator,
 // Frees a previously-allocated block of memory to the given allocator.
 IREE_API_EXPORT void iree_allocator_free(iree_allocator_t allocator, void* ptr);
 
+// Returns the alignment in bytes of allocations of |byte_length| made from
+// |allocator|. This is at least iree_max_align_t and may be larger for
+// allocators that guarantee more (such as those returning whole pages).
+IREE_API_EXPORT iree_host_size_t iree_allocator_query_alignment(
+    iree_allocator_t allocator, iree_host_size_t byte_length);
+
 //===----------------------------------------------------------------------===//
 // Built-in iree_allocator_t implementations
 //===----------------------------------------------------------------------===//
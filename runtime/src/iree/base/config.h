@@ -299,6 +299,16 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE 0
 #endif  // !IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE
 
+#if !defined(IREE_VM_EXECUTION_COUNTERS_ENABLE)
+// Enables per-function and per-block execution counters in the bytecode
+// dispatcher. Each thread executing a module state records into its own
+// counter table (2 bytes per byte of bytecode) so that concurrent contexts do
+// not race; tables are merged when read. Adds one increment per executed block
+// plus one extra dispatch per taken branch as branches no longer skip the
+// vm.block marker. Use iree_vm_bytecode_module_append_counters to dump them.
+#define IREE_VM_EXECUTION_COUNTERS_ENABLE 0
+#endif  // !IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 #if !defined(IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE)
 // Enables the use of compute goto for bytecode dispatch. This can have a
 // moderate performance improvement (~10-20%) on very heavy VMVX workloads but
@@ -325,6 +335,12 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_EXT_F64_ENABLE 1
 #endif  // !IREE_VM_EXT_F64_ENABLE
 
+#if !defined(IREE_VM_EXT_FUSED_ENABLE)
+// Enables the fused superinstruction extension.
+// Targeted from the compiler with `-iree-vm-target-extension-fused`.
+#define IREE_VM_EXT_FUSED_ENABLE 1
+#endif  // !IREE_VM_EXT_FUSED_ENABLE
+
 #if !defined(IREE_VM_UBSAN_CHECKABLE_ENABLE)
 // Exposes VMVX kernels to UBSAN checking, else disable UBSAN checking.
 #define IREE_VM_UBSAN_CHECKABLE_ENABLE 0
@@ -6,6 +6,8 @@
 
 #include "iree/base/internal/memory.h"
 
+#include <string.h>
+
 //===----------------------------------------------------------------------===//
 // Memory subsystem information and control
 //===----------------------------------------------------------------------===//
@@ -159,3 +161,623 @@ void iree_memory_flush_icache(void* base_address, iree_host_size_t length) {
 }
 
 #endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// Page allocation
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(MADV_HUGEPAGE)
+// Returns the size of a transparent large page (the PMD size on Linux).
+static iree_host_size_t iree_memory_transparent_large_page_size(void) {
+  iree_host_size_t large_page_size = 2 * 1024 * 1024;
+  FILE* file =
+      fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+  if (file) {
+    unsigned long long value = 0;
+    if (fscanf(file, "%llu", &value) == 1 &&
+        iree_is_power_of_two_uint64(value)) {
+      large_page_size = (iree_host_size_t)value;
+    }
+    fclose(file);
+  }
+  return large_page_size;
+}
+#endif  // MADV_HUGEPAGE
+
+#if defined(MAP_HUGETLB)
+
+// From linux/mman.h; not all libc headers carry the page size encodings.
+#if !defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_SHIFT 26
+#endif  // !MAP_HUGE_SHIFT
+#if !defined(MAP_HUGE_1GB)
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif  // !MAP_HUGE_1GB
+
+// Returns the size of an explicit large page as selected by |flags|.
+static iree_host_size_t iree_memory_explicit_large_page_size(
+    iree_memory_page_flags_t flags) {
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES)) {
+    return 1024 * 1024 * 1024;
+  }
+  iree_host_size_t large_page_size = 2 * 1024 * 1024;
+  FILE* file = fopen("/proc/meminfo", "r");
+  if (file) {
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+      unsigned long long value_kb = 0;
+      if (sscanf(line, "Hugepagesize: %llu kB", &value_kb) == 1) {
+        if (iree_is_power_of_two_uint64(value_kb)) {
+          large_page_size = (iree_host_size_t)(value_kb * 1024);
+        }
+        break;
+      }
+    }
+    fclose(file);
+  }
+  return large_page_size;
+}
+
+#endif  // MAP_HUGETLB
+
+iree_host_size_t iree_memory_pages_granularity(iree_memory_page_flags_t flags) {
+#if defined(MAP_HUGETLB)
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES)) {
+    return iree_memory_explicit_large_page_size(flags);
+  }
+#endif  // MAP_HUGETLB
+#if defined(MADV_HUGEPAGE)
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES)) {
+    return iree_memory_transparent_large_page_size();
+  }
+#endif  // MADV_HUGEPAGE
+  return (iree_host_size_t)sysconf(_SC_PAGESIZE);
+}
+
+iree_status_t iree_memory_pages_allocate(iree_host_size_t length,
+                                         iree_memory_page_flags_t flags,
+                                         void** out_base_address) {
+  IREE_ASSERT_ARGUMENT(out_base_address);
+  *out_base_address = NULL;
+  const iree_host_size_t page_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  length = iree_host_align(length, page_size);
+  if (!length) return iree_ok_status();
+
+#if defined(MAP_HUGETLB)
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES) &&
+      length % iree_memory_explicit_large_page_size(flags) == 0) {
+    // Private hugetlb mappings reserve their pages up front so this fails
+    // immediately (instead of on first touch) if the pool is exhausted.
+    int map_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+    if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES)) {
+      map_flags |= MAP_HUGE_1GB;
+    }
+    void* base_address =
+        mmap(NULL, length, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+    if (base_address != MAP_FAILED) {
+      *out_base_address = base_address;
+      return iree_ok_status();
+    }
+  }
+#endif  // MAP_HUGETLB
+
+  iree_host_size_t alignment = page_size;
+#if defined(MADV_HUGEPAGE)
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES)) {
+    const iree_host_size_t large_page_size =
+        iree_memory_transparent_large_page_size();
+    if (length >= large_page_size) alignment = large_page_size;
+  }
+#endif  // MADV_HUGEPAGE
+
+  // Over-reserve so that an aligned range can be carved out of the mapping and
+  // the unaligned head and tail returned.
+  const iree_host_size_t reserve_length = length + alignment - page_size;
+  uint8_t* reserve_base =
+      (uint8_t*)mmap(NULL, reserve_length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserve_base == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mmap of %" PRIhsz " bytes failed", length);
+  }
+  uint8_t* base_address =
+      (uint8_t*)iree_host_align((uintptr_t)reserve_base, alignment);
+  uint8_t* end_address = base_address + length;
+  uint8_t* reserve_end = reserve_base + reserve_length;
+  if (base_address > reserve_base) {
+    munmap(reserve_base, base_address - reserve_base);
+  }
+  if (reserve_end > end_address) {
+    munmap(end_address, reserve_end - end_address);
+  }
+
+#if defined(MADV_HUGEPAGE)
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES)) {
+    // Best-effort: transparent large pages may be disabled on the system.
+    madvise(base_address, length, MADV_HUGEPAGE);
+  }
+#endif  // MADV_HUGEPAGE
+
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+void iree_memory_pages_free(void* base_address, iree_host_size_t length) {
+  if (!base_address) return;
+  const iree_host_size_t page_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  munmap(base_address, iree_host_align(length, page_size));
+}
+
+#elif defined(IREE_PLATFORM_WINDOWS)
+
+// Large pages require SeLockMemoryPrivilege and are not supported.
+iree_host_size_t iree_memory_pages_granularity(iree_memory_page_flags_t flags) {
+  return iree_memory_query_info().normal_page_size;
+}
+
+iree_status_t iree_memory_pages_allocate(iree_host_size_t length,
+                                         iree_memory_page_flags_t flags,
+                                         void** out_base_address) {
+  IREE_ASSERT_ARGUMENT(out_base_address);
+  *out_base_address = NULL;
+  if (!length) return iree_ok_status();
+  void* base_address =
+      VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  if (!base_address) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "VirtualAlloc of %" PRIhsz " bytes failed",
+                            length);
+  }
+  *out_base_address = base_address;
+  return iree_ok_status();
+}
+
+void iree_memory_pages_free(void* base_address, iree_host_size_t length) {
+  if (!base_address) return;
+  VirtualFree(base_address, 0, MEM_RELEASE);
+}
+
+#else
+
+iree_host_size_t iree_memory_pages_granularity(iree_memory_page_flags_t flags) {
+  return iree_memory_query_info().normal_page_size;
+}
+
+iree_status_t iree_memory_pages_allocate(iree_host_size_t length,
+                                         iree_memory_page_flags_t flags,
+                                         void** out_base_address) {
+  IREE_ASSERT_ARGUMENT(out_base_address);
+  *out_base_address = NULL;
+  if (!length) return iree_ok_status();
+  const iree_memory_info_t memory_info = iree_memory_query_info();
+  return iree_allocator_malloc_aligned(iree_allocator_system(), length,
+                                       memory_info.normal_page_size,
+                                       /*offset=*/0, out_base_address);
+}
+
+void iree_memory_pages_free(void* base_address, iree_host_size_t length) {
+  iree_allocator_free_aligned(iree_allocator_system(), base_address);
+}
+
+#endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// iree_memory_page_allocator_t
+//===----------------------------------------------------------------------===//
+
+void iree_memory_page_allocator_initialize(
+    iree_memory_page_flags_t flags, iree_allocator_t delegate_allocator,
+    iree_memory_page_allocator_t* out_page_allocator) {
+  IREE_ASSERT_ARGUMENT(out_page_allocator);
+  memset(out_page_allocator, 0, sizeof(*out_page_allocator));
+  out_page_allocator->flags = flags;
+  out_page_allocator->page_alignment =
+      iree_memory_query_info().normal_page_size;
+  out_page_allocator->large_page_size = iree_memory_pages_granularity(
+      flags & ~IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES);
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES |
+                                   IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES)) {
+    const iree_host_size_t gigantic_page_size =
+        iree_memory_pages_granularity(flags);
+    if (gigantic_page_size > out_page_allocator->large_page_size) {
+      out_page_allocator->gigantic_page_size = gigantic_page_size;
+    }
+  }
+  out_page_allocator->delegate_allocator = delegate_allocator;
+  iree_slim_mutex_initialize(&out_page_allocator->mutex);
+}
+
+void iree_memory_page_allocator_deinitialize(
+    iree_memory_page_allocator_t* page_allocator) {
+  IREE_ASSERT_ARGUMENT(page_allocator);
+  IREE_ASSERT_EQ(page_allocator->allocation_count, 0,
+                 "page-backed allocations must be freed before deinit");
+  iree_allocator_free(page_allocator->delegate_allocator,
+                      page_allocator->allocations);
+  iree_slim_mutex_deinitialize(&page_allocator->mutex);
+  memset(page_allocator, 0, sizeof(*page_allocator));
+}
+
+// Returns the index of the first allocation in the table with a base address
+// not less than |ptr|. Must be called with the mutex held.
+static iree_host_size_t iree_memory_page_allocator_lower_bound_locked(
+    iree_memory_page_allocator_t* page_allocator, void* ptr) {
+  iree_host_size_t low = 0;
+  iree_host_size_t high = page_allocator->allocation_count;
+  while (low < high) {
+    const iree_host_size_t mid = low + (high - low) / 2;
+    if ((uintptr_t)page_allocator->allocations[mid].base_address <
+        (uintptr_t)ptr) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+// Returns the index of the page-backed allocation at |ptr| or -1 if |ptr| was
+// made from the delegate allocator. Must be called with the mutex held.
+static iree_host_size_t iree_memory_page_allocator_find_locked(
+    iree_memory_page_allocator_t* page_allocator, void* ptr) {
+  const iree_host_size_t index =
+      iree_memory_page_allocator_lower_bound_locked(page_allocator, ptr);
+  if (index < page_allocator->allocation_count &&
+      page_allocator->allocations[index].base_address == ptr) {
+    return index;
+  }
+  return IREE_HOST_SIZE_MAX;
+}
+
+// Looks up the page-backed allocation at |ptr| and returns it in
+// |out_allocation|. If |remove| is true the allocation is removed from the
+// table. Returns false if |ptr| was made from the delegate allocator.
+static bool iree_memory_page_allocator_lookup(
+    iree_memory_page_allocator_t* page_allocator, void* ptr, bool remove,
+    iree_memory_page_allocation_t* out_allocation) {
+  // Page-backed allocations are always page aligned; anything else must have
+  // come from the delegate and can skip the lookup.
+  if (!iree_host_size_has_alignment((uintptr_t)ptr,
+                                    page_allocator->page_alignment)) {
+    return false;
+  }
+  iree_slim_mutex_lock(&page_allocator->mutex);
+  const iree_host_size_t index =
+      iree_memory_page_allocator_find_locked(page_allocator, ptr);
+  const bool found = index != IREE_HOST_SIZE_MAX;
+  if (found) {
+    *out_allocation = page_allocator->allocations[index];
+    if (remove) {
+      memmove(&page_allocator->allocations[index],
+              &page_allocator->allocations[index + 1],
+              (page_allocator->allocation_count - index - 1) *
+                  sizeof(page_allocator->allocations[0]));
+      --page_allocator->allocation_count;
+    }
+  }
+  iree_slim_mutex_unlock(&page_allocator->mutex);
+  return found;
+}
+
+// Updates the user-requested length of the page-backed allocation at |ptr|.
+static void iree_memory_page_allocator_resize(
+    iree_memory_page_allocator_t* page_allocator, void* ptr,
+    iree_host_size_t byte_length) {
+  iree_slim_mutex_lock(&page_allocator->mutex);
+  const iree_host_size_t index =
+      iree_memory_page_allocator_find_locked(page_allocator, ptr);
+  if (index != IREE_HOST_SIZE_MAX) {
+    page_allocator->allocations[index].byte_length = byte_length;
+  }
+  iree_slim_mutex_unlock(&page_allocator->mutex);
+}
+
+// Inserts |allocation| into the table in address order, growing it as needed.
+static iree_status_t iree_memory_page_allocator_insert(
+    iree_memory_page_allocator_t* page_allocator,
+    iree_memory_page_allocation_t allocation) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&page_allocator->mutex);
+  if (page_allocator->allocation_count == page_allocator->allocation_capacity) {
+    const iree_host_size_t new_capacity =
+        iree_max(16, page_allocator->allocation_capacity * 2);
+    iree_memory_page_allocation_t* new_allocations =
+        page_allocator->allocations;
+    status = iree_allocator_realloc(
+        page_allocator->delegate_allocator,
+        new_capacity * sizeof(*new_allocations), (void**)&new_allocations);
+    if (iree_status_is_ok(status)) {
+      page_allocator->allocations = new_allocations;
+      page_allocator->allocation_capacity = new_capacity;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    const iree_host_size_t index =
+        iree_memory_page_allocator_lower_bound_locked(
+            page_allocator, allocation.base_address);
+    memmove(&page_allocator->allocations[index + 1],
+            &page_allocator->allocations[index],
+            (page_allocator->allocation_count - index) *
+                sizeof(page_allocator->allocations[0]));
+    page_allocator->allocations[index] = allocation;
+    ++page_allocator->allocation_count;
+  }
+  iree_slim_mutex_unlock(&page_allocator->mutex);
+  return status;
+}
+
+// Allocates |byte_length| bytes from pages and records the allocation.
+static iree_status_t iree_memory_page_allocator_alloc_pages(
+    iree_memory_page_allocator_t* page_allocator, iree_host_size_t byte_length,
+    void** out_ptr) {
+  // Pages come zeroed from the system so CALLOC needs no special handling.
+  iree_memory_page_flags_t flags = page_allocator->flags;
+  iree_host_size_t granularity = page_allocator->large_page_size;
+  if (page_allocator->gigantic_page_size &&
+      byte_length >= page_allocator->gigantic_page_size) {
+    granularity = page_allocator->gigantic_page_size;
+  } else {
+    flags &= ~IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES;
+  }
+  iree_host_size_t page_length = byte_length;
+  if (iree_all_bits_set(flags, IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES)) {
+    page_length = iree_host_align(byte_length, granularity);
+    if (IREE_UNLIKELY(page_length < byte_length)) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "allocation of %" PRIhsz " bytes overflows",
+                              byte_length);
+    }
+  }
+  void* base_address = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_memory_pages_allocate(page_length, flags, &base_address));
+  iree_memory_page_allocation_t allocation = {
+      .base_address = base_address,
+      .page_length = page_length,
+      .byte_length = byte_length,
+  };
+  iree_status_t status =
+      iree_memory_page_allocator_insert(page_allocator, allocation);
+  if (!iree_status_is_ok(status)) {
+    iree_memory_pages_free(base_address, page_length);
+    return status;
+  }
+  IREE_TRACE_ALLOC(base_address, page_length);
+  *out_ptr = base_address;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_memory_page_allocator_alloc(
+    iree_memory_page_allocator_t* page_allocator,
+    iree_allocator_command_t command, iree_host_size_t byte_length,
+    void** out_ptr) {
+  if (IREE_UNLIKELY(byte_length == 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocations must be >0 bytes");
+  }
+  if (byte_length < page_allocator->large_page_size) {
+    return command == IREE_ALLOCATOR_COMMAND_CALLOC
+               ? iree_allocator_malloc(page_allocator->delegate_allocator,
+                                       byte_length, out_ptr)
+               : iree_allocator_malloc_uninitialized(
+                     page_allocator->delegate_allocator, byte_length,
+                     out_ptr);
+  }
+  return iree_memory_page_allocator_alloc_pages(page_allocator, byte_length,
+                                                out_ptr);
+}
+
+static void iree_memory_page_allocator_free(
+    iree_memory_page_allocator_t* page_allocator, void* ptr) {
+  if (!ptr) return;
+  iree_memory_page_allocation_t allocation;
+  if (iree_memory_page_allocator_lookup(page_allocator, ptr, /*remove=*/true,
+                                        &allocation)) {
+    IREE_TRACE_FREE(allocation.base_address);
+    iree_memory_pages_free(allocation.base_address, allocation.page_length);
+  } else {
+    iree_allocator_free(page_allocator->delegate_allocator, ptr);
+  }
+}
+
+static iree_status_t iree_memory_page_allocator_realloc(
+    iree_memory_page_allocator_t* page_allocator, iree_host_size_t byte_length,
+    void** inout_ptr) {
+  void* existing_ptr = *inout_ptr;
+  if (!existing_ptr) {
+    return iree_memory_page_allocator_alloc(
+        page_allocator, IREE_ALLOCATOR_COMMAND_MALLOC, byte_length, inout_ptr);
+  }
+  if (IREE_UNLIKELY(byte_length == 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocations must be >0 bytes");
+  }
+
+  iree_memory_page_allocation_t allocation;
+  if (!iree_memory_page_allocator_lookup(page_allocator, existing_ptr,
+                                         /*remove=*/false, &allocation)) {
+    // Delegate allocations are resized by the delegate. We don't know their
+    // length so those growing into pages are first resized by the delegate
+    // and then copied in full, as with iree_allocator_realloc_aligned.
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        page_allocator->delegate_allocator, byte_length, inout_ptr));
+    if (byte_length < page_allocator->large_page_size) return iree_ok_status();
+    void* new_ptr = NULL;
+    iree_status_t status = iree_memory_page_allocator_alloc_pages(
+        page_allocator, byte_length, &new_ptr);
+    if (!iree_status_is_ok(status)) {
+      // The delegate allocation is still valid; keep using it.
+      iree_status_ignore(status);
+      return iree_ok_status();
+    }
+    memcpy(new_ptr, *inout_ptr, byte_length);
+    iree_allocator_free(page_allocator->delegate_allocator, *inout_ptr);
+    *inout_ptr = new_ptr;
+    return iree_ok_status();
+  }
+
+  // Page-backed allocations that still fit in their pages are resized in
+  // place.
+  if (byte_length >= page_allocator->large_page_size &&
+      byte_length <= allocation.page_length) {
+    iree_memory_page_allocator_resize(page_allocator, existing_ptr,
+                                      byte_length);
+    return iree_ok_status();
+  }
+
+  // Otherwise move the contents to a new allocation of the right kind.
+  void* new_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_memory_page_allocator_alloc(
+      page_allocator, IREE_ALLOCATOR_COMMAND_MALLOC, byte_length, &new_ptr));
+  memcpy(new_ptr, existing_ptr, iree_min(allocation.byte_length, byte_length));
+  iree_memory_page_allocator_free(page_allocator, existing_ptr);
+  *inout_ptr = new_ptr;
+  return iree_ok_status();
+}
+
+// Returns the alignment of allocations of |byte_length|.
+static iree_host_size_t iree_memory_page_allocator_query_alignment(
+    iree_memory_page_allocator_t* page_allocator,
+    iree_host_size_t byte_length) {
+  if (byte_length < page_allocator->large_page_size) {
+    return iree_allocator_query_alignment(page_allocator->delegate_allocator,
+                                          byte_length);
+  }
+  return page_allocator->page_alignment;
+}
+
+iree_status_t iree_memory_page_allocator_ctl(void* self,
+                                             iree_allocator_command_t command,
+                                             const void* params,
+                                             void** inout_ptr) {
+  iree_memory_page_allocator_t* page_allocator =
+      (iree_memory_page_allocator_t*)self;
+  IREE_ASSERT_ARGUMENT(inout_ptr);
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC:
+      return iree_memory_page_allocator_alloc(
+          page_allocator, command,
+          ((const iree_allocator_alloc_params_t*)params)->byte_length,
+          inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_REALLOC:
+      return iree_memory_page_allocator_realloc(
+          page_allocator,
+          ((const iree_allocator_alloc_params_t*)params)->byte_length,
+          inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_FREE:
+      iree_memory_page_allocator_free(page_allocator, *inout_ptr);
+      *inout_ptr = NULL;
+      return iree_ok_status();
+    case IREE_ALLOCATOR_COMMAND_QUERY_ALIGNMENT:
+      *inout_ptr = (void*)(uintptr_t)iree_memory_page_allocator_query_alignment(
+          page_allocator,
+          ((const iree_allocator_alloc_params_t*)params)->byte_length);
+      return iree_ok_status();
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported page allocator command");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// NUMA memory placement
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+
+#include <errno.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// From linux/mempolicy.h; not all libc headers (or NDK versions) carry it and
+// we only need a few values.
+#if !defined(MPOL_PREFERRED)
+#define MPOL_PREFERRED 1
+#endif  // !MPOL_PREFERRED
+#if !defined(MPOL_MF_MOVE)
+#define MPOL_MF_MOVE (1 << 1)
+#endif  // !MPOL_MF_MOVE
+
+#define IREE_MEMORY_NUMA_NODE_MASK_WORDS \
+  (IREE_MEMORY_NUMA_NODE_LIMIT / (8 * sizeof(unsigned long)))
+
+static iree_status_t iree_memory_make_numa_node_mask(
+    uint32_t node_id,
+    unsigned long node_mask[IREE_MEMORY_NUMA_NODE_MASK_WORDS]) {
+  if (node_id >= IREE_MEMORY_NUMA_NODE_LIMIT) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "NUMA node %u out of range (limit %d)", node_id,
+                            IREE_MEMORY_NUMA_NODE_LIMIT);
+  }
+  memset(node_mask, 0, IREE_MEMORY_NUMA_NODE_MASK_WORDS * sizeof(node_mask[0]));
+  node_mask[node_id / (8 * sizeof(unsigned long))] =
+      1ul << (node_id % (8 * sizeof(unsigned long)));
+  return iree_ok_status();
+}
+
+iree_status_t iree_memory_bind_thread_to_numa_node(uint32_t node_id) {
+#if defined(SYS_set_mempolicy)
+  unsigned long node_mask[IREE_MEMORY_NUMA_NODE_MASK_WORDS];
+  IREE_RETURN_IF_ERROR(iree_memory_make_numa_node_mask(node_id, node_mask));
+  // NOTE: the kernel treats maxnode as one past the number of bits to read.
+  if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, node_mask,
+              IREE_MEMORY_NUMA_NODE_LIMIT + 1) != 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "set_mempolicy to NUMA node %u failed", node_id);
+  }
+  return iree_ok_status();
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "set_mempolicy not available");
+#endif  // SYS_set_mempolicy
+}
+
+iree_status_t iree_memory_bind_range_to_numa_node(void* base_address,
+                                                  iree_host_size_t length,
+                                                  uint32_t node_id) {
+#if defined(SYS_mbind)
+  unsigned long node_mask[IREE_MEMORY_NUMA_NODE_MASK_WORDS];
+  IREE_RETURN_IF_ERROR(iree_memory_make_numa_node_mask(node_id, node_mask));
+  const iree_host_size_t page_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  const uintptr_t range_begin =
+      iree_host_align((uintptr_t)base_address, page_size);
+  const uintptr_t range_end =
+      ((uintptr_t)base_address + length) & ~(uintptr_t)(page_size - 1);
+  if (range_end <= range_begin) return iree_ok_status();  // no whole pages
+  if (syscall(SYS_mbind, (void*)range_begin, range_end - range_begin,
+              MPOL_PREFERRED, node_mask, IREE_MEMORY_NUMA_NODE_LIMIT + 1,
+              MPOL_MF_MOVE) != 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mbind to NUMA node %u failed", node_id);
+  }
+  return iree_ok_status();
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "mbind not available");
+#endif  // SYS_mbind
+}
+
+#else
+
+iree_status_t iree_memory_bind_thread_to_numa_node(uint32_t node_id) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "NUMA memory policies not available");
+}
+
+iree_status_t iree_memory_bind_range_to_numa_node(void* base_address,
+                                                  iree_host_size_t length,
+                                                  uint32_t node_id) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "NUMA memory policies not available");
+}
+
+#endif  // IREE_PLATFORM_*
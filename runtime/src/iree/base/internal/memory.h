@@ -8,6 +8,7 @@
 #define IREE_BASE_INTERNAL_MEMORY_H_
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,6 +69,154 @@ void iree_memory_jit_context_end(void);
 // executing code from any pages that have been written during load.
 void iree_memory_flush_icache(void* base_address, iree_host_size_t length);
 
+//===----------------------------------------------------------------------===//
+// Page allocation
+//===----------------------------------------------------------------------===//
+
+enum iree_memory_page_flag_bits_e {
+  IREE_MEMORY_PAGE_FLAG_NONE = 0u,
+
+  // Hints that the pages should be backed by transparent large pages where
+  // supported (THP via madvise(MADV_HUGEPAGE) on Linux). Allocations of at
+  // least one large page are aligned to the large page size so that the whole
+  // range can be mapped with large pages. Ignored on other platforms.
+  IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES = 1u << 0,
+
+  // Requests pages from the explicitly reserved large page pool (hugetlbfs via
+  // MAP_HUGETLB on Linux) of the system default large page size. Only used
+  // when the length is a multiple of iree_memory_pages_granularity. If the pool
+  // has no free pages the allocation falls back to transparent large pages if
+  // requested or normal pages otherwise. Ignored on other platforms.
+  IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES = 1u << 1,
+
+  // Selects 1GB pages instead of the system default large page size for
+  // IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES. The 1GB pool must have been
+  // reserved on the system (such as with `hugepagesz=1G hugepages=N` on the
+  // Linux kernel command line).
+  IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES = 1u << 2,
+};
+typedef uint32_t iree_memory_page_flags_t;
+
+// Returns the size of the pages backing allocations made with |flags| where
+// available. Allocations with a length that is a multiple of this are backed
+// entirely by pages of this size. Returns the normal page size if |flags| does
+// not request large pages or they are not supported on the platform.
+iree_host_size_t iree_memory_pages_granularity(iree_memory_page_flags_t flags);
+
+// Allocates |length| bytes of zero-initialized read/write memory directly from
+// the platform aligned to at least the normal page size. Intended for large
+// long-lived allocations such as scratch arenas where the page-level placement
+// and backing matter. Pages are committed lazily on first touch where the
+// platform supports it and will be placed according to the memory policy of
+// the touching thread.
+//
+// Must be freed with iree_memory_pages_free using the same |length|.
+iree_status_t iree_memory_pages_allocate(iree_host_size_t length,
+                                         iree_memory_page_flags_t flags,
+                                         void** out_base_address);
+
+// Frees |length| bytes of pages previously allocated with
+// iree_memory_pages_allocate.
+void iree_memory_pages_free(void* base_address, iree_host_size_t length);
+
+//===----------------------------------------------------------------------===//
+// iree_memory_page_allocator_t
+//===----------------------------------------------------------------------===//
+
+// A live page-backed allocation made from the page allocator.
+typedef struct iree_memory_page_allocation_t {
+  // Base address of the pages as returned to the user.
+  void* base_address;
+  // Length of the pages as passed to iree_memory_pages_allocate.
+  iree_host_size_t page_length;
+  // Length of the allocation as requested by the user.
+  iree_host_size_t byte_length;
+} iree_memory_page_allocation_t;
+
+// An iree_allocator_t serving large allocations directly from pages allocated
+// with iree_memory_pages_allocate and forwarding all others to a delegate
+// allocator. Intended as the data allocator of host-local HAL heaps so that
+// large buffers (weights, activations) are backed by large pages and kernels
+// streaming through them take fewer TLB misses.
+//
+// Allocations of at least one large page are page-backed and returned at the
+// base of their pages. When explicit large pages are requested their length is
+// rounded up to the page granularity as pool pages cannot be shared between
+// allocations. Page-backed allocations are tracked in a side table so that no
+// header is needed and their alignment can be reported via
+// IREE_ALLOCATOR_COMMAND_QUERY_ALIGNMENT.
+//
+// Thread-safe.
+typedef struct iree_memory_page_allocator_t {
+  // Flags used for page-backed allocations.
+  iree_memory_page_flags_t flags;
+  // Alignment of all page-backed allocations.
+  iree_host_size_t page_alignment;
+  // Granularity of page-backed allocations smaller than |gigantic_page_size|.
+  iree_host_size_t large_page_size;
+  // Granularity of IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES allocations or 0 if
+  // gigantic pages were not requested.
+  iree_host_size_t gigantic_page_size;
+  // Allocator used for allocations smaller than |large_page_size| and the
+  // allocation table.
+  iree_allocator_t delegate_allocator;
+  // Guards the allocation table.
+  iree_slim_mutex_t mutex;
+  // Live page-backed allocations sorted by base address.
+  iree_memory_page_allocation_t* allocations;
+  iree_host_size_t allocation_count;
+  iree_host_size_t allocation_capacity;
+} iree_memory_page_allocator_t;
+
+// Initializes |out_page_allocator| to allocate large pages using |flags|.
+// Allocations smaller than a large page use |delegate_allocator|.
+// The page allocator must remain valid for as long as any allocator returned
+// by iree_memory_page_allocator is in use.
+void iree_memory_page_allocator_initialize(
+    iree_memory_page_flags_t flags, iree_allocator_t delegate_allocator,
+    iree_memory_page_allocator_t* out_page_allocator);
+
+// Deinitializes |page_allocator|. All allocations must have been freed.
+void iree_memory_page_allocator_deinitialize(
+    iree_memory_page_allocator_t* page_allocator);
+
+// Page allocator controller used by iree_memory_page_allocator.
+iree_status_t iree_memory_page_allocator_ctl(void* self,
+                                             iree_allocator_command_t command,
+                                             const void* params,
+                                             void** inout_ptr);
+
+// Returns an iree_allocator_t that allocates from |page_allocator|.
+static inline iree_allocator_t iree_memory_page_allocator(
+    iree_memory_page_allocator_t* page_allocator) {
+  iree_allocator_t v = {page_allocator, iree_memory_page_allocator_ctl};
+  return v;
+}
+
+//===----------------------------------------------------------------------===//
+// NUMA memory placement
+//===----------------------------------------------------------------------===//
+
+// Maximum NUMA node ordinal (exclusive) that can be passed to the binding
+// functions. Matches the range of iree_thread_affinity_t::group.
+#define IREE_MEMORY_NUMA_NODE_LIMIT 128
+
+// Sets the memory policy of the calling thread such that pages it first-touches
+// are preferentially allocated from NUMA |node_id|. The policy is a preference
+// and the kernel will fall back to other nodes when |node_id| is exhausted.
+// Returns IREE_STATUS_UNAVAILABLE on platforms without NUMA memory policies.
+iree_status_t iree_memory_bind_thread_to_numa_node(uint32_t node_id);
+
+// Sets the memory policy of the pages fully contained within the given range
+// such that they are preferentially allocated from NUMA |node_id| when first
+// touched. Partial pages at either end of the range are left unchanged as they
+// may be shared with other allocations. Pages that have already been faulted
+// in are migrated to the node where possible.
+// Returns IREE_STATUS_UNAVAILABLE on platforms without NUMA memory policies.
+iree_status_t iree_memory_bind_range_to_numa_node(void* base_address,
+                                                  iree_host_size_t length,
+                                                  uint32_t node_id);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,202 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/memory.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Returns true if all |length| bytes at |ptr| are |value|.
+static bool IsFilledWith(const void* ptr, iree_host_size_t length,
+                         uint8_t value) {
+  const uint8_t* bytes = (const uint8_t*)ptr;
+  for (iree_host_size_t i = 0; i < length; ++i) {
+    if (bytes[i] != value) return false;
+  }
+  return true;
+}
+
+//==============================================================================
+// Page allocation
+//==============================================================================
+
+class MemoryPagesTest
+    : public ::testing::TestWithParam<iree_memory_page_flags_t> {};
+
+TEST_P(MemoryPagesTest, Granularity) {
+  const iree_host_size_t granularity =
+      iree_memory_pages_granularity(GetParam());
+  EXPECT_TRUE(iree_host_size_is_power_of_two(granularity));
+  EXPECT_GE(granularity, iree_memory_query_info().normal_page_size);
+}
+
+TEST_P(MemoryPagesTest, AllocateZeroed) {
+  // Explicit large pages fall back to other pages if the pool is empty.
+  const iree_host_size_t length =
+      2 * iree_memory_pages_granularity(GetParam());
+  void* base_address = NULL;
+  IREE_ASSERT_OK(
+      iree_memory_pages_allocate(length, GetParam(), &base_address));
+  ASSERT_NE(base_address, nullptr);
+  EXPECT_TRUE(IsFilledWith(base_address, length, 0));
+  memset(base_address, 0xCD, length);
+  iree_memory_pages_free(base_address, length);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllFlags, MemoryPagesTest,
+    ::testing::Values(IREE_MEMORY_PAGE_FLAG_NONE,
+                      IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES,
+                      IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES |
+                          IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES));
+
+TEST(MemoryPagesGranularityTest, NoneIsNormalPageSize) {
+  EXPECT_EQ(iree_memory_pages_granularity(IREE_MEMORY_PAGE_FLAG_NONE),
+            iree_memory_query_info().normal_page_size);
+}
+
+//==============================================================================
+// iree_memory_page_allocator_t
+//==============================================================================
+
+class MemoryPageAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_memory_page_allocator_initialize(
+        IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES, iree_allocator_system(),
+        &page_allocator_);
+    allocator_ = iree_memory_page_allocator(&page_allocator_);
+  }
+
+  void TearDown() override {
+    iree_memory_page_allocator_deinitialize(&page_allocator_);
+  }
+
+  iree_memory_page_allocator_t page_allocator_;
+  iree_allocator_t allocator_;
+};
+
+TEST_F(MemoryPageAllocatorTest, SmallAndLarge) {
+  const iree_host_size_t lengths[] = {
+      1,
+      128,
+      page_allocator_.large_page_size - 1,
+      page_allocator_.large_page_size,
+      3 * page_allocator_.large_page_size + 17,
+  };
+  for (iree_host_size_t length : lengths) {
+    void* ptr = NULL;
+    IREE_ASSERT_OK(iree_allocator_malloc(allocator_, length, &ptr));
+    EXPECT_EQ((uintptr_t)ptr % iree_max_align_t, 0u);
+    EXPECT_TRUE(IsFilledWith(ptr, length, 0)) << length;
+    memset(ptr, 0xCD, length);
+    iree_allocator_free(allocator_, ptr);
+  }
+}
+
+TEST_F(MemoryPageAllocatorTest, LargeAllocationsArePageAligned) {
+  const iree_host_size_t page_size = iree_memory_query_info().normal_page_size;
+  const iree_host_size_t length = page_allocator_.large_page_size;
+  EXPECT_EQ(iree_allocator_query_alignment(allocator_, 128), iree_max_align_t);
+  EXPECT_GE(iree_allocator_query_alignment(allocator_, length), page_size);
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator_, length, &ptr));
+  EXPECT_EQ((uintptr_t)ptr % page_size, 0u);
+  ASSERT_EQ(page_allocator_.allocation_count, 1u);
+  EXPECT_EQ(page_allocator_.allocations[0].page_length, length);
+  iree_allocator_free(allocator_, ptr);
+  EXPECT_EQ(page_allocator_.allocation_count, 0u);
+}
+
+// The allocation table is kept sorted as allocations come and go in any order.
+TEST_F(MemoryPageAllocatorTest, ManyAllocationsOutOfOrder) {
+  const iree_host_size_t length = page_allocator_.large_page_size;
+  std::vector<void*> ptrs(40, nullptr);
+  for (iree_host_size_t i = 0; i < ptrs.size(); ++i) {
+    IREE_ASSERT_OK(iree_allocator_malloc(allocator_, length, &ptrs[i]));
+    memset(ptrs[i], (uint8_t)i, length);
+  }
+  ASSERT_EQ(page_allocator_.allocation_count, ptrs.size());
+  auto expect_sorted = [&]() {
+    for (iree_host_size_t i = 1; i < page_allocator_.allocation_count; ++i) {
+      EXPECT_LT((uintptr_t)page_allocator_.allocations[i - 1].base_address,
+                (uintptr_t)page_allocator_.allocations[i].base_address);
+    }
+  };
+  expect_sorted();
+
+  // Free every third allocation and then the rest in reverse order.
+  for (iree_host_size_t i = 0; i < ptrs.size(); i += 3) {
+    EXPECT_TRUE(IsFilledWith(ptrs[i], length, (uint8_t)i));
+    iree_allocator_free(allocator_, ptrs[i]);
+    ptrs[i] = nullptr;
+  }
+  expect_sorted();
+  for (iree_host_size_t i = ptrs.size(); i-- > 0;) {
+    if (!ptrs[i]) continue;
+    EXPECT_TRUE(IsFilledWith(ptrs[i], length, (uint8_t)i));
+    iree_allocator_free(allocator_, ptrs[i]);
+    expect_sorted();
+  }
+  EXPECT_EQ(page_allocator_.allocation_count, 0u);
+}
+
+TEST_F(MemoryPageAllocatorTest, ZeroLength) {
+  void* ptr = NULL;
+  EXPECT_THAT(Status(iree_allocator_malloc(allocator_, 0, &ptr)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(MemoryPageAllocatorTest, ReallocAcrossThreshold) {
+  const iree_host_size_t small_length = 1000;
+  const iree_host_size_t large_length = 2 * page_allocator_.large_page_size;
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator_, small_length, &ptr));
+  memset(ptr, 0xAB, small_length);
+
+  // Small -> small stays with the delegate.
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator_, 2 * small_length, &ptr));
+  EXPECT_TRUE(IsFilledWith(ptr, small_length, 0xAB));
+  memset(ptr, 0xAB, 2 * small_length);
+
+  // Small -> large moves to pages.
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator_, large_length, &ptr));
+  EXPECT_TRUE(IsFilledWith(ptr, 2 * small_length, 0xAB));
+  memset(ptr, 0xEF, large_length);
+
+  // Large -> small moves back to the delegate.
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator_, small_length, &ptr));
+  EXPECT_TRUE(IsFilledWith(ptr, small_length, 0xEF));
+  iree_allocator_free(allocator_, ptr);
+}
+
+TEST(MemoryPageAllocatorExplicitTest, FallsBackWhenPoolEmpty) {
+  iree_memory_page_allocator_t page_allocator;
+  iree_memory_page_allocator_initialize(
+      IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES |
+          IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES |
+          IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES,
+      iree_allocator_system(), &page_allocator);
+  iree_allocator_t allocator = iree_memory_page_allocator(&page_allocator);
+  const iree_host_size_t length = page_allocator.large_page_size + 1;
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, length, &ptr));
+  EXPECT_TRUE(IsFilledWith(ptr, length, 0));
+  memset(ptr, 0xCD, length);
+  iree_allocator_free(allocator, ptr);
+  iree_memory_page_allocator_deinitialize(&page_allocator);
+}
+
+}  // namespace
+}  // namespace iree
@@ -59,7 +59,7 @@
 
 // MSVC uses architecture-specific intrinsics.
 
-static inline void iree_processor_yield(void) {
+void iree_processor_yield(void) {
 #if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
   // https://docs.microsoft.com/en-us/cpp/intrinsics/x86-intrinsics-list
   _mm_pause();
@@ -75,7 +75,7 @@ static inline void iree_processor_yield(void) {
 
 // Clang/GCC and compatibles use architecture-specific inline assembly.
 
-static inline void iree_processor_yield(void) {
+void iree_processor_yield(void) {
 #if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
   asm volatile("pause");
 #elif defined(IREE_ARCH_ARM_32) || defined(IREE_ARCH_ARM_64)
@@ -582,6 +582,11 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   return true;
 }
 
+bool iree_notification_poll_wait(iree_notification_t* notification,
+                                 iree_wait_token_t wait_token) {
+  return true;
+}
+
 void iree_notification_cancel_wait(iree_notification_t* notification) {}
 
 #elif !defined(IREE_RUNTIME_USE_FUTEX)
@@ -668,6 +673,14 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   return result;
 }
 
+bool iree_notification_poll_wait(iree_notification_t* notification,
+                                 iree_wait_token_t wait_token) {
+  pthread_mutex_lock(&notification->mutex);
+  bool result = notification->epoch != wait_token;
+  pthread_mutex_unlock(&notification->mutex);
+  return result;
+}
+
 void iree_notification_cancel_wait(iree_notification_t* notification) {
   pthread_mutex_lock(&notification->mutex);
   SYNC_ASSERT(notification->waiters > 0);
@@ -802,6 +815,12 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   return result == IREE_NOTIFICATION_RESULT_RESOLVED;
 }
 
+bool iree_notification_poll_wait(iree_notification_t* notification,
+                                 iree_wait_token_t wait_token) {
+  return iree_notification_test_wait_condition(notification, wait_token) ==
+         IREE_NOTIFICATION_RESULT_RESOLVED;
+}
+
 void iree_notification_cancel_wait(iree_notification_t* notification) {
   // TODO(benvanik): benchmark under real workloads.
   // iree_memory_order_relaxed would suffice for correctness but the faster
@@ -78,6 +78,25 @@
 
 #endif  // !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
 
+// Storage class specifier for variables with one instance per thread.
+// Declarations provide their own linkage, such as:
+//   static iree_thread_local uint32_t my_value = 0;
+// When synchronization is disabled there is only ever one thread and the
+// variable is a normal global.
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#define iree_thread_local
+#elif defined(__cplusplus)
+#define iree_thread_local thread_local
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define iree_thread_local _Thread_local
+#elif defined(IREE_COMPILER_MSVC)
+#define iree_thread_local __declspec(thread)
+#elif defined(IREE_COMPILER_GCC_COMPAT)
+#define iree_thread_local __thread
+#else
+#error "thread-local storage is required unless synchronization is disabled"
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -85,6 +104,15 @@ extern "C" {
 #define IREE_ALL_WAITERS INT32_MAX
 #define IREE_INFINITE_TIMEOUT_MS UINT32_MAX
 
+//==============================================================================
+// Cross-platform processor yield (where supported)
+//==============================================================================
+
+// Hints to the processor that the caller is in a spin-wait loop.
+// On processors with SMT this allows the sibling hardware threads to make
+// progress while the caller spins. No-op where not supported.
+void iree_processor_yield(void);
+
 //==============================================================================
 // iree_mutex_t
 //==============================================================================
@@ -424,6 +452,16 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
                                    iree_duration_t spin_ns,
                                    iree_time_t deadline_ns);
 
+// Returns true if a notification has been posted since |wait_token| was
+// prepared. The pending wait is unaffected and must still be committed or
+// canceled. Allows callers to implement their own spin policies before
+// committing to a wait that may block in the system.
+//
+// Acts as (at least) a memory_order_acquire operation on the notification
+// object when returning true.
+bool iree_notification_poll_wait(iree_notification_t* notification,
+                                 iree_wait_token_t wait_token);
+
 // Cancels a pending wait operation without blocking.
 //
 // Acts as (at least) a memory_order_relaxed barrier:
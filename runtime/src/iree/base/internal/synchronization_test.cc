@@ -217,4 +217,24 @@ TEST(NotificationTest, Timeout) {
   iree_notification_deinitialize(&notification);
 }
 
+TEST(NotificationTest, PollWait) {
+  iree_notification_t notification;
+  iree_notification_initialize(&notification);
+
+  // Polling does not consume the pending wait.
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  EXPECT_FALSE(iree_notification_poll_wait(&notification, wait_token));
+  EXPECT_FALSE(iree_notification_poll_wait(&notification, wait_token));
+
+  // Once posted polling succeeds and the wait can be committed without
+  // blocking.
+  iree_notification_post(&notification, IREE_ALL_WAITERS);
+  EXPECT_TRUE(iree_notification_poll_wait(&notification, wait_token));
+  EXPECT_TRUE(iree_notification_commit_wait(
+      &notification, wait_token, /*spin_ns=*/IREE_DURATION_ZERO,
+      /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE));
+
+  iree_notification_deinitialize(&notification);
+}
+
 }  // namespace
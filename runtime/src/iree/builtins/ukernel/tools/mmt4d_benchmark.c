@@ -5,9 +5,11 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <stdio.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/memory.h"
 #include "iree/builtins/ukernel/api.h"
 #include "iree/builtins/ukernel/exported_bits.h"
 #include "iree/builtins/ukernel/mmt4d.h"
@@ -28,6 +30,44 @@ IREE_FLAG(
 IREE_FLAG(bool, accumulate, false,
           "Whether the kernel should accumulate into the existing accumulator "
           "tile values, or zero the accumulator tile.");
+IREE_FLAG(
+    string, large_pages, "",
+    "Allocates the LHS/RHS/accumulator buffers from large pages to compare "
+    "TLB behavior against the default malloc-backed buffers. One of "
+    "'transparent' (THP), 'explicit' (hugetlbfs pool with THP fallback) or "
+    "'explicit_1gb' (1GB pool for buffers of 1GB or more). TLB effects are "
+    "visible once the buffers span many pages, such as with decode-like "
+    "shapes: --m_size=1 --n_size=2048 --k_size=2048.");
+
+// Allocator used for all operand buffers as selected by --large_pages.
+static iree_memory_page_allocator_t iree_uk_benchmark_page_allocator;
+static iree_allocator_t iree_uk_benchmark_buffer_allocator;
+
+static iree_status_t iree_uk_benchmark_initialize_buffer_allocator(void) {
+  iree_memory_page_flags_t flags = IREE_MEMORY_PAGE_FLAG_NONE;
+  if (strlen(FLAG_large_pages) == 0) {
+    iree_uk_benchmark_buffer_allocator = iree_allocator_system();
+    return iree_ok_status();
+  } else if (strcmp(FLAG_large_pages, "transparent") == 0) {
+    flags = IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES;
+  } else if (strcmp(FLAG_large_pages, "explicit") == 0) {
+    flags = IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES |
+            IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES;
+  } else if (strcmp(FLAG_large_pages, "explicit_1gb") == 0) {
+    flags = IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES |
+            IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES |
+            IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported large page mode '%s'",
+                            FLAG_large_pages);
+  }
+  iree_memory_page_allocator_initialize(flags, iree_allocator_system(),
+                                        &iree_uk_benchmark_page_allocator);
+  iree_uk_benchmark_buffer_allocator =
+      iree_memory_page_allocator(&iree_uk_benchmark_page_allocator);
+  return iree_ok_status();
+}
 
 static iree_status_t iree_uk_benchmark_mmt4d(
     const iree_benchmark_def_t* benchmark_def,
@@ -55,9 +95,16 @@ static iree_status_t iree_uk_benchmark_mmt4d(
       iree_uk_2d_buffer_length(rhs_type, params.N, params.rhs_stride0);
   iree_uk_index_t out_buffer_size =
       iree_uk_2d_buffer_length(out_type, params.M, params.out_stride0);
-  void* lhs_buffer = malloc(lhs_buffer_size);
-  void* rhs_buffer = malloc(rhs_buffer_size);
-  void* out_buffer = malloc(out_buffer_size);
+  iree_allocator_t allocator = iree_uk_benchmark_buffer_allocator;
+  void* lhs_buffer = NULL;
+  void* rhs_buffer = NULL;
+  void* out_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+      allocator, lhs_buffer_size, &lhs_buffer));
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+      allocator, rhs_buffer_size, &rhs_buffer));
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+      allocator, out_buffer_size, &out_buffer));
   iree_uk_random_engine_t* engine = iree_uk_benchmark_random_engine(user_data);
   // It's just about plausible that on some platform, for some number type,
   // performance might be different on zero buffers vs random buffers. But it
@@ -81,9 +128,9 @@ static iree_status_t iree_uk_benchmark_mmt4d(
   iree_benchmark_set_items_processed(
       benchmark_state, total_iterations * 2 * params.M * params.N * params.K *
                            params.M0 * params.N0 * params.K0);
-  free(lhs_buffer);
-  free(rhs_buffer);
-  free(out_buffer);
+  iree_allocator_free(allocator, lhs_buffer);
+  iree_allocator_free(allocator, rhs_buffer);
+  iree_allocator_free(allocator, out_buffer);
   return iree_ok_status();
 }
 
@@ -123,6 +170,7 @@ int main(int argc, char** argv) {
 
   iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
   iree_uk_benchmark_initialize(&argc, argv);
+  IREE_CHECK_OK(iree_uk_benchmark_initialize_buffer_allocator());
 
 #if defined(IREE_ARCH_ARM_64)
   iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 8, 8, 1,
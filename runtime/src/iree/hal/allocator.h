@@ -439,6 +439,25 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t data_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
 
+// Indicates that a queue is not associated with any particular NUMA node.
+#define IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY UINT32_MAX
+
+// Creates a host-local heap allocator as with iree_hal_allocator_create_heap
+// that places buffer storage on the NUMA node of the queues it is allocated
+// for. |queue_node_ids| maps each of the |queue_count| queue ordinals to the
+// NUMA node the queue executes on (or IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY).
+// Queue affinity bits beyond |queue_count| wrap around as they do when devices
+// select queues.
+//
+// Buffers whose queue affinity resolves to queues all on the same node have
+// their storage bound to that node; all others (including those allocated for
+// any queue on a multi-node device) use the default system policy. Binding is
+// best-effort and silently ignored if unsupported by the platform.
+IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap_numa(
+    iree_string_view_t identifier, iree_host_size_t queue_count,
+    const uint32_t* queue_node_ids, iree_allocator_t data_allocator,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t implementation details
 //===----------------------------------------------------------------------===//
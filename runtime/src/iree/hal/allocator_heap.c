@@ -7,6 +7,8 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/memory.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
 #include "iree/hal/buffer_heap_impl.h"
@@ -18,8 +20,17 @@ typedef struct iree_hal_heap_allocator_t {
   iree_allocator_t data_allocator;
   iree_string_view_t identifier;
   IREE_STATISTICS(iree_hal_heap_allocator_statistics_t statistics;)
+  // NUMA node of each queue ordinal or IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY.
+  // Empty if the allocator is not NUMA-aware.
+  iree_host_size_t queue_count;
+  uint32_t queue_node_ids[];
 } iree_hal_heap_allocator_t;
 
+// Minimum buffer size that will have its storage bound to a NUMA node.
+// Smaller buffers share pages with other allocations (so can't be bound
+// anyway) and aren't worth the syscall.
+#define IREE_HAL_HEAP_ALLOCATOR_NUMA_MIN_SIZE (64 * 1024)
+
 static const iree_hal_allocator_vtable_t iree_hal_heap_allocator_vtable;
 
 iree_hal_heap_allocator_t* iree_hal_heap_allocator_cast(
@@ -30,13 +41,32 @@ iree_hal_heap_allocator_t* iree_hal_heap_allocator_cast(
 IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t data_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  return iree_hal_allocator_create_heap_numa(
+      identifier, /*queue_count=*/0, /*queue_node_ids=*/NULL, data_allocator,
+      host_allocator, out_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap_numa(
+    iree_string_view_t identifier, iree_host_size_t queue_count,
+    const uint32_t* queue_node_ids, iree_allocator_t data_allocator,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(!queue_count || queue_node_ids);
   IREE_ASSERT_ARGUMENT(out_allocator);
   *out_allocator = NULL;
+  if (queue_count > sizeof(iree_hal_queue_affinity_t) * 8) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "queue count %" PRIhsz
+                            " exceeds the queue affinity bit count",
+                            queue_count);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_heap_allocator_t* allocator = NULL;
+  iree_host_size_t node_ids_size =
+      iree_host_align(queue_count * sizeof(allocator->queue_node_ids[0]),
+                      iree_max_align_t);
   iree_host_size_t total_size =
-      iree_sizeof_struct(*allocator) + identifier.size;
+      iree_sizeof_struct(*allocator) + node_ids_size + identifier.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&allocator);
   if (iree_status_is_ok(status)) {
@@ -44,9 +74,13 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
                                  &allocator->resource);
     allocator->host_allocator = host_allocator;
     allocator->data_allocator = data_allocator;
+    allocator->queue_count = queue_count;
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
+      allocator->queue_node_ids[i] = queue_node_ids[i];
+    }
     iree_string_view_append_to_buffer(
         identifier, &allocator->identifier,
-        (char*)allocator + iree_sizeof_struct(*allocator));
+        (char*)allocator + iree_sizeof_struct(*allocator) + node_ids_size);
 
     IREE_STATISTICS({
       // All start initialized to zero.
@@ -60,6 +94,30 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
   return status;
 }
 
+// Returns the NUMA node shared by all queues in |queue_affinity| or
+// IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY if they span nodes (or are unknown).
+static uint32_t iree_hal_heap_allocator_select_node(
+    iree_hal_heap_allocator_t* allocator,
+    iree_hal_queue_affinity_t queue_affinity) {
+  if (!allocator->queue_count) return IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY;
+  if (iree_hal_queue_affinity_is_empty(queue_affinity)) {
+    queue_affinity = IREE_HAL_QUEUE_AFFINITY_ANY;
+  }
+  uint32_t node_id = IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY;
+  IREE_HAL_FOR_QUEUE_AFFINITY(queue_affinity) {
+    uint32_t queue_node_id =
+        allocator->queue_node_ids[queue_ordinal % allocator->queue_count];
+    if (queue_node_id == IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY) {
+      return IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY;
+    } else if (queue_index == 0) {
+      node_id = queue_node_id;
+    } else if (queue_node_id != node_id) {
+      return IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY;
+    }
+  }
+  return node_id;
+}
+
 static void iree_hal_heap_allocator_destroy(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
   iree_hal_heap_allocator_t* allocator =
@@ -153,7 +211,8 @@ iree_hal_heap_allocator_query_buffer_compatibility(
       compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
     }
     if (iree_any_bit_set(params->usage,
-                         IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE)) {
+                         IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                             IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS)) {
       compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH;
     }
   }
@@ -201,6 +260,20 @@ static iree_status_t iree_hal_heap_allocator_allocate_buffer(
       statistics, &compat_params, allocation_size, allocator->data_allocator,
       allocator->host_allocator, &buffer));
 
+  // Place the storage on the node of the queues that will be using it. Pages
+  // that have not yet been touched (the common case for large allocations that
+  // come directly from the system) will be faulted in on the node and any that
+  // were reused from prior allocations are migrated.
+  if (allocation_size >= IREE_HAL_HEAP_ALLOCATOR_NUMA_MIN_SIZE) {
+    uint32_t node_id = iree_hal_heap_allocator_select_node(
+        allocator, compat_params.queue_affinity);
+    if (node_id != IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY) {
+      iree_byte_span_t storage = iree_hal_heap_buffer_storage(buffer);
+      iree_status_ignore(iree_memory_bind_range_to_numa_node(
+          storage.data, storage.data_length, node_id));
+    }
+  }
+
   *out_buffer = buffer;
   return iree_ok_status();
 }
@@ -28,6 +28,11 @@ typedef enum iree_hal_heap_buffer_storage_mode_e {
   // A user-provided buffer release callback is notified that the buffer is no
   // longer referencing the data.
   IREE_HAL_HEAP_BUFFER_STORAGE_MODE_EXTERNAL = 2u,
+  // Allocated as split [metadata] and [data] where the data allocator already
+  // guarantees the buffer alignment and the data is not padded.
+  // The base metadata pointer must be freed with iree_allocator_free.
+  // The data storage must be freed with iree_allocator_free.
+  IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT_UNPADDED = 3u,
 } iree_hal_heap_buffer_storage_mode_t;
 
 typedef struct iree_hal_heap_buffer_t {
@@ -57,18 +62,23 @@ static const iree_hal_buffer_vtable_t iree_hal_heap_buffer_vtable;
 
 // Allocates a buffer with the metadata and storage split.
 // This results in an additional host allocation but allows for user-overridden
-// data storage allocations.
+// data storage allocations. If |data_aligned| is true the data allocator
+// guarantees the buffer alignment and the storage is allocated unpadded.
 static iree_status_t iree_hal_heap_buffer_allocate_split(
     iree_device_size_t allocation_size, iree_allocator_t data_allocator,
-    iree_allocator_t host_allocator, iree_hal_heap_buffer_t** out_buffer,
-    iree_byte_span_t* out_data) {
+    bool data_aligned, iree_allocator_t host_allocator,
+    iree_hal_heap_buffer_t** out_buffer, iree_byte_span_t* out_data) {
   // Try allocating the storage first as it's the most likely to fail if OOM.
   // It must be aligned to the minimum buffer alignment.
   out_data->data_length = allocation_size;
   uint8_t* data_ptr = 0;
-  IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
-      data_allocator, allocation_size, IREE_HAL_HEAP_BUFFER_ALIGNMENT,
-      /*offset=*/0, (void**)&data_ptr));
+  IREE_RETURN_IF_ERROR(
+      data_aligned
+          ? iree_allocator_malloc(data_allocator, allocation_size,
+                                  (void**)&data_ptr)
+          : iree_allocator_malloc_aligned(data_allocator, allocation_size,
+                                          IREE_HAL_HEAP_BUFFER_ALIGNMENT,
+                                          /*offset=*/0, (void**)&data_ptr));
   IREE_ASSERT_TRUE(iree_host_size_has_alignment(
       (iree_host_size_t)data_ptr, IREE_HAL_HEAP_BUFFER_ALIGNMENT));
   out_data->data = data_ptr;
@@ -78,7 +88,11 @@ static iree_status_t iree_hal_heap_buffer_allocate_split(
       host_allocator, sizeof(**out_buffer), (void**)out_buffer);
   if (!iree_status_is_ok(status)) {
     // Need to free the storage we just allocated.
-    iree_allocator_free_aligned(data_allocator, out_data->data);
+    if (data_aligned) {
+      iree_allocator_free(data_allocator, out_data->data);
+    } else {
+      iree_allocator_free_aligned(data_allocator, out_data->data);
+    }
   }
   return status;
 }
@@ -123,20 +137,28 @@ iree_status_t iree_hal_heap_buffer_create(
   IREE_ASSERT_ARGUMENT(out_buffer);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // If the data and host allocators are the same we can allocate more
-  // efficiently as a large slab. Otherwise we need to allocate both the
-  // metadata and the storage independently.
-  const bool same_allocator =
+  // If the data allocator already guarantees the buffer alignment (such as
+  // when returning whole pages) the storage is allocated on its own without
+  // padding so that it keeps that placement. Otherwise if the data and host
+  // allocators are the same we can allocate more efficiently as a large slab.
+  // Otherwise we need to allocate both the metadata and the storage
+  // independently.
+  const bool data_aligned =
+      iree_allocator_query_alignment(data_allocator,
+                                     (iree_host_size_t)allocation_size) >=
+      IREE_HAL_HEAP_BUFFER_ALIGNMENT;
+  const bool use_slab =
+      !data_aligned &&
       memcmp(&data_allocator, &host_allocator, sizeof(data_allocator)) == 0;
 
   iree_hal_heap_buffer_t* buffer = NULL;
   iree_byte_span_t data = iree_make_byte_span(NULL, 0);
   iree_status_t status =
-      same_allocator
-          ? iree_hal_heap_buffer_allocate_slab(allocation_size, host_allocator,
-                                               &buffer, &data)
-          : iree_hal_heap_buffer_allocate_split(allocation_size, data_allocator,
-                                                host_allocator, &buffer, &data);
+      use_slab ? iree_hal_heap_buffer_allocate_slab(
+                     allocation_size, host_allocator, &buffer, &data)
+               : iree_hal_heap_buffer_allocate_split(
+                     allocation_size, data_allocator, data_aligned,
+                     host_allocator, &buffer, &data);
 
   if (iree_status_is_ok(status)) {
     iree_hal_buffer_initialize(
@@ -146,11 +168,13 @@ iree_status_t iree_hal_heap_buffer_create(
     buffer->host_allocator = host_allocator;
     buffer->data = data;
 
-    if (same_allocator) {
+    if (use_slab) {
       buffer->base.flags = IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SLAB;
       buffer->data_allocator = iree_allocator_null();
     } else {
-      buffer->base.flags = IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT;
+      buffer->base.flags =
+          data_aligned ? IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT_UNPADDED
+                       : IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT;
       buffer->data_allocator = data_allocator;
     }
 
@@ -171,6 +195,11 @@ iree_status_t iree_hal_heap_buffer_create(
   return status;
 }
 
+iree_byte_span_t iree_hal_heap_buffer_storage(iree_hal_buffer_t* base_buffer) {
+  iree_hal_heap_buffer_t* buffer = (iree_hal_heap_buffer_t*)base_buffer;
+  return buffer->data;
+}
+
 iree_status_t iree_hal_heap_buffer_wrap(
     iree_hal_buffer_placement_t placement, iree_hal_memory_type_t memory_type,
     iree_hal_memory_access_t allowed_access,
@@ -233,6 +262,11 @@ static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
       break;
     }
     case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT: {
+      iree_allocator_free_aligned(buffer->data_allocator, buffer->data.data);
+      iree_allocator_free(host_allocator, buffer);
+      break;
+    }
+    case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT_UNPADDED: {
       iree_allocator_free(buffer->data_allocator, buffer->data.data);
       iree_allocator_free(host_allocator, buffer);
       break;
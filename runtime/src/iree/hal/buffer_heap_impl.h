@@ -36,6 +36,9 @@ iree_status_t iree_hal_heap_buffer_create(
     iree_allocator_t data_allocator, iree_allocator_t host_allocator,
     iree_hal_buffer_t** out_buffer);
 
+// Returns the storage of a buffer created with iree_hal_heap_buffer_create.
+iree_byte_span_t iree_hal_heap_buffer_storage(iree_hal_buffer_t* buffer);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
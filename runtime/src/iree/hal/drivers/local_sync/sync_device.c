@@ -14,6 +14,7 @@
 #include "iree/base/internal/cpu.h"
 #include "iree/hal/drivers/local_sync/sync_event.h"
 #include "iree/hal/drivers/local_sync/sync_semaphore.h"
+#include "iree/hal/local/dispatch_counters.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/inline_command_buffer.h"
 #include "iree/hal/local/local_executable_cache.h"
@@ -31,6 +32,11 @@ typedef struct iree_hal_sync_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Collector used when profiling with
+  // IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS. Referenced by all
+  // executables prepared by the device.
+  iree_hal_local_dispatch_counters_t dispatch_counters;
+
   // Block pool used for command buffers with a larger block size (as command
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t large_block_pool;
@@ -96,6 +102,8 @@ iree_status_t iree_hal_sync_device_create(
     iree_string_view_append_to_buffer(identifier, &device->identifier,
                                       (char*)device + struct_size);
     device->host_allocator = host_allocator;
+    iree_hal_local_dispatch_counters_initialize(host_allocator,
+                                                &device->dispatch_counters);
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
     iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
@@ -124,6 +132,8 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_local_dispatch_counters_deinitialize(&device->dispatch_counters);
+
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
@@ -261,7 +271,8 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   return iree_hal_local_executable_cache_create(
       identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+      &device->dispatch_counters, iree_hal_device_host_allocator(base_device),
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_sync_device_import_file(
@@ -458,27 +469,28 @@ static iree_status_t iree_hal_sync_device_wait_semaphores(
 static iree_status_t iree_hal_sync_device_profiling_begin(
     iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  // Only dispatch counters are implemented; other modes are ignored (and
+  // that's ok).
+  if (!iree_all_bits_set(options->mode,
+                         IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS)) {
+    return iree_ok_status();
+  }
+  return iree_hal_local_dispatch_counters_begin(
+      &device->dispatch_counters,
+      iree_make_cstring_view(options->file_path ? options->file_path : ""));
 }
 
 static iree_status_t iree_hal_sync_device_profiling_flush(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  return iree_hal_local_dispatch_counters_flush(&device->dispatch_counters);
 }
 
 static iree_status_t iree_hal_sync_device_profiling_end(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  return iree_hal_local_dispatch_counters_end(&device->dispatch_counters);
 }
 
 static const iree_hal_device_vtable_t iree_hal_sync_device_vtable = {
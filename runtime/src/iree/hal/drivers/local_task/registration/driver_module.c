@@ -19,6 +19,11 @@
 IREE_FLAG(
     bool, task_abort_on_failure, false,
     "Aborts the program on the first failure within a task system queue.");
+IREE_FLAG(bool, task_sticky_dispatch, false,
+          "Keeps each range of workgroups of a dispatch on the same worker "
+          "every time it is issued from a command buffer. Improves cache reuse "
+          "for dispatches repeated each step (such as LLM decode) at the cost "
+          "of less dynamic load balancing.");
 
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
@@ -49,6 +54,9 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
   if (FLAG_task_abort_on_failure) {
     default_params.queue_scope_flags |= IREE_TASK_SCOPE_FLAG_ABORT_ON_FAILURE;
   }
+  if (FLAG_task_sticky_dispatch) {
+    default_params.queue_scope_flags |= IREE_TASK_SCOPE_FLAG_STICKY_DISPATCHES;
+  }
 
   // Create executors for each topology specified by flags.
   // Stack allocated storage today but we can query for the total count and
@@ -74,11 +82,21 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
   }
 
   // TODO(benvanik): allow this to be injected to share across drivers.
+  // Each executor becomes a device queue and buffers allocated for a queue are
+  // placed on the NUMA node its workers run on (if known).
   iree_hal_allocator_t* device_allocator = NULL;
   if (iree_status_is_ok(status)) {
-    status = iree_hal_allocator_create_heap(iree_make_cstring_view("local"),
-                                            host_allocator, host_allocator,
-                                            &device_allocator);
+    uint32_t queue_node_ids[IREE_ARRAYSIZE(executor_storage)];
+    for (iree_host_size_t i = 0; i < executor_count; ++i) {
+      iree_task_topology_node_id_t node_id =
+          iree_task_executor_node_id(executors[i]);
+      queue_node_ids[i] = node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY
+                              ? IREE_HAL_HEAP_ALLOCATOR_NODE_ID_ANY
+                              : node_id;
+    }
+    status = iree_hal_allocator_create_heap_numa(
+        iree_make_cstring_view("local"), executor_count, queue_node_ids,
+        host_allocator, host_allocator, &device_allocator);
   }
 
   // Create a task driver that will use the given executors for scheduling work
@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
@@ -33,12 +34,44 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
+//
+// Reusable command buffers (not IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) keep
+// their task DAG after issue as a graph: when recording ends we snapshot the
+// mutable state of every task and each issue restores it instead of rebuilding
+// the DAG. Steady-state submissions then only allocate a single exit task from
+// the submission arena. The tasks can only be used by one submission at a time
+// and overlapping submissions are queued until the prior one exits.
+
+// Linked list node tracking a task recorded into a reusable command buffer.
+typedef struct iree_hal_task_graph_node_t {
+  struct iree_hal_task_graph_node_t* next;
+  iree_task_t* task;
+} iree_hal_task_graph_node_t;
+
+// A task in a reusable command buffer and the state of its mutable fields as
+// they were when recording ended.
+typedef struct iree_hal_task_graph_entry_t {
+  iree_task_t* task;
+  iree_task_t* completion_task;
+  int32_t pending_dependency_count;
+  iree_task_flags_t flags;
+  // Workgroup count of IREE_TASK_TYPE_DISPATCH tasks. Indirect dispatches
+  // replace the pointer with the value it references when issued.
+  union {
+    uint32_t value[3];
+    const uint32_t* ptr;
+  } workgroup_count;
+} iree_hal_task_graph_entry_t;
+
 typedef struct iree_hal_task_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
   iree_task_scope_t* scope;
 
+  // Number of workers in the executor the command buffer is issued on.
+  iree_host_size_t worker_count;
+
   // Arena used for all allocations; references the shared device block pool.
   iree_arena_allocator_t arena;
 
@@ -77,6 +110,37 @@ typedef struct iree_hal_task_command_buffer_t {
     // All execution tasks emitted that must execute after |open_barrier|.
     iree_task_list_t open_tasks;
   } state;
+
+  // Reusable task graph used when the command buffer is not one-shot.
+  // Populated when recording ends and immutable afterward except for the
+  // fields guarded by |mutex|.
+  struct {
+    // All tasks recorded, most recent first. Only valid during recording.
+    iree_hal_task_graph_node_t* recorded_tasks;
+    iree_host_size_t recorded_task_count;
+
+    // Snapshot of every task in the DAG restored prior to each issue.
+    iree_host_size_t entry_count;
+    iree_hal_task_graph_entry_t* entries;
+
+    // Tasks that are ready to execute when the graph is issued.
+    iree_host_size_t root_count;
+    iree_task_t** roots;
+
+    // Tasks that must complete before the graph is considered complete.
+    iree_host_size_t leaf_count;
+    iree_task_t** leaves;
+
+    // Guards |in_flight| and |pending_exits|.
+    iree_slim_mutex_t mutex;
+
+    // True while a submission is executing the graph tasks.
+    bool in_flight;
+
+    // Exit tasks of submissions waiting on the in-flight submission to complete
+    // before they can execute the graph, in submission order.
+    iree_task_list_t pending_exits;
+  } graph;
 } iree_hal_task_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -90,7 +154,7 @@ static iree_hal_task_command_buffer_t* iree_hal_task_command_buffer_cast(
 
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_allocator_t* device_allocator, iree_task_scope_t* scope,
-    iree_hal_command_buffer_mode_t mode,
+    iree_host_size_t worker_count, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
@@ -98,19 +162,6 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
   if (binding_capacity > 0) {
     // TODO(#10144): support indirect command buffers with binding tables.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
@@ -132,10 +183,14 @@ iree_status_t iree_hal_task_command_buffer_create(
         &iree_hal_task_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
     command_buffer->scope = scope;
+    command_buffer->worker_count = worker_count;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+    memset(&command_buffer->graph, 0, sizeof(command_buffer->graph));
+    iree_slim_mutex_initialize(&command_buffer->graph.mutex);
+    iree_task_list_initialize(&command_buffer->graph.pending_exits);
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
   }
@@ -159,6 +214,8 @@ static void iree_hal_task_command_buffer_destroy(
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
   iree_task_list_discard(&command_buffer->root_tasks);
   iree_task_list_discard(&command_buffer->leaf_tasks);
+  IREE_ASSERT(!command_buffer->graph.in_flight);
+  iree_slim_mutex_deinitialize(&command_buffer->graph.mutex);
   iree_arena_deinitialize(&command_buffer->arena);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_allocator_free(host_allocator, command_buffer);
@@ -172,6 +229,13 @@ bool iree_hal_task_command_buffer_isa(
                               &iree_hal_task_command_buffer_vtable);
 }
 
+// Returns true if the command buffer keeps its task DAG for reuse.
+static bool iree_hal_task_command_buffer_is_graph(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  return !iree_all_bits_set(iree_hal_command_buffer_mode(&command_buffer->base),
+                            IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_task_command_buffer_t recording
 //===----------------------------------------------------------------------===//
@@ -183,13 +247,17 @@ static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  if (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+  if (!iree_task_list_is_empty(&command_buffer->root_tasks) ||
+      command_buffer->graph.entries != NULL) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
   return iree_ok_status();
 }
 
+static iree_status_t iree_hal_task_command_buffer_snapshot_graph(
+    iree_hal_task_command_buffer_t* command_buffer);
+
 static iree_status_t iree_hal_task_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
@@ -209,6 +277,11 @@ static iree_status_t iree_hal_task_command_buffer_end(
 
   iree_hal_resource_set_freeze(command_buffer->resource_set);
 
+  if (iree_hal_task_command_buffer_is_graph(command_buffer)) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_snapshot_graph(command_buffer));
+  }
+
   return iree_ok_status();
 }
 
@@ -261,6 +334,22 @@ static iree_status_t iree_hal_task_command_buffer_flush_tasks(
   return iree_ok_status();
 }
 
+// Tracks |task| as part of the reusable graph, if the command buffer is one.
+static iree_status_t iree_hal_task_command_buffer_track_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
+  if (!iree_hal_task_command_buffer_is_graph(command_buffer)) {
+    return iree_ok_status();
+  }
+  iree_hal_task_graph_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*node), (void**)&node));
+  node->next = command_buffer->graph.recorded_tasks;
+  node->task = task;
+  command_buffer->graph.recorded_tasks = node;
+  ++command_buffer->graph.recorded_task_count;
+  return iree_ok_status();
+}
+
 // Emits a global barrier, splitting execution into all prior recorded tasks
 // and all subsequent recorded tasks. This is currently the critical piece that
 // limits our concurrency: changing to fine-grained barriers (via barrier
@@ -283,6 +372,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
                                            sizeof(*barrier), (void**)&barrier));
   iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_task(
+      command_buffer, &barrier->header));
 
   // If there were previous tasks then join them to the barrier.
   for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
@@ -319,6 +410,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
 // scope (after state.open_barrier and before the next barrier).
 static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
     iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_track_task(command_buffer, task));
   if (command_buffer->state.open_barrier == NULL) {
     // If there is no open barrier then we are at the head and going right into
     // the task DAG.
@@ -331,10 +424,245 @@ static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
   return iree_ok_status();
 }
 
+// Copies the tasks in |list| into an array allocated from the arena.
+static iree_status_t iree_hal_task_command_buffer_flatten_task_list(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_list_t* list,
+    iree_host_size_t* out_task_count, iree_task_t*** out_tasks) {
+  iree_host_size_t task_count = iree_task_list_calculate_size(list);
+  iree_task_t** tasks = NULL;
+  if (task_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                             task_count * sizeof(*tasks),
+                                             (void**)&tasks));
+  }
+  iree_host_size_t i = 0;
+  for (iree_task_t* task = iree_task_list_front(list); task != NULL;
+       task = task->next_task) {
+    tasks[i++] = task;
+  }
+  *out_task_count = task_count;
+  *out_tasks = tasks;
+  return iree_ok_status();
+}
+
+// Snapshots the recorded task DAG so that it can be restored on each issue.
+// The root and leaf lists are moved into arrays as the intrusive list pointers
+// are overwritten by the task system as soon as the tasks are issued.
+static iree_status_t iree_hal_task_command_buffer_snapshot_graph(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0,
+                                   command_buffer->graph.recorded_task_count);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_task_command_buffer_flatten_task_list(
+              command_buffer, &command_buffer->root_tasks,
+              &command_buffer->graph.root_count, &command_buffer->graph.roots));
+  if (!iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0,
+        iree_hal_task_command_buffer_flatten_task_list(
+            command_buffer, &command_buffer->leaf_tasks,
+            &command_buffer->graph.leaf_count, &command_buffer->graph.leaves));
+  } else {
+    // Single layer DAG: the root tasks are also the leaves.
+    command_buffer->graph.leaf_count = command_buffer->graph.root_count;
+    command_buffer->graph.leaves = command_buffer->graph.roots;
+  }
+
+  iree_host_size_t entry_count = command_buffer->graph.recorded_task_count;
+  iree_hal_task_graph_entry_t* entries = NULL;
+  if (entry_count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(&command_buffer->arena,
+                                entry_count * sizeof(*entries),
+                                (void**)&entries));
+  }
+  iree_hal_task_graph_node_t* node = command_buffer->graph.recorded_tasks;
+  for (iree_host_size_t i = entry_count; i > 0; --i, node = node->next) {
+    iree_hal_task_graph_entry_t* entry = &entries[i - 1];
+    iree_task_t* task = node->task;
+    memset(entry, 0, sizeof(*entry));
+    entry->task = task;
+    entry->completion_task = task->completion_task;
+    entry->pending_dependency_count = iree_atomic_load(
+        &task->pending_dependency_count, iree_memory_order_acquire);
+    entry->flags = task->flags;
+    if (task->type == IREE_TASK_TYPE_DISPATCH) {
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      static_assert(sizeof(entry->workgroup_count) ==
+                        sizeof(dispatch_task->workgroup_count),
+                    "workgroup count storage must match the dispatch task");
+      memcpy(&entry->workgroup_count, &dispatch_task->workgroup_count,
+             sizeof(entry->workgroup_count));
+    }
+  }
+  command_buffer->graph.entry_count = entry_count;
+  command_buffer->graph.entries = entries;
+  command_buffer->graph.recorded_tasks = NULL;
+
+  // The tasks are owned by the graph from here on and must not be discarded
+  // with the lists.
+  iree_task_list_initialize(&command_buffer->root_tasks);
+  iree_task_list_initialize(&command_buffer->leaf_tasks);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Task joining all leaf tasks of a reusable command buffer for one submission.
+// Allocated from the submission arena and completes into the retire task of
+// the submission.
+typedef struct iree_hal_task_cmd_graph_exit_t {
+  iree_task_call_t task;
+  iree_hal_task_command_buffer_t* command_buffer;
+  // Set once the graph tasks have been handed off to the next pending
+  // submission or released for new submissions.
+  bool released;
+} iree_hal_task_cmd_graph_exit_t;
+
+// Restores the graph tasks to their recorded state, joins the leaves on
+// |exit_task|, and enqueues the roots into |pending_submission|.
+// The caller must have exclusive use of the graph tasks.
+static void iree_hal_task_command_buffer_launch_graph(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* exit_task,
+    iree_task_submission_t* pending_submission) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Tasks retire destructively: the completion task is cleared, dependency
+  // counts are consumed, and dispatches set flags and resolve indirect
+  // workgroup counts in-place. Call and dispatch status is consumed on retire.
+  for (iree_host_size_t i = 0; i < command_buffer->graph.entry_count; ++i) {
+    const iree_hal_task_graph_entry_t* entry =
+        &command_buffer->graph.entries[i];
+    iree_task_t* task = entry->task;
+    task->next_task = NULL;
+    task->completion_task = entry->completion_task;
+    task->flags = entry->flags;
+    iree_atomic_store(&task->pending_dependency_count,
+                      entry->pending_dependency_count,
+                      iree_memory_order_release);
+    if (task->type == IREE_TASK_TYPE_DISPATCH) {
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      memcpy(&dispatch_task->workgroup_count, &entry->workgroup_count,
+             sizeof(dispatch_task->workgroup_count));
+      memset(&dispatch_task->statistics, 0,
+             sizeof(dispatch_task->statistics));
+    }
+  }
+
+  for (iree_host_size_t i = 0; i < command_buffer->graph.leaf_count; ++i) {
+    iree_task_set_completion_task(command_buffer->graph.leaves[i], exit_task);
+  }
+
+  iree_task_list_t ready_tasks;
+  iree_task_list_initialize(&ready_tasks);
+  for (iree_host_size_t i = 0; i < command_buffer->graph.root_count; ++i) {
+    iree_task_list_push_back(&ready_tasks, command_buffer->graph.roots[i]);
+  }
+  iree_task_submission_enqueue_list(pending_submission, &ready_tasks);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Runs once all graph tasks of a submission have retired and hands the graph
+// off to the next submission waiting on it, if any.
+static iree_status_t iree_hal_task_cmd_graph_exit(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  iree_hal_task_cmd_graph_exit_t* cmd =
+      (iree_hal_task_cmd_graph_exit_t*)user_context;
+  iree_hal_task_command_buffer_t* command_buffer = cmd->command_buffer;
+
+  iree_slim_mutex_lock(&command_buffer->graph.mutex);
+  iree_task_t* next_exit_task =
+      iree_task_list_pop_front(&command_buffer->graph.pending_exits);
+  if (next_exit_task == NULL) command_buffer->graph.in_flight = false;
+  iree_slim_mutex_unlock(&command_buffer->graph.mutex);
+  cmd->released = true;
+
+  // The next submission is only able to run once we flush the pending
+  // submission after this task has retired.
+  if (next_exit_task != NULL) {
+    iree_hal_task_command_buffer_launch_graph(command_buffer, next_exit_task,
+                                              pending_submission);
+  }
+  return iree_ok_status();
+}
+
+// Cleanup for iree_hal_task_cmd_graph_exit_t that releases the graph if the
+// exit was aborted due to a failure in the scope. Submissions waiting to use
+// the graph are discarded as they would be aborted anyway.
+static void iree_hal_task_cmd_graph_exit_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_cmd_graph_exit_t* cmd = (iree_hal_task_cmd_graph_exit_t*)task;
+  if (cmd->released) return;
+  iree_hal_task_command_buffer_t* command_buffer = cmd->command_buffer;
+
+  iree_task_list_t discard_worklist;
+  iree_task_list_initialize(&discard_worklist);
+  iree_slim_mutex_lock(&command_buffer->graph.mutex);
+  iree_task_list_move(&command_buffer->graph.pending_exits, &discard_worklist);
+  command_buffer->graph.in_flight = false;
+  iree_slim_mutex_unlock(&command_buffer->graph.mutex);
+
+  // Mark the pending exits as released so that their own cleanup doesn't
+  // release the graph out from under any new submission.
+  for (iree_task_t* pending_task = iree_task_list_front(&discard_worklist);
+       pending_task != NULL; pending_task = pending_task->next_task) {
+    ((iree_hal_task_cmd_graph_exit_t*)pending_task)->released = true;
+  }
+  iree_task_list_discard(&discard_worklist);
+}
+
+// Issues a reusable command buffer by restoring its graph tasks.
+// Only one submission may use the graph tasks at a time and if one is still
+// executing the new submission is queued until it exits.
+static iree_status_t iree_hal_task_command_buffer_issue_graph(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* retire_task,
+    iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission) {
+  // If the command buffer is empty (valid!) then we are a no-op.
+  if (command_buffer->graph.root_count == 0) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_task_cmd_graph_exit_t* cmd = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(arena, sizeof(*cmd), (void**)&cmd));
+  iree_task_call_initialize(
+      command_buffer->scope,
+      iree_task_make_call_closure(iree_hal_task_cmd_graph_exit, (void*)cmd),
+      &cmd->task);
+  iree_task_set_cleanup_fn(&cmd->task.header,
+                           iree_hal_task_cmd_graph_exit_cleanup);
+  iree_task_set_completion_task(&cmd->task.header, retire_task);
+  cmd->command_buffer = command_buffer;
+  cmd->released = false;
+
+  iree_slim_mutex_lock(&command_buffer->graph.mutex);
+  const bool launch = !command_buffer->graph.in_flight;
+  if (launch) {
+    command_buffer->graph.in_flight = true;
+  } else {
+    iree_task_list_push_back(&command_buffer->graph.pending_exits,
+                             &cmd->task.header);
+  }
+  iree_slim_mutex_unlock(&command_buffer->graph.mutex);
+
+  if (launch) {
+    iree_hal_task_command_buffer_launch_graph(
+        command_buffer, &cmd->task.header, pending_submission);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -343,6 +671,11 @@ iree_status_t iree_hal_task_command_buffer_issue(
       iree_hal_task_command_buffer_cast(base_command_buffer);
   IREE_ASSERT_TRUE(command_buffer);
 
+  if (iree_hal_task_command_buffer_is_graph(command_buffer)) {
+    return iree_hal_task_command_buffer_issue_graph(
+        command_buffer, retire_task, arena, pending_submission);
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
   bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
   if (!has_root_tasks) {
@@ -825,6 +1158,19 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       dispatch_attrs.local_memory_pages *
       IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE;
 
+  // Keep workgroups on the same workers each time the dispatch is issued. The
+  // partitions are reset on each issue and can be shared by all submissions of
+  // a reusable command buffer as only one may execute the tasks at a time.
+  if (iree_any_bit_set(command_buffer->scope->flags,
+                       IREE_TASK_SCOPE_FLAG_STICKY_DISPATCHES)) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena,
+        command_buffer->worker_count * sizeof(*cmd->task.partitions),
+        (void**)&cmd->task.partitions));
+    cmd->task.partition_capacity = (uint32_t)command_buffer->worker_count;
+    cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_STICKY;
+  }
+
   // Push constants are pulled directly from the args and copied into the
   // command buffer. Note that we require 4 byte alignment and if the input
   // buffer is not aligned we have to fail.
@@ -18,9 +18,12 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Creates a command buffer recording tasks into |scope|.
+// |worker_count| is the number of workers in the executor the command buffer
+// will be issued on and is used to size per-dispatch scheduling state.
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_allocator_t* device_allocator, iree_task_scope_t* scope,
-    iree_hal_command_buffer_mode_t mode,
+    iree_host_size_t worker_count, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
@@ -46,6 +49,11 @@ bool iree_hal_task_command_buffer_isa(
 //
 // |pending_submission| will receive the ready list of commands and must be
 // submitted to the executor (or discarded on failure) by the caller.
+//
+// One-shot command buffers hand their tasks to the submission and can only be
+// issued once. Reusable command buffers restore their recorded task graph on
+// each issue and may be issued any number of times; if a prior submission is
+// still executing the graph the new one will begin after it completes.
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -0,0 +1,308 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the submit-to-completion overhead of task command buffers.
+//
+// Each step submits a command buffer of 100 tiny fill dispatches to a
+// local-task device and waits for it to complete. The fills touch so little
+// memory that the time is dominated by building and scheduling the task DAG:
+//
+// - one_shot: records a new one-shot command buffer every step.
+// - deferred: records once into a deferred command buffer that is replayed
+//   into a new one-shot task command buffer on every submission. This is how
+//   reusable command buffers were emulated prior to reusable task graphs.
+// - graph: records once into a reusable task command buffer whose task graph
+//   is restored and reissued on every submission.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/task/api.h"
+#include "iree/testing/benchmark.h"
+
+// Number of workers in the executor.
+#define IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_WORKER_COUNT 4
+
+// Number of dispatches recorded into each command buffer.
+#define IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_DISPATCH_COUNT 100
+
+// Bytes filled by each dispatch.
+#define IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_FILL_LENGTH 256
+
+typedef enum iree_hal_task_command_buffer_benchmark_mode_e {
+  IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_ONE_SHOT = 0,
+  IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_DEFERRED,
+  IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_GRAPH,
+} iree_hal_task_command_buffer_benchmark_mode_t;
+
+// Records the benchmark dispatches into |command_buffer|.
+// Inserts an execution barrier between each dispatch when |serial| is set such
+// that they execute serially. Otherwise all dispatches may execute
+// concurrently.
+static iree_status_t iree_hal_task_command_buffer_benchmark_record(
+    bool serial, iree_hal_buffer_t* buffer,
+    iree_hal_command_buffer_t* command_buffer) {
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_begin(command_buffer));
+  const uint32_t pattern = 0xCDCDCDCDu;
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_DISPATCH_COUNT; ++i) {
+    if (serial && i > 0) {
+      IREE_RETURN_IF_ERROR(iree_hal_command_buffer_execution_barrier(
+          command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+          IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+          IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_fill_buffer(
+        command_buffer,
+        iree_hal_make_buffer_ref(
+            buffer, i * IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_FILL_LENGTH,
+            IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_FILL_LENGTH),
+        &pattern, sizeof(pattern), IREE_HAL_FILL_FLAG_NONE));
+  }
+  return iree_hal_command_buffer_end(command_buffer);
+}
+
+// Creates a command buffer for |mode| and records the benchmark dispatches into
+// it.
+static iree_status_t iree_hal_task_command_buffer_benchmark_create(
+    iree_hal_task_command_buffer_benchmark_mode_t mode, bool serial,
+    iree_hal_device_t* device, iree_arena_block_pool_t* block_pool,
+    iree_hal_buffer_t* buffer, iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  switch (mode) {
+    case IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_ONE_SHOT:
+      IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+          device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+          IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+          /*binding_capacity=*/0, &command_buffer));
+      break;
+    case IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_DEFERRED:
+      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_create(
+          iree_hal_device_allocator(device),
+          IREE_HAL_COMMAND_BUFFER_MODE_DEFAULT, IREE_HAL_COMMAND_CATEGORY_ANY,
+          IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, block_pool,
+          iree_hal_device_host_allocator(device), &command_buffer));
+      break;
+    case IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_GRAPH:
+      IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+          device, IREE_HAL_COMMAND_BUFFER_MODE_DEFAULT,
+          IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+          /*binding_capacity=*/0, &command_buffer));
+      break;
+  }
+  iree_status_t status = iree_hal_task_command_buffer_benchmark_record(
+      serial, buffer, command_buffer);
+  if (iree_status_is_ok(status)) {
+    *out_command_buffer = command_buffer;
+  } else {
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  return status;
+}
+
+// Submits a command buffer created for |mode| and waits for it to complete
+// each step.
+static void iree_hal_task_command_buffer_benchmark_run(
+    iree_benchmark_state_t* benchmark_state,
+    iree_hal_task_command_buffer_benchmark_mode_t mode, bool serial) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(
+      IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_WORKER_COUNT, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(
+      iree_task_executor_create(options, &topology, host_allocator, &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_hal_allocator_t* device_allocator = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_create_heap(
+      IREE_SV("heap"), host_allocator, host_allocator, &device_allocator));
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  iree_hal_device_t* device = NULL;
+  IREE_CHECK_OK(iree_hal_task_device_create(
+      IREE_SV("local-task"), &params, /*queue_count=*/1, &executor,
+      /*loader_count=*/0, NULL, device_allocator, host_allocator, &device));
+  iree_hal_allocator_release(device_allocator);
+  iree_task_executor_release(executor);
+
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(32 * 1024, host_allocator, &block_pool);
+
+  iree_hal_buffer_params_t buffer_params = {
+      .type =
+          IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
+  };
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(device), buffer_params,
+      IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_DISPATCH_COUNT *
+          IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_FILL_LENGTH,
+      &buffer));
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_semaphore_create(device, 0ull,
+                                          IREE_HAL_SEMAPHORE_FLAG_NONE,
+                                          &semaphore));
+
+  // Reusable command buffers are recorded once outside of the timed region.
+  const bool reusable =
+      mode != IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_ONE_SHOT;
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  if (reusable) {
+    IREE_CHECK_OK(iree_hal_task_command_buffer_benchmark_create(
+        mode, serial, device, &block_pool, buffer, &command_buffer));
+  }
+
+  uint64_t semaphore_value = 0;
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    if (!reusable) {
+      IREE_CHECK_OK(iree_hal_task_command_buffer_benchmark_create(
+          mode, serial, device, &block_pool, buffer, &command_buffer));
+    }
+    ++semaphore_value;
+    iree_hal_semaphore_list_t signal_semaphores = {
+        .count = 1,
+        .semaphores = &semaphore,
+        .payload_values = &semaphore_value,
+    };
+    IREE_CHECK_OK(iree_hal_device_queue_execute(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, command_buffer,
+        iree_hal_buffer_binding_table_empty(), IREE_HAL_EXECUTE_FLAG_NONE));
+    IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, semaphore_value,
+                                          iree_infinite_timeout()));
+    if (!reusable) {
+      iree_hal_command_buffer_release(command_buffer);
+      command_buffer = NULL;
+    }
+    ++batch_count;
+  }
+  iree_benchmark_set_items_processed(
+      benchmark_state,
+      batch_count * IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_DISPATCH_COUNT);
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_buffer_release(buffer);
+  iree_hal_device_release(device);
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+// Records a new one-shot command buffer every step.
+//
+// user_data is true if the dispatches execute serially.
+static iree_status_t iree_hal_task_command_buffer_benchmark_one_shot(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_hal_task_command_buffer_benchmark_run(
+      benchmark_state, IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_ONE_SHOT,
+      (bool)(uintptr_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+// Replays a deferred command buffer into a new one-shot command buffer every
+// step.
+//
+// user_data is true if the dispatches execute serially.
+static iree_status_t iree_hal_task_command_buffer_benchmark_deferred(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_hal_task_command_buffer_benchmark_run(
+      benchmark_state, IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_DEFERRED,
+      (bool)(uintptr_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+// Reissues the task graph of a reusable command buffer every step.
+//
+// user_data is true if the dispatches execute serially.
+static iree_status_t iree_hal_task_command_buffer_benchmark_graph(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_hal_task_command_buffer_benchmark_run(
+      benchmark_state, IREE_HAL_TASK_COMMAND_BUFFER_BENCHMARK_MODE_GRAPH,
+      (bool)(uintptr_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_hal_task_command_buffer_benchmark_one_shot
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_task_command_buffer_benchmark_one_shot,
+    };
+    benchmark_def.user_data = (void*)false;
+    iree_benchmark_register(
+        iree_make_cstring_view("command_buffer_one_shot_concurrent_100"),
+        &benchmark_def);
+    benchmark_def.user_data = (void*)true;
+    iree_benchmark_register(
+        iree_make_cstring_view("command_buffer_one_shot_serial_100"),
+        &benchmark_def);
+  }
+
+  // iree_hal_task_command_buffer_benchmark_deferred
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_task_command_buffer_benchmark_deferred,
+    };
+    benchmark_def.user_data = (void*)false;
+    iree_benchmark_register(
+        iree_make_cstring_view("command_buffer_deferred_concurrent_100"),
+        &benchmark_def);
+    benchmark_def.user_data = (void*)true;
+    iree_benchmark_register(
+        iree_make_cstring_view("command_buffer_deferred_serial_100"),
+        &benchmark_def);
+  }
+
+  // iree_hal_task_command_buffer_benchmark_graph
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_task_command_buffer_benchmark_graph,
+    };
+    benchmark_def.user_data = (void*)false;
+    iree_benchmark_register(
+        iree_make_cstring_view("command_buffer_graph_concurrent_100"),
+        &benchmark_def);
+    benchmark_def.user_data = (void*)true;
+    iree_benchmark_register(
+        iree_make_cstring_view("command_buffer_graph_serial_100"),
+        &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -0,0 +1,398 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests for reusable task command buffers that reissue their task graph.
+// Command buffers are issued directly against a task executor so that the
+// tests control exactly when submissions overlap and when the scope fails.
+
+#include "iree/hal/drivers/local_task/task_command_buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_queue_state.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/loaders/static_library_loader.h"
+#include "iree/hal/local/local_executable_cache.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Test executable library
+//===----------------------------------------------------------------------===//
+
+// Maximum number of workgroups dispatched by any test.
+static constexpr uint32_t kMaxWorkgroupCount = 8;
+
+// Increments binding[0][workgroup_id_x]. Each workgroup owns its element so
+// the number of times the dispatch has covered each workgroup can be checked.
+static int count_workgroups(
+    const iree_hal_executable_environment_v0_t* environment,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  uint32_t* counts = (uint32_t*)dispatch_state->binding_ptrs[0];
+  ++counts[workgroup_state->workgroup_id_x];
+  return 0;
+}
+
+static const iree_hal_executable_library_header_t test_library_header = {
+    .version = IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
+    .name = "task_command_buffer_test",
+    .features = IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+    .sanitizer = IREE_HAL_EXECUTABLE_LIBRARY_SANITIZER_NONE,
+};
+static const iree_hal_executable_dispatch_v0_t test_library_entry_points[1] = {
+    count_workgroups,
+};
+static const iree_hal_executable_dispatch_attrs_v0_t test_library_attrs[1] = {
+    {
+        .local_memory_pages = 0,
+        .constant_count = 0,
+        .binding_count = 1,
+    },
+};
+static const char* test_library_names[1] = {
+    "count_workgroups",
+};
+static const iree_hal_executable_library_v0_t test_library = {
+    .header = &test_library_header,
+    .imports =
+        {
+            .count = 0,
+            .symbols = NULL,
+        },
+    .exports =
+        {
+            .count = 1,
+            .ptrs = test_library_entry_points,
+            .attrs = test_library_attrs,
+            .names = test_library_names,
+            .tags = NULL,
+        },
+    .constants =
+        {
+            .count = 0,
+        },
+};
+
+static const iree_hal_executable_library_header_t** test_library_query(
+    iree_hal_executable_library_version_t max_version,
+    const iree_hal_executable_environment_v0_t* environment) {
+  return max_version <= IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST
+             ? (const iree_hal_executable_library_header_t**)&test_library
+             : NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// Retire tasks
+//===----------------------------------------------------------------------===//
+
+// Task completing a single issue of a command buffer.
+// Records whether it executed or was discarded because the scope failed.
+struct RetireTask {
+  iree_task_call_t task;
+  int execute_count = 0;
+  int cleanup_count = 0;
+  iree_status_code_t cleanup_status_code = IREE_STATUS_OK;
+
+  static iree_status_t Execute(void* user_context, iree_task_t* task,
+                               iree_task_submission_t* pending_submission) {
+    ++reinterpret_cast<RetireTask*>(user_context)->execute_count;
+    return iree_ok_status();
+  }
+
+  static void Cleanup(iree_task_t* task, iree_status_code_t status_code) {
+    RetireTask* retire_task = reinterpret_cast<RetireTask*>(task);
+    ++retire_task->cleanup_count;
+    retire_task->cleanup_status_code = status_code;
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// Fixture
+//===----------------------------------------------------------------------===//
+
+class TaskCommandBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(4, &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                             host_allocator, &executor_));
+    iree_task_topology_deinitialize(&topology);
+    iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                               IREE_TASK_SCOPE_FLAG_NONE, &scope_);
+    iree_hal_task_queue_state_initialize(&queue_state_);
+    iree_arena_block_pool_initialize(4096, host_allocator, &block_pool_);
+
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), host_allocator, host_allocator,
+        &device_allocator_));
+    iree_hal_buffer_params_t buffer_params = {};
+    buffer_params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT |
+                          IREE_HAL_BUFFER_USAGE_MAPPING |
+                          IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, kMaxWorkgroupCount * sizeof(uint32_t),
+        &counts_buffer_));
+    IREE_ASSERT_OK(
+        iree_hal_buffer_map_zero(counts_buffer_, 0, IREE_HAL_WHOLE_BUFFER));
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, 3 * sizeof(uint32_t),
+        &workgroup_count_buffer_));
+
+    const iree_hal_executable_library_query_fn_t library_query_fns[1] = {
+        test_library_query,
+    };
+    IREE_ASSERT_OK(iree_hal_static_library_loader_create(
+        IREE_ARRAYSIZE(library_query_fns), library_query_fns,
+        iree_hal_executable_import_provider_null(), host_allocator, &loader_));
+    IREE_ASSERT_OK(iree_hal_local_executable_cache_create(
+        iree_make_cstring_view("cache"),
+        iree_task_executor_worker_count(executor_), /*loader_count=*/1,
+        &loader_, /*dispatch_counters=*/NULL, host_allocator,
+        &executable_cache_));
+    iree_hal_executable_params_t executable_params;
+    iree_hal_executable_params_initialize(&executable_params);
+    executable_params.caching_mode =
+        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    executable_params.executable_format = iree_make_cstring_view("static");
+    executable_params.executable_data = iree_make_const_byte_span(
+        test_library_header.name, strlen(test_library_header.name));
+    IREE_ASSERT_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache_, &executable_params, &executable_));
+  }
+
+  void TearDown() override {
+    iree_hal_executable_release(executable_);
+    iree_hal_executable_cache_release(executable_cache_);
+    iree_hal_executable_loader_release(loader_);
+    iree_hal_buffer_release(workgroup_count_buffer_);
+    iree_hal_buffer_release(counts_buffer_);
+    iree_hal_allocator_release(device_allocator_);
+    iree_arena_block_pool_deinitialize(&block_pool_);
+    iree_hal_task_queue_state_deinitialize(&queue_state_);
+    iree_task_scope_deinitialize(&scope_);
+    iree_task_executor_release(executor_);
+  }
+
+  // Creates a reusable command buffer recording tasks into the test scope.
+  void CreateCommandBuffer(iree_hal_command_buffer_t** out_command_buffer) {
+    IREE_ASSERT_OK(iree_hal_task_command_buffer_create(
+        device_allocator_, &scope_, iree_task_executor_worker_count(executor_),
+        IREE_HAL_COMMAND_BUFFER_MODE_DEFAULT, IREE_HAL_COMMAND_CATEGORY_ANY,
+        IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, &block_pool_,
+        iree_allocator_system(), out_command_buffer));
+  }
+
+  // Records a dispatch counting workgroups into the counts buffer.
+  // The workgroup count is read from the workgroup count buffer if |indirect|.
+  iree_status_t RecordDispatch(iree_hal_command_buffer_t* command_buffer,
+                               uint32_t workgroup_count_x, bool indirect) {
+    iree_hal_buffer_ref_t binding_refs[1] = {
+        iree_hal_make_buffer_ref(counts_buffer_, 0, IREE_HAL_WHOLE_BUFFER),
+    };
+    const iree_hal_buffer_ref_list_t bindings = {
+        IREE_ARRAYSIZE(binding_refs),
+        binding_refs,
+    };
+    if (indirect) {
+      return iree_hal_command_buffer_dispatch_indirect(
+          command_buffer, executable_, /*entry_point=*/0,
+          iree_hal_make_buffer_ref(workgroup_count_buffer_, 0,
+                                   3 * sizeof(uint32_t)),
+          iree_const_byte_span_empty(), bindings, IREE_HAL_DISPATCH_FLAG_NONE);
+    }
+    const uint32_t workgroup_count[3] = {workgroup_count_x, 1, 1};
+    return iree_hal_command_buffer_dispatch(
+        command_buffer, executable_, /*entry_point=*/0, workgroup_count,
+        iree_const_byte_span_empty(), bindings, IREE_HAL_DISPATCH_FLAG_NONE);
+  }
+
+  // Issues |command_buffer| once per retire task in |retire_tasks| within a
+  // single submission and waits for the scope to idle.
+  void IssueAndWaitIdle(iree_hal_command_buffer_t* command_buffer,
+                        std::vector<RetireTask>& retire_tasks) {
+    iree_arena_allocator_t arena;
+    iree_arena_initialize(&block_pool_, &arena);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    for (RetireTask& retire_task : retire_tasks) {
+      iree_task_call_initialize(
+          &scope_,
+          iree_task_make_call_closure(RetireTask::Execute, &retire_task),
+          &retire_task.task);
+      iree_task_set_cleanup_fn(&retire_task.task.header, RetireTask::Cleanup);
+      iree_task_fence_t* fence = NULL;
+      IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor_, &scope_,
+                                                      &fence));
+      iree_task_set_completion_task(&retire_task.task.header, &fence->header);
+      IREE_ASSERT_OK(iree_hal_task_command_buffer_issue(
+          command_buffer, &queue_state_, &retire_task.task.header, &arena,
+          &submission));
+    }
+    iree_task_executor_submit(executor_, &submission);
+    iree_task_executor_flush(executor_);
+    IREE_ASSERT_OK(iree_task_scope_wait_idle(
+        &scope_, iree_time_now() + 10 * 1000000000ull));
+    iree_arena_deinitialize(&arena);
+  }
+
+  // Returns the per-workgroup counts recorded by the dispatches.
+  std::vector<uint32_t> ReadCounts() {
+    std::vector<uint32_t> counts(kMaxWorkgroupCount);
+    IREE_CHECK_OK(iree_hal_buffer_map_read(counts_buffer_, 0, counts.data(),
+                                           counts.size() * sizeof(uint32_t)));
+    return counts;
+  }
+
+  iree_task_executor_t* executor_ = NULL;
+  iree_task_scope_t scope_;
+  iree_hal_task_queue_state_t queue_state_;
+  iree_arena_block_pool_t block_pool_;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_buffer_t* counts_buffer_ = NULL;
+  iree_hal_buffer_t* workgroup_count_buffer_ = NULL;
+  iree_hal_executable_loader_t* loader_ = NULL;
+  iree_hal_executable_cache_t* executable_cache_ = NULL;
+  iree_hal_executable_t* executable_ = NULL;
+};
+
+// Two dispatches separated by a barrier reissued one submission at a time.
+TEST_F(TaskCommandBufferTest, Reissue) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  CreateCommandBuffer(&command_buffer);
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(RecordDispatch(command_buffer, 4, /*indirect=*/false));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  IREE_ASSERT_OK(RecordDispatch(command_buffer, 4, /*indirect=*/false));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  for (uint32_t i = 1; i <= 3; ++i) {
+    std::vector<RetireTask> retire_tasks(1);
+    IssueAndWaitIdle(command_buffer, retire_tasks);
+    EXPECT_EQ(retire_tasks[0].execute_count, 1);
+    EXPECT_EQ(retire_tasks[0].cleanup_status_code, IREE_STATUS_OK);
+    EXPECT_EQ(ReadCounts(), std::vector<uint32_t>({2 * i, 2 * i, 2 * i, 2 * i,
+                                                   0, 0, 0, 0}));
+  }
+
+  iree_hal_command_buffer_release(command_buffer);
+}
+
+// Submissions issued while the graph is in flight wait for the prior one.
+TEST_F(TaskCommandBufferTest, OverlappingSubmissions) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  CreateCommandBuffer(&command_buffer);
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(RecordDispatch(command_buffer, 4, /*indirect=*/false));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  IREE_ASSERT_OK(RecordDispatch(command_buffer, 4, /*indirect=*/false));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  // All issues happen before the submission is flushed and the later ones
+  // must be queued behind the first.
+  std::vector<RetireTask> retire_tasks(3);
+  IssueAndWaitIdle(command_buffer, retire_tasks);
+  for (const RetireTask& retire_task : retire_tasks) {
+    EXPECT_EQ(retire_task.execute_count, 1);
+    EXPECT_EQ(retire_task.cleanup_status_code, IREE_STATUS_OK);
+  }
+  EXPECT_EQ(ReadCounts(), std::vector<uint32_t>({6, 6, 6, 6, 0, 0, 0, 0}));
+
+  // The graph is released after the queued submissions complete.
+  std::vector<RetireTask> final_retire_tasks(1);
+  IssueAndWaitIdle(command_buffer, final_retire_tasks);
+  EXPECT_EQ(final_retire_tasks[0].execute_count, 1);
+  EXPECT_EQ(ReadCounts(), std::vector<uint32_t>({8, 8, 8, 8, 0, 0, 0, 0}));
+
+  iree_hal_command_buffer_release(command_buffer);
+}
+
+// Indirect workgroup counts are resolved in-place when a dispatch is issued
+// and must be restored so each submission reads the current buffer contents.
+TEST_F(TaskCommandBufferTest, ReissueIndirect) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  CreateCommandBuffer(&command_buffer);
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(RecordDispatch(command_buffer, 0, /*indirect=*/true));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  const uint32_t workgroup_count_2[3] = {2, 1, 1};
+  IREE_ASSERT_OK(iree_hal_buffer_map_write(workgroup_count_buffer_, 0,
+                                           workgroup_count_2,
+                                           sizeof(workgroup_count_2)));
+  std::vector<RetireTask> retire_tasks(1);
+  IssueAndWaitIdle(command_buffer, retire_tasks);
+  EXPECT_EQ(ReadCounts(), std::vector<uint32_t>({1, 1, 0, 0, 0, 0, 0, 0}));
+
+  const uint32_t workgroup_count_8[3] = {8, 1, 1};
+  IREE_ASSERT_OK(iree_hal_buffer_map_write(workgroup_count_buffer_, 0,
+                                           workgroup_count_8,
+                                           sizeof(workgroup_count_8)));
+  IssueAndWaitIdle(command_buffer, retire_tasks);
+  EXPECT_EQ(ReadCounts(), std::vector<uint32_t>({2, 2, 1, 1, 1, 1, 1, 1}));
+
+  iree_hal_command_buffer_release(command_buffer);
+}
+
+// Submissions aborted by a scope failure discard any submissions queued on the
+// graph and release it for new submissions.
+TEST_F(TaskCommandBufferTest, ScopeFailure) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  CreateCommandBuffer(&command_buffer);
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(RecordDispatch(command_buffer, 4, /*indirect=*/false));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  iree_task_scope_fail(&scope_,
+                       iree_make_status(IREE_STATUS_DATA_LOSS, "injected"));
+
+  std::vector<RetireTask> retire_tasks(2);
+  IssueAndWaitIdle(command_buffer, retire_tasks);
+  for (const RetireTask& retire_task : retire_tasks) {
+    EXPECT_EQ(retire_task.execute_count, 0);
+    EXPECT_EQ(retire_task.cleanup_count, 1);
+    EXPECT_EQ(retire_task.cleanup_status_code, IREE_STATUS_ABORTED);
+  }
+
+  // If the graph were still marked in-flight the new submission would be
+  // queued forever and never retire or be discarded.
+  std::vector<RetireTask> final_retire_tasks(1);
+  IssueAndWaitIdle(command_buffer, final_retire_tasks);
+  EXPECT_EQ(final_retire_tasks[0].execute_count, 0);
+  EXPECT_EQ(final_retire_tasks[0].cleanup_count, 1);
+  EXPECT_EQ(final_retire_tasks[0].cleanup_status_code, IREE_STATUS_ABORTED);
+
+  EXPECT_EQ(ReadCounts(), std::vector<uint32_t>(kMaxWorkgroupCount, 0));
+  iree_hal_command_buffer_release(command_buffer);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
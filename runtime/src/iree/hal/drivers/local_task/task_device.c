@@ -16,6 +16,7 @@
 #include "iree/hal/drivers/local_task/task_event.h"
 #include "iree/hal/drivers/local_task/task_queue.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
+#include "iree/hal/local/dispatch_counters.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
@@ -42,6 +43,11 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Collector used when profiling with
+  // IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS. Referenced by all
+  // executables prepared by the device.
+  iree_hal_local_dispatch_counters_t dispatch_counters;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -112,6 +118,8 @@ iree_status_t iree_hal_task_device_create(
     iree_string_view_append_to_buffer(identifier, &device->identifier,
                                       (char*)device + struct_size);
     device->host_allocator = host_allocator;
+    iree_hal_local_dispatch_counters_initialize(host_allocator,
+                                                &device->dispatch_counters);
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
 
@@ -159,6 +167,8 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
 
+  iree_hal_local_dispatch_counters_deinitialize(&device->dispatch_counters);
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -279,7 +289,16 @@ static iree_host_size_t iree_hal_task_device_select_queue(
   // TODO(benvanik): evaluate if we want to obscure this mapping a bit so that
   // affinity really means "equivalent affinities map to equivalent queues" and
   // not a specific queue index.
-  return queue_affinity % device->queue_count;
+  if (iree_hal_queue_affinity_is_any(queue_affinity) ||
+      iree_hal_queue_affinity_is_empty(queue_affinity)) {
+    return queue_affinity % device->queue_count;
+  }
+  // Route specific affinities to the first queue they select. Queues map 1:1
+  // with executors and the device allocator places buffers allocated for a
+  // queue on the NUMA node of its executor so this keeps dispatches on the
+  // node that owns their bindings.
+  return iree_hal_queue_affinity_find_first_set(queue_affinity) %
+         device->queue_count;
 }
 
 static iree_status_t iree_hal_task_device_create_channel(
@@ -296,11 +315,10 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   if (binding_capacity > 0) {
-    // TODO(indirect-cmd): natively support reusable task command buffers. For
-    // now we emulate by recording into a deferred command buffer and
-    // recording/issuing at submission time. The task system needs some
-    // reworking to support being able to resubmit task graphs as today it is
-    // destructive.
+    // TODO(indirect-cmd): natively support binding tables in task command
+    // buffers. For now we emulate by recording into a deferred command buffer
+    // and recording/issuing at submission time. Reusable command buffers
+    // without binding tables are recorded directly as reusable task graphs.
     return iree_hal_deferred_command_buffer_create(
         iree_hal_device_allocator(base_device), mode, command_categories,
         queue_affinity, binding_capacity, &device->large_block_pool,
@@ -310,9 +328,10 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
         device, command_categories, queue_affinity);
     return iree_hal_task_command_buffer_create(
         iree_hal_device_allocator(base_device),
-        &device->queues[queue_index].scope, mode, command_categories,
-        queue_affinity, binding_capacity, &device->large_block_pool,
-        device->host_allocator, out_command_buffer);
+        &device->queues[queue_index].scope,
+        iree_task_executor_worker_count(device->queues[queue_index].executor),
+        mode, command_categories, queue_affinity, binding_capacity,
+        &device->large_block_pool, device->host_allocator, out_command_buffer);
   }
 }
 
@@ -339,7 +358,8 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
 
   return iree_hal_local_executable_cache_create(
       identifier, total_worker_count, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+      &device->dispatch_counters, iree_hal_device_host_allocator(base_device),
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_task_device_import_file(
@@ -492,27 +512,28 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
 static iree_status_t iree_hal_task_device_profiling_begin(
     iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  // Only dispatch counters are implemented; other modes are ignored (and
+  // that's ok).
+  if (!iree_all_bits_set(options->mode,
+                         IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS)) {
+    return iree_ok_status();
+  }
+  return iree_hal_local_dispatch_counters_begin(
+      &device->dispatch_counters,
+      iree_make_cstring_view(options->file_path ? options->file_path : ""));
 }
 
 static iree_status_t iree_hal_task_device_profiling_flush(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  return iree_hal_local_dispatch_counters_flush(&device->dispatch_counters);
 }
 
 static iree_status_t iree_hal_task_device_profiling_end(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  return iree_hal_local_dispatch_counters_end(&device->dispatch_counters);
 }
 
 static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
@@ -214,6 +214,7 @@ static iree_status_t iree_hal_task_queue_issue_cmd_deferred(
       z0,
       iree_hal_task_command_buffer_create(
           cmd->queue->device_allocator, &cmd->queue->scope,
+          iree_task_executor_worker_count(cmd->queue->executor),
           iree_hal_command_buffer_mode(command_buffer) |
               IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
               // NOTE: we need to validate if a binding table is provided as the
@@ -0,0 +1,616 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/dispatch_counters.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/synchronization.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#define IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT 1
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT 0
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+//===----------------------------------------------------------------------===//
+// Aggregation tables
+//===----------------------------------------------------------------------===//
+
+// Counters accumulated for a single executable export.
+typedef struct iree_hal_local_dispatch_counters_entry_t {
+  // Retained executable or NULL if the entry is unused.
+  iree_hal_local_executable_t* executable;
+  uint32_t ordinal;
+  uint64_t dispatch_count;
+  uint64_t workgroup_count;
+  uint64_t duration_ns;
+  uint64_t values[IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+} iree_hal_local_dispatch_counters_entry_t;
+
+// Open-addressed hash table of entries keyed by executable and ordinal.
+typedef struct iree_hal_local_dispatch_counters_table_t {
+  iree_host_size_t count;
+  iree_host_size_t capacity;  // power of two
+  iree_hal_local_dispatch_counters_entry_t* entries;
+} iree_hal_local_dispatch_counters_table_t;
+
+static iree_host_size_t iree_hal_local_dispatch_counters_hash(
+    const iree_hal_local_executable_t* executable, uint32_t ordinal) {
+  uint64_t key = (uint64_t)(uintptr_t)executable ^ ((uint64_t)ordinal << 48);
+  key ^= key >> 33;
+  key *= 0xFF51AFD7ED558CCDull;
+  key ^= key >> 33;
+  return (iree_host_size_t)key;
+}
+
+// Returns the slot for |executable| and |ordinal| in |entries|; the slot is
+// either the existing entry or the unused slot it should be inserted into.
+static iree_hal_local_dispatch_counters_entry_t*
+iree_hal_local_dispatch_counters_table_slot(
+    iree_hal_local_dispatch_counters_entry_t* entries,
+    iree_host_size_t capacity, const iree_hal_local_executable_t* executable,
+    uint32_t ordinal) {
+  iree_host_size_t i =
+      iree_hal_local_dispatch_counters_hash(executable, ordinal) &
+      (capacity - 1);
+  for (;;) {
+    iree_hal_local_dispatch_counters_entry_t* entry = &entries[i];
+    if (!entry->executable ||
+        (entry->executable == executable && entry->ordinal == ordinal)) {
+      return entry;
+    }
+    i = (i + 1) & (capacity - 1);
+  }
+}
+
+// Releases all executables referenced by |table| and frees its storage.
+static void iree_hal_local_dispatch_counters_table_deinitialize(
+    iree_hal_local_dispatch_counters_table_t* table,
+    iree_allocator_t host_allocator) {
+  for (iree_host_size_t i = 0; i < table->capacity; ++i) {
+    iree_hal_executable_release(
+        (iree_hal_executable_t*)table->entries[i].executable);
+  }
+  iree_allocator_free(host_allocator, table->entries);
+  memset(table, 0, sizeof(*table));
+}
+
+// Returns the entry for |executable| and |ordinal|, inserting a new one
+// retaining |executable| if not found.
+static iree_status_t iree_hal_local_dispatch_counters_table_lookup(
+    iree_hal_local_dispatch_counters_table_t* table,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_counters_entry_t** out_entry) {
+  if (table->capacity) {
+    iree_hal_local_dispatch_counters_entry_t* entry =
+        iree_hal_local_dispatch_counters_table_slot(
+            table->entries, table->capacity, executable, ordinal);
+    if (entry->executable) {
+      *out_entry = entry;
+      return iree_ok_status();
+    }
+  }
+
+  // Keep the load factor at or below 1/2 so probe sequences stay short.
+  if ((table->count + 1) * 2 > table->capacity) {
+    const iree_host_size_t new_capacity =
+        table->capacity ? table->capacity * 2 : 16;
+    iree_hal_local_dispatch_counters_entry_t* new_entries = NULL;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        host_allocator, new_capacity * sizeof(*new_entries),
+        (void**)&new_entries));
+    for (iree_host_size_t i = 0; i < table->capacity; ++i) {
+      const iree_hal_local_dispatch_counters_entry_t* entry =
+          &table->entries[i];
+      if (!entry->executable) continue;
+      *iree_hal_local_dispatch_counters_table_slot(
+          new_entries, new_capacity, entry->executable, entry->ordinal) =
+          *entry;
+    }
+    iree_allocator_free(host_allocator, table->entries);
+    table->entries = new_entries;
+    table->capacity = new_capacity;
+  }
+
+  iree_hal_local_dispatch_counters_entry_t* entry =
+      iree_hal_local_dispatch_counters_table_slot(
+          table->entries, table->capacity, executable, ordinal);
+  iree_hal_executable_retain((iree_hal_executable_t*)executable);
+  entry->executable = executable;
+  entry->ordinal = ordinal;
+  ++table->count;
+  *out_entry = entry;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// perf_event_open
+//===----------------------------------------------------------------------===//
+
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+
+// Hardware event configs indexed by iree_instrument_dispatch_counter_t.
+static const uint64_t iree_hal_local_perf_event_configs[] = {
+    PERF_COUNT_HW_CPU_CYCLES,          PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_REFERENCES,    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+};
+static_assert(IREE_ARRAYSIZE(iree_hal_local_perf_event_configs) ==
+                  IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT,
+              "perf event configs must match the instrument counters");
+
+static iree_status_t iree_hal_local_perf_event_status_from_errno(int error) {
+  switch (error) {
+    case EACCES:
+    case EPERM:
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "not permitted to open hardware performance "
+                              "counters; check "
+                              "/proc/sys/kernel/perf_event_paranoid");
+    case ENOENT:
+    case ENODEV:
+    case ENOSYS:
+    case EOPNOTSUPP:
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "hardware performance counters are not "
+                              "supported on this host (errno %d)",
+                              error);
+    default:
+      return iree_make_status(iree_status_code_from_errno(error),
+                              "failed to open hardware performance counters");
+  }
+}
+
+static void iree_hal_local_perf_event_group_close(int* fds) {
+  for (iree_host_size_t i = 0; i < IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT;
+       ++i) {
+    if (fds[i] >= 0) close(fds[i]);
+    fds[i] = -1;
+  }
+}
+
+// Opens an event group counting all hardware counters on the calling thread.
+// The first event is the group leader and reading it reads all of them.
+static iree_status_t iree_hal_local_perf_event_group_open(int* out_fds) {
+  for (iree_host_size_t i = 0; i < IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT;
+       ++i) {
+    out_fds[i] = -1;
+  }
+  for (iree_host_size_t i = 0; i < IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT;
+       ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = iree_hal_local_perf_event_configs[i];
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = (int)syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                          /*group_fd=*/i == 0 ? -1 : out_fds[0],
+                          PERF_FLAG_FD_CLOEXEC);
+    if (fd < 0) {
+      const int error = errno;
+      iree_hal_local_perf_event_group_close(out_fds);
+      return iree_hal_local_perf_event_status_from_errno(error);
+    }
+    out_fds[i] = fd;
+  }
+  return iree_ok_status();
+}
+
+// Reads all counters in the group led by |fds|[0] into |out_values|.
+static void iree_hal_local_perf_event_group_read(const int* fds,
+                                                 uint64_t* out_values) {
+  // PERF_FORMAT_GROUP: { u64 nr; u64 values[nr]; }
+  uint64_t buffer[1 + IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+  if (read(fds[0], buffer, sizeof(buffer)) == (ssize_t)sizeof(buffer)) {
+    memcpy(out_values, &buffer[1],
+           IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT * sizeof(*out_values));
+  } else {
+    memset(out_values, 0,
+           IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT * sizeof(*out_values));
+  }
+}
+
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_dispatch_counters_t
+//===----------------------------------------------------------------------===//
+
+// State for a single thread issuing workgroups in a capture.
+struct iree_hal_local_dispatch_counters_thread_t {
+  iree_hal_local_dispatch_counters_thread_t* next;
+  iree_allocator_t host_allocator;
+  // Process-unique identifier of the owning thread.
+  int64_t thread_id;
+  // Event group file descriptors opened on the thread.
+  int fds[IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+  // Guards |table| as it is updated by the owning thread and read by flushes.
+  iree_slim_mutex_t mutex;
+  // Counters aggregated on the thread.
+  iree_hal_local_dispatch_counters_table_t table;
+};
+
+// Monotonically increasing capture identifier.
+static iree_atomic_int64_t iree_hal_local_dispatch_counters_session_id_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+
+// Monotonically increasing thread identifier. Identifiers are never reused so
+// a thread can not adopt the event groups opened by an exited thread.
+static iree_atomic_int64_t iree_hal_local_dispatch_counters_thread_id_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Thread state in the most recent capture the thread issued workgroups in.
+// Stale when |session_id| does not match the collector issuing the workgroup.
+static iree_thread_local struct {
+  // Identifier of the thread assigned on first use or 0 if unassigned.
+  int64_t thread_id;
+  int64_t session_id;
+  iree_hal_local_dispatch_counters_thread_t* thread;
+} iree_hal_local_dispatch_counters_tls_ = {0, 0, NULL};
+
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+
+void iree_hal_local_dispatch_counters_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_counters_t* out_counters) {
+  memset(out_counters, 0, sizeof(*out_counters));
+  out_counters->host_allocator = host_allocator;
+  iree_atomic_store(&out_counters->session_id, 0, iree_memory_order_relaxed);
+  iree_slim_mutex_initialize(&out_counters->mutex);
+}
+
+// Discards the active capture of |counters|, if any.
+// Must be called with the collector mutex held.
+static void iree_hal_local_dispatch_counters_reset(
+    iree_hal_local_dispatch_counters_t* counters) {
+  iree_allocator_t host_allocator = counters->host_allocator;
+  iree_atomic_store(&counters->session_id, 0, iree_memory_order_release);
+  iree_hal_local_dispatch_counters_thread_t* thread = counters->threads;
+  while (thread) {
+    iree_hal_local_dispatch_counters_thread_t* next = thread->next;
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+    iree_hal_local_perf_event_group_close(thread->fds);
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+    iree_hal_local_dispatch_counters_table_deinitialize(&thread->table,
+                                                        host_allocator);
+    iree_slim_mutex_deinitialize(&thread->mutex);
+    iree_allocator_free(host_allocator, thread);
+    thread = next;
+  }
+  counters->threads = NULL;
+  iree_allocator_free(host_allocator, counters->file_path);
+  counters->file_path = NULL;
+}
+
+void iree_hal_local_dispatch_counters_deinitialize(
+    iree_hal_local_dispatch_counters_t* counters) {
+  iree_slim_mutex_lock(&counters->mutex);
+  iree_hal_local_dispatch_counters_reset(counters);
+  iree_slim_mutex_unlock(&counters->mutex);
+  iree_slim_mutex_deinitialize(&counters->mutex);
+}
+
+iree_status_t iree_hal_local_dispatch_counters_begin(
+    iree_hal_local_dispatch_counters_t* counters,
+    iree_string_view_t file_path) {
+  IREE_ASSERT_ARGUMENT(counters);
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+  if (iree_string_view_is_empty(file_path)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "dispatch counter profiling requires an output "
+                            "file path");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Probe on the calling thread so that hosts without hardware counters (VMs,
+  // containers, restrictive perf_event_paranoid) fail here instead of on the
+  // first dispatch.
+  int probe_fds[IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_local_perf_event_group_open(probe_fds));
+  iree_hal_local_perf_event_group_close(probe_fds);
+
+  iree_slim_mutex_lock(&counters->mutex);
+  iree_status_t status = iree_ok_status();
+  if (counters->file_path) {
+    status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "dispatch counter profiling is already active "
+                              "on this device");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(counters->host_allocator, file_path.size + 1,
+                                   (void**)&counters->file_path);
+  }
+  if (iree_status_is_ok(status)) {
+    memcpy(counters->file_path, file_path.data, file_path.size);
+    counters->file_path[file_path.size] = 0;
+    iree_atomic_store(
+        &counters->session_id,
+        iree_atomic_fetch_add(&iree_hal_local_dispatch_counters_session_id_, 1,
+                              iree_memory_order_relaxed) +
+            1,
+        iree_memory_order_release);
+  }
+  iree_slim_mutex_unlock(&counters->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "hardware performance counters are only supported "
+                          "on Linux and Android");
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+}
+
+// Merges the tables of all threads into |merged|.
+static iree_status_t iree_hal_local_dispatch_counters_merge(
+    iree_hal_local_dispatch_counters_t* counters,
+    iree_hal_local_dispatch_counters_table_t* merged) {
+  iree_status_t status = iree_ok_status();
+  for (iree_hal_local_dispatch_counters_thread_t* thread = counters->threads;
+       thread && iree_status_is_ok(status); thread = thread->next) {
+    // The owning thread may be concurrently inserting into (and growing) its
+    // table.
+    iree_slim_mutex_lock(&thread->mutex);
+    for (iree_host_size_t i = 0;
+         i < thread->table.capacity && iree_status_is_ok(status); ++i) {
+      const iree_hal_local_dispatch_counters_entry_t* source =
+          &thread->table.entries[i];
+      if (!source->executable) continue;
+      iree_hal_local_dispatch_counters_entry_t* target = NULL;
+      status = iree_hal_local_dispatch_counters_table_lookup(
+          merged, source->executable, source->ordinal,
+          counters->host_allocator, &target);
+      if (!iree_status_is_ok(status)) break;
+      target->dispatch_count += source->dispatch_count;
+      target->workgroup_count += source->workgroup_count;
+      target->duration_ns += source->duration_ns;
+      for (iree_host_size_t j = 0; j < IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT;
+           ++j) {
+        target->values[j] += source->values[j];
+      }
+    }
+    iree_slim_mutex_unlock(&thread->mutex);
+  }
+  return status;
+}
+
+static iree_string_view_t iree_hal_local_dispatch_counters_entry_name(
+    const iree_hal_local_dispatch_counters_entry_t* entry) {
+  if (!entry->executable->export_names) return iree_string_view_empty();
+  return iree_make_cstring_view(
+      entry->executable->export_names[entry->ordinal]);
+}
+
+// Serializes |table| as a chunk into |out_buffer| allocated from
+// |host_allocator|.
+static iree_status_t iree_hal_local_dispatch_counters_serialize(
+    const iree_hal_local_dispatch_counters_table_t* table,
+    iree_allocator_t host_allocator, iree_byte_span_t* out_buffer) {
+  iree_host_size_t content_length = 0;
+  for (iree_host_size_t i = 0; i < table->capacity; ++i) {
+    const iree_hal_local_dispatch_counters_entry_t* entry = &table->entries[i];
+    if (!entry->executable) continue;
+    content_length += iree_host_align(
+        sizeof(iree_instrument_dispatch_counters_t) +
+            iree_hal_local_dispatch_counters_entry_name(entry).size,
+        16);
+  }
+
+  const iree_host_size_t total_length =
+      sizeof(iree_idbts_chunk_header_t) + content_length;
+  uint8_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_length, (void**)&buffer));
+  memset(buffer, 0, total_length);
+
+  iree_idbts_chunk_header_t* header = (iree_idbts_chunk_header_t*)buffer;
+  header->magic = IREE_IDBTS_CHUNK_MAGIC;
+  header->type = IREE_IDBTS_CHUNK_TYPE_DISPATCH_COUNTERS;
+  header->version = 0;
+  header->content_length = content_length;
+
+  uint8_t* record_ptr = buffer + sizeof(*header);
+  for (iree_host_size_t i = 0; i < table->capacity; ++i) {
+    const iree_hal_local_dispatch_counters_entry_t* entry = &table->entries[i];
+    if (!entry->executable) continue;
+    iree_string_view_t name =
+        iree_hal_local_dispatch_counters_entry_name(entry);
+    iree_instrument_dispatch_counters_t* record =
+        (iree_instrument_dispatch_counters_t*)record_ptr;
+    record->export_ordinal = entry->ordinal;
+    record->name_length = (uint32_t)name.size;
+    record->dispatch_count = entry->dispatch_count;
+    record->workgroup_count = entry->workgroup_count;
+    record->duration_ns = entry->duration_ns;
+    memcpy(record->values, entry->values, sizeof(record->values));
+    memcpy(record->name, name.data, name.size);
+    record_ptr += iree_host_align(sizeof(*record) + name.size, 16);
+  }
+
+  *out_buffer = iree_make_byte_span(buffer, total_length);
+  return iree_ok_status();
+}
+
+// Writes the counters of the active capture to its file.
+// Must be called with the collector mutex held.
+static iree_status_t iree_hal_local_dispatch_counters_flush_locked(
+    iree_hal_local_dispatch_counters_t* counters) {
+  if (!counters->file_path) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, counters->file_path);
+
+  iree_hal_local_dispatch_counters_table_t merged;
+  memset(&merged, 0, sizeof(merged));
+  iree_byte_span_t buffer = iree_make_byte_span(NULL, 0);
+  iree_status_t status =
+      iree_hal_local_dispatch_counters_merge(counters, &merged);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_dispatch_counters_serialize(
+        &merged, counters->host_allocator, &buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_file_write_contents(
+        counters->file_path,
+        iree_make_const_byte_span(buffer.data, buffer.data_length));
+  }
+
+  iree_allocator_free(counters->host_allocator, buffer.data);
+  iree_hal_local_dispatch_counters_table_deinitialize(
+      &merged, counters->host_allocator);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_local_dispatch_counters_flush(
+    iree_hal_local_dispatch_counters_t* counters) {
+  IREE_ASSERT_ARGUMENT(counters);
+  iree_slim_mutex_lock(&counters->mutex);
+  iree_status_t status =
+      iree_hal_local_dispatch_counters_flush_locked(counters);
+  iree_slim_mutex_unlock(&counters->mutex);
+  return status;
+}
+
+iree_status_t iree_hal_local_dispatch_counters_end(
+    iree_hal_local_dispatch_counters_t* counters) {
+  IREE_ASSERT_ARGUMENT(counters);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&counters->mutex);
+  iree_status_t status =
+      iree_hal_local_dispatch_counters_flush_locked(counters);
+  iree_hal_local_dispatch_counters_reset(counters);
+  iree_slim_mutex_unlock(&counters->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+
+// Returns the state of the calling thread in the capture with |session_id|,
+// opening the counters on the thread if it has not yet issued workgroups in it.
+static iree_status_t iree_hal_local_dispatch_counters_acquire_thread(
+    iree_hal_local_dispatch_counters_t* counters, int64_t session_id,
+    iree_hal_local_dispatch_counters_thread_t** out_thread) {
+  if (!iree_hal_local_dispatch_counters_tls_.thread_id) {
+    iree_hal_local_dispatch_counters_tls_.thread_id =
+        iree_atomic_fetch_add(&iree_hal_local_dispatch_counters_thread_id_, 1,
+                              iree_memory_order_relaxed) +
+        1;
+  }
+  const int64_t thread_id = iree_hal_local_dispatch_counters_tls_.thread_id;
+
+  // The thread may have already joined the capture if it alternates between
+  // issuing workgroups for multiple devices.
+  iree_slim_mutex_lock(&counters->mutex);
+  iree_hal_local_dispatch_counters_thread_t* thread = counters->threads;
+  while (thread && thread->thread_id != thread_id) thread = thread->next;
+  iree_status_t status = iree_ok_status();
+  if (!thread) {
+    status = iree_allocator_malloc(counters->host_allocator, sizeof(*thread),
+                                   (void**)&thread);
+    if (iree_status_is_ok(status)) {
+      memset(thread, 0, sizeof(*thread));
+      thread->host_allocator = counters->host_allocator;
+      thread->thread_id = thread_id;
+      status = iree_hal_local_perf_event_group_open(thread->fds);
+      if (iree_status_is_ok(status)) {
+        iree_slim_mutex_initialize(&thread->mutex);
+        thread->next = counters->threads;
+        counters->threads = thread;
+      } else {
+        iree_allocator_free(counters->host_allocator, thread);
+        thread = NULL;
+      }
+    }
+  }
+  iree_slim_mutex_unlock(&counters->mutex);
+  if (!iree_status_is_ok(status)) return status;
+
+  iree_hal_local_dispatch_counters_tls_.session_id = session_id;
+  iree_hal_local_dispatch_counters_tls_.thread = thread;
+  *out_thread = thread;
+  return iree_ok_status();
+}
+
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+
+iree_status_t iree_hal_local_dispatch_counters_call_begin(
+    iree_hal_local_dispatch_counters_t* counters,
+    iree_hal_local_dispatch_counters_scope_t* out_scope) {
+  out_scope->thread = NULL;
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+  if (!counters) return iree_ok_status();
+  const int64_t session_id =
+      iree_atomic_load(&counters->session_id, iree_memory_order_acquire);
+  if (IREE_LIKELY(!session_id)) return iree_ok_status();
+
+  // Lazily open the counters on the calling thread the first time it issues
+  // a workgroup in this capture.
+  iree_hal_local_dispatch_counters_thread_t* thread =
+      iree_hal_local_dispatch_counters_tls_.thread;
+  if (IREE_UNLIKELY(iree_hal_local_dispatch_counters_tls_.session_id !=
+                    session_id)) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_dispatch_counters_acquire_thread(
+        counters, session_id, &thread));
+  }
+
+  out_scope->thread = thread;
+  iree_hal_local_perf_event_group_read(thread->fds, out_scope->start_values);
+  out_scope->start_time_ns = iree_time_now();
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_local_dispatch_counters_call_end(
+    iree_hal_local_dispatch_counters_scope_t* scope,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  if (IREE_LIKELY(!scope->thread)) return iree_ok_status();
+#if IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+  const iree_time_t end_time_ns = iree_time_now();
+  uint64_t end_values[IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+  iree_hal_local_perf_event_group_read(scope->thread->fds, end_values);
+
+  // Uncontended unless a flush is merging the table.
+  iree_hal_local_dispatch_counters_thread_t* thread = scope->thread;
+  iree_slim_mutex_lock(&thread->mutex);
+  iree_hal_local_dispatch_counters_entry_t* entry = NULL;
+  iree_status_t status = iree_hal_local_dispatch_counters_table_lookup(
+      &thread->table, executable, (uint32_t)ordinal, thread->host_allocator,
+      &entry);
+  if (iree_status_is_ok(status)) {
+    // Every dispatch issues its first workgroup exactly once.
+    if (workgroup_state->workgroup_id_x == 0 &&
+        workgroup_state->workgroup_id_y == 0 &&
+        workgroup_state->workgroup_id_z == 0) {
+      ++entry->dispatch_count;
+    }
+    ++entry->workgroup_count;
+    entry->duration_ns += (uint64_t)(end_time_ns - scope->start_time_ns);
+    for (iree_host_size_t i = 0; i < IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT;
+         ++i) {
+      entry->values[i] += end_values[i] - scope->start_values[i];
+    }
+  }
+  iree_slim_mutex_unlock(&thread->mutex);
+  IREE_RETURN_IF_ERROR(status);
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_PERF_EVENT
+  return iree_ok_status();
+}
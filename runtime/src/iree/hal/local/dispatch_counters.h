@@ -0,0 +1,115 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_DISPATCH_COUNTERS_H_
+#define IREE_HAL_LOCAL_DISPATCH_COUNTERS_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/schemas/instruments/dispatch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_dispatch_counters_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_local_dispatch_counters_thread_t
+    iree_hal_local_dispatch_counters_thread_t;
+
+// Collects hardware performance counters (cycles, instructions, cache and
+// branch misses) around every workgroup issued through
+// iree_hal_local_executable_issue_call and aggregates them per executable
+// export across all workers. Used by the local CPU devices to implement
+// IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS.
+//
+// Each device embeds its own collector and executables prepared by the device
+// reference it (see iree_hal_local_executable_cache_create) so that only
+// workgroups issued by the device are counted and multiple devices can be
+// profiled at the same time.
+//
+// Counters are sampled with perf_event_open on Linux/Android and are opened
+// lazily on each thread issuing workgroups the first time it does so within a
+// capture. Each workgroup costs two additional syscalls while a capture is
+// active and nothing beyond an atomic load otherwise. Executables that are
+// issued are retained until the capture ends so that their names are
+// available when flushing.
+typedef struct iree_hal_local_dispatch_counters_t {
+  iree_allocator_t host_allocator;
+  // Unique identifier of the active capture or 0 if not capturing. Used to
+  // invalidate thread-local state from prior captures.
+  iree_atomic_int64_t session_id;
+  // Guards the fields below.
+  iree_slim_mutex_t mutex;
+  // NUL-terminated output file path of the active capture.
+  char* file_path;
+  // All threads that have issued workgroups during the active capture.
+  iree_hal_local_dispatch_counters_thread_t* threads;
+} iree_hal_local_dispatch_counters_t;
+
+// Initializes an inactive collector in |out_counters|.
+void iree_hal_local_dispatch_counters_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_counters_t* out_counters);
+
+// Deinitializes |counters|, discarding any active capture without flushing.
+// Must only be called when no workgroups are being issued.
+void iree_hal_local_dispatch_counters_deinitialize(
+    iree_hal_local_dispatch_counters_t* counters);
+
+// Begins a capture on |counters|.
+// |file_path| is where the aggregated counters are written on flush in the
+// iree-dump-instruments chunk format.
+//
+// Fails with IREE_STATUS_UNAVAILABLE if hardware counters are not supported on
+// the platform or host, IREE_STATUS_PERMISSION_DENIED if the process is not
+// allowed to open them (see /proc/sys/kernel/perf_event_paranoid), and
+// IREE_STATUS_FAILED_PRECONDITION if a capture is already active.
+iree_status_t iree_hal_local_dispatch_counters_begin(
+    iree_hal_local_dispatch_counters_t* counters,
+    iree_string_view_t file_path);
+
+// Writes the counters aggregated so far to the file specified on begin.
+// No-op if no capture is active. May be called while workgroups are issued.
+iree_status_t iree_hal_local_dispatch_counters_flush(
+    iree_hal_local_dispatch_counters_t* counters);
+
+// Flushes and ends the active capture, if any, and releases all retained
+// executables. Must only be called when no workgroups are being issued.
+iree_status_t iree_hal_local_dispatch_counters_end(
+    iree_hal_local_dispatch_counters_t* counters);
+
+// Per-call scope storing the counter values sampled before the call.
+typedef struct iree_hal_local_dispatch_counters_scope_t {
+  // Thread state in the active capture or NULL if not capturing.
+  iree_hal_local_dispatch_counters_thread_t* thread;
+  iree_time_t start_time_ns;
+  uint64_t start_values[IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+} iree_hal_local_dispatch_counters_scope_t;
+
+// Begins a workgroup call scope on the calling thread by sampling the current
+// counter values if |counters| is non-NULL and capturing. Must be paired with a
+// call to iree_hal_local_dispatch_counters_call_end on the same thread.
+iree_status_t iree_hal_local_dispatch_counters_call_begin(
+    iree_hal_local_dispatch_counters_t* counters,
+    iree_hal_local_dispatch_counters_scope_t* out_scope);
+
+// Ends a workgroup call |scope| and accumulates the counter deltas into the
+// entry for the |ordinal| export of |executable|.
+iree_status_t iree_hal_local_dispatch_counters_call_end(
+    iree_hal_local_dispatch_counters_scope_t* scope,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_DISPATCH_COUNTERS_H_
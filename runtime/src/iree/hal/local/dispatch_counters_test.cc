@@ -0,0 +1,267 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/dispatch_counters.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+static const char* const kExportNames[] = {"export_a", "export_b"};
+
+static void FakeExecutableDestroy(iree_hal_executable_t* base_executable) {
+  iree_hal_local_executable_t* executable =
+      (iree_hal_local_executable_t*)base_executable;
+  iree_allocator_t host_allocator = executable->host_allocator;
+  iree_hal_local_executable_deinitialize(executable);
+  iree_allocator_free(host_allocator, executable);
+}
+
+static iree_status_t FakeExecutableIssueCall(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  volatile uint32_t sum = 0;
+  for (uint32_t i = 0; i < 1000; ++i) sum += i;
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t kFakeExecutableVtable = {
+    /*.base=*/{/*.destroy=*/FakeExecutableDestroy},
+    /*.issue_call=*/FakeExecutableIssueCall,
+};
+
+// Issues all workgroups of a dispatch of |ordinal| in |executable|.
+static iree_status_t IssueDispatch(iree_hal_local_executable_t* executable,
+                                   iree_host_size_t ordinal,
+                                   uint32_t workgroup_count) {
+  iree_hal_executable_dispatch_state_v0_t dispatch_state;
+  memset(&dispatch_state, 0, sizeof(dispatch_state));
+  dispatch_state.workgroup_count_x = workgroup_count;
+  dispatch_state.workgroup_count_y = 1;
+  dispatch_state.workgroup_count_z = 1;
+  iree_hal_executable_workgroup_state_v0_t workgroup_state;
+  memset(&workgroup_state, 0, sizeof(workgroup_state));
+  for (uint32_t x = 0; x < workgroup_count; ++x) {
+    workgroup_state.workgroup_id_x = x;
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_call(
+        executable, ordinal, &dispatch_state, &workgroup_state,
+        /*worker_id=*/0));
+  }
+  return iree_ok_status();
+}
+
+// Reads the records of the dispatch counters chunk written to |file_path|
+// keyed by export name.
+static iree_status_t ReadRecords(
+    const std::string& file_path,
+    std::map<std::string, iree_instrument_dispatch_counters_t>* out_records) {
+  out_records->clear();
+  iree_file_contents_t* file_contents = NULL;
+  IREE_RETURN_IF_ERROR(iree_file_read_contents(
+      file_path.c_str(), IREE_FILE_READ_FLAG_DEFAULT, iree_allocator_system(),
+      &file_contents));
+  const uint8_t* data = file_contents->const_buffer.data;
+  const iree_idbts_chunk_header_t* header =
+      (const iree_idbts_chunk_header_t*)data;
+  iree_status_t status = iree_ok_status();
+  if (file_contents->const_buffer.data_length < sizeof(*header) ||
+      header->magic != IREE_IDBTS_CHUNK_MAGIC ||
+      header->type != IREE_IDBTS_CHUNK_TYPE_DISPATCH_COUNTERS ||
+      file_contents->const_buffer.data_length !=
+          sizeof(*header) + header->content_length) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS, "malformed chunk");
+  }
+  for (iree_host_size_t offset = 0;
+       iree_status_is_ok(status) && offset < header->content_length;) {
+    const iree_instrument_dispatch_counters_t* record =
+        (const iree_instrument_dispatch_counters_t*)(data + sizeof(*header) +
+                                                     offset);
+    (*out_records)[std::string((const char*)record->name,
+                               record->name_length)] = *record;
+    offset += iree_host_align(sizeof(*record) + record->name_length, 16);
+  }
+  iree_file_contents_free(file_contents);
+  return status;
+}
+
+class DispatchCountersTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_allocator_malloc(host_allocator_, sizeof(*executable_),
+                                         (void**)&executable_));
+    iree_hal_local_executable_initialize(&kFakeExecutableVtable,
+                                         host_allocator_, executable_);
+    executable_->export_names = kExportNames;
+
+    // The executable is issued as if prepared by the device owning |counters_|.
+    iree_hal_local_dispatch_counters_initialize(host_allocator_, &counters_);
+    executable_->dispatch_counters = &counters_;
+
+    const char* tmpdir = getenv("TEST_TMPDIR");
+    if (!tmpdir) tmpdir = getenv("TMPDIR");
+    if (!tmpdir) tmpdir = "/tmp";
+    file_path_ = std::string(tmpdir) + "/iree_dispatch_counters_test.bin";
+    other_file_path_ =
+        std::string(tmpdir) + "/iree_dispatch_counters_test_other.bin";
+  }
+
+  void TearDown() override {
+    iree_hal_local_dispatch_counters_deinitialize(&counters_);
+    iree_hal_executable_release((iree_hal_executable_t*)executable_);
+    remove(file_path_.c_str());
+    remove(other_file_path_.c_str());
+  }
+
+  // Begins a capture on |counters| writing to |file_path|.
+  static iree_status_t Begin(iree_hal_local_dispatch_counters_t* counters,
+                             const std::string& file_path) {
+    return iree_hal_local_dispatch_counters_begin(
+        counters, iree_make_string_view(file_path.data(), file_path.size()));
+  }
+
+  iree_allocator_t host_allocator_ = iree_allocator_system();
+  iree_hal_local_executable_t* executable_ = NULL;
+  iree_hal_local_dispatch_counters_t counters_;
+  std::string file_path_;
+  std::string other_file_path_;
+};
+
+#define SKIP_IF_UNAVAILABLE(status)                                        \
+  do {                                                                     \
+    iree_status_t status_ = (status);                                      \
+    if (iree_status_is_unavailable(status_) ||                             \
+        iree_status_is_permission_denied(status_)) {                       \
+      iree_status_ignore(status_);                                         \
+      GTEST_SKIP() << "hardware performance counters not available";       \
+    }                                                                      \
+    IREE_ASSERT_OK(status_);                                               \
+  } while (0)
+
+TEST_F(DispatchCountersTest, InactiveIsNoOp) {
+  IREE_ASSERT_OK(IssueDispatch(executable_, 0, 4));
+  executable_->dispatch_counters = NULL;
+  IREE_ASSERT_OK(IssueDispatch(executable_, 0, 4));
+}
+
+TEST_F(DispatchCountersTest, SingleCapturePerCollector) {
+  SKIP_IF_UNAVAILABLE(Begin(&counters_, file_path_));
+  EXPECT_THAT(Status(Begin(&counters_, file_path_)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  IREE_ASSERT_OK(iree_hal_local_dispatch_counters_end(&counters_));
+
+  // Restarting after the capture ends is allowed.
+  SKIP_IF_UNAVAILABLE(Begin(&counters_, file_path_));
+  IREE_ASSERT_OK(iree_hal_local_dispatch_counters_end(&counters_));
+}
+
+TEST_F(DispatchCountersTest, AggregatesPerExport) {
+  SKIP_IF_UNAVAILABLE(Begin(&counters_, file_path_));
+  IREE_ASSERT_OK(IssueDispatch(executable_, 0, 4));
+  IREE_ASSERT_OK(IssueDispatch(executable_, 0, 4));
+  IREE_ASSERT_OK(IssueDispatch(executable_, 1, 3));
+  IREE_ASSERT_OK(iree_hal_local_dispatch_counters_end(&counters_));
+
+  std::map<std::string, iree_instrument_dispatch_counters_t> records;
+  IREE_ASSERT_OK(ReadRecords(file_path_, &records));
+  ASSERT_EQ(records.size(), 2u);
+  const auto& a = records["export_a"];
+  EXPECT_EQ(a.export_ordinal, 0u);
+  EXPECT_EQ(a.dispatch_count, 2u);
+  EXPECT_EQ(a.workgroup_count, 8u);
+  EXPECT_GT(a.values[IREE_INSTRUMENT_DISPATCH_COUNTER_INSTRUCTIONS], 0u);
+  const auto& b = records["export_b"];
+  EXPECT_EQ(b.export_ordinal, 1u);
+  EXPECT_EQ(b.dispatch_count, 1u);
+  EXPECT_EQ(b.workgroup_count, 3u);
+}
+
+// Each device has its own collector: captures on multiple devices may be
+// active at once and only count the executables prepared by their device.
+TEST_F(DispatchCountersTest, CollectorsAreIndependent) {
+  iree_hal_local_dispatch_counters_t other_counters;
+  iree_hal_local_dispatch_counters_initialize(host_allocator_,
+                                              &other_counters);
+  iree_status_t status = Begin(&counters_, file_path_);
+  if (iree_status_is_ok(status)) {
+    status = Begin(&other_counters, other_file_path_);
+  }
+  if (iree_status_is_ok(status)) {
+    status = IssueDispatch(executable_, 0, 4);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_dispatch_counters_end(&other_counters);
+  }
+  iree_hal_local_dispatch_counters_deinitialize(&other_counters);
+  SKIP_IF_UNAVAILABLE(status);
+  IREE_ASSERT_OK(iree_hal_local_dispatch_counters_end(&counters_));
+
+  std::map<std::string, iree_instrument_dispatch_counters_t> records;
+  IREE_ASSERT_OK(ReadRecords(file_path_, &records));
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_EQ(records["export_a"].workgroup_count, 4u);
+  IREE_ASSERT_OK(ReadRecords(other_file_path_, &records));
+  EXPECT_TRUE(records.empty());
+}
+
+// Flushes may happen while workers are issuing workgroups and growing their
+// tables.
+TEST_F(DispatchCountersTest, FlushWhileIssuing) {
+  SKIP_IF_UNAVAILABLE(Begin(&counters_, file_path_));
+
+  // Many executables force the issuing thread to repeatedly grow its table.
+  std::vector<iree_hal_local_executable_t*> executables(64);
+  for (auto*& executable : executables) {
+    IREE_ASSERT_OK(iree_allocator_malloc(
+        host_allocator_, sizeof(*executable), (void**)&executable));
+    iree_hal_local_executable_initialize(&kFakeExecutableVtable,
+                                         host_allocator_, executable);
+    executable->export_names = kExportNames;
+    executable->dispatch_counters = &counters_;
+  }
+  std::atomic<bool> issue_status_ok{true};
+  std::thread issuing_thread([&]() {
+    for (auto* executable : executables) {
+      if (!iree_status_is_ok(IssueDispatch(executable, 0, 2))) {
+        issue_status_ok = false;
+      }
+    }
+  });
+  for (int i = 0; i < 16; ++i) {
+    IREE_EXPECT_OK(iree_hal_local_dispatch_counters_flush(&counters_));
+  }
+  issuing_thread.join();
+  EXPECT_TRUE(issue_status_ok);
+
+  IREE_ASSERT_OK(iree_hal_local_dispatch_counters_end(&counters_));
+  for (auto* executable : executables) {
+    iree_hal_executable_release((iree_hal_executable_t*)executable);
+  }
+  std::map<std::string, iree_instrument_dispatch_counters_t> records;
+  IREE_ASSERT_OK(ReadRecords(file_path_, &records));
+  // All executables share export names and the last record wins here.
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_EQ(records["export_a"].workgroup_count, 2u);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/memory.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_loader.h"
@@ -48,6 +49,10 @@ IREE_FLAG(int32_t, workgroup_size_z, 1,
 IREE_FLAG(int32_t, max_concurrency, 1,
           "Maximum available concurrency exposed to the dispatch.");
 
+IREE_FLAG(int64_t, local_memory_size, 0,
+          "Minimum bytes of workgroup local memory passed to the dispatch.\n"
+          "The executable-declared amount is used if larger.");
+
 // Parsed parameters from flags.
 // Used to construct the dispatch parameters for the benchmark invocation.
 struct {
@@ -167,7 +172,8 @@ static iree_status_t iree_hal_executable_library_run(
   iree_hal_local_executable_t* local_executable =
       iree_hal_local_executable_cast(executable);
 
-  // Allocate workgroup-local memory that each invocation can use.
+  // Allocate workgroup-local memory that each invocation can use. This matches
+  // the large page-backed arenas the task system workers use.
   iree_byte_span_t local_memory = iree_make_byte_span(NULL, 0);
   iree_host_size_t local_memory_size =
       local_executable->dispatch_attrs
@@ -175,9 +181,12 @@ static iree_status_t iree_hal_executable_library_run(
                     .local_memory_pages *
                 IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
           : 0;
+  local_memory_size =
+      iree_max(local_memory_size, (iree_host_size_t)FLAG_local_memory_size);
   if (local_memory_size > 0) {
-    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
-        host_allocator, local_memory_size, (void**)&local_memory.data));
+    IREE_RETURN_IF_ERROR(iree_memory_pages_allocate(
+        local_memory_size, IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES,
+        (void**)&local_memory.data));
     local_memory.data_length = local_memory_size;
   }
 
@@ -248,6 +257,7 @@ static iree_status_t iree_hal_executable_library_run(
     iree_hal_buffer_view_release(buffer_views[i]);
   }
   iree_hal_allocator_release(heap_allocator);
+  iree_memory_pages_free(local_memory.data, local_memory.data_length);
 
   // Unload.
   iree_hal_executable_release(executable);
@@ -6,6 +6,7 @@
 
 #include "iree/hal/local/local_executable.h"
 
+#include "iree/hal/local/dispatch_counters.h"
 #include "iree/hal/local/executable_environment.h"
 
 void iree_hal_local_executable_initialize(
@@ -17,6 +18,10 @@ void iree_hal_local_executable_initialize(
 
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
+  out_base_executable->export_names = NULL;
+
+  // Assigned by the executable cache that prepares the executable.
+  out_base_executable->dispatch_counters = NULL;
 
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
@@ -39,10 +44,23 @@ iree_status_t iree_hal_local_executable_issue_call(
   IREE_ASSERT_ARGUMENT(executable);
   IREE_ASSERT_ARGUMENT(dispatch_state);
   IREE_ASSERT_ARGUMENT(workgroup_state);
-  return ((const iree_hal_local_executable_vtable_t*)
-              executable->resource.vtable)
-      ->issue_call(executable, ordinal, dispatch_state, workgroup_state,
-                   worker_id);
+
+  // Samples hardware counters around the call when dispatch counter profiling
+  // is active and otherwise is just an atomic load.
+  iree_hal_local_dispatch_counters_scope_t counters_scope;
+  IREE_RETURN_IF_ERROR(iree_hal_local_dispatch_counters_call_begin(
+      executable->dispatch_counters, &counters_scope));
+
+  iree_status_t status =
+      ((const iree_hal_local_executable_vtable_t*)executable->resource.vtable)
+          ->issue_call(executable, ordinal, dispatch_state, workgroup_state,
+                       worker_id);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_dispatch_counters_call_end(
+        &counters_scope, executable, ordinal, workgroup_state);
+  }
+  return status;
 }
 
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
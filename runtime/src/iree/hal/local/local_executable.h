@@ -25,6 +25,14 @@ typedef struct iree_hal_local_executable_t {
   // minimum amount of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Optional per-entry point export names used for diagnostics and profiling.
+  // NULL if the executable format does not retain names.
+  const char* const* export_names;
+
+  // Dispatch counter collector of the device that prepared the executable or
+  // NULL if the executable was not prepared by a device.
+  struct iree_hal_local_dispatch_counters_t* dispatch_counters;
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -9,11 +9,14 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "iree/hal/local/local_executable.h"
+
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
   iree_host_size_t worker_capacity;
+  iree_hal_local_dispatch_counters_t* dispatch_counters;
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -30,6 +33,7 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_local_dispatch_counters_t* dispatch_counters,
     iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
@@ -52,6 +56,7 @@ iree_status_t iree_hal_local_executable_cache_create(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
     executable_cache->worker_capacity = worker_capacity;
+    executable_cache->dispatch_counters = dispatch_counters;
 
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
@@ -119,7 +124,10 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
         executable_cache->loaders[i], executable_params,
         executable_cache->worker_capacity, out_executable);
     if (iree_status_is_ok(status)) {
-      // Executable was successfully loaded.
+      // Executable was successfully loaded. All local loaders produce local
+      // executables.
+      iree_hal_local_executable_cast(*out_executable)->dispatch_counters =
+          executable_cache->dispatch_counters;
       return status;
     } else if (!iree_status_is_cancelled(status) &&
                !iree_status_is_not_found(status)) {
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/dispatch_counters.h"
 #include "iree/hal/local/executable_loader.h"
 
 #ifdef __cplusplus
@@ -23,9 +24,14 @@ extern "C" {
 // one device is the same JIT'ed executable in another, and in multi-tenant
 // situations we're likely to want that isolation _and_ sharing.
 
+// Creates an executable cache preparing executables with the first of
+// |loaders| that supports them. |dispatch_counters| is the optional collector
+// of the owning device that prepared executables report to; it must remain
+// valid for the lifetime of the cache and its executables.
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_local_dispatch_counters_t* dispatch_counters,
     iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
@@ -6,11 +6,247 @@
 
 #include "iree/hal/utils/caching_allocator.h"
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
 #include "iree/base/internal/synchronization.h"
 
 // Default capacity of a pool free list when not specified by the user.
 #define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY 64
 
+// Number of power-of-two size buckets in each shard free list.
+// Bucket i holds buffers with allocation sizes in [2^i, 2^(i+1)).
+#define IREE_HAL_CACHING_ALLOCATOR_BUCKET_COUNT 64
+
+// Sentinel entry index used to terminate shard free lists.
+#define IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE UINT32_MAX
+
+// Monotonically increasing counter used to assign threads their shard.
+static iree_atomic_int32_t iree_hal_caching_allocator_next_shard_hint =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Per-thread shard hint; 0 indicates the thread has not yet been assigned.
+static iree_thread_local uint32_t iree_hal_caching_allocator_shard_hint = 0;
+
+// Returns the shard hint of the calling thread. Threads are assigned hints in
+// round-robin order on first use so that the first N threads to touch any pool
+// with N shards land on unique shards.
+static uint32_t iree_hal_caching_allocator_current_shard_hint(void) {
+  uint32_t hint = iree_hal_caching_allocator_shard_hint;
+  if (IREE_UNLIKELY(hint == 0)) {
+    hint = (uint32_t)iree_atomic_fetch_add(
+               &iree_hal_caching_allocator_next_shard_hint, 1,
+               iree_memory_order_relaxed) +
+           1;
+    iree_hal_caching_allocator_shard_hint = hint;
+  }
+  return hint - 1;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_caching_allocator_shard_t
+//===----------------------------------------------------------------------===//
+
+// Returns the size bucket that |allocation_size| belongs in.
+static inline int iree_hal_caching_allocator_bucket_index(
+    iree_device_size_t allocation_size) {
+  if (allocation_size <= 1) return 0;
+  return 63 - iree_math_count_leading_zeros_u64((uint64_t)allocation_size);
+}
+
+// An entry in a shard free list.
+typedef struct iree_hal_caching_allocator_entry_t {
+  // Retained buffer available for reuse or NULL if the entry is unused.
+  iree_hal_buffer_t* buffer;
+  // Index of the next entry in the bucket list (or unused entry list).
+  uint32_t next;
+} iree_hal_caching_allocator_entry_t;
+
+// A lock-protected subset of a pool free list.
+// Free buffers are bucketed by their power-of-two size such that lookups only
+// need to scan buffers of similar sizes. Each bucket is a singly-linked list
+// ordered by descending recency (the head is the most recently released).
+//
+// Thread-safe. Shards are guarded by their own mutex and multiple shards in the
+// same pool can be accessed concurrently.
+typedef struct iree_hal_caching_allocator_shard_t {
+  // Guards all shard state.
+  iree_slim_mutex_t mutex;
+
+  // Total number of entries available for tracking free buffers.
+  uint32_t capacity;
+
+  // Total number of free buffers currently in the shard.
+  uint32_t free_count;
+
+  // Head of the unused entry list.
+  uint32_t unused_head;
+
+  // Bitmask of buckets with at least one free buffer.
+  uint64_t bucket_mask;
+
+  // Head entry index of each size bucket list.
+  uint32_t bucket_heads[IREE_HAL_CACHING_ALLOCATOR_BUCKET_COUNT];
+
+  // Entry storage with |capacity| elements.
+  iree_hal_caching_allocator_entry_t entries[];
+} iree_hal_caching_allocator_shard_t;
+
+// Returns the total size in bytes of a shard with |capacity| entries.
+// Shards are padded to avoid false sharing between adjacent shard mutexes.
+static iree_host_size_t iree_hal_caching_allocator_shard_size(
+    iree_host_size_t capacity) {
+  return iree_host_align(sizeof(iree_hal_caching_allocator_shard_t) +
+                             capacity *
+                                 sizeof(iree_hal_caching_allocator_entry_t),
+                         iree_hardware_destructive_interference_size);
+}
+
+// Initializes a shard in |out_shard| with storage for |capacity| entries.
+static void iree_hal_caching_allocator_shard_initialize(
+    uint32_t capacity, iree_hal_caching_allocator_shard_t* out_shard) {
+  iree_slim_mutex_initialize(&out_shard->mutex);
+  out_shard->capacity = capacity;
+  out_shard->free_count = 0;
+  out_shard->bucket_mask = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_shard->bucket_heads);
+       ++i) {
+    out_shard->bucket_heads[i] = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  }
+  out_shard->unused_head =
+      capacity > 0 ? 0 : IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  for (uint32_t i = 0; i < capacity; ++i) {
+    out_shard->entries[i].buffer = NULL;
+    out_shard->entries[i].next =
+        i + 1 < capacity ? i + 1 : IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  }
+}
+
+// Deinitializes |shard|; all free buffers must have been taken.
+static void iree_hal_caching_allocator_shard_deinitialize(
+    iree_hal_caching_allocator_shard_t* shard) {
+  IREE_ASSERT_EQ(shard->free_count, 0,
+                 "must have released all allocations prior to deinit");
+  iree_slim_mutex_deinitialize(&shard->mutex);
+}
+
+// Pushes |buffer| on to the head of its bucket in the |shard| free list.
+// The buffer will be retained in the list. Returns false if the shard is full.
+//
+// Must be called with the shard mutex held.
+static bool iree_hal_caching_allocator_shard_push_buffer(
+    iree_hal_caching_allocator_shard_t* shard, iree_hal_buffer_t* buffer) {
+  uint32_t entry_index = shard->unused_head;
+  if (entry_index == IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) return false;
+  iree_hal_caching_allocator_entry_t* entry = &shard->entries[entry_index];
+  shard->unused_head = entry->next;
+
+  // Retain the buffer; the caller must release it to complete the ownership
+  // transfer.
+  iree_hal_buffer_retain(buffer);
+
+  const int bucket = iree_hal_caching_allocator_bucket_index(
+      iree_hal_buffer_allocation_size(buffer));
+  entry->buffer = buffer;
+  entry->next = shard->bucket_heads[bucket];
+  shard->bucket_heads[bucket] = entry_index;
+  shard->bucket_mask |= 1ull << bucket;
+  ++shard->free_count;
+  return true;
+}
+
+// Takes the buffer at |entry_index| in the |shard| free list |bucket| and
+// returns ownership. |prev_index| is the entry preceding it in the bucket list
+// or IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE if it is the head.
+//
+// Must be called with the shard mutex held.
+static iree_hal_buffer_t* iree_hal_caching_allocator_shard_take_buffer_at(
+    iree_hal_caching_allocator_shard_t* shard, int bucket, uint32_t prev_index,
+    uint32_t entry_index) {
+  iree_hal_caching_allocator_entry_t* entry = &shard->entries[entry_index];
+  iree_hal_buffer_t* buffer = entry->buffer;
+
+  // Unlink from the bucket list.
+  if (prev_index == IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    shard->bucket_heads[bucket] = entry->next;
+  } else {
+    shard->entries[prev_index].next = entry->next;
+  }
+  if (shard->bucket_heads[bucket] == IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    shard->bucket_mask &= ~(1ull << bucket);
+  }
+
+  // Return the entry to the unused list.
+  entry->buffer = NULL;
+  entry->next = shard->unused_head;
+  shard->unused_head = entry_index;
+  --shard->free_count;
+
+  return buffer;
+}
+
+// Scans the |shard| free list for the smallest buffer of at least
+// |allocation_size| and less than |max_size| bytes that matches the given
+// requirements and returns ownership. Buckets are scanned in increasing size
+// order starting with the one containing |allocation_size| and the scan stops
+// at the first bucket with a match as it holds the best fit.
+//
+// Must be called with the shard mutex held.
+static iree_hal_buffer_t* iree_hal_caching_allocator_shard_find_and_take_buffer(
+    iree_hal_caching_allocator_shard_t* shard,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_device_size_t max_size) {
+  const int first_bucket =
+      iree_hal_caching_allocator_bucket_index(allocation_size);
+  const int last_bucket = iree_hal_caching_allocator_bucket_index(max_size - 1);
+  for (int bucket = first_bucket; bucket <= last_bucket; ++bucket) {
+    if (!(shard->bucket_mask & (1ull << bucket))) continue;  // empty bucket
+    uint32_t best_prev_index = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+    uint32_t best_index = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+    iree_device_size_t best_size = max_size;
+    uint32_t prev_index = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+    for (uint32_t i = shard->bucket_heads[bucket];
+         i != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+         prev_index = i, i = shard->entries[i].next) {
+      // NOTE: we are not currently checking alignment as we don't really have
+      // it. We assume programs will use consistent alignments for a particular
+      // heap (as the heap has a min alignment).
+      iree_hal_buffer_t* buffer = shard->entries[i].buffer;
+      const iree_device_size_t buffer_size =
+          iree_hal_buffer_allocation_size(buffer);
+      if (buffer_size < allocation_size || buffer_size >= best_size) continue;
+      if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                             params->type) ||
+          !iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                             params->usage)) {
+        continue;
+      }
+      best_prev_index = prev_index;
+      best_index = i;
+      best_size = buffer_size;
+      if (buffer_size == allocation_size) break;  // can't do better
+    }
+    if (best_index != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+      return iree_hal_caching_allocator_shard_take_buffer_at(
+          shard, bucket, best_prev_index, best_index);
+    }
+  }
+  return NULL;  // nothing found
+}
+
+// Takes the most recently released buffer from the largest non-empty bucket in
+// |shard| and returns ownership. Returns NULL if the shard is empty.
+//
+// Must be called with the shard mutex held.
+static iree_hal_buffer_t* iree_hal_caching_allocator_shard_take_largest_buffer(
+    iree_hal_caching_allocator_shard_t* shard) {
+  if (!shard->bucket_mask) return NULL;
+  const int bucket =
+      63 - iree_math_count_leading_zeros_u64(shard->bucket_mask);
+  return iree_hal_caching_allocator_shard_take_buffer_at(
+      shard, bucket, IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE,
+      shard->bucket_heads[bucket]);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_caching_allocator_pool_t
 //===----------------------------------------------------------------------===//
@@ -28,14 +264,17 @@ void iree_hal_caching_allocator_pool_params_initialize(
   out_params->max_allocation_capacity = IREE_DEVICE_SIZE_MAX;
   out_params->max_free_allocation_count =
       IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY;
+  out_params->size_class = IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_EXACT;
+  out_params->size_class_granularity = heap.min_alignment;
+  out_params->shard_count = 1;
 }
 
 // Pool of arbitrarily-sized device allocations for a particular heap.
 // This maintains a free list of blocks available for use but does not track
-// outstanding allocations.
+// outstanding allocations. The free list is split into one or more shards.
 //
 // Thread-safe. Pools can service requests from multiple threads concurrently by
-// way of a pool-specific mutex. The mutex will not be held during underlying
+// way of shard-specific mutexes. The mutexes will not be held during underlying
 // allocator operations such as when acquiring a new allocation as these can be
 // extremely slow and the underlying allocator is also assumed thread-safe.
 typedef iree_alignas(
@@ -47,35 +286,53 @@ typedef iree_alignas(
   // Unretained as the parent allocator retains it for us.
   iree_hal_allocator_t* device_allocator;
 
-  // Guards access to the pool data structures as buffers can be
-  // acquired/released from multiple threads if shared across user-visible
-  // devices.
-  //
-  // Note that we keep the mutex per-pool so that if we do need to allocate or
-  // free we can do so without holding the lock.
-  iree_slim_mutex_t mutex;
-
   // Total size, in bytes, of all outstanding allocations made from this pool.
   // This only includes allocations we are able to pool as we otherwise cannot
   // observe imported/exported buffers.
-  iree_device_size_t total_allocated_size;
+  iree_atomic_int64_t total_allocated_size;
 
   // Total size, in bytes, of all free buffers currently in this pool.
-  iree_device_size_t free_allocated_size;
-
-  // Flat MRU list of available buffers with max_free_allocation_count slots.
-  // Sorted by ascending recency (the higher the index the more recent).
-  // If we really cared about optimizing the interior removal then we'd want
-  // a linked/skip list or some bucketing but that's really for the higher
-  // level allocators to do.
-  iree_host_size_t free_count;
-  iree_hal_buffer_t* free_buffers[];
+  iree_atomic_int64_t free_allocated_size;
+
+  // Shards the free list is split into. Each guards its own portion of the
+  // free list with its own mutex.
+  iree_host_size_t shard_count;
+  iree_hal_caching_allocator_shard_t* shards[];
 } iree_hal_caching_allocator_pool_t;
 
+// Returns the number of free list entries each shard in a pool will have.
+static iree_host_size_t iree_hal_caching_allocator_pool_shard_capacity(
+    const iree_hal_caching_allocator_pool_params_t* params) {
+  return iree_host_size_ceil_div(params->max_free_allocation_count,
+                                 params->shard_count);
+}
+
+// Returns the total size in bytes of a pool with the given |params|.
+static iree_host_size_t iree_hal_caching_allocator_pool_size(
+    const iree_hal_caching_allocator_pool_params_t* params) {
+  iree_hal_caching_allocator_pool_t* pool = NULL;
+  iree_host_size_t total_size = iree_host_align(
+      sizeof(*pool) + params->shard_count * sizeof(pool->shards[0]),
+      iree_hardware_destructive_interference_size);
+  total_size +=
+      params->shard_count *
+      iree_hal_caching_allocator_shard_size(
+          iree_hal_caching_allocator_pool_shard_capacity(params));
+  return iree_host_align(total_size, iree_max_align_t);
+}
+
+// Returns the shard the calling thread prefers in |pool|.
+static inline iree_host_size_t iree_hal_caching_allocator_pool_shard_ordinal(
+    iree_hal_caching_allocator_pool_t* pool) {
+  if (pool->shard_count == 1) return 0;
+  return iree_hal_caching_allocator_current_shard_hint() % pool->shard_count;
+}
+
 static void iree_hal_caching_allocator_pool_trim(
     iree_hal_caching_allocator_pool_t* pool);
 
-// Initializes a buffer pool in |out_pool|.
+// Initializes a buffer pool in |out_pool|, which must have storage for at least
+// iree_hal_caching_allocator_pool_size bytes.
 // Buffer device storage will be allocated from |device_allocator|.
 static void iree_hal_caching_allocator_pool_initialize(
     iree_hal_caching_allocator_pool_params_t params,
@@ -85,16 +342,31 @@ static void iree_hal_caching_allocator_pool_initialize(
 
   out_pool->params = params;
   out_pool->device_allocator = device_allocator;
-  iree_slim_mutex_initialize(&out_pool->mutex);
-  out_pool->total_allocated_size = 0;
-  out_pool->free_allocated_size = 0;
-  out_pool->free_count = 0;
+  iree_atomic_store(&out_pool->total_allocated_size, 0,
+                    iree_memory_order_relaxed);
+  iree_atomic_store(&out_pool->free_allocated_size, 0,
+                    iree_memory_order_relaxed);
+
+  // Shards are stored immediately after the pool and its shard pointer list.
+  out_pool->shard_count = params.shard_count;
+  const iree_host_size_t shard_capacity =
+      iree_hal_caching_allocator_pool_shard_capacity(&params);
+  uint8_t* shard_ptr =
+      (uint8_t*)out_pool +
+      iree_host_align(sizeof(*out_pool) +
+                          params.shard_count * sizeof(out_pool->shards[0]),
+                      iree_hardware_destructive_interference_size);
+  for (iree_host_size_t i = 0; i < params.shard_count; ++i) {
+    out_pool->shards[i] = (iree_hal_caching_allocator_shard_t*)shard_ptr;
+    shard_ptr += iree_hal_caching_allocator_shard_size(shard_capacity);
+    iree_hal_caching_allocator_shard_initialize((uint32_t)shard_capacity,
+                                                out_pool->shards[i]);
+  }
 
   IREE_TRACE_SET_PLOT_TYPE(IREE_HAL_CACHING_ALLOCATOR_ID,
                            IREE_TRACING_PLOT_TYPE_MEMORY, /*step=*/true,
                            /*fill=*/true, /*color=*/0);
-  IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
-                            out_pool->free_allocated_size);
+  IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID, 0);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -107,86 +379,71 @@ static void iree_hal_caching_allocator_pool_deinitialize(
   // Trim first to release all the buffers. There shouldn't be any live
   // allocations by the time we are deinitializing.
   iree_hal_caching_allocator_pool_trim(pool);
-  IREE_ASSERT_EQ(pool->total_allocated_size, 0,
-                 "must have released all allocations prior to deinit");
-  IREE_ASSERT_EQ(pool->free_allocated_size, 0,
-                 "must have released all allocations prior to deinit");
-  IREE_ASSERT_EQ(pool->free_count, 0,
-                 "must have released all allocations prior to deinit");
-
-  iree_slim_mutex_deinitialize(&pool->mutex);
+  IREE_ASSERT_EQ(iree_atomic_load(&pool->total_allocated_size,
+                                  iree_memory_order_acquire),
+                 0, "must have released all allocations prior to deinit");
+  IREE_ASSERT_EQ(
+      iree_atomic_load(&pool->free_allocated_size, iree_memory_order_acquire),
+      0, "must have released all allocations prior to deinit");
+
+  for (iree_host_size_t i = 0; i < pool->shard_count; ++i) {
+    iree_hal_caching_allocator_shard_deinitialize(pool->shards[i]);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
 
-// Pushes |buffer| on to the pool free list as the most recently used.
-// The buffer will be retained in the list.
-//
-// Must be called with the pool mutex held.
-static void iree_hal_caching_allocator_pool_push_buffer(
-    iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
-  // Retain the buffer; the caller must release it to complete the ownership
-  // transfer.
-  iree_hal_buffer_retain(buffer);
-
-  IREE_ASSERT_LT(pool->free_count, pool->params.max_free_allocation_count);
-
-  // Add to the end of the list (the most recent).
-  iree_host_size_t i = pool->free_count++;
-  pool->free_buffers[i] = buffer;
-
-  // Track that we're now retaining unused memory.
-  pool->free_allocated_size += buffer->allocation_size;
-  IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
-                            pool->free_allocated_size);
+// Adjusts the |pool| free size by |delta| bytes.
+static void iree_hal_caching_allocator_pool_adjust_free_size(
+    iree_hal_caching_allocator_pool_t* pool, int64_t delta) {
+  int64_t free_allocated_size =
+      iree_atomic_fetch_add(&pool->free_allocated_size, delta,
+                            iree_memory_order_relaxed) +
+      delta;
+  (void)free_allocated_size;
+  IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID, free_allocated_size);
 }
 
-// Takes the buffer in the |pool| free list at index |i| and returns ownership.
-// If the list is large this is bad but in most cases it's just a few dozen
-// elements.
+// Scans the |pool| free lists for a buffer matching the given requirements and
+// returns ownership. The calling thread's shard is checked first and then all
+// other shards that are not currently locked by other threads.
 //
-// Must be called with the pool mutex held.
-static iree_hal_buffer_t* iree_hal_caching_allocator_pool_take_buffer_at(
-    iree_hal_caching_allocator_pool_t* pool, iree_host_size_t i) {
-  iree_hal_buffer_t* buffer = pool->free_buffers[i];
-  if (i < pool->free_count - 1) {
-    // Shift the list down to keep it dense and in ascending recency order.
-    memmove(&pool->free_buffers[i], &pool->free_buffers[i + 1],
-            (pool->free_count - i - 1) * sizeof(pool->free_buffers[0]));
-  }
-  --pool->free_count;
-  pool->free_allocated_size -= buffer->allocation_size;
-  IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
-                            pool->free_allocated_size);
-  return buffer;
-}
-
-// Scans the |pool| free list for a buffer matching the given requirements and
-// returns ownership.
-//
-// Must be called with the pool mutex held.
+// Thread-safe; multiple threads may concurrently access the |pool|.
 static iree_hal_buffer_t* iree_hal_caching_allocator_pool_find_and_take_buffer(
     iree_hal_caching_allocator_pool_t* pool,
     const iree_hal_buffer_params_t* params,
     iree_device_size_t allocation_size) {
-  // Walk backwards so that we check the most recently released buffers first.
-  for (int i = (int)pool->free_count - 1; i >= 0; --i) {
-    // NOTE: we are not currently checking alignment as we don't really have it.
-    // We assume programs will use consistent alignments for a particular heap
-    // (as the heap has a min alignment).
-    iree_hal_buffer_t* buffer = pool->free_buffers[i];
-    if (iree_all_bits_set(iree_hal_buffer_memory_type(buffer), params->type) &&
-        iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
-                          params->usage) &&
-        iree_hal_buffer_allocation_size(buffer) == allocation_size) {
-      return iree_hal_caching_allocator_pool_take_buffer_at(pool, i);
+  // Size classes allow reusing buffers less than 2x the (rounded) size.
+  iree_device_size_t max_size = allocation_size + 1;
+  if (pool->params.size_class != IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_EXACT) {
+    max_size = allocation_size <= IREE_DEVICE_SIZE_MAX / 2
+                   ? allocation_size * 2
+                   : IREE_DEVICE_SIZE_MAX;
+  }
+  const iree_host_size_t home_ordinal =
+      iree_hal_caching_allocator_pool_shard_ordinal(pool);
+  iree_hal_buffer_t* buffer = NULL;
+  for (iree_host_size_t i = 0; i < pool->shard_count && !buffer; ++i) {
+    iree_hal_caching_allocator_shard_t* shard =
+        pool->shards[(home_ordinal + i) % pool->shard_count];
+    if (i == 0) {
+      iree_slim_mutex_lock(&shard->mutex);
+    } else if (!iree_slim_mutex_try_lock(&shard->mutex)) {
+      continue;  // busy; don't wait on other threads' shards
     }
+    buffer = iree_hal_caching_allocator_shard_find_and_take_buffer(
+        shard, params, allocation_size, max_size);
+    iree_slim_mutex_unlock(&shard->mutex);
   }
-  return NULL;  // nothing found
+  if (buffer) {
+    iree_hal_caching_allocator_pool_adjust_free_size(
+        pool, -(int64_t)iree_hal_buffer_allocation_size(buffer));
+  }
+  return buffer;
 }
 
 // Trims |pool| down to at most |target_size| of available allocations.
-// The oldest allocations will be trimmed first.
+// The largest allocations will be trimmed first.
 //
 // Thread-safe; multiple threads may concurrently access the |pool|.
 static void iree_hal_caching_allocator_pool_trim_to_size(
@@ -194,44 +451,84 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)target_size);
 
-  iree_slim_mutex_lock(&pool->mutex);
-
-  while (pool->free_count > 0 && pool->total_allocated_size > target_size) {
-    // Take the oldest buffer in the list.
-    iree_hal_buffer_t* dead_buffer =
-        iree_hal_caching_allocator_pool_take_buffer_at(pool,
-                                                       pool->free_count - 1);
-
-    // NOTE: we've removed the buffer but have not subtracted the size from
-    // the total yet - we want to do that only after releasing the buffer.
-    // If we didn't it's possible for another thread to start an allocation
-    // thinking that we've already released the buffer.
-    iree_device_size_t allocation_size =
-        iree_hal_buffer_allocation_size(dead_buffer);
-
-    // Release the buffer without holding the lock as deallocation can be slow.
-    iree_slim_mutex_unlock(&pool->mutex);
-    iree_hal_allocator_deallocate_buffer(pool->device_allocator, dead_buffer);
-    iree_slim_mutex_lock(&pool->mutex);
-
-    // Update accounting to represent that we've released the buffer.
-    IREE_ASSERT_GE(pool->total_allocated_size, allocation_size);
-    pool->total_allocated_size -= allocation_size;
+  for (iree_host_size_t i = 0; i < pool->shard_count; ++i) {
+    iree_hal_caching_allocator_shard_t* shard = pool->shards[i];
+    iree_slim_mutex_lock(&shard->mutex);
+    while ((iree_device_size_t)iree_atomic_load(&pool->total_allocated_size,
+                                                iree_memory_order_relaxed) >
+           target_size) {
+      iree_hal_buffer_t* dead_buffer =
+          iree_hal_caching_allocator_shard_take_largest_buffer(shard);
+      if (!dead_buffer) break;
+
+      // NOTE: we've removed the buffer but have not subtracted the size from
+      // the total yet - we want to do that only after releasing the buffer.
+      // If we didn't it's possible for another thread to start an allocation
+      // thinking that we've already released the buffer.
+      iree_device_size_t allocation_size =
+          iree_hal_buffer_allocation_size(dead_buffer);
+      iree_hal_caching_allocator_pool_adjust_free_size(
+          pool, -(int64_t)allocation_size);
+
+      // Release the buffer without holding the lock as deallocation can be
+      // slow.
+      iree_slim_mutex_unlock(&shard->mutex);
+      iree_hal_allocator_deallocate_buffer(pool->device_allocator, dead_buffer);
+      iree_slim_mutex_lock(&shard->mutex);
+
+      // Update accounting to represent that we've released the buffer.
+      iree_atomic_fetch_sub(&pool->total_allocated_size,
+                            (int64_t)allocation_size,
+                            iree_memory_order_relaxed);
+    }
+    iree_slim_mutex_unlock(&shard->mutex);
   }
 
-  iree_slim_mutex_unlock(&pool->mutex);
-
   IREE_TRACE_ZONE_END(z0);
 }
 
 // Releases all unused buffers in |pool| to the underlying device allocator.
 //
-// The pool mutex must not be held by the caller.
+// The pool shard mutexes must not be held by the caller.
 static void iree_hal_caching_allocator_pool_trim(
     iree_hal_caching_allocator_pool_t* pool) {
   iree_hal_caching_allocator_pool_trim_to_size(pool, 0);
 }
 
+// Rounds |allocation_size| up to the size class it belongs to in |pool|.
+// Sizes that would exceed the maximum allocation size of the heap when rounded
+// are returned unmodified.
+static iree_device_size_t iree_hal_caching_allocator_pool_round_size(
+    iree_hal_caching_allocator_pool_t* pool,
+    iree_device_size_t allocation_size) {
+  const iree_device_size_t granularity =
+      iree_max(1, pool->params.size_class_granularity);
+  iree_device_size_t rounded_size = allocation_size;
+  switch (pool->params.size_class) {
+    default:
+    case IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_EXACT:
+      return allocation_size;
+    case IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_POW2:
+      rounded_size =
+          allocation_size <= granularity
+              ? granularity
+              : (iree_device_size_t)iree_math_round_up_to_pow2_u64(
+                    (uint64_t)allocation_size);
+      break;
+    case IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_LINEAR:
+      rounded_size = iree_device_size_ceil_div(allocation_size, granularity) *
+                     granularity;
+      break;
+  }
+  const iree_device_size_t max_allocation_size =
+      pool->params.heap.max_allocation_size;
+  if (rounded_size < allocation_size ||
+      (max_allocation_size && rounded_size > max_allocation_size)) {
+    return allocation_size;  // overflow or too large for the heap
+  }
+  return rounded_size;
+}
+
 // Acquires a buffer of |allocation_size| from the |pool|.
 // The buffer will have a memory type and usage compatible with the given types.
 // Fails if the pool is empty and the underlying device fails the allocation.
@@ -244,18 +541,15 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
 
+  // Round up to the size class such that buffers of similar sizes can be used.
+  allocation_size =
+      iree_hal_caching_allocator_pool_round_size(pool, allocation_size);
+
   // Scan the free list to find an appropriate block.
   // If found we pop it off the list and return it without needing to allocate.
-  iree_slim_mutex_lock(&pool->mutex);
   iree_hal_buffer_t* existing_buffer =
       iree_hal_caching_allocator_pool_find_and_take_buffer(pool, params,
                                                            allocation_size);
-  if (!existing_buffer) {
-    // We'll need to allocate so we add the size such that it'll be accounted
-    // for by other threads allocating at the same time.
-    pool->total_allocated_size += allocation_size;
-  }
-  iree_slim_mutex_unlock(&pool->mutex);
   if (existing_buffer) {
     // Found a buffer! Return it uninitialized.
     *out_buffer = existing_buffer;
@@ -263,26 +557,39 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
     return iree_ok_status();
   }
 
+  // We'll need to allocate so we add the size such that it'll be accounted
+  // for by other threads allocating at the same time.
+  iree_atomic_fetch_add(&pool->total_allocated_size, (int64_t)allocation_size,
+                        iree_memory_order_relaxed);
+
   // Trim first before allocating so that we don't go over peak.
   iree_hal_caching_allocator_pool_trim_to_size(
       pool, pool->params.max_allocation_capacity);
 
   // No existing buffer was found that could be used and we'll need to allocate
-  // one. Note that we do this without holding the lock as the underlying
+  // one. Note that we do this without holding any lock as the underlying
   // device allocator can be very slow. It's possible for buffers to be released
   // to the pool by another thread while we're allocating here but that's OK.
   iree_hal_buffer_t* buffer = NULL;
   iree_status_t status = iree_hal_allocator_allocate_buffer(
       pool->device_allocator, *params, allocation_size, &buffer);
 
-  // If the allocation failed then remove the size from the total.
+  // If the allocation failed then remove the size from the total. If it
+  // succeeded but the device allocator padded the size we account for the
+  // actual size so that it balances when the buffer is released.
   if (iree_status_is_ok(status)) {
+    const iree_device_size_t actual_size =
+        iree_hal_buffer_allocation_size(buffer);
+    if (actual_size != allocation_size) {
+      iree_atomic_fetch_add(&pool->total_allocated_size,
+                            (int64_t)actual_size - (int64_t)allocation_size,
+                            iree_memory_order_relaxed);
+    }
     *out_buffer = buffer;
   } else {
     if (buffer) iree_hal_buffer_release(buffer);
-    iree_slim_mutex_lock(&pool->mutex);
-    pool->total_allocated_size -= allocation_size;
-    iree_slim_mutex_unlock(&pool->mutex);
+    iree_atomic_fetch_sub(&pool->total_allocated_size,
+                          (int64_t)allocation_size, iree_memory_order_relaxed);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -300,30 +607,35 @@ static void iree_hal_caching_allocator_pool_release(
 
   // Try to add the buffer to the pool. If the pool is at capacity we'll just
   // release it back to the allocator.
-  iree_slim_mutex_lock(&pool->mutex);
-
   const iree_device_size_t allocation_size =
       iree_hal_buffer_allocation_size(buffer);
-  const bool under_capacity = pool->total_allocated_size - allocation_size <=
-                              pool->params.max_allocation_capacity;
-  const bool under_count =
-      pool->free_count + 1 <= pool->params.max_free_allocation_count;
-  if (under_capacity && under_count) {
-    iree_hal_caching_allocator_pool_push_buffer(pool, buffer);
-    buffer = NULL;
+  const bool under_capacity =
+      (iree_device_size_t)iree_atomic_load(&pool->total_allocated_size,
+                                           iree_memory_order_relaxed) -
+          allocation_size <=
+      pool->params.max_allocation_capacity;
+  if (under_capacity) {
+    iree_hal_caching_allocator_shard_t* shard =
+        pool->shards[iree_hal_caching_allocator_pool_shard_ordinal(pool)];
+    iree_slim_mutex_lock(&shard->mutex);
+    if (iree_hal_caching_allocator_shard_push_buffer(shard, buffer)) {
+      buffer = NULL;
+    }
+    iree_slim_mutex_unlock(&shard->mutex);
   }
 
-  // If the buffer didn't fit in the pool we drop it here while we don't hold
-  // the lock as deallocations can be very expensive.
-  if (buffer) {
-    iree_slim_mutex_unlock(&pool->mutex);
+  if (!buffer) {
+    // Track that we're now retaining unused memory.
+    iree_hal_caching_allocator_pool_adjust_free_size(pool,
+                                                     (int64_t)allocation_size);
+  } else {
+    // If the buffer didn't fit in the pool we drop it here while we don't hold
+    // the lock as deallocations can be very expensive.
     iree_hal_allocator_deallocate_buffer(pool->device_allocator, buffer);
-    iree_slim_mutex_lock(&pool->mutex);
-    pool->total_allocated_size -= allocation_size;
+    iree_atomic_fetch_sub(&pool->total_allocated_size,
+                          (int64_t)allocation_size, iree_memory_order_relaxed);
   }
 
-  iree_slim_mutex_unlock(&pool->mutex);
-
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -396,19 +708,37 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
   IREE_ASSERT_ARGUMENT(out_allocator);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Verify pool parameters as we'll use them to compute storage sizes.
+  for (iree_host_size_t i = 0; i < pool_count; ++i) {
+    if (pool_params[i].shard_count == 0 ||
+        pool_params[i].shard_count >
+            IREE_HAL_CACHING_ALLOCATOR_MAX_SHARD_COUNT) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "pool %" PRIhsz " shard count %" PRIhsz " out of range (1 to %d)", i,
+          pool_params[i].shard_count,
+          IREE_HAL_CACHING_ALLOCATOR_MAX_SHARD_COUNT);
+    }
+    if (iree_hal_caching_allocator_pool_shard_capacity(&pool_params[i]) >=
+        IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "pool %" PRIhsz " max free allocation count %" PRIhsz " too large", i,
+          pool_params[i].max_free_allocation_count);
+    }
+  }
+
   // Allocate the allocator itself and then a trailing list of variable-length
-  // pools based on their free list sizes.
+  // pools based on their free list sizes and shard counts.
   iree_hal_caching_allocator_t* allocator = NULL;
   iree_host_size_t pool_list_size = pool_count * sizeof(allocator->pools[0]);
   iree_host_size_t total_size = iree_host_align(
       iree_sizeof_struct(*allocator) + pool_list_size, iree_max_align_t);
   iree_host_size_t pool_offset = total_size;
   for (iree_host_size_t i = 0; i < pool_count; ++i) {
-    iree_hal_caching_allocator_pool_t* pool = NULL;
-    total_size += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
-                            pool_params[i].max_free_allocation_count,
-        iree_max_align_t);
+    total_size += iree_hal_caching_allocator_pool_size(&pool_params[i]);
   }
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0,
@@ -427,10 +757,7 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
   for (iree_host_size_t i = 0; i < pool_count; ++i) {
     iree_hal_caching_allocator_pool_t* pool =
         (iree_hal_caching_allocator_pool_t*)pool_ptr;
-    pool_ptr += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
-                            pool_params[i].max_free_allocation_count,
-        iree_max_align_t);
+    pool_ptr += iree_hal_caching_allocator_pool_size(&pool_params[i]);
     allocator->pools[i] = pool;
     iree_hal_caching_allocator_pool_initialize(pool_params[i], device_allocator,
                                                pool);
@@ -553,6 +880,10 @@ iree_status_t iree_hal_caching_allocator_create_from_spec(
                            &pool_config);
     iree_string_view_split(pool_config, ';', &max_free_allocation_count_str,
                            &pool_config);
+    iree_string_view_t size_class_str = iree_string_view_empty();
+    iree_string_view_t shard_count_str = iree_string_view_empty();
+    iree_string_view_split(pool_config, ';', &size_class_str, &pool_config);
+    iree_string_view_split(pool_config, ';', &shard_count_str, &pool_config);
     max_allocation_size_str = iree_string_view_trim(max_allocation_size_str);
     if (!iree_string_view_is_empty(max_allocation_size_str) &&
         !iree_string_view_equal(max_allocation_size_str, IREE_SV("*"))) {
@@ -584,6 +915,34 @@ iree_status_t iree_hal_caching_allocator_create_from_spec(
       }
       pool_params->max_free_allocation_count = max_free_allocation_count;
     }
+    size_class_str = iree_string_view_trim(size_class_str);
+    if (iree_string_view_equal(size_class_str, IREE_SV("pow2"))) {
+      pool_params->size_class = IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_POW2;
+    } else if (!iree_string_view_is_empty(size_class_str) &&
+               !iree_string_view_equal(size_class_str, IREE_SV("*")) &&
+               !iree_string_view_equal(size_class_str, IREE_SV("exact"))) {
+      pool_params->size_class = IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_LINEAR;
+      IREE_RETURN_IF_ERROR(
+          iree_string_view_parse_device_size(
+              size_class_str, &pool_params->size_class_granularity),
+          "parsing size class granularity");
+      if (pool_params->size_class_granularity == 0) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "size class granularity must be non-zero");
+      }
+    }
+    shard_count_str = iree_string_view_trim(shard_count_str);
+    if (!iree_string_view_is_empty(shard_count_str) &&
+        !iree_string_view_equal(shard_count_str, IREE_SV("*"))) {
+      uint32_t shard_count = 0;
+      if (!iree_string_view_atoi_uint32(shard_count_str, &shard_count)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "invalid shard count '%.*s'",
+                                (int)shard_count_str.size,
+                                shard_count_str.data);
+      }
+      pool_params->shard_count = shard_count;
+    }
   } while (!iree_string_view_is_empty(config_pairs));
   return iree_hal_caching_allocator_create_with_pools(
       pool_count, pool_params_storage, device_allocator, host_allocator,
@@ -726,8 +1085,9 @@ static iree_status_t iree_hal_caching_allocator_allocate_buffer(
   }
 
   // Acquire the buffer from the pool.
+  iree_hal_buffer_t* buffer = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_caching_allocator_pool_acquire(
-      pool, &compat_params, allocation_size, out_buffer));
+      pool, &compat_params, allocation_size, &buffer));
 
   // Point the buffer back to us for deallocation.
   //
@@ -735,9 +1095,17 @@ static iree_status_t iree_hal_caching_allocator_allocate_buffer(
   // longer requires the pooling_allocator on iree_hal_buffer_t. We should
   // instead be creating a new iree_hal_cached_buffer_t that we return as if it
   // were an allocated buffer and that can store a reference back to the pool.
-  (*out_buffer)->pooling_allocator = base_allocator;
-
-  return iree_ok_status();
+  buffer->pooling_allocator = base_allocator;
+
+  // Buffers rounded up to their size class (or reused from a larger one) are
+  // returned as a subspan of the requested length so that users see the same
+  // byte length as they would from the underlying allocator. The subspan keeps
+  // the pooled buffer alive and releases it back to the pool when destroyed.
+  iree_status_t status =
+      iree_hal_buffer_subspan(buffer, 0, allocation_size,
+                              allocator->host_allocator, out_buffer);
+  iree_hal_buffer_release(buffer);
+  return status;
 }
 
 static void iree_hal_caching_allocator_deallocate_buffer(
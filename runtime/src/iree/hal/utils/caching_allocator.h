@@ -26,6 +26,24 @@ extern "C" {
 // manipulated from multiple threads.
 typedef struct iree_hal_caching_allocator_t iree_hal_caching_allocator_t;
 
+// Controls how allocation sizes are grouped into classes when caching.
+// Requests are rounded up to the size of their class such that free buffers of
+// slightly different sizes can be reused. This trades memory consumption for a
+// higher hit rate in programs with dynamically shaped allocations.
+typedef enum iree_hal_caching_allocator_size_class_e {
+  // Free buffers are only reused for requests of exactly the same size.
+  IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_EXACT = 0,
+  // Requests are rounded up to the next power-of-two with a minimum class size
+  // of size_class_granularity. Worst case waste is <50% of each allocation.
+  IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_POW2,
+  // Requests are rounded up to the next multiple of size_class_granularity and
+  // reuse the best-fitting free buffer less than 2x the rounded size.
+  IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_LINEAR,
+} iree_hal_caching_allocator_size_class_t;
+
+// Maximum number of shards a single pool can be split into.
+#define IREE_HAL_CACHING_ALLOCATOR_MAX_SHARD_COUNT 64
+
 // Parameters used to configure an iree_hal_caching_allocator_t pool.
 // These cannot be changed once the allocator has been created.
 typedef struct iree_hal_caching_allocator_pool_params_t {
@@ -49,6 +67,24 @@ typedef struct iree_hal_caching_allocator_pool_params_t {
   // This is used to allocate storage for the free list and should be reasonably
   // bounded (~64-1024).
   iree_host_size_t max_free_allocation_count;
+
+  // Size class mode used to round allocation requests.
+  // Note that the allocations backing buffers returned from pools with size
+  // classes may be larger than requested. The buffers themselves are subspans
+  // of the requested length.
+  iree_hal_caching_allocator_size_class_t size_class;
+
+  // Granularity in bytes of the size classes as defined by the |size_class|
+  // mode. Ignored for IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_EXACT.
+  iree_device_size_t size_class_granularity;
+
+  // Number of independently locked free lists the pool is split into.
+  // Each thread prefers the shard it is assigned on first use and only probes
+  // other shards when its own cannot satisfy a request. The
+  // max_free_allocation_count is divided evenly across all shards. Pools shared
+  // by many concurrently allocating threads should use one shard per few
+  // threads; a single shard is best when only one thread allocates.
+  iree_host_size_t shard_count;
 } iree_hal_caching_allocator_pool_params_t;
 
 // Initializes |out_params| to the default values using |heap| for storage.
@@ -100,11 +136,18 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
 // than 100MB can be retained. Wildcards can be used to indicate max values or
 // defaults.
 //
+// Optionally the size class mode and shard count can be specified after the
+// limits. The size class mode is `exact` (the default), `pow2` for
+// power-of-two classes, or a byte size for linear classes of that granularity.
+//
 // Expected form:
 //   heap_key=max_allocation_size;max_allocation_capacity;max_free_allocation_count
+//     [;size_classes[;shard_count]]
 // Example:
 //   device_local=1gib;1gib;8
 //   host_local=*;*;32
+//   device_local=*;4gib;1024;pow2;16
+//   device_local=*;4gib;1024;64kib;8
 iree_status_t iree_hal_caching_allocator_create_from_spec(
     iree_string_view_t config_pairs, iree_hal_allocator_t* device_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
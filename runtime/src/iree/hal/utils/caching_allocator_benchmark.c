@@ -0,0 +1,216 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/prng.h"
+#include "iree/base/internal/threading.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/caching_allocator.h"
+#include "iree/testing/benchmark.h"
+
+// Number of buffers each thread holds live at a time. Keeping a few buffers
+// live per thread more closely matches what programs do with transients.
+#define IREE_HAL_CACHING_ALLOCATOR_BENCHMARK_LIVE_COUNT 4
+
+// Shared state between the benchmark thread and contending threads.
+typedef struct iree_hal_caching_allocator_benchmark_shared_t {
+  iree_hal_allocator_t* allocator;
+  iree_atomic_int32_t should_exit;
+} iree_hal_caching_allocator_benchmark_shared_t;
+
+// Allocates and frees a set of randomly sized buffers using |prng| to pick the
+// sizes. Sizes are spread over a few size classes to exercise the lookup.
+static void iree_hal_caching_allocator_benchmark_step(
+    iree_hal_allocator_t* allocator, iree_prng_xoroshiro128_state_t* prng) {
+  iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+  };
+  iree_hal_buffer_t*
+      buffers[IREE_HAL_CACHING_ALLOCATOR_BENCHMARK_LIVE_COUNT] = {NULL};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(buffers); ++i) {
+    iree_device_size_t allocation_size =
+        1024 + (iree_prng_xoroshiro128plus_next_uint32(prng) % (64 * 1024));
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator, params, allocation_size, &buffers[i]));
+  }
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(buffers); ++i) {
+    iree_hal_buffer_release(buffers[i]);
+  }
+}
+
+static int iree_hal_caching_allocator_benchmark_contending_thread(
+    void* entry_arg) {
+  iree_hal_caching_allocator_benchmark_shared_t* shared =
+      (iree_hal_caching_allocator_benchmark_shared_t*)entry_arg;
+  iree_prng_xoroshiro128_state_t prng = {0};
+  iree_prng_xoroshiro128_initialize((uint64_t)(uintptr_t)&prng, &prng);
+  while (!iree_atomic_load(&shared->should_exit, iree_memory_order_acquire)) {
+    iree_hal_caching_allocator_benchmark_step(shared->allocator, &prng);
+  }
+  return 0;
+}
+
+// Measures the latency of allocating and freeing buffers from the benchmark
+// thread while |contending_thread_count| other threads concurrently hammer the
+// same allocator created from |spec|.
+static void iree_hal_caching_allocator_benchmark_contention(
+    iree_benchmark_state_t* benchmark_state, const char* spec,
+    uint32_t contending_thread_count) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  // Heap allocator that is wrapped by the caching allocator under test.
+  iree_hal_allocator_t* heap_allocator = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_create_heap(
+      IREE_SV("heap"), host_allocator, host_allocator, &heap_allocator));
+  iree_hal_caching_allocator_benchmark_shared_t shared;
+  memset(&shared, 0, sizeof(shared));
+  IREE_CHECK_OK(iree_hal_caching_allocator_create_from_spec(
+      iree_make_cstring_view(spec), heap_allocator, host_allocator,
+      &shared.allocator));
+  iree_hal_allocator_release(heap_allocator);
+
+  // Spin up the contending threads. They run until the benchmark completes.
+  iree_thread_t* threads[32] = {NULL};
+  IREE_ASSERT_LE(contending_thread_count, IREE_ARRAYSIZE(threads));
+  for (uint32_t i = 0; i < contending_thread_count; ++i) {
+    iree_thread_create_params_t thread_params;
+    memset(&thread_params, 0, sizeof(thread_params));
+    thread_params.name = IREE_SV("contending");
+    IREE_CHECK_OK(iree_thread_create(
+        iree_hal_caching_allocator_benchmark_contending_thread, &shared,
+        thread_params, host_allocator, &threads[i]));
+  }
+
+  iree_prng_xoroshiro128_state_t prng = {0};
+  iree_prng_xoroshiro128_initialize(123ull, &prng);
+  while (iree_benchmark_keep_running(
+      benchmark_state,
+      /*batch_count=*/IREE_HAL_CACHING_ALLOCATOR_BENCHMARK_LIVE_COUNT)) {
+    iree_hal_caching_allocator_benchmark_step(shared.allocator, &prng);
+  }
+
+  // Cleanup.
+  iree_atomic_store(&shared.should_exit, 1, iree_memory_order_release);
+  for (uint32_t i = 0; i < contending_thread_count; ++i) {
+    iree_thread_join(threads[i]);
+    iree_thread_release(threads[i]);
+  }
+  iree_hal_allocator_release(shared.allocator);
+}
+
+// Original single-lock exact-size free list.
+//
+// user_data is the number of contending threads.
+static iree_status_t iree_hal_caching_allocator_benchmark_exact_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_hal_caching_allocator_benchmark_contention(
+      benchmark_state, "*=*;*;256",
+      (uint32_t)(uintptr_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+// Single lock with power-of-two size classes.
+//
+// user_data is the number of contending threads.
+static iree_status_t iree_hal_caching_allocator_benchmark_pow2_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_hal_caching_allocator_benchmark_contention(
+      benchmark_state, "*=*;*;256;pow2;1",
+      (uint32_t)(uintptr_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+// Power-of-two size classes split across 8 shards.
+//
+// user_data is the number of contending threads.
+static iree_status_t iree_hal_caching_allocator_benchmark_pow2_sharded_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_hal_caching_allocator_benchmark_contention(
+      benchmark_state, "*=*;*;256;pow2;8",
+      (uint32_t)(uintptr_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_hal_caching_allocator_benchmark_exact_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_caching_allocator_benchmark_exact_n,
+    };
+    benchmark_def.user_data = (void*)0u;
+    iree_benchmark_register(iree_make_cstring_view("exact_0"), &benchmark_def);
+    benchmark_def.user_data = (void*)3u;
+    iree_benchmark_register(iree_make_cstring_view("exact_3"), &benchmark_def);
+    benchmark_def.user_data = (void*)7u;
+    iree_benchmark_register(iree_make_cstring_view("exact_7"), &benchmark_def);
+    benchmark_def.user_data = (void*)15u;
+    iree_benchmark_register(iree_make_cstring_view("exact_15"), &benchmark_def);
+  }
+
+  // iree_hal_caching_allocator_benchmark_pow2_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_caching_allocator_benchmark_pow2_n,
+    };
+    benchmark_def.user_data = (void*)0u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_0"), &benchmark_def);
+    benchmark_def.user_data = (void*)3u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_3"), &benchmark_def);
+    benchmark_def.user_data = (void*)7u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_7"), &benchmark_def);
+    benchmark_def.user_data = (void*)15u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_15"), &benchmark_def);
+  }
+
+  // iree_hal_caching_allocator_benchmark_pow2_sharded_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_caching_allocator_benchmark_pow2_sharded_n,
+    };
+    benchmark_def.user_data = (void*)0u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_sharded_0"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)3u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_sharded_3"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)7u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_sharded_7"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)15u;
+    iree_benchmark_register(iree_make_cstring_view("pow2_sharded_15"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
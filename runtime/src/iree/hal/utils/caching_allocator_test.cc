@@ -0,0 +1,252 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <atomic>
+#include <thread>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Host allocator that tracks live allocations and can be told to fail.
+struct CountingAllocator {
+  std::atomic<int> live_count{0};
+  std::atomic<bool> fail{false};
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    CountingAllocator* counting = (CountingAllocator*)self;
+    iree_allocator_t system = iree_allocator_system();
+    switch (command) {
+      case IREE_ALLOCATOR_COMMAND_MALLOC:
+      case IREE_ALLOCATOR_COMMAND_CALLOC: {
+        if (counting->fail) {
+          return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                  "injected allocation failure");
+        }
+        IREE_RETURN_IF_ERROR(
+            system.ctl(system.self, command, params, inout_ptr));
+        ++counting->live_count;
+        return iree_ok_status();
+      }
+      case IREE_ALLOCATOR_COMMAND_FREE:
+        --counting->live_count;
+        return system.ctl(system.self, command, params, inout_ptr);
+      default:
+        return system.ctl(system.self, command, params, inout_ptr);
+    }
+  }
+};
+
+class CachingAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Buffer storage comes from |data_allocator_| so that live_count tracks
+    // the underlying allocations made by the heap.
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), data_allocator_.allocator(), iree_allocator_system(),
+        &device_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(device_allocator_);
+    EXPECT_EQ(data_allocator_.live_count, 0);
+  }
+
+  // Creates a caching allocator from |spec| over the heap allocator.
+  iree_status_t CreateFromSpec(const char* spec,
+                               iree_hal_allocator_t** out_allocator) {
+    return iree_hal_caching_allocator_create_from_spec(
+        iree_make_cstring_view(spec), device_allocator_,
+        host_allocator_.allocator(), out_allocator);
+  }
+
+  static iree_hal_buffer_params_t BufferParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE;
+    return params;
+  }
+
+  static iree_hal_buffer_t* Allocate(iree_hal_allocator_t* allocator,
+                                     iree_device_size_t size) {
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(allocator, BufferParams(),
+                                                     size, &buffer));
+    return buffer;
+  }
+
+  // Returns the size of the pooled allocation backing |buffer|.
+  static iree_device_size_t BackingSize(iree_hal_buffer_t* buffer) {
+    return iree_hal_buffer_allocation_size(
+        iree_hal_buffer_allocated_buffer(buffer));
+  }
+
+  CountingAllocator data_allocator_;
+  CountingAllocator host_allocator_;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+};
+
+TEST_F(CachingAllocatorTest, SpecSizeClassesAndShards) {
+  struct {
+    const char* spec;
+    iree_device_size_t request_size;
+    iree_device_size_t backing_size;
+  } cases[] = {
+      {"*=*;*;16", 3000, 3000},
+      {"*=*;*;16;exact", 3000, 3000},
+      {"*=*;*;16;*;4", 3000, 3000},
+      {"*=*;*;16;pow2", 3000, 4096},
+      {"*=*;*;16;pow2;8", 3000, 4096},
+      {"*=*;*;16;64kib", 3000, 64 * 1024},
+      {"*=*;*;16; 1kib ; 64 ", 3000, 3072},
+  };
+  for (const auto& test_case : cases) {
+    SCOPED_TRACE(test_case.spec);
+    iree_hal_allocator_t* allocator = NULL;
+    IREE_ASSERT_OK(CreateFromSpec(test_case.spec, &allocator));
+    iree_hal_buffer_t* buffer = Allocate(allocator, test_case.request_size);
+    EXPECT_EQ(iree_hal_buffer_byte_length(buffer), test_case.request_size);
+    EXPECT_EQ(BackingSize(buffer), test_case.backing_size);
+    iree_hal_buffer_release(buffer);
+    iree_hal_allocator_release(allocator);
+  }
+}
+
+TEST_F(CachingAllocatorTest, SpecMalformed) {
+  const char* specs[] = {
+      "=*;*;16",             // missing heap key
+      "*=*;*;16;bogus",      // unparsable size class
+      "*=*;*;16;0",          // zero granularity
+      "*=*;*;16;pow2;0",     // zero shards
+      "*=*;*;16;pow2;65",    // too many shards
+      "*=*;*;16;pow2;four",  // unparsable shard count
+      "*=*;*;many",          // unparsable free count
+  };
+  for (const char* spec : specs) {
+    SCOPED_TRACE(spec);
+    iree_hal_allocator_t* allocator = NULL;
+    iree_status_t status = CreateFromSpec(spec, &allocator);
+    EXPECT_THAT(Status(std::move(status)),
+                StatusIs(StatusCode::kInvalidArgument));
+    EXPECT_EQ(allocator, nullptr);
+  }
+}
+
+// Requests reuse the smallest free buffer that fits across all buckets within
+// the 2x size class limit.
+TEST_F(CachingAllocatorTest, BestFitAcrossBuckets) {
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_ASSERT_OK(CreateFromSpec("*=*;*;16;64", &allocator));
+
+  // Sizes span two power-of-two buckets: [2048, 4096) and [4096, 8192).
+  iree_hal_buffer_t* large = Allocate(allocator, 4096);
+  iree_hal_buffer_t* medium = Allocate(allocator, 3072);
+  iree_hal_buffer_t* small = Allocate(allocator, 2624);
+  iree_hal_buffer_t* too_large = Allocate(allocator, 5184);
+  iree_hal_buffer_release(large);
+  iree_hal_buffer_release(medium);
+  iree_hal_buffer_release(small);
+  iree_hal_buffer_release(too_large);
+  ASSERT_EQ(data_allocator_.live_count, 4);
+
+  iree_hal_buffer_t* buffers[4] = {NULL};
+  for (int i = 0; i < 4; ++i) buffers[i] = Allocate(allocator, 2560);
+  EXPECT_EQ(BackingSize(buffers[0]), 2624);
+  EXPECT_EQ(BackingSize(buffers[1]), 3072);
+  EXPECT_EQ(BackingSize(buffers[2]), 4096);
+  // 5184 is more than 2x the request and a new allocation is made instead.
+  EXPECT_EQ(BackingSize(buffers[3]), 2560);
+  EXPECT_EQ(data_allocator_.live_count, 5);
+  for (iree_hal_buffer_t* buffer : buffers) {
+    EXPECT_EQ(iree_hal_buffer_byte_length(buffer), 2560);
+    iree_hal_buffer_release(buffer);
+  }
+
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator));
+  EXPECT_EQ(data_allocator_.live_count, 0);
+  iree_hal_allocator_release(allocator);
+}
+
+// Buffers released on one thread are reused by others and trimmed from every
+// shard regardless of the trimming thread.
+TEST_F(CachingAllocatorTest, CrossShardReuseAndTrim) {
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_ASSERT_OK(CreateFromSpec("*=*;*;16;pow2;4", &allocator));
+
+  iree_hal_buffer_t* buffer = Allocate(allocator, 1000);
+  iree_hal_buffer_t* backing = iree_hal_buffer_allocated_buffer(buffer);
+  iree_hal_buffer_release(buffer);
+  ASSERT_EQ(data_allocator_.live_count, 1);
+
+  // Each thread is assigned a new shard on first use; the worker reuses the
+  // buffer the main thread released into its own shard.
+  std::thread worker([&]() {
+    iree_hal_buffer_t* reused = Allocate(allocator, 1000);
+    EXPECT_EQ(iree_hal_buffer_allocated_buffer(reused), backing);
+    iree_hal_buffer_t* other = Allocate(allocator, 1000);
+    iree_hal_buffer_release(reused);
+    iree_hal_buffer_release(other);
+  });
+  worker.join();
+  EXPECT_EQ(data_allocator_.live_count, 2);
+
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator));
+  EXPECT_EQ(data_allocator_.live_count, 0);
+  iree_hal_allocator_release(allocator);
+}
+
+// Pooled buffers are returned wrapped in a subspan of the requested length.
+// The wrapper keeps the pooled buffer alive and failing to allocate it returns
+// the pooled buffer to the pool.
+TEST_F(CachingAllocatorTest, SubspanWrapper) {
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_ASSERT_OK(CreateFromSpec("*=*;*;16;pow2", &allocator));
+
+  iree_hal_buffer_t* buffer = Allocate(allocator, 1000);
+  iree_hal_buffer_t* backing = iree_hal_buffer_allocated_buffer(buffer);
+  EXPECT_NE(buffer, backing);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), 1000);
+  EXPECT_EQ(iree_hal_buffer_byte_offset(buffer), 0);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(backing), 1024);
+  iree_hal_buffer_release(buffer);
+  EXPECT_EQ(data_allocator_.live_count, 1);
+
+  host_allocator_.fail = true;
+  iree_hal_buffer_t* failed = NULL;
+  EXPECT_THAT(Status(iree_hal_allocator_allocate_buffer(
+                  allocator, BufferParams(), 1000, &failed)),
+              StatusIs(StatusCode::kResourceExhausted));
+  EXPECT_EQ(failed, nullptr);
+  host_allocator_.fail = false;
+  EXPECT_EQ(data_allocator_.live_count, 1);
+
+  // The pooled buffer is still available for reuse.
+  buffer = Allocate(allocator, 1000);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(buffer), backing);
+  iree_hal_buffer_release(buffer);
+
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator));
+  EXPECT_EQ(data_allocator_.live_count, 0);
+  iree_hal_allocator_release(allocator);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
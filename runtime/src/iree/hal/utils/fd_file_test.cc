@@ -0,0 +1,209 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/fd_file.h"
+
+#include "iree/base/config.h"
+
+#if IREE_FILE_IO_ENABLE
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Reads at or above this length are split into segments and issued through
+// io_uring when available. Matches IREE_HAL_FD_FILE_IO_URING_MIN_LENGTH so
+// that both sides of the threshold are covered.
+constexpr iree_host_size_t kRingThreshold = 2 * 1024 * 1024;
+
+// Alignment required for reads to use the O_DIRECT descriptor.
+constexpr iree_host_size_t kDirectAlignment = 4096;
+
+// Spans several 1MB ring segments and ends on an unaligned length.
+constexpr iree_host_size_t kFileLength = 7 * 1024 * 1024 + 123;
+
+// Returns the expected byte at |offset| in the test file.
+static uint8_t ExpectedByte(uint64_t offset) {
+  return (uint8_t)((offset * 2654435761ull) >> 13);
+}
+
+static std::string GetUniquePath(const char* unique_name) {
+  const char* test_tmpdir = getenv("TEST_TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TEMP");
+  if (!test_tmpdir) test_tmpdir = "/tmp";
+  std::random_device device;
+  uint64_t random = ((uint64_t)device() << 32) | device();
+  char unique_path[256];
+  snprintf(unique_path, sizeof(unique_path), "%s/iree_test_%" PRIx64 "_%s",
+           test_tmpdir, random, unique_name);
+  return unique_path;
+}
+
+class FdFileTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    path_ = new std::string(GetUniquePath("fd_file_test.bin"));
+    std::vector<uint8_t> contents(kFileLength);
+    for (iree_host_size_t i = 0; i < contents.size(); ++i) {
+      contents[i] = ExpectedByte(i);
+    }
+    FILE* file = fopen(path_->c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fwrite(contents.data(), 1, contents.size(), file),
+              contents.size());
+    ASSERT_EQ(fclose(file), 0);
+  }
+
+  static void TearDownTestSuite() {
+    remove(path_->c_str());
+    delete path_;
+    path_ = nullptr;
+  }
+
+  void SetUp() override {
+    iree_io_file_handle_t* handle = NULL;
+    IREE_ASSERT_OK(iree_io_file_handle_open(
+        IREE_IO_FILE_MODE_READ, iree_make_cstring_view(path_->c_str()),
+        iree_allocator_system(), &handle));
+    IREE_ASSERT_OK(iree_hal_fd_file_from_handle(IREE_HAL_MEMORY_ACCESS_READ,
+                                                handle, iree_allocator_system(),
+                                                &file_));
+    iree_io_file_handle_release(handle);
+    ASSERT_EQ(iree_hal_file_length(file_), kFileLength);
+  }
+
+  void TearDown() override { iree_hal_file_release(file_); }
+
+  // Reads |length| bytes at |file_offset| into a buffer at |buffer_offset|
+  // from a page-aligned host allocation.
+  iree_status_t Read(uint64_t file_offset, iree_host_size_t buffer_offset,
+                     iree_host_size_t length, std::vector<uint8_t>* out_data) {
+    const iree_host_size_t allocation_size =
+        iree_host_align(buffer_offset + length, kDirectAlignment);
+    uint8_t* storage = NULL;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
+        iree_allocator_system(), allocation_size, kDirectAlignment,
+        /*offset=*/0, (void**)&storage));
+    memset(storage, 0xCD, allocation_size);
+    iree_hal_buffer_placement_t placement = {0};
+    iree_hal_buffer_t* buffer = NULL;
+    iree_status_t status = iree_hal_heap_buffer_wrap(
+        placement, IREE_HAL_MEMORY_TYPE_HOST_LOCAL,
+        IREE_HAL_MEMORY_ACCESS_ALL, IREE_HAL_BUFFER_USAGE_MAPPING,
+        allocation_size, iree_make_byte_span(storage, allocation_size),
+        iree_hal_buffer_release_callback_null(), iree_allocator_system(),
+        &buffer);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_hal_file_read(file_, file_offset, buffer, buffer_offset, length);
+    }
+    if (iree_status_is_ok(status)) {
+      out_data->assign(storage + buffer_offset,
+                       storage + buffer_offset + length);
+    }
+    iree_hal_buffer_release(buffer);
+    iree_allocator_free_aligned(iree_allocator_system(), storage);
+    return status;
+  }
+
+  // Reads the given range and verifies its contents.
+  void ReadAndVerify(uint64_t file_offset, iree_host_size_t buffer_offset,
+                     iree_host_size_t length) {
+    SCOPED_TRACE(::testing::Message()
+                 << "file_offset=" << file_offset
+                 << " buffer_offset=" << buffer_offset << " length=" << length);
+    std::vector<uint8_t> data;
+    IREE_ASSERT_OK(Read(file_offset, buffer_offset, length, &data));
+    ASSERT_EQ(data.size(), length);
+    for (iree_host_size_t i = 0; i < length; ++i) {
+      if (data[i] != ExpectedByte(file_offset + i)) {
+        FAIL() << "mismatch at byte " << i;
+      }
+    }
+  }
+
+  static std::string* path_;
+  iree_hal_file_t* file_ = NULL;
+};
+
+std::string* FdFileTest::path_ = nullptr;
+
+// Reads below the threshold always use pread.
+TEST_F(FdFileTest, SmallReads) {
+  ReadAndVerify(0, 0, 1);
+  ReadAndVerify(0, 0, kDirectAlignment);
+  ReadAndVerify(13, 5, 1000);
+  ReadAndVerify(kDirectAlignment, 0, kRingThreshold - kDirectAlignment);
+  ReadAndVerify(1, 0, kRingThreshold - 1);
+}
+
+// Reads at or above the threshold are segmented through the ring when it is
+// available. Aligned ranges may use O_DIRECT and unaligned ones fall back to
+// the buffered descriptor.
+TEST_F(FdFileTest, LargeAlignedReads) {
+  ReadAndVerify(0, 0, kRingThreshold);
+  ReadAndVerify(kDirectAlignment, 0, 5 * 1024 * 1024);
+  ReadAndVerify(0, 0, kFileLength - 123);
+}
+
+TEST_F(FdFileTest, LargeUnalignedReads) {
+  // Unaligned file offset.
+  ReadAndVerify(17, 0, kRingThreshold);
+  // Unaligned buffer pointer.
+  ReadAndVerify(kDirectAlignment, 3, 3 * 1024 * 1024);
+  // Unaligned length spanning a partial trailing segment.
+  ReadAndVerify(0, 0, kRingThreshold + 5);
+  // Everything unaligned through the end of the file.
+  ReadAndVerify(123, 7, kFileLength - 123);
+  ReadAndVerify(0, 0, kFileLength);
+}
+
+// Concurrent large reads on the same file find the ring busy and fall back to
+// pread.
+TEST_F(FdFileTest, ConcurrentLargeReads) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([this, i]() {
+      for (int j = 0; j < 3; ++j) {
+        ReadAndVerify(i * 4099, i, kFileLength - i * 4099);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+// Reads extending past the end of the file fail after draining any reads
+// still in flight. The file remains usable afterward.
+TEST_F(FdFileTest, ReadPastEnd) {
+  std::vector<uint8_t> data;
+  EXPECT_THAT(Status(Read(kFileLength - kRingThreshold, 0,
+                          kRingThreshold + kDirectAlignment, &data)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(Read(kFileLength - 10, 0, 20, &data)),
+              StatusIs(StatusCode::kOutOfRange));
+  ReadAndVerify(kFileLength - kRingThreshold, 0, kRingThreshold);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_FILE_IO_ENABLE
@@ -17,9 +17,11 @@
 
 #if !defined(IREE_HAL_TRANSFER_WORKER_LIMIT)
 // Maximum number of workers that will be used. This is something we can derive
-// from the transfer size and the loop; small transfers or synchronous loops
-// should have 1 and we can measure to see how many others we need.
-#define IREE_HAL_TRANSFER_WORKER_LIMIT 1
+// from the transfer size and the loop; small transfers should have 1 and we can
+// measure to see how many others we need. Two workers let large transfers
+// overlap the file I/O of one chunk with the device copy of the previous one
+// even when run on a synchronous loop.
+#define IREE_HAL_TRANSFER_WORKER_LIMIT 2
 #endif  // !IREE_HAL_TRANSFER_WORKER_LIMIT
 
 #if !defined(IREE_HAL_TRANSFER_CHUNK_SIZE)
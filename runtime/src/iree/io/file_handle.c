@@ -660,18 +660,16 @@ static iree_status_t iree_io_platform_map_file_view(
   }
 
   // Pass hints to the memory manager - informational only.
-  int advice = 0;
+  // NOTE: madvise advice values are not bit flags and must be issued
+  // individually.
   if (iree_all_bits_set(flags, IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS)) {
-    advice |= MADV_SEQUENTIAL;
+    madvise(ptr, adjusted_length, MADV_SEQUENTIAL);
   }
 #if defined(MADV_DONTDUMP)
   if (iree_all_bits_set(flags, IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS)) {
-    advice |= MADV_DONTDUMP;
+    madvise(ptr, adjusted_length, MADV_DONTDUMP);
   }
 #endif  // MADV_DONTDUMP
-  if (advice) {
-    madvise(ptr, adjusted_length, advice);
-  }
 
   *out_impl = ptr;
   *out_contents = iree_make_byte_span(ptr, adjusted_length);
@@ -973,3 +971,26 @@ iree_io_file_mapping_contents_rw(iree_io_file_mapping_t* mapping) {
   IREE_ASSERT_ARGUMENT(mapping);
   return mapping->contents;
 }
+
+static iree_status_t iree_io_file_mapping_deallocator_ctl(
+    void* self, iree_allocator_command_t command, const void* params,
+    void** inout_ptr) {
+  if (command != IREE_ALLOCATOR_COMMAND_FREE) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "file mapping deallocator must only be used to "
+                            "deallocate file mapping contents");
+  }
+  iree_io_file_mapping_t* mapping = (iree_io_file_mapping_t*)self;
+  iree_io_file_mapping_release(mapping);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_allocator_t
+iree_io_file_mapping_deallocator(iree_io_file_mapping_t* mapping) {
+  IREE_ASSERT_ARGUMENT(mapping);
+  iree_allocator_t allocator = {
+      .self = mapping,
+      .ctl = iree_io_file_mapping_deallocator_ctl,
+  };
+  return allocator;
+}
@@ -313,6 +313,14 @@ iree_io_file_mapping_contents_ro(const iree_io_file_mapping_t* mapping);
 IREE_API_EXPORT iree_byte_span_t
 iree_io_file_mapping_contents_rw(iree_io_file_mapping_t* mapping);
 
+// Returns an allocator that releases |mapping| when its contents are freed.
+// This can be passed to functions that take ownership of memory and require a
+// deallocation mechanism, such as iree_vm_bytecode_module_create, to reference
+// the mapped contents without copying them. The caller's reference to
+// |mapping| is transferred to the allocator and released on free.
+IREE_API_EXPORT iree_allocator_t
+iree_io_file_mapping_deallocator(iree_io_file_mapping_t* mapping);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -9,11 +9,22 @@
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/synchronization.h"
 
+// Minimum capacity of the key lookup table when first allocated.
+#define IREE_IO_PARAMETER_INDEX_MIN_SLOT_CAPACITY 32
+
+// A slot in the open-addressed key lookup table.
+typedef struct iree_io_parameter_index_slot_t {
+  // Hash of the entry key; used to skip most key comparisons when probing.
+  uint64_t key_hash;
+  // Entry in the index or NULL if the slot is empty.
+  const iree_io_parameter_index_entry_t* entry;
+} iree_io_parameter_index_slot_t;
+
 struct iree_io_parameter_index_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t host_allocator;
 
-  // Guards mutation of the entries list.
+  // Guards mutation of the entries list and lookup table.
   // NOTE: this does not guard the entries themselves as we assume they are
   // immutable (today).
   iree_slim_mutex_t mutex;
@@ -24,8 +35,26 @@ struct iree_io_parameter_index_t {
   iree_host_size_t entry_count;
   // Dense list of entries in the index. Grows as needed.
   iree_io_parameter_index_entry_t** entries;
+
+  // Total capacity of the lookup table in slots. Always a power-of-two and
+  // kept at least twice the entry count to keep probe sequences short.
+  iree_host_size_t slot_capacity;
+  // Linear-probed hash table of entries keyed by their key. Built
+  // incrementally as entries are added. When multiple entries share the same
+  // key only the first one added is present in the table.
+  iree_io_parameter_index_slot_t* slots;
 };
 
+// Returns a 64-bit FNV-1a hash of |key|.
+static uint64_t iree_io_parameter_index_hash_key(iree_string_view_t key) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < key.size; ++i) {
+    hash ^= (uint8_t)key.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
     iree_allocator_t host_allocator, iree_io_parameter_index_t** out_index) {
   IREE_ASSERT_ARGUMENT(out_index);
@@ -46,6 +75,8 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
   index->entry_capacity = 0;
   index->entry_count = 0;
   index->entries = NULL;
+  index->slot_capacity = 0;
+  index->slots = NULL;
 
   *out_index = index;
   IREE_TRACE_ZONE_END(z0);
@@ -71,6 +102,9 @@ static void iree_io_parameter_index_destroy(iree_io_parameter_index_t* index) {
   if (index->entries) {
     iree_allocator_free(host_allocator, index->entries);
   }
+  if (index->slots) {
+    iree_allocator_free(host_allocator, index->slots);
+  }
 
   iree_slim_mutex_deinitialize(&index->mutex);
 
@@ -102,6 +136,61 @@ iree_io_parameter_index_count(iree_io_parameter_index_t* index) {
   return count;
 }
 
+// Inserts |entry| with |key_hash| into the |slots| table of |slot_capacity|.
+// If an entry with the same key is already present the table is unchanged so
+// that lookups continue to return the first entry added.
+static void iree_io_parameter_index_insert_slot(
+    iree_host_size_t slot_capacity, iree_io_parameter_index_slot_t* slots,
+    uint64_t key_hash, const iree_io_parameter_index_entry_t* entry) {
+  const iree_host_size_t slot_mask = slot_capacity - 1;
+  for (iree_host_size_t i = (iree_host_size_t)key_hash & slot_mask;;
+       i = (i + 1) & slot_mask) {
+    iree_io_parameter_index_slot_t* slot = &slots[i];
+    if (!slot->entry) {
+      slot->key_hash = key_hash;
+      slot->entry = entry;
+      return;
+    } else if (slot->key_hash == key_hash &&
+               iree_string_view_equal(slot->entry->key, entry->key)) {
+      return;  // duplicate key; first entry wins
+    }
+  }
+}
+
+// Grows the lookup table such that it can hold at least |entry_capacity|
+// entries while staying under the maximum load factor.
+static iree_status_t iree_io_parameter_index_reserve_slots_unsafe(
+    iree_io_parameter_index_t* index, iree_host_size_t entry_capacity) {
+  iree_host_size_t new_slot_capacity = iree_max(
+      IREE_IO_PARAMETER_INDEX_MIN_SLOT_CAPACITY, index->slot_capacity);
+  while (new_slot_capacity < entry_capacity * 2) new_slot_capacity *= 2;
+  if (new_slot_capacity == index->slot_capacity) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, new_slot_capacity);
+
+  iree_io_parameter_index_slot_t* new_slots = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(index->host_allocator,
+                                new_slot_capacity * sizeof(new_slots[0]),
+                                (void**)&new_slots));
+
+  // Rehash all existing entries into the new table. We reuse the cached hashes
+  // so that we don't need to touch the entries.
+  for (iree_host_size_t i = 0; i < index->slot_capacity; ++i) {
+    const iree_io_parameter_index_slot_t* slot = &index->slots[i];
+    if (!slot->entry) continue;
+    iree_io_parameter_index_insert_slot(new_slot_capacity, new_slots,
+                                        slot->key_hash, slot->entry);
+  }
+
+  iree_allocator_free(index->host_allocator, index->slots);
+  index->slot_capacity = new_slot_capacity;
+  index->slots = new_slots;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_io_parameter_index_reserve_unsafe(
     iree_io_parameter_index_t* index, iree_host_size_t new_capacity) {
   IREE_ASSERT_ARGUMENT(index);
@@ -117,6 +206,9 @@ static iree_status_t iree_io_parameter_index_reserve_unsafe(
     index->entry_capacity = new_capacity;
     index->entries = new_entries;
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_index_reserve_slots_unsafe(index, new_capacity);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -147,6 +239,10 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
     status = iree_io_parameter_index_reserve_unsafe(
         index, iree_max(16, index->entry_capacity * 2));
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_index_reserve_slots_unsafe(
+        index, index->entry_count + 1);
+  }
 
   // Clone the entry memory. We allocate it as a single slab and stash the
   // pointers for easier access by callers. Entries themselves are never
@@ -184,8 +280,12 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
     memcpy((void*)cloned_entry->metadata.data, entry->metadata.data,
            entry->metadata.data_length);
 
-    // Append the entry to the file index.
+    // Append the entry to the file index and make it available for lookup.
+    // Storage for both was reserved above so this cannot fail.
     index->entries[index->entry_count++] = cloned_entry;
+    iree_io_parameter_index_insert_slot(
+        index->slot_capacity, index->slots,
+        iree_io_parameter_index_hash_key(cloned_entry->key), cloned_entry);
   }
 
   iree_slim_mutex_unlock(&index->mutex);
@@ -226,11 +326,18 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
   iree_slim_mutex_lock(&index->mutex);
 
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < index->entry_count; ++i) {
-    const iree_io_parameter_index_entry_t* entry = index->entries[i];
-    if (iree_string_view_equal(key, entry->key)) {
-      *out_entry = entry;
-      break;
+  if (index->slot_capacity > 0) {
+    const uint64_t key_hash = iree_io_parameter_index_hash_key(key);
+    const iree_host_size_t slot_mask = index->slot_capacity - 1;
+    for (iree_host_size_t i = (iree_host_size_t)key_hash & slot_mask;;
+         i = (i + 1) & slot_mask) {
+      const iree_io_parameter_index_slot_t* slot = &index->slots[i];
+      if (!slot->entry) break;  // end of probe sequence
+      if (slot->key_hash == key_hash &&
+          iree_string_view_equal(key, slot->entry->key)) {
+        *out_entry = slot->entry;
+        break;
+      }
     }
   }
   if (*out_entry == NULL) {
@@ -0,0 +1,136 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_index.h"
+#include "iree/testing/benchmark.h"
+
+// Formats a synthetic key for entry |i| into |buffer| that looks like the
+// tensor names found in common checkpoints (long shared prefixes).
+static iree_string_view_t iree_io_parameter_index_benchmark_key(
+    uint32_t i, char buffer[64]) {
+  int length = snprintf(buffer, 64, "model.layers.%u.self_attn.%s.weight",
+                        i / 8, (i % 2) ? "q_proj" : "k_proj");
+  // Make keys unique within each layer while keeping the shared prefix.
+  length += snprintf(buffer + length, 64 - length, ".%u", i % 8);
+  return iree_make_string_view(buffer, length);
+}
+
+// Builds an index with |entry_count| synthetic file entries.
+static void iree_io_parameter_index_benchmark_build(
+    uint32_t entry_count, iree_allocator_t host_allocator,
+    iree_io_parameter_index_t** out_index) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_CHECK_OK(iree_io_parameter_index_create(host_allocator, &index));
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    char key_buffer[64];
+    iree_io_parameter_index_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.key = iree_io_parameter_index_benchmark_key(i, key_buffer);
+    entry.length = 4096;
+    entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT;
+    entry.storage.splat.pattern_length = 1;
+    IREE_CHECK_OK(iree_io_parameter_index_add(index, &entry));
+  }
+  *out_index = index;
+}
+
+// Simulates process startup: builds an index of N entries as a parser would
+// and then looks up every entry once as a gather of all parameters would.
+//
+// user_data is the entry count.
+static iree_status_t iree_io_parameter_index_benchmark_startup_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const uint32_t entry_count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_io_parameter_index_t* index = NULL;
+    iree_io_parameter_index_benchmark_build(
+        entry_count, benchmark_state->host_allocator, &index);
+    for (uint32_t i = 0; i < entry_count; ++i) {
+      char key_buffer[64];
+      const iree_io_parameter_index_entry_t* entry = NULL;
+      IREE_CHECK_OK(iree_io_parameter_index_lookup(
+          index, iree_io_parameter_index_benchmark_key(i, key_buffer),
+          &entry));
+    }
+    iree_io_parameter_index_release(index);
+  }
+  return iree_ok_status();
+}
+
+// Measures the lookup of a single entry in an index of N entries.
+//
+// user_data is the entry count.
+static iree_status_t iree_io_parameter_index_benchmark_lookup_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const uint32_t entry_count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_io_parameter_index_t* index = NULL;
+  iree_io_parameter_index_benchmark_build(
+      entry_count, benchmark_state->host_allocator, &index);
+  uint32_t i = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    char key_buffer[64];
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_CHECK_OK(iree_io_parameter_index_lookup(
+        index, iree_io_parameter_index_benchmark_key(i, key_buffer), &entry));
+    i = (i + 7919) % entry_count;
+  }
+  iree_io_parameter_index_release(index);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_io_parameter_index_benchmark_startup_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MILLISECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_io_parameter_index_benchmark_startup_n,
+    };
+    benchmark_def.user_data = (void*)1000u;
+    iree_benchmark_register(iree_make_cstring_view("startup_1000"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)10000u;
+    iree_benchmark_register(iree_make_cstring_view("startup_10000"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)50000u;
+    iree_benchmark_register(iree_make_cstring_view("startup_50000"),
+                            &benchmark_def);
+  }
+
+  // iree_io_parameter_index_benchmark_lookup_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_io_parameter_index_benchmark_lookup_n,
+    };
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("lookup_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)50000u;
+    iree_benchmark_register(iree_make_cstring_view("lookup_50000"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -6,12 +6,22 @@
 
 #include "iree/io/parameter_index_provider.h"
 
+#include <stdlib.h>
+
 #include "iree/hal/utils/file_cache.h"
 
 // Limit concurrent operations to avoid blowing the stack. This is arbitrary and
 // if we wanted to support more we could switch to using heap allocations or
 // a growable stack scratchpad.
-#define IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY 8
+#define IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY 32
+
+// Maximum length in bytes of a file operation produced by coalescing adjacent
+// parameter spans. Spans larger than this are never split but we stop merging
+// once a run reaches this size so that the work can still be distributed
+// across timelines.
+#if !defined(IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH)
+#define IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH (64 * 1024 * 1024)
+#endif  // !IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH
 
 typedef struct iree_io_parameter_index_provider_t {
   iree_io_parameter_provider_t base;
@@ -672,6 +682,76 @@ static iree_status_t iree_io_parameter_op_batch_end(
   return status;
 }
 
+// A file read or write resolved from one or more parameter spans.
+typedef struct iree_io_parameter_file_op_t {
+  // File being read from or written to, retained.
+  iree_hal_file_t* file;
+  // Offset in bytes into the file.
+  uint64_t file_offset;
+  // Offset in bytes into the buffer being gathered into or scattered from.
+  iree_device_size_t buffer_offset;
+  // Length in bytes of the operation.
+  iree_device_size_t length;
+} iree_io_parameter_file_op_t;
+
+// Orders file ops by file and then by file offset.
+static int iree_io_parameter_file_op_compare(const void* lhs_ptr,
+                                             const void* rhs_ptr) {
+  const iree_io_parameter_file_op_t* lhs =
+      (const iree_io_parameter_file_op_t*)lhs_ptr;
+  const iree_io_parameter_file_op_t* rhs =
+      (const iree_io_parameter_file_op_t*)rhs_ptr;
+  if (lhs->file != rhs->file) {
+    return (uintptr_t)lhs->file < (uintptr_t)rhs->file ? -1 : 1;
+  }
+  if (lhs->file_offset != rhs->file_offset) {
+    return lhs->file_offset < rhs->file_offset ? -1 : 1;
+  }
+  return 0;
+}
+
+// Sorts |ops| by file and file offset and merges runs that are contiguous in
+// both the file and the buffer into single operations. Files of merged ops are
+// released. Returns the number of ops remaining at the head of |ops|.
+//
+// Reordering is only valid because span buffer ranges may not overlap (see
+// iree_io_parameter_provider_gather). Overlapping spans are not diagnosed and
+// the order in which they land is undefined: splats are enqueued before any
+// file read and the merged reads are distributed across independent
+// timelines.
+//
+// Parameter archives are usually written in the same order the compiler packs
+// them into gather/scatter buffers so large runs of spans collapse into a
+// handful of large operations that are much cheaper to issue than one per span.
+static iree_host_size_t iree_io_parameter_file_ops_coalesce(
+    iree_host_size_t count, iree_io_parameter_file_op_t* ops) {
+  if (count <= 1) return count;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
+
+  qsort(ops, count, sizeof(*ops), iree_io_parameter_file_op_compare);
+
+  iree_host_size_t merged_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_io_parameter_file_op_t* op = &ops[i];
+    iree_io_parameter_file_op_t* tail =
+        merged_count > 0 ? &ops[merged_count - 1] : NULL;
+    if (tail && tail->file == op->file &&
+        tail->file_offset + tail->length == op->file_offset &&
+        tail->buffer_offset + tail->length == op->buffer_offset &&
+        tail->length + op->length <= IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH) {
+      tail->length += op->length;
+      iree_hal_file_release(op->file);
+    } else {
+      ops[merged_count++] = *op;
+    }
+  }
+
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, merged_count);
+  IREE_TRACE_ZONE_END(z0);
+  return merged_count;
+}
+
 static void iree_io_file_handle_buffer_release(void* user_data,
                                                iree_hal_buffer_t* buffer) {
   iree_io_file_handle_release((iree_io_file_handle_t*)user_data);
@@ -851,9 +931,18 @@ static iree_status_t iree_io_parameter_index_provider_gather(
                                    wait_semaphore_list, signal_semaphore_list,
                                    &batch);
 
-  // Process each entry by enqueuing the appropriate operation.
+  // File reads are resolved first and issued after coalescing adjacent spans.
+  iree_host_size_t file_op_count = 0;
+  iree_io_parameter_file_op_t* file_ops = NULL;
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < count; ++i) {
+  if (count > 0) {
+    status = iree_allocator_malloc(provider->host_allocator,
+                                   count * sizeof(*file_ops),
+                                   (void**)&file_ops);
+  }
+
+  // Process each entry by enqueuing splats and recording file reads.
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < count; ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(
         z_entry, "iree_io_parameter_index_provider_gather_entry");
     IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, i);
@@ -871,7 +960,7 @@ static iree_status_t iree_io_parameter_index_provider_gather(
       IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, span.length);
     }
 
-    // Enqueue the transfer/file operation.
+    // Enqueue the transfer operation or record the file operation.
     if (iree_status_is_ok(status)) {
       switch (source_entry->type) {
         case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT: {
@@ -884,10 +973,13 @@ static iree_status_t iree_io_parameter_index_provider_gather(
         }
         case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
           IREE_ASSERT(source_file);
-          status = iree_io_parameter_op_batch_enqueue_file_read(
-              &batch, source_file,
-              source_entry->storage.file.offset + span.parameter_offset,
-              target_buffer, span.buffer_offset, span.length, 0);
+          iree_io_parameter_file_op_t* file_op = &file_ops[file_op_count++];
+          file_op->file = source_file;  // ownership transferred
+          file_op->file_offset =
+              source_entry->storage.file.offset + span.parameter_offset;
+          file_op->buffer_offset = span.buffer_offset;
+          file_op->length = span.length;
+          source_file = NULL;
           break;
         }
         default: {
@@ -903,9 +995,25 @@ static iree_status_t iree_io_parameter_index_provider_gather(
     iree_hal_file_release(source_file);
 
     IREE_TRACE_ZONE_END(z_entry);
-    if (!iree_status_is_ok(status)) break;
   }
 
+  // Merge contiguous reads and enqueue them across the batch timelines.
+  if (iree_status_is_ok(status)) {
+    file_op_count =
+        iree_io_parameter_file_ops_coalesce(file_op_count, file_ops);
+  }
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < file_op_count;
+       ++i) {
+    const iree_io_parameter_file_op_t* file_op = &file_ops[i];
+    status = iree_io_parameter_op_batch_enqueue_file_read(
+        &batch, file_op->file, file_op->file_offset, target_buffer,
+        file_op->buffer_offset, file_op->length, 0);
+  }
+  for (iree_host_size_t i = 0; i < file_op_count; ++i) {
+    iree_hal_file_release(file_ops[i].file);
+  }
+  iree_allocator_free(provider->host_allocator, file_ops);
+
   // Flush any outstanding batch operations and end the batch.
   status = iree_io_parameter_op_batch_end(&batch, status);
 
@@ -931,9 +1039,18 @@ static iree_status_t iree_io_parameter_index_provider_scatter(
                                    wait_semaphore_list, signal_semaphore_list,
                                    &batch);
 
-  // Process each entry by enqueuing the appropriate operation.
+  // File writes are resolved first and issued after coalescing adjacent spans.
+  iree_host_size_t file_op_count = 0;
+  iree_io_parameter_file_op_t* file_ops = NULL;
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < count; ++i) {
+  if (count > 0) {
+    status = iree_allocator_malloc(provider->host_allocator,
+                                   count * sizeof(*file_ops),
+                                   (void**)&file_ops);
+  }
+
+  // Process each entry by recording the file operation.
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < count; ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(
         z_entry, "iree_io_parameter_index_provider_scatter_entry");
     IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, i);
@@ -951,15 +1068,18 @@ static iree_status_t iree_io_parameter_index_provider_scatter(
       IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, span.length);
     }
 
-    // Enqueue the transfer/file operation.
+    // Record the file operation.
     if (iree_status_is_ok(status)) {
       switch (target_entry->type) {
         case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
           IREE_ASSERT(target_file);
-          status = iree_io_parameter_op_batch_enqueue_file_write(
-              &batch, source_buffer, span.buffer_offset, target_file,
-              target_entry->storage.file.offset + span.parameter_offset,
-              span.length, 0);
+          iree_io_parameter_file_op_t* file_op = &file_ops[file_op_count++];
+          file_op->file = target_file;  // ownership transferred
+          file_op->file_offset =
+              target_entry->storage.file.offset + span.parameter_offset;
+          file_op->buffer_offset = span.buffer_offset;
+          file_op->length = span.length;
+          target_file = NULL;
           break;
         }
         default: {
@@ -975,9 +1095,25 @@ static iree_status_t iree_io_parameter_index_provider_scatter(
     iree_hal_file_release(target_file);
 
     IREE_TRACE_ZONE_END(z_entry);
-    if (!iree_status_is_ok(status)) break;
   }
 
+  // Merge contiguous writes and enqueue them across the batch timelines.
+  if (iree_status_is_ok(status)) {
+    file_op_count =
+        iree_io_parameter_file_ops_coalesce(file_op_count, file_ops);
+  }
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < file_op_count;
+       ++i) {
+    const iree_io_parameter_file_op_t* file_op = &file_ops[i];
+    status = iree_io_parameter_op_batch_enqueue_file_write(
+        &batch, source_buffer, file_op->buffer_offset, file_op->file,
+        file_op->file_offset, file_op->length, 0);
+  }
+  for (iree_host_size_t i = 0; i < file_op_count; ++i) {
+    iree_hal_file_release(file_ops[i].file);
+  }
+  iree_allocator_free(provider->host_allocator, file_ops);
+
   // Flush any outstanding batch operations and end the batch.
   status = iree_io_parameter_op_batch_end(&batch, status);
 
@@ -29,7 +29,11 @@ extern "C" {
 // part of a gather or scatter are allowed to be in-flight at a time. A lower
 // number can reduce system resource requirements during the operation (less
 // transient memory required, etc) while increasing latency (lower I/O
-// utilization).
+// utilization). Values are clamped to an implementation-defined maximum.
+//
+// Gathers and scatters coalesce spans that are contiguous in both the file and
+// the buffer into single file operations before distributing them across the
+// concurrent operations.
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
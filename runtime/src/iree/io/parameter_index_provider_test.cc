@@ -0,0 +1,265 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_index_provider.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/io/parameter_index.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+// This test is built with IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH reduced so
+// that runs split without needing huge files.
+#if !defined(IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH)
+#error "expected the test to override IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH"
+#endif  // !IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH
+
+namespace iree {
+namespace io {
+namespace {
+
+// Length of each file-backed parameter.
+constexpr iree_host_size_t kParameterLength = 64;
+// Number of file-backed parameters stored back-to-back in the file.
+constexpr iree_host_size_t kParameterCount = 16;
+// Length of the parameter file and gather target buffer.
+constexpr iree_host_size_t kFileLength = kParameterLength * kParameterCount;
+
+static_assert(IREE_IO_PARAMETER_OP_COALESCE_MAX_LENGTH < kFileLength / 2,
+              "max length must be small enough to split runs");
+
+// Returns the expected byte at |offset| in the parameter file.
+static uint8_t FileByte(iree_host_size_t offset) {
+  return (uint8_t)(offset * 7 + 3);
+}
+
+// Span gathered from the parameter named |key|.
+struct Span {
+  std::string key;
+  iree_io_parameter_span_t span;
+};
+
+class ParameterIndexProviderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), host_allocator, host_allocator, &device_allocator));
+    iree_hal_sync_device_params_t device_params;
+    iree_hal_sync_device_params_initialize(&device_params);
+    iree_status_t status = iree_hal_sync_device_create(
+        IREE_SV("local-sync"), &device_params, /*loader_count=*/0,
+        /*loaders=*/NULL, device_allocator, host_allocator, &device_);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+
+    // All file-backed parameters live back-to-back in a single file.
+    file_contents_.resize(kFileLength);
+    for (iree_host_size_t i = 0; i < kFileLength; ++i) {
+      file_contents_[i] = FileByte(i);
+    }
+    iree_io_file_handle_t* file_handle = NULL;
+    IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ,
+        iree_make_byte_span(file_contents_.data(), file_contents_.size()),
+        iree_io_file_handle_release_callback_null(), host_allocator,
+        &file_handle));
+
+    iree_io_parameter_index_t* index = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_create(host_allocator, &index));
+    keys_.resize(kParameterCount);
+    for (iree_host_size_t i = 0; i < kParameterCount; ++i) {
+      keys_[i] = "p" + std::to_string(i);
+      iree_io_parameter_index_entry_t entry = {};
+      entry.key = iree_make_string_view(keys_[i].data(), keys_[i].size());
+      entry.length = kParameterLength;
+      entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+      entry.storage.file.handle = file_handle;
+      entry.storage.file.offset = i * kParameterLength;
+      IREE_ASSERT_OK(iree_io_parameter_index_add(index, &entry));
+    }
+    iree_io_parameter_index_entry_t splat_entry = {};
+    splat_entry.key = IREE_SV("splat");
+    splat_entry.length = kParameterLength;
+    splat_entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT;
+    splat_entry.storage.splat.pattern_length = 1;
+    splat_entry.storage.splat.pattern[0] = 0xAB;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(index, &splat_entry));
+    iree_io_file_handle_release(file_handle);
+
+    status = iree_io_parameter_index_provider_create(
+        IREE_SV("scope"), index, /*max_concurrent_operations=*/4,
+        host_allocator, &provider_);
+    iree_io_parameter_index_release(index);
+    IREE_ASSERT_OK(status);
+  }
+
+  void TearDown() override {
+    iree_io_parameter_provider_release(provider_);
+    iree_hal_device_release(device_);
+  }
+
+  // Gathers |spans| into a new zeroed buffer and returns its contents.
+  std::vector<uint8_t> Gather(const std::vector<Span>& spans) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device_), params, kFileLength, &buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_zero(buffer, 0, IREE_HAL_WHOLE_BUFFER));
+
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_CHECK_OK(iree_hal_semaphore_create(
+        device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &semaphore));
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+    iree_io_parameter_enumerator_t enumerator = {
+        [](void* user_data, iree_host_size_t i, iree_string_view_t* out_key,
+           iree_io_parameter_span_t* out_span) {
+          const Span& span = (*(const std::vector<Span>*)user_data)[i];
+          *out_key = iree_make_string_view(span.key.data(), span.key.size());
+          *out_span = span.span;
+          return iree_ok_status();
+        },
+        (void*)&spans,
+    };
+    IREE_CHECK_OK(iree_io_parameter_provider_gather(
+        provider_, device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+        iree_hal_semaphore_list_empty(), signal_list, IREE_SV("scope"), buffer,
+        spans.size(), enumerator));
+    IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, signal_value,
+                                          iree_infinite_timeout()));
+    iree_hal_semaphore_release(semaphore);
+
+    std::vector<uint8_t> contents(kFileLength);
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, 0, contents.data(), contents.size()));
+    iree_hal_buffer_release(buffer);
+    return contents;
+  }
+
+  // Returns a span of parameter |i| gathered to |buffer_offset|.
+  Span FileSpan(iree_host_size_t i, iree_device_size_t buffer_offset,
+                uint64_t parameter_offset = 0,
+                iree_device_size_t length = kParameterLength) {
+    return {keys_[i], {parameter_offset, buffer_offset, length}};
+  }
+
+  // Expects |length| bytes at |buffer_offset| to match the file contents at
+  // |file_offset|.
+  static void ExpectFileRange(const std::vector<uint8_t>& contents,
+                              iree_host_size_t buffer_offset,
+                              iree_host_size_t file_offset,
+                              iree_host_size_t length) {
+    for (iree_host_size_t i = 0; i < length; ++i) {
+      ASSERT_EQ(contents[buffer_offset + i], FileByte(file_offset + i))
+          << "buffer offset " << buffer_offset + i;
+    }
+  }
+
+  // Expects |length| bytes at |buffer_offset| to all be |value|.
+  static void ExpectFilled(const std::vector<uint8_t>& contents,
+                           iree_host_size_t buffer_offset,
+                           iree_host_size_t length, uint8_t value) {
+    for (iree_host_size_t i = 0; i < length; ++i) {
+      ASSERT_EQ(contents[buffer_offset + i], value)
+          << "buffer offset " << buffer_offset + i;
+    }
+  }
+
+  iree_hal_device_t* device_ = NULL;
+  iree_io_parameter_provider_t* provider_ = NULL;
+  std::vector<uint8_t> file_contents_;
+  std::vector<std::string> keys_;
+};
+
+// Spans contiguous in both the file and the buffer are merged regardless of
+// the order they are enumerated in.
+TEST_F(ParameterIndexProviderTest, GatherMergedRun) {
+  std::vector<Span> spans = {
+      FileSpan(2, 2 * kParameterLength),
+      FileSpan(0, 0 * kParameterLength),
+      FileSpan(3, 3 * kParameterLength),
+      FileSpan(1, 1 * kParameterLength),
+  };
+  auto contents = Gather(spans);
+  ExpectFileRange(contents, 0, 0, 4 * kParameterLength);
+  ExpectFilled(contents, 4 * kParameterLength,
+               kFileLength - 4 * kParameterLength, 0);
+}
+
+// Spans adjacent in the file but not in the buffer (or the reverse) must not
+// be merged.
+TEST_F(ParameterIndexProviderTest, GatherAdjacentNonContiguous) {
+  std::vector<Span> spans = {
+      // Adjacent in the file, reversed in the buffer.
+      FileSpan(0, 5 * kParameterLength),
+      FileSpan(1, 4 * kParameterLength),
+      // Adjacent in the file with a gap in the buffer.
+      FileSpan(2, 0),
+      FileSpan(3, 2 * kParameterLength),
+      // Adjacent in the buffer with a gap in the file.
+      FileSpan(6, 8 * kParameterLength),
+      FileSpan(8, 9 * kParameterLength),
+      // Partial spans adjacent in the buffer but not the file.
+      FileSpan(10, 12 * kParameterLength, 8, 16),
+      FileSpan(10, 12 * kParameterLength + 16, 0, 8),
+  };
+  auto contents = Gather(spans);
+  ExpectFileRange(contents, 5 * kParameterLength, 0, kParameterLength);
+  ExpectFileRange(contents, 4 * kParameterLength, 1 * kParameterLength,
+                  kParameterLength);
+  ExpectFileRange(contents, 0, 2 * kParameterLength, kParameterLength);
+  ExpectFilled(contents, 1 * kParameterLength, kParameterLength, 0);
+  ExpectFileRange(contents, 2 * kParameterLength, 3 * kParameterLength,
+                  kParameterLength);
+  ExpectFileRange(contents, 8 * kParameterLength, 6 * kParameterLength,
+                  kParameterLength);
+  ExpectFileRange(contents, 9 * kParameterLength, 8 * kParameterLength,
+                  kParameterLength);
+  ExpectFileRange(contents, 12 * kParameterLength, 10 * kParameterLength + 8,
+                  16);
+  ExpectFileRange(contents, 12 * kParameterLength + 16, 10 * kParameterLength,
+                  8);
+}
+
+// Runs longer than the coalescing limit are split into multiple reads.
+TEST_F(ParameterIndexProviderTest, GatherMaxLengthSplit) {
+  std::vector<Span> spans;
+  for (iree_host_size_t i = 0; i < kParameterCount; ++i) {
+    spans.push_back(FileSpan(kParameterCount - i - 1,
+                             (kParameterCount - i - 1) * kParameterLength));
+  }
+  auto contents = Gather(spans);
+  ExpectFileRange(contents, 0, 0, kFileLength);
+}
+
+// Splats are enqueued independently of the merged file reads.
+TEST_F(ParameterIndexProviderTest, GatherSplatsAndFiles) {
+  std::vector<Span> spans = {
+      FileSpan(0, 0),
+      {"splat", {0, 1 * kParameterLength, kParameterLength}},
+      FileSpan(1, 2 * kParameterLength),
+      FileSpan(2, 3 * kParameterLength),
+  };
+  auto contents = Gather(spans);
+  ExpectFileRange(contents, 0, 0, kParameterLength);
+  ExpectFilled(contents, 1 * kParameterLength, kParameterLength, 0xAB);
+  ExpectFileRange(contents, 2 * kParameterLength, 1 * kParameterLength,
+                  2 * kParameterLength);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
@@ -0,0 +1,101 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_index.h"
+
+#include <cstring>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+// Adds a splat entry with the given |key| and |length| to |index|.
+static iree_status_t AddSplatEntry(iree_io_parameter_index_t* index,
+                                   const std::string& key, uint64_t length) {
+  iree_io_parameter_index_entry_t entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.key = iree_make_string_view(key.data(), key.size());
+  entry.length = length;
+  entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT;
+  entry.storage.splat.pattern_length = 1;
+  return iree_io_parameter_index_add(index, &entry);
+}
+
+TEST(ParameterIndexTest, LookupEmpty) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  EXPECT_THAT(
+      iree::Status(iree_io_parameter_index_lookup(index, IREE_SV("a"), &entry)),
+      StatusIs(StatusCode::kNotFound));
+  EXPECT_EQ(entry, nullptr);
+  iree_io_parameter_index_release(index);
+}
+
+TEST(ParameterIndexTest, LookupMany) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  static const int kEntryCount = 1000;
+  for (int i = 0; i < kEntryCount; ++i) {
+    IREE_ASSERT_OK(AddSplatEntry(index, "key" + std::to_string(i), i));
+  }
+  EXPECT_EQ(iree_io_parameter_index_count(index), kEntryCount);
+  for (int i = 0; i < kEntryCount; ++i) {
+    std::string key = "key" + std::to_string(i);
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_lookup(
+        index, iree_make_string_view(key.data(), key.size()), &entry));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_TRUE(iree_string_view_equal(
+        entry->key, iree_make_string_view(key.data(), key.size())));
+    EXPECT_EQ(entry->length, i);
+  }
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  EXPECT_THAT(iree::Status(iree_io_parameter_index_lookup(
+                  index, IREE_SV("key1000"), &entry)),
+              StatusIs(StatusCode::kNotFound));
+  iree_io_parameter_index_release(index);
+}
+
+TEST(ParameterIndexTest, LookupAfterReserve) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  IREE_ASSERT_OK(AddSplatEntry(index, "a", 1));
+  IREE_ASSERT_OK(iree_io_parameter_index_reserve(index, 100));
+  IREE_ASSERT_OK(AddSplatEntry(index, "b", 2));
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(index, IREE_SV("a"), &entry));
+  EXPECT_EQ(entry->length, 1);
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(index, IREE_SV("b"), &entry));
+  EXPECT_EQ(entry->length, 2);
+  iree_io_parameter_index_release(index);
+}
+
+// Duplicate keys are allowed in the index but lookups always return the first
+// entry added with the key.
+TEST(ParameterIndexTest, DuplicateKeysReturnFirst) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  IREE_ASSERT_OK(AddSplatEntry(index, "a", 1));
+  IREE_ASSERT_OK(AddSplatEntry(index, "a", 2));
+  EXPECT_EQ(iree_io_parameter_index_count(index), 2);
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(index, IREE_SV("a"), &entry));
+  EXPECT_EQ(entry->length, 1);
+  iree_io_parameter_index_release(index);
+}
+
+}  // namespace
@@ -155,7 +155,8 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_provider_write(
 // The |enumerator| defines the source keys in |source_scope| and the offset and
 // length in the |target_buffer| of each span. Multiple spans may reference the
 // same source parameter but behavior is undefined if multiple span target
-// ranges overlap.
+// ranges overlap. Spans are not processed in enumeration order and providers
+// may merge or reorder them, so overlapping ranges may land in any order.
 //
 // Returns IREE_STATUS_NOT_FOUND if any parameter is not found.
 IREE_API_EXPORT iree_status_t iree_io_parameter_provider_gather(
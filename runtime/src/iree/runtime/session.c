@@ -51,6 +51,10 @@ struct iree_runtime_session_t {
   // synchronized.
   iree_vm_context_t* context;
 
+  // The HAL module registered in the context. Retained so that forked sessions
+  // can resolve their HAL module state without depending on module order.
+  iree_vm_module_t* hal_module;
+
   // The HAL module state bound to the target devices.
   // This is used internally by the loaded modules to interact with the devices
   // but can also be used by the caller to perform allocation and custom device
@@ -107,7 +111,53 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
     status = iree_vm_context_resolve_module_state(session->context, hal_module,
                                                   &session->hal_module_state);
   }
-  iree_vm_module_release(hal_module);
+  if (iree_status_is_ok(status)) {
+    session->hal_module = hal_module;
+  } else {
+    iree_vm_module_release(hal_module);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_session = session;
+  } else {
+    iree_runtime_session_release(session);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_session_fork(
+    const iree_runtime_session_t* parent_session,
+    iree_allocator_t host_allocator, iree_runtime_session_t** out_session) {
+  IREE_ASSERT_ARGUMENT(parent_session);
+  IREE_ASSERT_ARGUMENT(out_session);
+  *out_session = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Allocate the session state.
+  iree_runtime_session_t* session = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*session),
+                                (void**)&session));
+  session->host_allocator = host_allocator;
+  iree_atomic_ref_count_init(&session->ref_count);
+
+  session->instance = parent_session->instance;
+  iree_runtime_instance_retain(session->instance);
+
+  // Fork the context; modules are shared and their state is cloned from the
+  // parent without rerunning any initializers.
+  iree_status_t status = iree_vm_context_fork(
+      parent_session->context, host_allocator, &session->context);
+
+  // The forked context shares the parent modules and has its own state for
+  // each of them.
+  session->hal_module = parent_session->hal_module;
+  iree_vm_module_retain(session->hal_module);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_context_resolve_module_state(
+        session->context, session->hal_module, &session->hal_module_state);
+  }
 
   if (iree_status_is_ok(status)) {
     *out_session = session;
@@ -123,6 +173,7 @@ static void iree_runtime_session_destroy(iree_runtime_session_t* session) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_vm_context_release(session->context);
+  iree_vm_module_release(session->hal_module);
   iree_runtime_instance_release(session->instance);
 
   iree_allocator_free(session->host_allocator, session);
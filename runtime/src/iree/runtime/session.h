@@ -88,6 +88,25 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
     const iree_runtime_session_options_t* options, iree_hal_device_t* device,
     iree_allocator_t host_allocator, iree_runtime_session_t** out_session);
 
+// Forks |parent_session| into a new session stored in |out_session|.
+// The new session shares the parent instance, device, and loaded modules and
+// starts with a shallow copy of the parent module state: immutable resources
+// such as executables, constant buffers, and resolved imports are shared by
+// reference while mutable globals are copied. Module initializers are not run
+// again, making this significantly cheaper than creating a new session and
+// loading the same modules for each isolated user or request.
+//
+// The parent session must not be executing during the fork. After the fork the
+// sessions are independent and changes to globals in one will not be visible
+// in the other. Forked sessions cannot have additional modules appended and
+// all modules loaded in the parent must support forking.
+//
+// |host_allocator| will be used to allocate the session and any associated
+// resources. |out_session| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_fork(
+    const iree_runtime_session_t* parent_session,
+    iree_allocator_t host_allocator, iree_runtime_session_t** out_session);
+
 // Retains the given |session| for the caller.
 IREE_API_EXPORT void iree_runtime_session_retain(
     iree_runtime_session_t* session);
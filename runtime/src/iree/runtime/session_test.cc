@@ -0,0 +1,128 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/session.h"
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/runtime/instance.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace runtime {
+namespace {
+
+class SessionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(&instance_options,
+                                                host_allocator, &instance_));
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), host_allocator, host_allocator,
+        &device_allocator));
+    iree_hal_sync_device_params_t device_params;
+    iree_hal_sync_device_params_initialize(&device_params);
+    iree_status_t status = iree_hal_sync_device_create(
+        iree_make_cstring_view("local-sync"), &device_params,
+        /*loader_count=*/0, /*loaders=*/NULL, device_allocator, host_allocator,
+        &device_);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+  }
+
+  void TearDown() override {
+    iree_hal_device_release(device_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  // Returns the device count reported by the HAL module in |session|.
+  static iree_status_t QueryDeviceCount(iree_runtime_session_t* session,
+                                        int32_t* out_device_count) {
+    iree_vm_list_t* output_list = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &output_list));
+    iree_status_t status = iree_runtime_session_call_by_name(
+        session, iree_make_cstring_view("hal.devices.count"),
+        /*input_list=*/NULL, output_list);
+    iree_vm_value_t value;
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_get_value(output_list, 0, &value);
+    }
+    if (iree_status_is_ok(status)) {
+      *out_device_count = iree_vm_value_get_i32(&value);
+    }
+    iree_vm_list_release(output_list);
+    return status;
+  }
+
+  iree_runtime_instance_t* instance_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+};
+
+TEST_F(SessionTest, Fork) {
+  iree_runtime_session_options_t session_options;
+  iree_runtime_session_options_initialize(&session_options);
+  iree_runtime_session_t* parent_session = NULL;
+  IREE_ASSERT_OK(iree_runtime_session_create_with_device(
+      instance_, &session_options, device_, iree_allocator_system(),
+      &parent_session));
+
+  iree_runtime_session_t* session = NULL;
+  IREE_ASSERT_OK(iree_runtime_session_fork(
+      parent_session, iree_allocator_system(), &session));
+  EXPECT_NE(iree_runtime_session_context(session),
+            iree_runtime_session_context(parent_session));
+  EXPECT_EQ(iree_runtime_session_instance(session), instance_);
+  EXPECT_EQ(iree_runtime_session_device(session), device_);
+  EXPECT_EQ(iree_runtime_session_device_allocator(session),
+            iree_hal_device_allocator(device_));
+
+  // The forked session must remain usable after the parent is released.
+  iree_runtime_session_release(parent_session);
+  int32_t device_count = 0;
+  IREE_ASSERT_OK(QueryDeviceCount(session, &device_count));
+  EXPECT_EQ(device_count, 1);
+
+  iree_runtime_session_release(session);
+}
+
+// Forks of forks resolve the HAL module state of their own context.
+TEST_F(SessionTest, ForkOfFork) {
+  iree_runtime_session_options_t session_options;
+  iree_runtime_session_options_initialize(&session_options);
+  iree_runtime_session_t* parent_session = NULL;
+  IREE_ASSERT_OK(iree_runtime_session_create_with_device(
+      instance_, &session_options, device_, iree_allocator_system(),
+      &parent_session));
+  iree_runtime_session_t* child_session = NULL;
+  IREE_ASSERT_OK(iree_runtime_session_fork(
+      parent_session, iree_allocator_system(), &child_session));
+  iree_runtime_session_t* grandchild_session = NULL;
+  IREE_ASSERT_OK(iree_runtime_session_fork(
+      child_session, iree_allocator_system(), &grandchild_session));
+  iree_runtime_session_release(child_session);
+  iree_runtime_session_release(parent_session);
+
+  EXPECT_EQ(iree_runtime_session_device(grandchild_session), device_);
+  int32_t device_count = 0;
+  IREE_ASSERT_OK(QueryDeviceCount(grandchild_session, &device_count));
+  EXPECT_EQ(device_count, 1);
+
+  iree_runtime_session_release(grandchild_session);
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace iree
@@ -30,6 +30,7 @@ enum iree_idbts_chunk_type_e {
   // NOTE: these will change in the real IDB spec.
   IREE_IDBTS_CHUNK_TYPE_DISPATCH_METADATA = 0x0000u,
   IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER = 0x0001u,
+  IREE_IDBTS_CHUNK_TYPE_DISPATCH_COUNTERS = 0x0002u,
 };
 typedef uint16_t iree_idbts_chunk_type_t;
 
@@ -130,4 +131,42 @@ typedef struct iree_instrument_dispatch_value_t {
   uint64_t bits;
 } iree_instrument_dispatch_value_t;
 
+//===----------------------------------------------------------------------===//
+// Dispatch performance counters
+//===----------------------------------------------------------------------===//
+// Hardware performance counters aggregated per executable export across all
+// dispatches and workers within a profiling capture. Produced by the local CPU
+// HAL devices when profiling with
+// IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS. The chunk payload is a
+// sequence of iree_instrument_dispatch_counters_t records each followed by
+// their name and padded to 16 bytes.
+
+typedef enum iree_instrument_dispatch_counter_e {
+  IREE_INSTRUMENT_DISPATCH_COUNTER_CPU_CYCLES = 0,
+  IREE_INSTRUMENT_DISPATCH_COUNTER_INSTRUCTIONS,
+  IREE_INSTRUMENT_DISPATCH_COUNTER_CACHE_REFERENCES,
+  IREE_INSTRUMENT_DISPATCH_COUNTER_CACHE_MISSES,
+  IREE_INSTRUMENT_DISPATCH_COUNTER_BRANCH_INSTRUCTIONS,
+  IREE_INSTRUMENT_DISPATCH_COUNTER_BRANCH_MISSES,
+  IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT,
+} iree_instrument_dispatch_counter_t;
+
+typedef struct iree_instrument_dispatch_counters_t {
+  // Export ordinal within the executable.
+  uint32_t export_ordinal;
+  // Length of the export name in |name| or 0 if the name is not available.
+  uint32_t name_length;
+  // Total number of dispatches and workgroups executed.
+  uint64_t dispatch_count;
+  uint64_t workgroup_count;
+  // Total wall time spent in workgroups summed across all workers.
+  uint64_t duration_ns;
+  // Counter values indexed by iree_instrument_dispatch_counter_t summed across
+  // all workgroups. Counters are only accumulated for user-mode execution.
+  uint64_t values[IREE_INSTRUMENT_DISPATCH_COUNTER_COUNT];
+  uint8_t name[];  // name_length, padded to 16b, no NUL terminator
+} iree_instrument_dispatch_counters_t;
+static_assert(sizeof(iree_instrument_dispatch_counters_t) % 16 == 0,
+              "dispatch counter records must be 16-byte aligned");
+
 #endif  // IREE_SCHEMAS_INSTRUMENTS_DISPATCH_H_
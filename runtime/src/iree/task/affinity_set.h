@@ -7,6 +7,7 @@
 #ifndef IREE_TASK_AFFINITY_SET_H_
 #define IREE_TASK_AFFINITY_SET_H_
 
+#include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/math.h"
 #include "iree/task/tuning.h"
@@ -25,8 +26,17 @@ extern "C" {
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
+// A bitmask of up to 64 workers.
+//
+// Tasks carry a single-word affinity set to keep their headers small. When an
+// executor has more than 64 workers bit N of a task affinity set selects
+// worker N of each block of 64 workers (see iree_task_worker_set_t). With 64 or
+// fewer workers this is just the worker with index N.
 typedef uint64_t iree_task_affinity_set_t;
 
+// Number of bits in an iree_task_affinity_set_t.
+#define IREE_TASK_AFFINITY_SET_BIT_COUNT (sizeof(iree_task_affinity_set_t) * 8)
+
 // Allows for only a specific worker to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
     uint8_t worker_index) {
@@ -53,6 +63,147 @@ static inline iree_task_affinity_set_t iree_task_affinity_for_any_worker(void) {
 #define iree_task_affinity_set_count_ones(set) iree_math_count_ones_u64(set)
 #define iree_task_affinity_set_rotr(set, count) iree_math_rotr_u64(set, count)
 
+//===----------------------------------------------------------------------===//
+// iree_task_worker_set_t
+//===----------------------------------------------------------------------===//
+
+// Total number of affinity set words required to have one bit per worker.
+#define IREE_TASK_WORKER_SET_WORD_COUNT                                   \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT + IREE_TASK_AFFINITY_SET_BIT_COUNT - \
+    1) /                                                                  \
+   IREE_TASK_AFFINITY_SET_BIT_COUNT)
+
+// A set of workers within an executor with one bit per worker.
+// Worker N is bit N % 64 of word N / 64. Operations are performed word-wise and
+// in most configurations (<= 64 workers) only the first word is ever non-zero.
+typedef struct iree_task_worker_set_t {
+  iree_task_affinity_set_t words[IREE_TASK_WORKER_SET_WORD_COUNT];
+} iree_task_worker_set_t;
+
+// Returns the index of the word in an iree_task_worker_set_t containing the
+// bit for |worker_index|.
+static inline iree_host_size_t iree_task_worker_set_word_index(
+    iree_host_size_t worker_index) {
+  return worker_index / IREE_TASK_AFFINITY_SET_BIT_COUNT;
+}
+
+// Returns the bit within its word representing |worker_index|.
+static inline iree_task_affinity_set_t iree_task_worker_set_word_bit(
+    iree_host_size_t worker_index) {
+  return 1ull << (worker_index % IREE_TASK_AFFINITY_SET_BIT_COUNT);
+}
+
+// Resets |set| to contain no workers.
+static inline void iree_task_worker_set_clear(iree_task_worker_set_t* set) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    set->words[i] = 0;
+  }
+}
+
+// Resets |set| to contain workers [0, |worker_count|).
+static inline void iree_task_worker_set_fill(iree_task_worker_set_t* set,
+                                             iree_host_size_t worker_count) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    iree_host_size_t word_base = i * IREE_TASK_AFFINITY_SET_BIT_COUNT;
+    if (worker_count >= word_base + IREE_TASK_AFFINITY_SET_BIT_COUNT) {
+      set->words[i] = UINT64_MAX;
+    } else if (worker_count > word_base) {
+      set->words[i] = iree_task_affinity_set_ones(worker_count - word_base);
+    } else {
+      set->words[i] = 0;
+    }
+  }
+}
+
+// Adds |worker_index| to |set|.
+static inline void iree_task_worker_set_insert(iree_task_worker_set_t* set,
+                                               iree_host_size_t worker_index) {
+  set->words[iree_task_worker_set_word_index(worker_index)] |=
+      iree_task_worker_set_word_bit(worker_index);
+}
+
+// Returns true if |worker_index| is in |set|.
+static inline bool iree_task_worker_set_contains(
+    const iree_task_worker_set_t* set, iree_host_size_t worker_index) {
+  return (set->words[iree_task_worker_set_word_index(worker_index)] &
+          iree_task_worker_set_word_bit(worker_index)) != 0;
+}
+
+// Returns true if |set| contains no workers.
+static inline bool iree_task_worker_set_is_empty(
+    const iree_task_worker_set_t* set) {
+  iree_task_affinity_set_t any_bits = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    any_bits |= set->words[i];
+  }
+  return any_bits == 0;
+}
+
+// Returns the total number of workers in |set|.
+static inline int iree_task_worker_set_count_ones(
+    const iree_task_worker_set_t* set) {
+  int count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    count += iree_task_affinity_set_count_ones(set->words[i]);
+  }
+  return count;
+}
+
+// Sets |out_set| to the workers in |set| that are allowed by the task
+// |affinity_set|. The affinity set is applied to each block of 64 workers.
+static inline void iree_task_worker_set_and_affinity(
+    const iree_task_worker_set_t* set, iree_task_affinity_set_t affinity_set,
+    iree_task_worker_set_t* out_set) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    out_set->words[i] = set->words[i] & affinity_set;
+  }
+}
+
+// Sets |out_set| to the workers in both |lhs| and |rhs|.
+static inline void iree_task_worker_set_and(const iree_task_worker_set_t* lhs,
+                                            const iree_task_worker_set_t* rhs,
+                                            iree_task_worker_set_t* out_set) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    out_set->words[i] = lhs->words[i] & rhs->words[i];
+  }
+}
+
+// Sets |out_set| to the workers in |lhs| that are not in |rhs|.
+static inline void iree_task_worker_set_and_not(
+    const iree_task_worker_set_t* lhs, const iree_task_worker_set_t* rhs,
+    iree_task_worker_set_t* out_set) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    out_set->words[i] = lhs->words[i] & ~rhs->words[i];
+  }
+}
+
+// Returns the lowest worker index in |set| that is >= |worker_index| or
+// IREE_HOST_SIZE_MAX if there are no such workers.
+//
+// Iterating a set:
+//   for (iree_host_size_t i = iree_task_worker_set_find_next(&set, 0);
+//        i != IREE_HOST_SIZE_MAX;
+//        i = iree_task_worker_set_find_next(&set, i + 1)) {
+//     ...
+//   }
+static inline iree_host_size_t iree_task_worker_set_find_next(
+    const iree_task_worker_set_t* set, iree_host_size_t worker_index) {
+  iree_host_size_t word_index = iree_task_worker_set_word_index(worker_index);
+  if (word_index >= IREE_TASK_WORKER_SET_WORD_COUNT) return IREE_HOST_SIZE_MAX;
+  // Mask off bits below the starting worker in its word.
+  iree_task_affinity_set_t word =
+      set->words[word_index] &
+      ~(iree_task_worker_set_word_bit(worker_index) - 1);
+  while (!word) {
+    if (++word_index >= IREE_TASK_WORKER_SET_WORD_COUNT) {
+      return IREE_HOST_SIZE_MAX;
+    }
+    word = set->words[word_index];
+  }
+  return word_index * IREE_TASK_AFFINITY_SET_BIT_COUNT +
+         iree_task_affinity_set_count_trailing_zeros(word);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_atomic_task_affinity_set_t
 //===----------------------------------------------------------------------===//
@@ -82,6 +233,36 @@ static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_or(
   return iree_atomic_fetch_or(set, value, order);
 }
 
+//===----------------------------------------------------------------------===//
+// iree_atomic_task_worker_set_t
+//===----------------------------------------------------------------------===//
+
+// An iree_task_worker_set_t where each word is individually atomic.
+// There is no atomicity across words: loads of the full set may observe some
+// words before and others after a concurrent update. All uses of these sets are
+// as hints where that is acceptable and updates to a single worker only ever
+// touch the word containing its bit.
+typedef struct iree_atomic_task_worker_set_t {
+  iree_atomic_task_affinity_set_t words[IREE_TASK_WORKER_SET_WORD_COUNT];
+} iree_atomic_task_worker_set_t;
+
+static inline void iree_atomic_task_worker_set_load(
+    iree_atomic_task_worker_set_t* set, iree_memory_order_t order,
+    iree_task_worker_set_t* out_value) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    out_value->words[i] =
+        iree_atomic_task_affinity_set_load(&set->words[i], order);
+  }
+}
+
+static inline void iree_atomic_task_worker_set_store(
+    iree_atomic_task_worker_set_t* set, const iree_task_worker_set_t* value,
+    iree_memory_order_t order) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_WORKER_SET_WORD_COUNT; ++i) {
+    iree_atomic_task_affinity_set_store(&set->words[i], value->words[i], order);
+  }
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -24,6 +24,21 @@ IREE_FLAG(
     "when latency is the #1 priority (vs. thermals, system-wide scheduling,\n"
     "etc).");
 
+IREE_FLAG(
+    string, task_worker_idle_policy, "park",
+    "Policy used by workers waiting for new work:\n"
+    " 'park': spin for up to --task_worker_spin_us and then park.\n"
+    " 'spin_yield_park': spin for up to --task_worker_spin_us, yield the\n"
+    "   thread for up to --task_worker_yield_us, and then park.\n"
+    " 'adaptive': as with 'spin_yield_park' but each worker adapts how long\n"
+    "   it spins and yields based on how soon work has arrived recently.");
+
+IREE_FLAG(
+    int32_t, task_worker_yield_us, 0,
+    "Maximum duration in microseconds each worker should yield its thread\n"
+    "to the system scheduler after spinning and before parking when using\n"
+    "the 'spin_yield_park' or 'adaptive' idle policies.");
+
 IREE_FLAG(
     int32_t, task_worker_stack_size, 128 * 1024,
     "Minimum size in bytes of each worker thread stack.\n"
@@ -37,23 +52,50 @@ IREE_FLAG(
 IREE_FLAG(
     int32_t, task_worker_local_memory, 0,
     "Overrides the bytes of per-worker local memory allocated for use by\n"
-    "dispatched tiles. Tiles may use less than this but will fail to dispatch\n"
-    "if they require more. Conceptually it is like a stack reservation and\n"
-    "should be treated the same way: the source programs must be built to\n"
-    "only use a specific maximum amount of local memory and the runtime must\n"
-    "be configured to make at least that amount of local memory available.\n"
+    "dispatched tiles when workers start. Workers grow their local memory\n"
+    "the first time they execute a dispatch that requires more. Setting this\n"
+    "to the largest amount required by the loaded programs avoids growing\n"
+    "while dispatches are executing. Workers will not grow beyond\n"
+    "--task_worker_local_memory_limit.\n"
     "By default the CPU L2 cache size is used if such queries are supported.");
 
+IREE_FLAG(
+    int32_t, task_worker_local_memory_limit, 0,
+    "Maximum bytes of per-worker local memory available to dispatched tiles.\n"
+    "Tiles may use less than this but will fail to dispatch if they require\n"
+    "more. Conceptually it is like a stack reservation and should be treated\n"
+    "the same way: the source programs must be built to only use a specific\n"
+    "maximum amount of local memory and the runtime must be configured to\n"
+    "make at least that amount of local memory available.\n"
+    "Defaults to 32MB when 0.");
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
   iree_task_executor_options_initialize(out_options);
   out_options->worker_spin_ns =
       (iree_duration_t)FLAG_task_worker_spin_us * 1000;
+  if (strcmp(FLAG_task_worker_idle_policy, "park") == 0) {
+    out_options->worker_idle_policy = IREE_TASK_WORKER_IDLE_POLICY_PARK;
+  } else if (strcmp(FLAG_task_worker_idle_policy, "spin_yield_park") == 0) {
+    out_options->worker_idle_policy =
+        IREE_TASK_WORKER_IDLE_POLICY_SPIN_YIELD_PARK;
+  } else if (strcmp(FLAG_task_worker_idle_policy, "adaptive") == 0) {
+    out_options->worker_idle_policy = IREE_TASK_WORKER_IDLE_POLICY_ADAPTIVE;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unknown value `%s` for worker idle policy; "
+                            "expected one of [park, spin_yield_park, adaptive]",
+                            FLAG_task_worker_idle_policy);
+  }
+  out_options->worker_yield_ns =
+      (iree_duration_t)FLAG_task_worker_yield_us * 1000;
   out_options->worker_stack_size =
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
       (iree_host_size_t)FLAG_task_worker_local_memory;
+  out_options->worker_local_memory_limit =
+      (iree_host_size_t)FLAG_task_worker_local_memory_limit;
   return iree_ok_status();
 }
 
@@ -216,6 +258,29 @@ static void iree_task_flags_print_action_flag(iree_string_view_t flag_name,
   fprintf(file, "# --%.*s\n", (int)flag_name.size, flag_name.data);
 }
 
+// Prints the groups in |group_mask| of the group with |group_index|.
+static void iree_task_flags_dump_group_mask(
+    iree_host_size_t group_index, iree_task_topology_group_mask_t group_mask) {
+  if (group_mask == 0) {
+    fprintf(stdout, "(none)\n");
+  } else if (group_mask == IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
+    fprintf(stdout, "(all/undefined)\n");
+  } else {
+    fprintf(stdout, "%d group(s): ", iree_math_count_ones_u64(group_mask));
+    iree_host_size_t block_base =
+        iree_task_topology_group_mask_base(group_index);
+    for (iree_host_size_t ic = 0, jc = 0;
+         ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
+      if ((group_mask >> ic) & 1) {
+        if (jc > 0) fprintf(stdout, ", ");
+        fprintf(stdout, "%" PRIhsz, block_base + ic);
+        ++jc;
+      }
+    }
+    fprintf(stdout, "\n");
+  }
+}
+
 static void iree_task_flags_dump_task_topology(
     iree_host_size_t topology_id, const iree_task_topology_t* topology) {
   fprintf(stdout,
@@ -233,6 +298,11 @@ static void iree_task_flags_dump_task_topology(
     const iree_task_topology_group_t* group = &topology->groups[j];
     fprintf(stdout, "# group[%d]: '%s'\n", group->group_index, group->name);
     fprintf(stdout, "#      processor: %u\n", group->processor_index);
+    if (group->node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      fprintf(stdout, "#      NUMA node: (any)\n");
+    } else {
+      fprintf(stdout, "#      NUMA node: %u\n", group->node_id);
+    }
     fprintf(stdout, "#       affinity: ");
     if (group->ideal_thread_affinity.specified) {
       fprintf(
@@ -246,25 +316,12 @@ static void iree_task_flags_dump_task_topology(
     fprintf(stdout, "#  caches: l1d=%u, l2d=%u\n", group->caches.l1_data,
             group->caches.l2_data);
 
+    fprintf(stdout, "#  cache sharing: ");
+    iree_task_flags_dump_group_mask(group->group_index,
+                                    group->constructive_sharing_mask);
     fprintf(stdout, "#  last level cache sharing: ");
-    if (group->constructive_sharing_mask == 0) {
-      fprintf(stdout, "(none)\n");
-    } else if (group->constructive_sharing_mask ==
-               IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
-      fprintf(stdout, "(all/undefined)\n");
-    } else {
-      fprintf(stdout, "%d group(s): ",
-              iree_math_count_ones_u64(group->constructive_sharing_mask));
-      for (iree_host_size_t ic = 0, jc = 0;
-           ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
-        if ((group->constructive_sharing_mask >> ic) & 1) {
-          if (jc > 0) fprintf(stdout, ", ");
-          fprintf(stdout, "%" PRIhsz, ic);
-          ++jc;
-        }
-      }
-      fprintf(stdout, "\n");
-    }
+    iree_task_flags_dump_group_mask(group->group_index,
+                                    group->llc_sharing_mask);
 
     fprintf(stdout, "#\n");
   }
@@ -0,0 +1,284 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the overhead of distributing dispatch tiles across workers.
+//
+// Each step runs a single dispatch with a large grid of workgroups that each
+// perform a configurable amount of work. With tiny workgroups the cost is
+// dominated by shards reserving tiles from the shared grid and the benchmark
+// compares the default fixed-size reservations against guided scheduling
+// (IREE_TASK_FLAG_DISPATCH_GUIDED).
+//
+// The decode grid models a matrix-vector product repeated every step where each
+// workgroup streams its own slice of a weight buffer. Sticky scheduling
+// (IREE_TASK_FLAG_DISPATCH_STICKY) keeps each slice on the same worker across
+// steps so that it remains warm in that worker's private caches.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/task/api.h"
+#include "iree/testing/benchmark.h"
+
+// Number of workers in the executor.
+#define IREE_TASK_DISPATCH_BENCHMARK_WORKER_COUNT 8
+
+// State shared by all tiles of a benchmark run.
+typedef struct iree_task_dispatch_benchmark_context_t {
+  // Number of loop iterations performed by each workgroup.
+  uint32_t workgroup_work;
+  // Number of weights read by each workgroup. Each workgroup reads a distinct
+  // slice of the weight buffer.
+  iree_host_size_t workgroup_weight_count;
+  // Weights with workgroup_weight_count values per workgroup.
+  const uint64_t* weights;
+  // One result per workgroup.
+  uint32_t* results;
+} iree_task_dispatch_benchmark_context_t;
+
+// |user_context| is the iree_task_dispatch_benchmark_context_t.
+static iree_status_t iree_task_dispatch_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_task_dispatch_benchmark_context_t* context =
+      (const iree_task_dispatch_benchmark_context_t*)user_context;
+  const uint32_t workgroup_id = tile_context->workgroup_xyz[0];
+  uint32_t value = workgroup_id;
+  for (uint32_t i = 0; i < context->workgroup_work; ++i) {
+    value = value * 1664525u + 1013904223u;
+  }
+  // Touch one value per cache line of the workgroup weight slice.
+  const uint64_t* weights =
+      context->weights + workgroup_id * context->workgroup_weight_count;
+  for (iree_host_size_t i = 0; i < context->workgroup_weight_count; i += 8) {
+    value += (uint32_t)weights[i];
+  }
+  context->results[workgroup_id] = value;
+  return iree_ok_status();
+}
+
+// Runs one dispatch per step over a grid of |workgroup_count| workgroups with
+// the given |dispatch_flags| (such as IREE_TASK_FLAG_DISPATCH_GUIDED). Each
+// workgroup performs |workgroup_work| loop iterations and reads a distinct
+// |workgroup_weight_size| byte slice of a weight buffer.
+static void iree_task_dispatch_benchmark_run(
+    iree_benchmark_state_t* benchmark_state, iree_task_flags_t dispatch_flags,
+    uint32_t workgroup_count, uint32_t workgroup_work,
+    iree_host_size_t workgroup_weight_size) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(
+      IREE_TASK_DISPATCH_BENCHMARK_WORKER_COUNT, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(
+      iree_task_executor_create(options, &topology, host_allocator, &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_dispatch_benchmark_context_t context = {
+      .workgroup_work = workgroup_work,
+      .workgroup_weight_count = workgroup_weight_size / sizeof(uint64_t),
+      .weights = NULL,
+      .results = NULL,
+  };
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                      workgroup_count * sizeof(uint32_t),
+                                      (void**)&context.results));
+  const iree_host_size_t weight_buffer_size =
+      workgroup_count * workgroup_weight_size;
+  if (weight_buffer_size) {
+    // Written so that each page is backed by distinct memory instead of the
+    // shared zero page.
+    uint64_t* weights = NULL;
+    IREE_CHECK_OK(iree_allocator_malloc(host_allocator, weight_buffer_size,
+                                        (void**)&weights));
+    memset(weights, 1, weight_buffer_size);
+    context.weights = weights;
+  }
+  iree_atomic_int64_t partitions[IREE_TASK_DISPATCH_BENCHMARK_WORKER_COUNT];
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(IREE_SV("dispatch"), IREE_TASK_SCOPE_FLAG_NONE,
+                             &scope);
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count_xyz[3] = {workgroup_count, 1, 1};
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(iree_task_dispatch_benchmark_tile,
+                                        &context),
+        workgroup_size, workgroup_count_xyz, &dispatch);
+    dispatch.header.flags |= dispatch_flags;
+    dispatch.partitions = partitions;
+    dispatch.partition_capacity = IREE_ARRAYSIZE(partitions);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    ++batch_count;
+  }
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     batch_count * workgroup_count);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_allocator_free(host_allocator, (void*)context.weights);
+  iree_allocator_free(host_allocator, context.results);
+}
+
+// Many near-empty workgroups dominated by tile reservation.
+//
+// user_data is the iree_task_flags_t added to the dispatch.
+static iree_status_t iree_task_dispatch_benchmark_tiny(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_dispatch_benchmark_run(
+      benchmark_state, (iree_task_flags_t)(uintptr_t)benchmark_def->user_data,
+      /*workgroup_count=*/256 * 1024, /*workgroup_work=*/1,
+      /*workgroup_weight_size=*/0);
+  return iree_ok_status();
+}
+
+// Many small workgroups.
+//
+// user_data is the iree_task_flags_t added to the dispatch.
+static iree_status_t iree_task_dispatch_benchmark_small(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_dispatch_benchmark_run(
+      benchmark_state, (iree_task_flags_t)(uintptr_t)benchmark_def->user_data,
+      /*workgroup_count=*/64 * 1024, /*workgroup_work=*/64,
+      /*workgroup_weight_size=*/0);
+  return iree_ok_status();
+}
+
+// Few large workgroups where reservation overhead is negligible.
+//
+// user_data is the iree_task_flags_t added to the dispatch.
+static iree_status_t iree_task_dispatch_benchmark_large(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_dispatch_benchmark_run(
+      benchmark_state, (iree_task_flags_t)(uintptr_t)benchmark_def->user_data,
+      /*workgroup_count=*/1024, /*workgroup_work=*/64 * 1024,
+      /*workgroup_weight_size=*/0);
+  return iree_ok_status();
+}
+
+// A matrix-vector product where each workgroup streams its own weights.
+//
+// user_data is the iree_task_flags_t added to the dispatch.
+static iree_status_t iree_task_dispatch_benchmark_decode(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_dispatch_benchmark_run(
+      benchmark_state, (iree_task_flags_t)(uintptr_t)benchmark_def->user_data,
+      /*workgroup_count=*/64, /*workgroup_work=*/0,
+      /*workgroup_weight_size=*/128 * 1024);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_task_dispatch_benchmark_tiny
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_dispatch_benchmark_tiny,
+    };
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_NONE;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_default_tiny"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_GUIDED;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_guided_tiny"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_STICKY;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_sticky_tiny"),
+                            &benchmark_def);
+  }
+
+  // iree_task_dispatch_benchmark_small
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_dispatch_benchmark_small,
+    };
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_NONE;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_default_small"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_GUIDED;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_guided_small"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_STICKY;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_sticky_small"),
+                            &benchmark_def);
+  }
+
+  // iree_task_dispatch_benchmark_large
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_dispatch_benchmark_large,
+    };
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_NONE;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_default_large"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_GUIDED;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_guided_large"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_STICKY;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_sticky_large"),
+                            &benchmark_def);
+  }
+
+  // iree_task_dispatch_benchmark_decode
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_dispatch_benchmark_decode,
+    };
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_NONE;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_default_decode"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_GUIDED;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_guided_decode"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(uintptr_t)IREE_TASK_FLAG_DISPATCH_STICKY;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_sticky_decode"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -29,7 +29,7 @@ void iree_task_executor_options_initialize(
   memset(out_options, 0, sizeof(*out_options));
 }
 
-// Returns the size of the worker local memory required by |group| in bytes.
+// Returns the initial size of the worker local memory for |group| in bytes.
 // We don't want destructive sharing between workers so ensure we are aligned to
 // at least the destructive interference size, even if a bit larger than what
 // the user asked for or the device supports.
@@ -47,6 +47,29 @@ static iree_host_size_t iree_task_topology_group_local_memory_size(
                          iree_hardware_destructive_interference_size);
 }
 
+// Returns a mask of all groups in |topology| on the same NUMA node as |group|.
+// Groups with an unknown node are treated as sharing a node with all others so
+// that stealing behaves as it would without NUMA information.
+static void iree_task_topology_node_sharing_mask(
+    const iree_task_topology_t* topology,
+    const iree_task_topology_group_t* group,
+    iree_task_worker_set_t* out_mask) {
+  iree_host_size_t group_count = iree_task_topology_group_count(topology);
+  if (group->node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+    iree_task_worker_set_fill(out_mask, group_count);
+    return;
+  }
+  iree_task_worker_set_clear(out_mask);
+  for (iree_host_size_t i = 0; i < group_count; ++i) {
+    const iree_task_topology_group_t* other =
+        iree_task_topology_get_group(topology, i);
+    if (other->node_id == group->node_id ||
+        other->node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      iree_task_worker_set_insert(out_mask, i);
+    }
+  }
+}
+
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                                         const iree_task_topology_t* topology,
                                         iree_allocator_t allocator,
@@ -71,23 +94,15 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
-  // The executor is followed in memory by worker[] + worker_local_memory[].
-  iree_host_size_t total_worker_local_memory_size = 0;
-  for (iree_host_size_t i = 0; i < worker_count; ++i) {
-    total_worker_local_memory_size +=
-        iree_task_topology_group_local_memory_size(
-            options, iree_task_topology_get_group(topology, i));
-  }
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)total_worker_local_memory_size);
-
+  // The executor is followed in memory by worker[]. Worker local memory is
+  // allocated by each worker on its own thread.
   iree_host_size_t executor_base_size =
       iree_host_align(sizeof(iree_task_executor_t),
                       iree_hardware_destructive_interference_size);
   iree_host_size_t worker_list_size =
       iree_host_align(worker_count * sizeof(iree_task_worker_t),
                       iree_hardware_destructive_interference_size);
-  iree_host_size_t executor_size =
-      executor_base_size + worker_list_size + total_worker_local_memory_size;
+  iree_host_size_t executor_size = executor_base_size + worker_list_size;
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -97,6 +112,15 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  executor->worker_idle_policy = options.worker_idle_policy;
+  executor->worker_yield_ns = options.worker_yield_ns;
+  executor->worker_local_memory_limit =
+      options.worker_local_memory_limit
+          ? options.worker_local_memory_limit
+          : IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT;
+  executor->worker_wake_latency_statistics =
+      options.worker_wake_latency_statistics ||
+      options.worker_idle_policy != IREE_TASK_WORKER_IDLE_POLICY_PARK;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
@@ -167,11 +191,19 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
     executor->worker_count = worker_count;
     executor->workers =
         (iree_task_worker_t*)((uint8_t*)executor + executor_base_size);
-    uint8_t* worker_local_memory =
-        (uint8_t*)executor->workers + worker_list_size;
 
-    iree_task_affinity_set_t worker_mask =
-        iree_task_affinity_set_ones(worker_count);
+    iree_task_worker_set_t worker_mask;
+    iree_task_worker_set_fill(&worker_mask, worker_count);
+
+    // The executor is only considered on a node if all workers are.
+    executor->node_id = iree_task_topology_get_group(topology, 0)->node_id;
+    for (iree_host_size_t i = 1; i < worker_count; ++i) {
+      if (iree_task_topology_get_group(topology, i)->node_id !=
+          executor->node_id) {
+        executor->node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
+        break;
+      }
+    }
 
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
       const iree_task_topology_group_t* group =
@@ -179,18 +211,19 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
       iree_host_size_t worker_local_memory_size =
           iree_task_topology_group_local_memory_size(options, group);
       iree_task_worker_t* worker = &executor->workers[i];
+      iree_task_worker_set_t node_sharing_mask;
+      iree_task_topology_node_sharing_mask(topology, group,
+                                           &node_sharing_mask);
       status = iree_task_worker_initialize(
-          executor, i, group, options.worker_stack_size,
-          iree_make_byte_span(worker_local_memory, worker_local_memory_size),
-          &seed_prng, worker);
-      worker_local_memory += worker_local_memory_size;
+          executor, i, group, &node_sharing_mask, options.worker_stack_size,
+          worker_local_memory_size, &seed_prng, worker);
       if (!iree_status_is_ok(status)) break;
     }
 
-    iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
-                                        worker_mask, iree_memory_order_release);
-    iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
-                                        worker_mask, iree_memory_order_release);
+    iree_atomic_task_worker_set_store(&executor->worker_idle_mask,
+                                      &worker_mask, iree_memory_order_release);
+    iree_atomic_task_worker_set_store(&executor->worker_live_mask,
+                                      &worker_mask, iree_memory_order_release);
   }
 
   if (!iree_status_is_ok(status)) {
@@ -274,6 +307,28 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor) {
+  return executor->node_id;
+}
+
+iree_status_t iree_task_executor_consume_worker_idle_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_worker_idle_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (worker_index >= executor->worker_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "worker index %" PRIhsz
+                            " out of range of the %" PRIhsz " workers",
+                            worker_index, executor->worker_count);
+  }
+  iree_task_worker_consume_idle_statistics(&executor->workers[worker_index],
+                                           out_statistics);
+  return iree_ok_status();
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -510,34 +565,29 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
   IREE_TRACE_ZONE_END(z0);
 }
 
-static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
-    iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
-    iree_task_queue_t* local_task_queue) {
-  if (!victim_mask) return NULL;
+static iree_task_t* iree_task_executor_try_steal_task_from_worker_set(
+    iree_task_executor_t* executor, const iree_task_worker_set_t* victim_mask,
+    uint32_t max_theft_attempts, iree_host_size_t max_theft_task_count,
+    iree_host_size_t rotation_offset, iree_task_queue_t* local_task_queue) {
+  if (iree_task_worker_set_is_empty(victim_mask)) return NULL;
   max_theft_attempts = iree_min(max_theft_attempts,
-                                iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
-
-  int worker_index = rotation_offset;
-  iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+                                iree_task_worker_set_count_ones(victim_mask));
+
+  // Walk the set bits starting at the rotation offset and wrapping around to
+  // the start of the set. Skipping directly to each set bit avoids the need for
+  // doing a full O(n) scan and instead gets us at O(popcnt) * O(words).
+  //
+  // Example: victim mask = 0b01010101
+  //          rotation_offset = 3 (randomly selected)
+  //          victims tried in order: 4, 6, 0, 2
+  iree_host_size_t worker_index = rotation_offset;
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
-    // Find the last set bit and skip to it. This avoids the need for doing
-    // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
-    //
-    // Example: sharing mask = 0b01010101
-    //          mask_rotation = 3 (randomly selected)
-    //          mask = 0b01010101 rotr 3 = 0b10101010
-    //          for (i = 0; i < 4; ++i)
-    //            offset = ctz(0b10101010) = 1
-    //            mask_rotation += 1 = 4
-    //            mask >>= 1 = 0b01010101
-    //            victim_index = 4 % 64 = 4
-    int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
-    worker_index += offset + 1;
-    mask = iree_shr(mask, offset + 1);
+    iree_host_size_t victim_index =
+        iree_task_worker_set_find_next(victim_mask, worker_index);
+    if (victim_index == IREE_HOST_SIZE_MAX) {
+      victim_index = iree_task_worker_set_find_next(victim_mask, 0);
+    }
+    worker_index = victim_index + 1;
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
     if (iree_atomic_load(&victim_worker->state, iree_memory_order_acquire) !=
         IREE_TASK_WORKER_STATE_RUNNING) {
@@ -551,8 +601,7 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     // thievery taking ~half of the tasks each time (across all queues) will
     // lead to a relatively even distribution.
     iree_task_t* task = iree_task_worker_try_steal_task(
-        victim_worker, local_task_queue,
-        /*max_tasks=*/IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT);
+        victim_worker, local_task_queue, max_theft_task_count);
     if (task) return task;
   }
 
@@ -564,10 +613,17 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
 //
-// We do a scan through ideal victims indicated by the
-// |constructive_sharing_mask|; these are the workers most likely to have some
-// cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// Victims are tried level by level moving outward in the cache/memory
+// hierarchy:
+//   1. |constructive_sharing_mask|: workers sharing L1/L2 caches; these are the
+//      workers most likely to have some cache benefits to taking their work.
+//   2. |llc_sharing_mask|: workers sharing the last level cache (the CCX on
+//      chiplet CPUs). Tiles stolen here may miss in L2 but not in L3.
+//   3. |node_sharing_mask|: workers on the same NUMA node. Data will need to
+//      come from another cache domain but not across the socket interconnect.
+//   4. All other workers so that we don't idle while others are overloaded.
+// Each level takes up to its own IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_* so
+// that fewer tasks are moved away from the caches holding their data.
 //
 // To prevent biasing any particular victim we use a fast prng function to
 // select where in the set of potential victims defined by the topology
@@ -576,45 +632,70 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // our search and then go in-order.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
-    iree_task_affinity_set_t constructive_sharing_mask,
+    const iree_task_worker_set_t* constructive_sharing_mask,
+    const iree_task_worker_set_t* llc_sharing_mask,
+    const iree_task_worker_set_t* node_sharing_mask,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_live_mask,
-                                         iree_memory_order_relaxed);
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_idle_mask,
-                                         iree_memory_order_relaxed);
+  iree_task_worker_set_t worker_live_mask;
+  iree_atomic_task_worker_set_load(&executor->worker_live_mask,
+                                   iree_memory_order_relaxed,
+                                   &worker_live_mask);
+  iree_task_worker_set_t worker_idle_mask;
+  iree_atomic_task_worker_set_load(&executor->worker_idle_mask,
+                                   iree_memory_order_relaxed,
+                                   &worker_idle_mask);
   // Limit the workers we will steal from to the ones that are currently live
   // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
+  iree_task_worker_set_t victim_mask;
+  iree_task_worker_set_and_not(&worker_live_mask, &worker_idle_mask,
+                               &victim_mask);
 
   // TODO(benvanik): it may be possible to rework this such that we better
   // use the prng; for example, instead of all this rotating stuff we could just
   // generate an 8-bit number (or even split it into two 4-bit numbers) per
   // theft attempt. The current rotation strategy is biased toward the same try
   // ordering vs. what we may really want with an unbiased random selection.
-  int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
-                        (8 * sizeof(iree_task_affinity_set_t) - 1);
-
-  // Try first with the workers we may have some caches shared with. This
-  // helps to prevent cache invalidations/availability updates as it's likely
-  // that we won't need to go back to main memory (or higher cache tiers) in the
-  // event that the thief and victim are running close to each other in time.
-  iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
-  if (task) {
-    IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
-  } else {
-    task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+  iree_host_size_t rotation_offset =
+      iree_prng_minilcg128_next_uint8(theft_prng) % executor->worker_count;
+
+  // Last level caches never span NUMA nodes; limiting the level to the node
+  // keeps topologies without cache information (where the mask is all workers)
+  // from skipping over the node level.
+  iree_task_worker_set_t llc_node_sharing_mask;
+  iree_task_worker_set_and(llc_sharing_mask, node_sharing_mask,
+                           &llc_node_sharing_mask);
+  const struct {
+    const iree_task_worker_set_t* sharing_mask;  // NULL for all workers
+    iree_host_size_t max_theft_task_count;
+    const char* trace_name;
+  } levels[] = {
+      {constructive_sharing_mask,
+       IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_SHARED_CACHE, "local"},
+      {&llc_node_sharing_mask,
+       IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_SHARED_LLC, "llc"},
+      {node_sharing_mask, IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_SAME_NODE,
+       "node"},
+      {NULL, IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_REMOTE, "non-local"},
+  };
+  iree_task_t* task = NULL;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(levels) && !task; ++i) {
+    // Victims at this level excluding those already tried at inner levels.
+    iree_task_worker_set_t level_mask = victim_mask;
+    if (levels[i].sharing_mask) {
+      iree_task_worker_set_and(&victim_mask, levels[i].sharing_mask,
+                               &level_mask);
+      iree_task_worker_set_and_not(&victim_mask, levels[i].sharing_mask,
+                                   &victim_mask);
+    }
+    task = iree_task_executor_try_steal_task_from_worker_set(
+        executor, &level_mask, max_theft_attempts,
+        levels[i].max_theft_task_count, rotation_offset, local_task_queue);
     if (task) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, levels[i].trace_name);
     }
   }
 
@@ -268,6 +268,28 @@ enum iree_task_scheduling_mode_bits_t {
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
+// Controls how workers wait for new work after running out.
+// Waking a parked worker requires a round trip through the system scheduler
+// that can take tens of microseconds and dominate the latency of small
+// dispatches. Spinning and yielding before parking trades CPU time for lower
+// wake latency when new work is expected to arrive soon.
+enum iree_task_worker_idle_policy_e {
+  // Workers spin for up to worker_spin_ns and then park in the system.
+  // With the default worker_spin_ns of 0 workers park immediately.
+  IREE_TASK_WORKER_IDLE_POLICY_PARK = 0u,
+  // Workers spin for up to worker_spin_ns, yield their thread to the system
+  // scheduler for up to worker_yield_ns, and then park.
+  IREE_TASK_WORKER_IDLE_POLICY_SPIN_YIELD_PARK,
+  // As with IREE_TASK_WORKER_IDLE_POLICY_SPIN_YIELD_PARK but each worker adapts
+  // its spin and yield durations to how quickly work has arrived in the past.
+  // The budget grows (up to the configured durations) when work arrives while
+  // spinning or shortly after parking and shrinks when workers park for long
+  // periods. This keeps latency low during bursts of small dispatches without
+  // burning cores while the executor is mostly idle.
+  IREE_TASK_WORKER_IDLE_POLICY_ADAPTIVE,
+};
+typedef uint32_t iree_task_worker_idle_policy_t;
+
 // Options controlling task executor behavior.
 typedef struct iree_task_executor_options_t {
   // Specifies the schedule mode used for worker and workload balancing.
@@ -288,6 +310,23 @@ typedef struct iree_task_executor_options_t {
   // scheduling, and the environment).
   iree_duration_t worker_spin_ns;
 
+  // Policy used by workers waiting for new work.
+  iree_task_worker_idle_policy_t worker_idle_policy;
+
+  // Maximum duration in nanoseconds each worker should yield its thread to the
+  // system scheduler after spinning and before parking. Only used by idle
+  // policies that yield. Yielding is cheaper for the rest of the system than
+  // spinning but wakes are slower as the worker may not be rescheduled
+  // immediately.
+  iree_duration_t worker_yield_ns;
+
+  // Measures the latency between work being posted to a waiting worker and
+  // the worker resuming as reported by
+  // iree_task_executor_consume_worker_idle_statistics. Requires querying the
+  // time on every wake and is always enabled by idle policies other than
+  // IREE_TASK_WORKER_IDLE_POLICY_PARK.
+  bool worker_wake_latency_statistics;
+
   // Minimum size in bytes of each worker thread stack.
   // The underlying platform may allocate more stack space but _should_
   // guarantee that the available stack space is near this amount. Note that the
@@ -297,12 +336,19 @@ typedef struct iree_task_executor_options_t {
   iree_host_size_t worker_stack_size;
 
   // Defines the bytes to be allocated and reserved by each worker to use for
-  // local memory operations. Will be rounded up to the next power of two.
-  // Dispatches performed will be able to request up to this amount of memory
-  // for their invocations and no more. May be 0 if no worker local memory is
-  // required.
+  // local memory operations. Will be rounded up to the page size.
+  // Workers allocate this amount when they start and grow their local memory
+  // when they execute dispatches requiring more such that each arena ends up
+  // sized to the largest dispatch it executes. May be 0 to defer allocation
+  // until a dispatch requires local memory.
   // By default the CPU L2 cache size is used if such queries are supported.
   iree_host_size_t worker_local_memory_size;
+
+  // Maximum bytes of local memory each worker may grow to. Dispatches requiring
+  // more fail with IREE_STATUS_RESOURCE_EXHAUSTED. Never lower than
+  // worker_local_memory_size. 0 uses
+  // IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT.
+  iree_host_size_t worker_local_memory_limit;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -336,6 +382,39 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Returns the NUMA node all workers of the executor are placed on or
+// IREE_TASK_TOPOLOGY_NODE_ID_ANY if they span nodes or the node is unknown.
+// Memory used predominantly by work scheduled on the executor should be placed
+// on this node.
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor);
+
+// Statistics describing how a worker waited for new work.
+typedef struct iree_task_worker_idle_statistics_t {
+  // Number of times the worker ran out of work and waited for more.
+  uint64_t wait_count;
+  // Number of waits that ended while the worker was spinning or yielding.
+  uint64_t spin_wake_count;
+  // Number of waits that parked the worker in the system.
+  uint64_t park_count;
+  // Total time spent spinning and yielding in nanoseconds.
+  iree_duration_t spin_duration_ns;
+  // Number of wakes that measured a latency. Only measured when
+  // worker_wake_latency_statistics is enabled.
+  uint64_t wake_count;
+  // Total and maximum time in nanoseconds between work being posted to the
+  // worker while it was waiting and the worker resuming.
+  iree_duration_t total_wake_latency_ns;
+  iree_duration_t max_wake_latency_ns;
+} iree_task_worker_idle_statistics_t;
+
+// Returns and resets the idle statistics of the worker with the executor-local
+// |worker_index|. Statistics are accumulated by each worker independently and
+// may be consumed from any thread.
+iree_status_t iree_task_executor_consume_worker_idle_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_worker_idle_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -0,0 +1,893 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/memory.h"
+#include "iree/base/internal/prng.h"
+#include "iree/task/api.h"
+#include "iree/testing/benchmark.h"
+
+//===----------------------------------------------------------------------===//
+// Utilities
+//===----------------------------------------------------------------------===//
+
+// Creates an executor with |worker_count| workers and no particular topology.
+static iree_task_executor_t* iree_task_executor_benchmark_create(
+    iree_task_executor_options_t options, iree_host_size_t worker_count,
+    iree_allocator_t host_allocator) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(
+      iree_task_executor_create(options, &topology, host_allocator, &executor));
+  iree_task_topology_deinitialize(&topology);
+  return executor;
+}
+
+// Submits the task graph starting at |head_task| and ending at |tail_task| to
+// |executor|. The caller must wait on |scope| for the graph to complete.
+static void iree_task_executor_benchmark_submit(iree_task_executor_t* executor,
+                                                iree_task_scope_t* scope,
+                                                iree_task_t* head_task,
+                                                iree_task_t* tail_task) {
+  iree_task_fence_t* fence = NULL;
+  IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, scope, &fence));
+  iree_task_set_completion_task(tail_task, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, head_task);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+}
+
+//===----------------------------------------------------------------------===//
+// NUMA placement
+//===----------------------------------------------------------------------===//
+
+// Simulates NUMA placement of dispatch work using fake topologies.
+//
+// Workers are grouped into fake NUMA nodes in the same way as
+// `numactl --cpunodebind=N --membind=N` would partition a real machine and
+// each node is given a buffer that its dispatches stream over. On machines with
+// real NUMA nodes matching the fake ones the buffers are bound to the nodes and
+// the benchmark measures the cost of remote memory access; on machines without
+// them the binding is skipped and the benchmark measures the scheduling
+// overhead of the node-aware policies.
+
+// Total number of workers across all fake NUMA nodes.
+#define IREE_TASK_NUMA_BENCHMARK_WORKER_COUNT 8
+
+// Maximum number of fake NUMA nodes in a topology.
+#define IREE_TASK_NUMA_BENCHMARK_MAX_NODES 4
+
+// Size of the buffer each node streams over per dispatch. Large enough that it
+// won't fit in the last level cache of most machines.
+#define IREE_TASK_NUMA_BENCHMARK_BUFFER_SIZE (16 * 1024 * 1024)
+
+// Bytes of the node buffer processed by each workgroup.
+#define IREE_TASK_NUMA_BENCHMARK_SLICE_SIZE (64 * 1024)
+
+#define IREE_TASK_NUMA_BENCHMARK_SLICE_COUNT \
+  (IREE_TASK_NUMA_BENCHMARK_BUFFER_SIZE / IREE_TASK_NUMA_BENCHMARK_SLICE_SIZE)
+
+typedef enum iree_task_numa_benchmark_mode_e {
+  // A single executor spanning all nodes without any node information.
+  // This is how executors behaved prior to NUMA awareness.
+  IREE_TASK_NUMA_BENCHMARK_MODE_FLAT = 0,
+  // A single executor spanning all nodes with node IDs assigned to the groups
+  // such that work stealing prefers victims on the same node.
+  IREE_TASK_NUMA_BENCHMARK_MODE_STEAL,
+  // One executor per node as with `--task_topology_nodes=`. Dispatches are
+  // routed to the executor on the node owning their buffer.
+  IREE_TASK_NUMA_BENCHMARK_MODE_SPLIT,
+} iree_task_numa_benchmark_mode_t;
+
+// Memory owned by a single fake node.
+typedef struct iree_task_numa_benchmark_node_t {
+  // Buffer streamed over by the dispatches of the node.
+  uint8_t* buffer;
+  // Sum of each slice of the buffer as computed by the dispatch workgroups.
+  uint64_t slice_sums[IREE_TASK_NUMA_BENCHMARK_SLICE_COUNT];
+} iree_task_numa_benchmark_node_t;
+
+// Sums one slice of the iree_task_numa_benchmark_node_t in |user_context|.
+static iree_status_t iree_task_numa_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  iree_task_numa_benchmark_node_t* node =
+      (iree_task_numa_benchmark_node_t*)user_context;
+  const uint32_t slice_index = tile_context->workgroup_xyz[0];
+  const uint64_t* slice =
+      (const uint64_t*)(node->buffer +
+                        slice_index * IREE_TASK_NUMA_BENCHMARK_SLICE_SIZE);
+  uint64_t sum = 0;
+  for (iree_host_size_t i = 0;
+       i < IREE_TASK_NUMA_BENCHMARK_SLICE_SIZE / sizeof(uint64_t); ++i) {
+    sum += slice[i];
+  }
+  node->slice_sums[slice_index] = sum;
+  return iree_ok_status();
+}
+
+// Populates |out_topology| with the groups of the fake nodes in
+// [node_begin, node_end). Node IDs are only assigned if |assign_nodes| is set.
+static void iree_task_numa_benchmark_make_topology(
+    iree_host_size_t workers_per_node, iree_host_size_t node_begin,
+    iree_host_size_t node_end, bool assign_nodes,
+    iree_task_topology_t* out_topology) {
+  iree_host_size_t group_count = (node_end - node_begin) * workers_per_node;
+  iree_task_topology_initialize_from_group_count(group_count, out_topology);
+  for (iree_host_size_t i = 0; i < group_count; ++i) {
+    iree_task_topology_group_t* group = &out_topology->groups[i];
+    iree_host_size_t node_index = i / workers_per_node;
+    if (assign_nodes) {
+      group->node_id = (iree_task_topology_node_id_t)(node_begin + node_index);
+    }
+    // Workers on the same node share the last level cache as they would on a
+    // typical multi-socket machine.
+    group->llc_sharing_mask = 0;
+    for (iree_host_size_t j = 0; j < workers_per_node; ++j) {
+      group->llc_sharing_mask |= 1ull << (node_index * workers_per_node + j);
+    }
+    group->constructive_sharing_mask = group->llc_sharing_mask;
+  }
+}
+
+// Streams over one buffer per fake node with a dispatch per node each step.
+static void iree_task_numa_benchmark_run(
+    iree_benchmark_state_t* benchmark_state,
+    iree_task_numa_benchmark_mode_t mode, iree_host_size_t node_count) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_host_size_t workers_per_node =
+      IREE_TASK_NUMA_BENCHMARK_WORKER_COUNT / node_count;
+  const bool assign_nodes = mode != IREE_TASK_NUMA_BENCHMARK_MODE_FLAT;
+
+  // Create the executors; one for all nodes or one per node.
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_t* executors[IREE_TASK_NUMA_BENCHMARK_MAX_NODES] = {NULL};
+  iree_host_size_t executor_count =
+      mode == IREE_TASK_NUMA_BENCHMARK_MODE_SPLIT ? node_count : 1;
+  for (iree_host_size_t i = 0; i < executor_count; ++i) {
+    iree_task_topology_t topology;
+    iree_host_size_t node_begin = executor_count == 1 ? 0 : i;
+    iree_host_size_t node_end = executor_count == 1 ? node_count : i + 1;
+    iree_task_numa_benchmark_make_topology(workers_per_node, node_begin,
+                                           node_end, assign_nodes, &topology);
+    IREE_CHECK_OK(iree_task_executor_create(options, &topology, host_allocator,
+                                            &executors[i]));
+    iree_task_topology_deinitialize(&topology);
+  }
+
+  // Allocate and bind the node buffers before first touch. Binding fails on
+  // machines without the fake node and the buffer is placed by the default
+  // policy instead.
+  iree_task_numa_benchmark_node_t* nodes = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(
+      host_allocator, node_count * sizeof(*nodes), (void**)&nodes));
+  for (iree_host_size_t i = 0; i < node_count; ++i) {
+    IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                        IREE_TASK_NUMA_BENCHMARK_BUFFER_SIZE,
+                                        (void**)&nodes[i].buffer));
+    if (assign_nodes) {
+      iree_status_ignore(iree_memory_bind_range_to_numa_node(
+          nodes[i].buffer, IREE_TASK_NUMA_BENCHMARK_BUFFER_SIZE,
+          (uint32_t)i));
+    }
+    memset(nodes[i].buffer, (int)i + 1, IREE_TASK_NUMA_BENCHMARK_BUFFER_SIZE);
+  }
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(IREE_SV("numa"), IREE_TASK_SCOPE_FLAG_NONE,
+                             &scope);
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {IREE_TASK_NUMA_BENCHMARK_SLICE_COUNT, 1,
+                                       1};
+  iree_task_dispatch_t dispatches[IREE_TASK_NUMA_BENCHMARK_MAX_NODES];
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    for (iree_host_size_t i = 0; i < node_count; ++i) {
+      iree_task_dispatch_initialize(
+          &scope,
+          iree_task_make_dispatch_closure(iree_task_numa_benchmark_tile,
+                                          &nodes[i]),
+          workgroup_size, workgroup_count, &dispatches[i]);
+      iree_task_executor_benchmark_submit(executors[i % executor_count], &scope,
+                                          &dispatches[i].header,
+                                          &dispatches[i].header);
+    }
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    ++batch_count;
+  }
+  iree_benchmark_set_bytes_processed(
+      benchmark_state,
+      batch_count * (int64_t)node_count * IREE_TASK_NUMA_BENCHMARK_BUFFER_SIZE);
+
+  // Cleanup.
+  iree_task_scope_deinitialize(&scope);
+  for (iree_host_size_t i = 0; i < node_count; ++i) {
+    iree_allocator_free(host_allocator, nodes[i].buffer);
+  }
+  iree_allocator_free(host_allocator, nodes);
+  for (iree_host_size_t i = 0; i < executor_count; ++i) {
+    iree_task_executor_release(executors[i]);
+  }
+}
+
+// A single executor without node information.
+//
+// user_data is the number of fake NUMA nodes.
+static iree_status_t iree_task_numa_benchmark_flat_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_numa_benchmark_run(benchmark_state,
+                               IREE_TASK_NUMA_BENCHMARK_MODE_FLAT,
+                               (iree_host_size_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+// A single executor with node-aware work stealing.
+//
+// user_data is the number of fake NUMA nodes.
+static iree_status_t iree_task_numa_benchmark_steal_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_numa_benchmark_run(benchmark_state,
+                               IREE_TASK_NUMA_BENCHMARK_MODE_STEAL,
+                               (iree_host_size_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+// One executor per node.
+//
+// user_data is the number of fake NUMA nodes.
+static iree_status_t iree_task_numa_benchmark_split_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_numa_benchmark_run(benchmark_state,
+                               IREE_TASK_NUMA_BENCHMARK_MODE_SPLIT,
+                               (iree_host_size_t)benchmark_def->user_data);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Worker scaling
+//===----------------------------------------------------------------------===//
+
+// Measures how the executor scales with large worker counts.
+//
+// Each step runs the same task graph as executor_demo.cc: a call fanning out to
+// two concurrent dispatches that join on a second call. Dispatch grids are
+// sized so that the total amount of work is fixed regardless of worker count
+// (strong scaling). Workers are not pinned to processors and on machines with
+// fewer cores than workers the benchmark measures the overhead of posting to
+// and stealing from the additional workers instead of any speedup.
+
+// State shared by all tiles of a scaling dispatch.
+typedef struct iree_task_scaling_benchmark_dispatch_t {
+  // Number of PRNG iterations performed by each tile. Small values measure
+  // scheduling overhead and large values measure throughput.
+  uint32_t tile_work;
+  // One result per workgroup of the dispatch.
+  uint64_t* tile_results;
+} iree_task_scaling_benchmark_dispatch_t;
+
+static iree_status_t iree_task_scaling_benchmark_call(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  return iree_ok_status();
+}
+
+// Simulates work for a tile of the iree_task_scaling_benchmark_dispatch_t in
+// |user_context|.
+static iree_status_t iree_task_scaling_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_task_scaling_benchmark_dispatch_t* dispatch =
+      (const iree_task_scaling_benchmark_dispatch_t*)user_context;
+  const uint32_t* count = tile_context->workgroup_count;
+  const uint32_t* xyz = tile_context->workgroup_xyz;
+  const iree_host_size_t tile_index =
+      ((iree_host_size_t)xyz[2] * count[1] + xyz[1]) * count[0] + xyz[0];
+  iree_prng_splitmix64_state_t state;
+  iree_prng_splitmix64_initialize(tile_index, &state);
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < dispatch->tile_work; ++i) {
+    sum += iree_prng_splitmix64_next(&state);
+  }
+  dispatch->tile_results[tile_index] = sum;
+  return iree_ok_status();
+}
+
+// Runs the executor_demo.cc task graph on an executor with |worker_count|
+// workers with each tile performing |tile_work| iterations.
+static void iree_task_scaling_benchmark_run(
+    iree_benchmark_state_t* benchmark_state, iree_host_size_t worker_count,
+    uint32_t tile_work) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  if (worker_count > IREE_TASK_EXECUTOR_MAX_WORKER_COUNT) {
+    iree_benchmark_skip(benchmark_state, "worker count exceeds maximum");
+    return;
+  }
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_t* executor = iree_task_executor_benchmark_create(
+      options, worker_count, host_allocator);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(IREE_SV("scaling"), IREE_TASK_SCOPE_FLAG_NONE,
+                             &scope);
+
+  // Grids have the same shapes as executor_demo.cc but enough tiles to keep
+  // all workers busy.
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count_0[3] = {4096, 4, 2};
+  const uint32_t workgroup_count_1[3] = {4096, 2, 1};
+  const iree_host_size_t tile_count_0 =
+      workgroup_count_0[0] * workgroup_count_0[1] * workgroup_count_0[2];
+  const iree_host_size_t tile_count_1 =
+      workgroup_count_1[0] * workgroup_count_1[1] * workgroup_count_1[2];
+  uint64_t* tile_results = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(
+      host_allocator, (tile_count_0 + tile_count_1) * sizeof(*tile_results),
+      (void**)&tile_results));
+  iree_task_scaling_benchmark_dispatch_t dispatch_state_0 = {
+      .tile_work = tile_work,
+      .tile_results = tile_results,
+  };
+  iree_task_scaling_benchmark_dispatch_t dispatch_state_1 = {
+      .tile_work = tile_work,
+      .tile_results = tile_results + tile_count_0,
+  };
+
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_task_call_t call0;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(iree_task_scaling_benchmark_call, NULL),
+        &call0);
+    iree_task_dispatch_t dispatch0;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(iree_task_scaling_benchmark_tile,
+                                        &dispatch_state_0),
+        workgroup_size, workgroup_count_0, &dispatch0);
+    iree_task_dispatch_t dispatch1;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(iree_task_scaling_benchmark_tile,
+                                        &dispatch_state_1),
+        workgroup_size, workgroup_count_1, &dispatch1);
+    iree_task_call_t call1;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(iree_task_scaling_benchmark_call, NULL),
+        &call1);
+
+    // Fan out from call0 to both dispatches and join on call1.
+    iree_task_t* barrier_tasks[2] = {&dispatch0.header, &dispatch1.header};
+    iree_task_barrier_t barrier;
+    iree_task_barrier_initialize(&scope, IREE_ARRAYSIZE(barrier_tasks),
+                                 barrier_tasks, &barrier);
+    iree_task_set_completion_task(&call0.header, &barrier.header);
+    iree_task_set_completion_task(&dispatch0.header, &call1.header);
+    iree_task_set_completion_task(&dispatch1.header, &call1.header);
+
+    iree_task_executor_benchmark_submit(executor, &scope, &call0.header,
+                                        &call1.header);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    ++batch_count;
+  }
+  iree_benchmark_set_items_processed(
+      benchmark_state, batch_count * (int64_t)(tile_count_0 + tile_count_1));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_allocator_free(host_allocator, tile_results);
+}
+
+// Near-empty tiles measuring the scheduling overhead of the workers.
+//
+// user_data is the number of workers.
+static iree_status_t iree_task_scaling_benchmark_overhead_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_scaling_benchmark_run(benchmark_state,
+                                  (iree_host_size_t)benchmark_def->user_data,
+                                  /*tile_work=*/1);
+  return iree_ok_status();
+}
+
+// Tiles with enough work to measure throughput.
+//
+// user_data is the number of workers.
+static iree_status_t iree_task_scaling_benchmark_work_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_scaling_benchmark_run(benchmark_state,
+                                  (iree_host_size_t)benchmark_def->user_data,
+                                  /*tile_work=*/4 * 1024);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Worker local memory
+//===----------------------------------------------------------------------===//
+
+// Measures dispatches whose workgroups use large amounts of local memory.
+//
+// Each workgroup packs a tile into the local memory arena of the worker running
+// it and then consumes it by writing and reading back one value per cache line.
+// Arenas grow on the first dispatch and are reused by all later ones.
+
+// Number of workers in the executor.
+#define IREE_TASK_LOCAL_MEMORY_BENCHMARK_WORKER_COUNT 4
+
+// Number of workgroups in each dispatch.
+#define IREE_TASK_LOCAL_MEMORY_BENCHMARK_WORKGROUP_COUNT 16
+
+// Streams through the local memory of a tile and stores the result in the
+// per-workgroup results in |user_context|.
+static iree_status_t iree_task_local_memory_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  uint32_t* results = (uint32_t*)user_context;
+  const uint32_t workgroup_id = tile_context->workgroup_xyz[0];
+  uint32_t* values = (uint32_t*)tile_context->local_memory.data;
+  const iree_host_size_t stride =
+      iree_hardware_destructive_interference_size / sizeof(uint32_t);
+  const iree_host_size_t count =
+      tile_context->local_memory.data_length / sizeof(uint32_t);
+  for (iree_host_size_t i = 0; i < count; i += stride) {
+    values[i] = workgroup_id + (uint32_t)i;
+  }
+  uint32_t sum = 0;
+  for (iree_host_size_t i = 0; i < count; i += stride) {
+    sum += values[i];
+  }
+  results[workgroup_id] = sum;
+  return iree_ok_status();
+}
+
+// Runs dispatches whose workgroups each use the full local memory limit.
+//
+// user_data is the local memory size of each workgroup in KB.
+static iree_status_t iree_task_local_memory_benchmark_dispatch_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_host_size_t local_memory_size =
+      (iree_host_size_t)benchmark_def->user_data * 1024;
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_limit = local_memory_size;
+  iree_task_executor_t* executor = iree_task_executor_benchmark_create(
+      options, IREE_TASK_LOCAL_MEMORY_BENCHMARK_WORKER_COUNT,
+      benchmark_state->host_allocator);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(IREE_SV("local_memory"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {
+      IREE_TASK_LOCAL_MEMORY_BENCHMARK_WORKGROUP_COUNT, 1, 1};
+  uint32_t results[IREE_TASK_LOCAL_MEMORY_BENCHMARK_WORKGROUP_COUNT] = {0};
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(iree_task_local_memory_benchmark_tile,
+                                        results),
+        workgroup_size, workgroup_count, &dispatch);
+    dispatch.local_memory_size = local_memory_size;
+    iree_task_executor_benchmark_submit(executor, &scope, &dispatch.header,
+                                        &dispatch.header);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    IREE_CHECK_OK(iree_task_scope_consume_status(&scope));
+    ++batch_count;
+  }
+  iree_benchmark_set_items_processed(
+      benchmark_state,
+      batch_count * IREE_TASK_LOCAL_MEMORY_BENCHMARK_WORKGROUP_COUNT);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Worker idle policies
+//===----------------------------------------------------------------------===//
+
+// Measures the latency of small dispatches submitted to idle workers.
+//
+// Each step submits a dispatch with one tiny tile per worker and waits for it
+// to complete. Between steps the submitting thread waits for a fixed gap
+// (excluded from timing) so that workers run out of work and go idle the same
+// way they would between the dispatches of a small latency-sensitive model.
+// The worker idle policy determines whether the workers are still spinning
+// when the next dispatch arrives or must be woken from the system.
+//
+// The label of each benchmark reports the worker wake latency and the fraction
+// of waits that ended while spinning as gathered from the executor idle
+// statistics.
+
+// Number of workers in the executor.
+#define IREE_TASK_IDLE_BENCHMARK_WORKER_COUNT 4
+
+static iree_status_t iree_task_idle_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  return iree_ok_status();
+}
+
+// Sets the benchmark label to the aggregate idle statistics of all workers.
+static void iree_task_idle_benchmark_report(
+    iree_benchmark_state_t* benchmark_state, iree_task_executor_t* executor) {
+  iree_task_worker_idle_statistics_t total;
+  memset(&total, 0, sizeof(total));
+  for (iree_host_size_t i = 0; i < iree_task_executor_worker_count(executor);
+       ++i) {
+    iree_task_worker_idle_statistics_t statistics;
+    IREE_CHECK_OK(iree_task_executor_consume_worker_idle_statistics(
+        executor, i, &statistics));
+    total.wait_count += statistics.wait_count;
+    total.spin_wake_count += statistics.spin_wake_count;
+    total.wake_count += statistics.wake_count;
+    total.total_wake_latency_ns += statistics.total_wake_latency_ns;
+    total.max_wake_latency_ns =
+        iree_max(total.max_wake_latency_ns, statistics.max_wake_latency_ns);
+  }
+  char label[128];
+  snprintf(label, sizeof(label),
+           "wake_avg=%.1fus wake_max=%.1fus spin_wakes=%.0f%%",
+           total.wake_count ? total.total_wake_latency_ns /
+                                  (double)total.wake_count / 1000.0
+                            : 0.0,
+           total.max_wake_latency_ns / 1000.0,
+           total.wait_count ? 100.0 * total.spin_wake_count / total.wait_count
+                            : 0.0);
+  iree_benchmark_set_label(benchmark_state, label);
+}
+
+// Submits small dispatches to an executor created with the idle policy in
+// |options| waiting |gap_ns| between the completion of one dispatch and the
+// submission of the next.
+static void iree_task_idle_benchmark_run(
+    iree_benchmark_state_t* benchmark_state,
+    iree_task_executor_options_t options, iree_duration_t gap_ns) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_task_executor_t* executor = iree_task_executor_benchmark_create(
+      options, IREE_TASK_IDLE_BENCHMARK_WORKER_COUNT, host_allocator);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(IREE_SV("idle"), IREE_TASK_SCOPE_FLAG_NONE,
+                             &scope);
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {IREE_TASK_IDLE_BENCHMARK_WORKER_COUNT, 1,
+                                       1};
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(iree_task_idle_benchmark_tile, NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    iree_task_executor_benchmark_submit(executor, &scope, &dispatch.header,
+                                        &dispatch.header);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    ++batch_count;
+
+    // Let the workers go idle before the next dispatch.
+    iree_benchmark_pause_timing(benchmark_state);
+    iree_wait_until(iree_time_now() + gap_ns);
+    iree_benchmark_resume_timing(benchmark_state);
+  }
+  iree_benchmark_set_items_processed(benchmark_state, batch_count);
+  iree_task_idle_benchmark_report(benchmark_state, executor);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Workers park immediately when they run out of work.
+//
+// user_data is the gap between dispatches in microseconds.
+static iree_status_t iree_task_idle_benchmark_park_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_idle_policy = IREE_TASK_WORKER_IDLE_POLICY_PARK;
+  options.worker_spin_ns = 0;
+  options.worker_wake_latency_statistics = true;
+  iree_task_idle_benchmark_run(
+      benchmark_state, options,
+      (iree_duration_t)(uintptr_t)benchmark_def->user_data * 1000);
+  return iree_ok_status();
+}
+
+// Workers spin for 100us before parking.
+//
+// user_data is the gap between dispatches in microseconds.
+static iree_status_t iree_task_idle_benchmark_spin_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_idle_policy = IREE_TASK_WORKER_IDLE_POLICY_PARK;
+  options.worker_spin_ns = 100 * 1000;
+  options.worker_wake_latency_statistics = true;
+  iree_task_idle_benchmark_run(
+      benchmark_state, options,
+      (iree_duration_t)(uintptr_t)benchmark_def->user_data * 1000);
+  return iree_ok_status();
+}
+
+// Workers spin for 50us and yield for 50us before parking.
+//
+// user_data is the gap between dispatches in microseconds.
+static iree_status_t iree_task_idle_benchmark_spin_yield_park_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_idle_policy = IREE_TASK_WORKER_IDLE_POLICY_SPIN_YIELD_PARK;
+  options.worker_spin_ns = 50 * 1000;
+  options.worker_yield_ns = 50 * 1000;
+  iree_task_idle_benchmark_run(
+      benchmark_state, options,
+      (iree_duration_t)(uintptr_t)benchmark_def->user_data * 1000);
+  return iree_ok_status();
+}
+
+// Workers adapt the 50us spin and yield budgets to observed wake latencies.
+//
+// user_data is the gap between dispatches in microseconds.
+static iree_status_t iree_task_idle_benchmark_adaptive_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_idle_policy = IREE_TASK_WORKER_IDLE_POLICY_ADAPTIVE;
+  options.worker_spin_ns = 50 * 1000;
+  options.worker_yield_ns = 50 * 1000;
+  iree_task_idle_benchmark_run(
+      benchmark_state, options,
+      (iree_duration_t)(uintptr_t)benchmark_def->user_data * 1000);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// main
+//===----------------------------------------------------------------------===//
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_task_numa_benchmark_flat_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_numa_benchmark_flat_n,
+    };
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("numa_flat_1"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)2u;
+    iree_benchmark_register(iree_make_cstring_view("numa_flat_2"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)4u;
+    iree_benchmark_register(iree_make_cstring_view("numa_flat_4"),
+                            &benchmark_def);
+  }
+
+  // iree_task_numa_benchmark_steal_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_numa_benchmark_steal_n,
+    };
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("numa_steal_1"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)2u;
+    iree_benchmark_register(iree_make_cstring_view("numa_steal_2"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)4u;
+    iree_benchmark_register(iree_make_cstring_view("numa_steal_4"),
+                            &benchmark_def);
+  }
+
+  // iree_task_numa_benchmark_split_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_numa_benchmark_split_n,
+    };
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("numa_split_1"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)2u;
+    iree_benchmark_register(iree_make_cstring_view("numa_split_2"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)4u;
+    iree_benchmark_register(iree_make_cstring_view("numa_split_4"),
+                            &benchmark_def);
+  }
+
+  // iree_task_scaling_benchmark_overhead_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_scaling_benchmark_overhead_n,
+    };
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("scaling_overhead_64"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)128u;
+    iree_benchmark_register(iree_make_cstring_view("scaling_overhead_128"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("scaling_overhead_256"),
+                            &benchmark_def);
+  }
+
+  // iree_task_scaling_benchmark_work_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_scaling_benchmark_work_n,
+    };
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("scaling_work_64"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)128u;
+    iree_benchmark_register(iree_make_cstring_view("scaling_work_128"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("scaling_work_256"),
+                            &benchmark_def);
+  }
+
+  // iree_task_local_memory_benchmark_dispatch_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_local_memory_benchmark_dispatch_n,
+    };
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("local_memory_256KB"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(4u * 1024u);
+    iree_benchmark_register(iree_make_cstring_view("local_memory_4MB"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)(32u * 1024u);
+    iree_benchmark_register(iree_make_cstring_view("local_memory_32MB"),
+                            &benchmark_def);
+  }
+
+  // iree_task_idle_benchmark_park_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_idle_benchmark_park_n,
+    };
+    benchmark_def.user_data = (void*)10u;
+    iree_benchmark_register(iree_make_cstring_view("idle_park_gap10us"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)100u;
+    iree_benchmark_register(iree_make_cstring_view("idle_park_gap100us"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)1000u;
+    iree_benchmark_register(iree_make_cstring_view("idle_park_gap1000us"),
+                            &benchmark_def);
+  }
+
+  // iree_task_idle_benchmark_spin_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_idle_benchmark_spin_n,
+    };
+    benchmark_def.user_data = (void*)10u;
+    iree_benchmark_register(iree_make_cstring_view("idle_spin_gap10us"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)100u;
+    iree_benchmark_register(iree_make_cstring_view("idle_spin_gap100us"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)1000u;
+    iree_benchmark_register(iree_make_cstring_view("idle_spin_gap1000us"),
+                            &benchmark_def);
+  }
+
+  // iree_task_idle_benchmark_spin_yield_park_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_idle_benchmark_spin_yield_park_n,
+    };
+    benchmark_def.user_data = (void*)10u;
+    iree_benchmark_register(
+        iree_make_cstring_view("idle_spin_yield_park_gap10us"), &benchmark_def);
+    benchmark_def.user_data = (void*)100u;
+    iree_benchmark_register(
+        iree_make_cstring_view("idle_spin_yield_park_gap100us"),
+        &benchmark_def);
+    benchmark_def.user_data = (void*)1000u;
+    iree_benchmark_register(
+        iree_make_cstring_view("idle_spin_yield_park_gap1000us"),
+        &benchmark_def);
+  }
+
+  // iree_task_idle_benchmark_adaptive_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_idle_benchmark_adaptive_n,
+    };
+    benchmark_def.user_data = (void*)10u;
+    iree_benchmark_register(iree_make_cstring_view("idle_adaptive_gap10us"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)100u;
+    iree_benchmark_register(iree_make_cstring_view("idle_adaptive_gap100us"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)1000u;
+    iree_benchmark_register(iree_make_cstring_view("idle_adaptive_gap1000us"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -42,6 +42,18 @@ struct iree_task_executor_t {
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
+  // Policy used by workers waiting for new work and the maximum time they
+  // yield their threads before parking.
+  iree_task_worker_idle_policy_t worker_idle_policy;
+  iree_duration_t worker_yield_ns;
+
+  // Maximum size in bytes each worker may grow its local memory arena to.
+  iree_host_size_t worker_local_memory_limit;
+
+  // True if workers measure their wake latency. Posting work to waiting
+  // workers only queries the time when set.
+  bool worker_wake_latency_statistics;
+
   // State used by the work-stealing operations performed by donated threads.
   // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
   // much care about the precise selection of workers enough to mind any tears
@@ -103,9 +115,9 @@ struct iree_task_executor_t {
   // be OK with getting slightly out-of-date information. The only way to get
   // an authoritative answer to the question "is this worker live" is to
   // atomically query worker->state. This mask is for usage patterns where one
-  // needs a cheap (single relaxed atomic op) approximation of all N workers'
-  // live state without having to perform N expensive atomic ops.
-  iree_atomic_task_affinity_set_t worker_live_mask;
+  // needs a cheap (one relaxed atomic op per 64 workers) approximation of all N
+  // workers' live state without having to perform N expensive atomic ops.
+  iree_atomic_task_worker_set_t worker_live_mask;
 
   // A bitset indicating which workers are currently idle. Used to bias incoming
   // tasks to workers that aren't doing much else. This is a balance of latency
@@ -114,7 +126,7 @@ struct iree_task_executor_t {
   //
   // This mask is just a hint, accessed with memory_order_relaxed. See the
   // comment on worker_live_mask.
-  iree_atomic_task_affinity_set_t worker_idle_mask;
+  iree_atomic_task_worker_set_t worker_idle_mask;
 
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
@@ -126,6 +138,10 @@ struct iree_task_executor_t {
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // NUMA node shared by all workers or IREE_TASK_TOPOLOGY_NODE_ID_ANY if the
+  // workers span multiple nodes (or the node is unknown).
+  iree_task_topology_node_id_t node_id;
 };
 
 // Merges a submission into the primary FIFO queues.
@@ -157,9 +173,14 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
+// Victims sharing L1/L2 caches (|constructive_sharing_mask|) are tried first
+// followed by those sharing the last level cache (|llc_sharing_mask|), those on
+// the same NUMA node (|node_sharing_mask|), and then all others.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
-    iree_task_affinity_set_t constructive_sharing_mask,
+    const iree_task_worker_set_t* constructive_sharing_mask,
+    const iree_task_worker_set_t* llc_sharing_mask,
+    const iree_task_worker_set_t* node_sharing_mask,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
@@ -13,6 +13,10 @@
 
 namespace {
 
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
 // Tests that an executor can be created and destroyed repeatedly without
 // running out of system resources. Since all systems are different there's no
 // guarantee this will fail but it does give ASAN/TSAN some nice stuff to chew
@@ -135,4 +139,93 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests serialized submission with each worker idle policy and that idle
+// statistics are gathered for each worker.
+TEST(ExecutorTest, IdlePolicies) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+
+  const iree_task_worker_idle_policy_t idle_policies[] = {
+      IREE_TASK_WORKER_IDLE_POLICY_PARK,
+      IREE_TASK_WORKER_IDLE_POLICY_SPIN_YIELD_PARK,
+      IREE_TASK_WORKER_IDLE_POLICY_ADAPTIVE,
+  };
+  for (iree_task_worker_idle_policy_t idle_policy : idle_policies) {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    options.worker_local_memory_size = 64 * 1024;
+    options.worker_idle_policy = idle_policy;
+    options.worker_spin_ns = 10 * 1000;
+    options.worker_yield_ns = 10 * 1000;
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_scope_t scope;
+    iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                               IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+    for (int i = 0; i < 100; ++i) {
+      static std::atomic<int> received_value = {0};
+      iree_task_call_t call;
+      iree_task_call_initialize(
+          &scope,
+          iree_task_make_call_closure(
+              [](void* user_context, iree_task_t* task,
+                 iree_task_submission_t* pending_submission) {
+                received_value = (int)(uintptr_t)user_context;
+                return iree_ok_status();
+              },
+              (void*)(uintptr_t)i),
+          &call);
+
+      iree_task_fence_t* fence = NULL;
+      IREE_ASSERT_OK(
+          iree_task_executor_acquire_fence(executor, &scope, &fence));
+      iree_task_set_completion_task(&call.header, &fence->header);
+
+      iree_task_submission_t submission;
+      iree_task_submission_initialize(&submission);
+      iree_task_submission_enqueue(&submission, &call.header);
+      iree_task_executor_submit(executor, &submission);
+      iree_task_executor_flush(executor);
+      IREE_ASSERT_OK(
+          iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+      EXPECT_EQ(received_value, i) << "call did not correlate to loop";
+    }
+
+    uint64_t total_wait_count = 0;
+    for (iree_host_size_t j = 0; j < iree_task_executor_worker_count(executor);
+         ++j) {
+      iree_task_worker_idle_statistics_t statistics;
+      IREE_ASSERT_OK(iree_task_executor_consume_worker_idle_statistics(
+          executor, j, &statistics));
+      // The worker may be in the middle of a wait that has been counted but
+      // not yet resolved to a spin wake or a park.
+      EXPECT_LE(statistics.spin_wake_count + statistics.park_count,
+                statistics.wait_count);
+      EXPECT_LE(statistics.wait_count,
+                statistics.spin_wake_count + statistics.park_count + 1);
+      EXPECT_LE(statistics.max_wake_latency_ns,
+                statistics.total_wake_latency_ns);
+      if (idle_policy == IREE_TASK_WORKER_IDLE_POLICY_PARK) {
+        // Wake latency is only measured when requested.
+        EXPECT_EQ(statistics.wake_count, 0);
+      }
+      total_wait_count += statistics.wait_count;
+    }
+    EXPECT_GT(total_wait_count, 0);
+    iree_task_worker_idle_statistics_t statistics;
+    EXPECT_THAT(Status(iree_task_executor_consume_worker_idle_statistics(
+                    executor, iree_task_executor_worker_count(executor),
+                    &statistics)),
+                StatusIs(StatusCode::kOutOfRange));
+
+    iree_task_scope_deinitialize(&scope);
+    iree_task_executor_release(executor);
+  }
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
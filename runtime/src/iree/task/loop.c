@@ -0,0 +1,387 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/loop.h"
+
+#include "iree/task/scope.h"
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
+
+//===----------------------------------------------------------------------===//
+// iree_task_loop_t
+//===----------------------------------------------------------------------===//
+
+struct iree_task_loop_t {
+  iree_allocator_t allocator;
+  iree_task_executor_t* executor;
+  iree_task_loop_options_t options;
+
+  // Scope used for all tasks issued by the loop. Operations route their
+  // failures to their callbacks and the scope is only used to track whether
+  // any operations are pending.
+  iree_task_scope_t scope;
+};
+
+IREE_API_EXPORT iree_status_t iree_task_loop_allocate(
+    iree_task_loop_options_t options, iree_task_executor_t* executor,
+    iree_allocator_t allocator, iree_task_loop_t** out_loop) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(out_loop);
+  *out_loop = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_loop_t* loop = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*loop), (void**)&loop));
+  loop->allocator = allocator;
+  loop->executor = executor;
+  iree_task_executor_retain(executor);
+  loop->options = options;
+  iree_task_scope_initialize(IREE_SV("loop"), IREE_TASK_SCOPE_FLAG_NONE,
+                             &loop->scope);
+
+  *out_loop = loop;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_task_loop_free(iree_task_loop_t* loop) {
+  if (!loop) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Operations must complete as they reference the loop.
+  IREE_IGNORE_ERROR(
+      iree_task_scope_wait_idle(&loop->scope, IREE_TIME_INFINITE_FUTURE));
+  iree_task_scope_deinitialize(&loop->scope);
+  iree_task_executor_release(loop->executor);
+  iree_allocator_free(loop->allocator, loop);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_task_loop_wait_idle(iree_task_loop_t* loop,
+                                                       iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(loop);
+  return iree_task_scope_wait_idle(&loop->scope,
+                                   iree_timeout_as_deadline_ns(timeout));
+}
+
+//===----------------------------------------------------------------------===//
+// Loop operations
+//===----------------------------------------------------------------------===//
+
+// A single loop operation.
+// Each operation is a call task issuing the user callback that may be preceded
+// by a dispatch or wait tasks stored in the trailing storage. The operation is
+// freed when the call task is cleaned up.
+typedef struct iree_task_loop_op_t {
+  // Call task issuing the callback; completion task of all other tasks.
+  // Must be first so that the operation can be recovered from the task.
+  iree_task_call_t call;
+
+  iree_task_loop_t* loop;
+  iree_loop_callback_t callback;
+
+  // First failure of the operation that is passed to the callback.
+  iree_atomic_intptr_t status;
+
+  // Cancellation flag shared by all waits in a wait-any operation.
+  iree_atomic_int32_t cancellation_flag;
+
+  // Workgroup function of dispatch operations.
+  iree_loop_workgroup_fn_t workgroup_fn;
+
+  // + trailing iree_task_dispatch_t or iree_task_wait_t[]
+} iree_task_loop_op_t;
+
+// Returns the trailing task storage of |op|.
+static inline void* iree_task_loop_op_trailing_storage(
+    iree_task_loop_op_t* op) {
+  return (uint8_t*)op + iree_host_align(sizeof(*op), iree_max_align_t);
+}
+
+// Stores |status| as the operation status if no failure has been stored yet.
+static void iree_task_loop_op_try_set_status(iree_task_loop_op_t* op,
+                                             iree_status_t new_status) {
+  if (IREE_LIKELY(iree_status_is_ok(new_status))) return;
+  iree_status_t old_status = iree_ok_status();
+  if (!iree_atomic_compare_exchange_strong(
+          &op->status, (intptr_t*)&old_status, (intptr_t)new_status,
+          iree_memory_order_acq_rel,
+          iree_memory_order_relaxed /* old_status is unused */)) {
+    // Previous status was not OK; drop our new status.
+    IREE_IGNORE_ERROR(new_status);
+  }
+}
+
+// Issues the operation callback with |status| (ownership transferred).
+// Failures returned by the callback are routed to the loop error handler.
+static void iree_task_loop_op_issue(iree_task_loop_op_t* op,
+                                    iree_status_t status) {
+  iree_task_loop_t* loop = op->loop;
+  iree_loop_callback_t callback = op->callback;
+  op->callback.fn = NULL;  // issued
+  iree_status_t callback_status =
+      callback.fn(callback.user_data, iree_task_loop(loop), status);
+  if (IREE_UNLIKELY(!iree_status_is_ok(callback_status))) {
+    if (loop->options.error_fn) {
+      loop->options.error_fn(loop->options.error_user_data, callback_status);
+    } else {
+      IREE_IGNORE_ERROR(callback_status);
+    }
+  }
+}
+
+static iree_status_t iree_task_loop_op_call(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  iree_task_loop_op_t* op = (iree_task_loop_op_t*)user_context;
+  iree_status_t status = (iree_status_t)iree_atomic_exchange(
+      &op->status, 0, iree_memory_order_acq_rel);
+  iree_task_loop_op_issue(op, status);
+  return iree_ok_status();
+}
+
+static void iree_task_loop_op_cleanup(iree_task_t* task,
+                                      iree_status_code_t status_code) {
+  iree_task_loop_op_t* op = (iree_task_loop_op_t*)task;
+  iree_task_loop_t* loop = op->loop;
+
+  // Callbacks are guaranteed to be issued even if the call was aborted.
+  if (IREE_UNLIKELY(op->callback.fn)) {
+    iree_status_t status = (iree_status_t)iree_atomic_exchange(
+        &op->status, 0, iree_memory_order_acq_rel);
+    IREE_IGNORE_ERROR(status);
+    iree_task_loop_op_issue(op, iree_status_from_code(IREE_STATUS_ABORTED));
+  }
+
+  iree_allocator_free_aligned(loop->allocator, op);
+
+  // NOTE: the loop may be freed as soon as this returns.
+  iree_task_scope_end(&loop->scope);
+}
+
+// Allocates a new operation issuing |callback| with |trailing_size| bytes of
+// task storage. The operation is pending in the loop until it is freed.
+static iree_status_t iree_task_loop_op_allocate(
+    iree_task_loop_t* loop, iree_loop_callback_t callback,
+    iree_host_size_t trailing_size, iree_task_loop_op_t** out_op) {
+  *out_op = NULL;
+  iree_task_loop_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
+      loop->allocator,
+      iree_host_align(sizeof(*op), iree_max_align_t) + trailing_size,
+      iree_max_align_t, 0, (void**)&op));
+  iree_task_call_initialize(
+      &loop->scope, iree_task_make_call_closure(iree_task_loop_op_call, op),
+      &op->call);
+  iree_task_set_cleanup_fn(&op->call.header, iree_task_loop_op_cleanup);
+  op->loop = loop;
+  op->callback = callback;
+  iree_atomic_store(&op->status, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&op->cancellation_flag, 0, iree_memory_order_relaxed);
+  op->workgroup_fn = NULL;
+  iree_task_scope_begin(&loop->scope);
+  *out_op = op;
+  return iree_ok_status();
+}
+
+// Submits all tasks in |submission| to the executor for execution.
+static void iree_task_loop_submit(iree_task_loop_t* loop,
+                                  iree_task_submission_t* submission) {
+  iree_task_executor_submit(loop->executor, submission);
+  iree_task_executor_flush(loop->executor);
+}
+
+//===----------------------------------------------------------------------===//
+// IREE_LOOP_COMMAND_CALL
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_task_loop_enqueue_call(
+    iree_task_loop_t* loop, const iree_loop_call_params_t* params) {
+  iree_task_loop_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_task_loop_op_allocate(loop, params->callback, 0, &op));
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &op->call.header);
+  iree_task_loop_submit(loop, &submission);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// IREE_LOOP_COMMAND_DISPATCH
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_task_loop_op_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  iree_task_loop_op_t* op = (iree_task_loop_op_t*)user_context;
+  // Workgroup failures are passed to the completion callback instead of
+  // failing the dispatch (and with it the loop scope).
+  iree_task_loop_op_try_set_status(
+      op, op->workgroup_fn(op->callback.user_data, iree_task_loop(op->loop),
+                           tile_context->workgroup_xyz[0],
+                           tile_context->workgroup_xyz[1],
+                           tile_context->workgroup_xyz[2]));
+  return iree_ok_status();
+}
+
+static iree_status_t iree_task_loop_enqueue_dispatch(
+    iree_task_loop_t* loop, const iree_loop_dispatch_params_t* params) {
+  iree_task_loop_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(iree_task_loop_op_allocate(
+      loop, params->callback, sizeof(iree_task_dispatch_t), &op));
+  op->workgroup_fn = params->workgroup_fn;
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  const uint32_t* workgroup_count = params->workgroup_count_xyz;
+  if (workgroup_count[0] && workgroup_count[1] && workgroup_count[2]) {
+    iree_task_dispatch_t* dispatch =
+        (iree_task_dispatch_t*)iree_task_loop_op_trailing_storage(op);
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    iree_task_dispatch_initialize(
+        &loop->scope,
+        iree_task_make_dispatch_closure(iree_task_loop_op_tile, op),
+        workgroup_size, workgroup_count, dispatch);
+    iree_task_set_completion_task(&dispatch->header, &op->call.header);
+    iree_task_submission_enqueue(&submission, &dispatch->header);
+  } else {
+    // Empty grids only issue the completion callback.
+    iree_task_submission_enqueue(&submission, &op->call.header);
+  }
+  iree_task_loop_submit(loop, &submission);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// IREE_LOOP_COMMAND_WAIT_*
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_task_loop_enqueue_wait_until(
+    iree_task_loop_t* loop, const iree_loop_wait_until_params_t* params) {
+  iree_task_loop_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(iree_task_loop_op_allocate(
+      loop, params->callback, sizeof(iree_task_wait_t), &op));
+  iree_task_wait_t* wait_task =
+      (iree_task_wait_t*)iree_task_loop_op_trailing_storage(op);
+  iree_task_wait_initialize_delay(&loop->scope, params->deadline_ns,
+                                  wait_task);
+  iree_task_wait_set_failure_status(wait_task, &op->status);
+  iree_task_set_completion_task(&wait_task->header, &op->call.header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &wait_task->header);
+  iree_task_loop_submit(loop, &submission);
+  return iree_ok_status();
+}
+
+// Enqueues a wait on all (or any, if |wait_any|) of |wait_sources|.
+static iree_status_t iree_task_loop_enqueue_wait(
+    iree_task_loop_t* loop, iree_loop_callback_t callback,
+    iree_time_t deadline_ns, iree_host_size_t count,
+    const iree_wait_source_t* wait_sources, bool wait_any) {
+  iree_task_loop_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(iree_task_loop_op_allocate(
+      loop, callback, count * sizeof(iree_task_wait_t), &op));
+  iree_task_wait_t* wait_tasks =
+      (iree_task_wait_t*)iree_task_loop_op_trailing_storage(op);
+
+  // Query the wait sources to avoid round-tripping through the poller for those
+  // that have already resolved, as is common for fences signaled before their
+  // waiters get to them. Only unresolved wait sources get wait tasks.
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_host_size_t wait_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    iree_status_t status =
+        iree_wait_source_query(wait_sources[i], &wait_status_code);
+    if (iree_status_is_ok(status) && wait_status_code != IREE_STATUS_OK &&
+        wait_status_code != IREE_STATUS_DEFERRED) {
+      status = iree_status_from_code(wait_status_code);
+    }
+    if (!iree_status_is_ok(status)) {
+      // Failed waits are passed to the callback.
+      iree_task_loop_op_try_set_status(op, status);
+      wait_count = 0;
+      break;
+    } else if (wait_status_code == IREE_STATUS_OK) {
+      if (wait_any) {
+        // Any resolved wait satisfies the whole operation.
+        wait_count = 0;
+        break;
+      }
+      continue;
+    }
+    iree_task_wait_t* wait_task = &wait_tasks[wait_count++];
+    iree_task_wait_initialize(&loop->scope, wait_sources[i], deadline_ns,
+                              wait_task);
+    iree_task_wait_set_failure_status(wait_task, &op->status);
+    if (wait_any) {
+      iree_task_wait_set_wait_any(wait_task, &op->cancellation_flag);
+    }
+  }
+
+  if (wait_count == 0) {
+    iree_task_submission_enqueue(&submission, &op->call.header);
+  } else {
+    for (iree_host_size_t i = 0; i < wait_count; ++i) {
+      iree_task_set_completion_task(&wait_tasks[i].header, &op->call.header);
+      iree_task_submission_enqueue(&submission, &wait_tasks[i].header);
+    }
+  }
+  iree_task_loop_submit(loop, &submission);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Control function
+//===----------------------------------------------------------------------===//
+
+// Control function for the task executor loop.
+// |self| must be an iree_task_loop_t.
+IREE_API_EXPORT iree_status_t iree_task_loop_ctl(void* self,
+                                                 iree_loop_command_t command,
+                                                 const void* params,
+                                                 void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(self);
+  iree_task_loop_t* loop = (iree_task_loop_t*)self;
+  switch (command) {
+    case IREE_LOOP_COMMAND_CALL:
+      return iree_task_loop_enqueue_call(
+          loop, (const iree_loop_call_params_t*)params);
+    case IREE_LOOP_COMMAND_DISPATCH:
+      return iree_task_loop_enqueue_dispatch(
+          loop, (const iree_loop_dispatch_params_t*)params);
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      return iree_task_loop_enqueue_wait_until(
+          loop, (const iree_loop_wait_until_params_t*)params);
+    case IREE_LOOP_COMMAND_WAIT_ONE: {
+      const iree_loop_wait_one_params_t* wait_params =
+          (const iree_loop_wait_one_params_t*)params;
+      return iree_task_loop_enqueue_wait(
+          loop, wait_params->callback, wait_params->deadline_ns, 1,
+          &wait_params->wait_source, /*wait_any=*/false);
+    }
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+    case IREE_LOOP_COMMAND_WAIT_ANY: {
+      const iree_loop_wait_multi_params_t* wait_params =
+          (const iree_loop_wait_multi_params_t*)params;
+      return iree_task_loop_enqueue_wait(
+          loop, wait_params->callback, wait_params->deadline_ns,
+          wait_params->count, wait_params->wait_sources,
+          /*wait_any=*/command == IREE_LOOP_COMMAND_WAIT_ANY);
+    }
+    case IREE_LOOP_COMMAND_DRAIN:
+      return iree_task_scope_wait_idle(
+          &loop->scope, ((const iree_loop_drain_params_t*)params)->deadline_ns);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented loop command");
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TASK_LOOP_H_
+#define IREE_TASK_LOOP_H_
+
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_task_loop_t
+//===----------------------------------------------------------------------===//
+
+// Handles errors returned from loop callback operations.
+// Ownership of |status| is passed to the handler and must be freed.
+typedef void(IREE_API_PTR* iree_task_loop_error_fn_t)(void* user_data,
+                                                      iree_status_t status);
+
+// Configuration options for the task executor loop implementation.
+typedef struct iree_task_loop_options_t {
+  // Optional function used to report errors returned by loop callbacks.
+  // If omitted the errors are ignored.
+  iree_task_loop_error_fn_t error_fn;
+  void* error_user_data;
+} iree_task_loop_options_t;
+
+// A loop that multiplexes operations over the workers of a task executor.
+//
+// Calls and dispatches run on the executor workers and waits are parked on the
+// executor poller without occupying any thread until they resolve. This allows
+// many concurrent cooperative programs - such as VM invocations started with
+// iree_vm_async_invoke that yield when awaiting HAL fences - to share a fixed
+// number of threads instead of requiring one blocked thread per program.
+//
+// Unlike iree_loop_sync_t operations are independent: a failure returned from
+// one callback is reported to the error handler but does not abort any other
+// pending operation. Failed waits (including those exceeding their deadline)
+// pass their status to their callback without impacting the loop.
+//
+// Up to IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS waits on system wait handles
+// are waited on directly by the executor poller. Any beyond that are polled
+// every IREE_TASK_EXECUTOR_WAIT_OVERFLOW_POLL_NS until a slot frees up and may
+// observe up to that much additional latency between being signaled and their
+// callback being issued.
+//
+// Thread-safe: operations may be enqueued from any thread and callbacks will be
+// issued concurrently from any executor worker.
+typedef struct iree_task_loop_t iree_task_loop_t;
+
+// Allocates a loop running operations on |executor| stored into |out_loop|.
+// The executor is retained for the lifetime of the loop.
+IREE_API_EXPORT iree_status_t iree_task_loop_allocate(
+    iree_task_loop_options_t options, iree_task_executor_t* executor,
+    iree_allocator_t allocator, iree_task_loop_t** out_loop);
+
+// Frees |loop| after waiting for all pending operations to complete.
+IREE_API_EXPORT void iree_task_loop_free(iree_task_loop_t* loop);
+
+// Waits until the loop is idle (all operations have retired).
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |timeout| is reached before the
+// loop is idle.
+IREE_API_EXPORT iree_status_t iree_task_loop_wait_idle(iree_task_loop_t* loop,
+                                                       iree_timeout_t timeout);
+
+IREE_API_EXPORT iree_status_t iree_task_loop_ctl(void* self,
+                                                 iree_loop_command_t command,
+                                                 const void* params,
+                                                 void** inout_ptr);
+
+// Returns a loop that schedules operations against |loop|.
+// The loop must remain valid until all operations scheduled against it have
+// completed.
+static inline iree_loop_t iree_task_loop(iree_task_loop_t* loop) {
+  iree_loop_t result = {
+      loop,
+      iree_task_loop_ctl,
+  };
+  return result;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TASK_LOOP_H_
@@ -0,0 +1,303 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Compares serving many concurrent requests that block on device fences with
+// one thread per request against multiplexing them on an iree_task_loop_t.
+//
+// Each request models an invocation that awaits a fixed number of fences in
+// sequence (such as a VM function yielding on hal.fence.await between
+// dispatches). Fences are events submitted to a simulated device thread that
+// signals everything submitted to it after a fixed latency. Each step runs a
+// batch of concurrent requests to completion:
+//
+//  thread_per_request: every request gets its own thread that blocks in the
+//    system on each fence.
+//  task_loop: every request is a chain of iree_loop_wait_one operations on a
+//    task loop with a small fixed number of workers. Waiting requests are
+//    parked on the executor poller and only occupy a worker when resuming.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/task/api.h"
+#include "iree/task/loop.h"
+#include "iree/testing/benchmark.h"
+
+// Number of workers in the executor used by the task loop.
+#define IREE_TASK_LOOP_BENCHMARK_WORKER_COUNT 4
+
+// Number of fences each request awaits.
+#define IREE_TASK_LOOP_BENCHMARK_STEP_COUNT 8
+
+// Simulated device latency of each fence.
+#define IREE_TASK_LOOP_BENCHMARK_STEP_DELAY_NS (100 /*us*/ * 1000)
+
+// Maximum number of concurrent requests in a batch.
+#define IREE_TASK_LOOP_BENCHMARK_MAX_REQUESTS 1024
+
+//===----------------------------------------------------------------------===//
+// Simulated device
+//===----------------------------------------------------------------------===//
+
+// A device that signals all fences submitted to it after a fixed latency.
+typedef struct iree_task_loop_benchmark_device_t {
+  iree_slim_mutex_t mutex;
+  iree_host_size_t pending_count IREE_GUARDED_BY(mutex);
+  iree_event_t* pending_fences[IREE_TASK_LOOP_BENCHMARK_MAX_REQUESTS]
+      IREE_GUARDED_BY(mutex);
+  // Fences being signaled by the device thread.
+  iree_event_t* signaling_fences[IREE_TASK_LOOP_BENCHMARK_MAX_REQUESTS];
+  iree_atomic_int32_t should_exit;
+  iree_thread_t* thread;
+} iree_task_loop_benchmark_device_t;
+
+static int iree_task_loop_benchmark_device_main(void* entry_arg) {
+  iree_task_loop_benchmark_device_t* device =
+      (iree_task_loop_benchmark_device_t*)entry_arg;
+  while (!iree_atomic_load(&device->should_exit, iree_memory_order_acquire)) {
+    iree_wait_until(iree_time_now() + IREE_TASK_LOOP_BENCHMARK_STEP_DELAY_NS);
+    iree_slim_mutex_lock(&device->mutex);
+    iree_host_size_t signaling_count = device->pending_count;
+    memcpy(device->signaling_fences, device->pending_fences,
+           signaling_count * sizeof(device->signaling_fences[0]));
+    device->pending_count = 0;
+    iree_slim_mutex_unlock(&device->mutex);
+    for (iree_host_size_t i = 0; i < signaling_count; ++i) {
+      iree_event_set(device->signaling_fences[i]);
+    }
+  }
+  return 0;
+}
+
+static void iree_task_loop_benchmark_device_start(
+    iree_allocator_t host_allocator,
+    iree_task_loop_benchmark_device_t* device) {
+  iree_slim_mutex_initialize(&device->mutex);
+  device->pending_count = 0;
+  iree_atomic_store(&device->should_exit, 0, iree_memory_order_release);
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = IREE_SV("device");
+  IREE_CHECK_OK(iree_thread_create(iree_task_loop_benchmark_device_main,
+                                   device, thread_params, host_allocator,
+                                   &device->thread));
+}
+
+static void iree_task_loop_benchmark_device_stop(
+    iree_task_loop_benchmark_device_t* device) {
+  iree_atomic_store(&device->should_exit, 1, iree_memory_order_release);
+  iree_thread_join(device->thread);
+  iree_thread_release(device->thread);
+  iree_slim_mutex_deinitialize(&device->mutex);
+}
+
+// Resets |fence| and submits it to |device| to be signaled.
+static void iree_task_loop_benchmark_device_submit(
+    iree_task_loop_benchmark_device_t* device, iree_event_t* fence) {
+  iree_event_reset(fence);
+  iree_slim_mutex_lock(&device->mutex);
+  device->pending_fences[device->pending_count++] = fence;
+  iree_slim_mutex_unlock(&device->mutex);
+}
+
+static iree_task_loop_benchmark_device_t iree_task_loop_benchmark_device;
+
+// State of a single in-flight request.
+typedef struct iree_task_loop_benchmark_request_t {
+  // Fence reused for each step of the request.
+  iree_event_t fence;
+  // Remaining number of fences to await.
+  int32_t remaining_steps;
+} iree_task_loop_benchmark_request_t;
+
+static iree_task_loop_benchmark_request_t
+    iree_task_loop_benchmark_requests[IREE_TASK_LOOP_BENCHMARK_MAX_REQUESTS];
+
+static void iree_task_loop_benchmark_initialize_requests(
+    iree_host_size_t request_count) {
+  for (iree_host_size_t i = 0; i < request_count; ++i) {
+    IREE_CHECK_OK(iree_event_initialize(
+        /*initial_state=*/false, &iree_task_loop_benchmark_requests[i].fence));
+  }
+}
+
+static void iree_task_loop_benchmark_deinitialize_requests(
+    iree_host_size_t request_count) {
+  for (iree_host_size_t i = 0; i < request_count; ++i) {
+    iree_event_deinitialize(&iree_task_loop_benchmark_requests[i].fence);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Thread per request
+//===----------------------------------------------------------------------===//
+
+static int iree_task_loop_benchmark_request_thread(void* entry_arg) {
+  iree_task_loop_benchmark_request_t* request =
+      (iree_task_loop_benchmark_request_t*)entry_arg;
+  while (request->remaining_steps-- > 0) {
+    iree_task_loop_benchmark_device_submit(&iree_task_loop_benchmark_device,
+                                           &request->fence);
+    IREE_CHECK_OK(iree_wait_one(&request->fence, IREE_TIME_INFINITE_FUTURE));
+  }
+  return 0;
+}
+
+// Runs batches of requests each on their own thread.
+//
+// user_data is the number of concurrent requests in each batch.
+static iree_status_t iree_task_loop_benchmark_thread_per_request(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_host_size_t request_count =
+      (iree_host_size_t)benchmark_def->user_data;
+  iree_task_loop_benchmark_initialize_requests(request_count);
+  iree_task_loop_benchmark_device_start(host_allocator,
+                                        &iree_task_loop_benchmark_device);
+
+  static iree_thread_t* threads[IREE_TASK_LOOP_BENCHMARK_MAX_REQUESTS];
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = IREE_SV("request");
+  thread_params.stack_size = 64 * 1024;
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    for (iree_host_size_t i = 0; i < request_count; ++i) {
+      iree_task_loop_benchmark_request_t* request =
+          &iree_task_loop_benchmark_requests[i];
+      request->remaining_steps = IREE_TASK_LOOP_BENCHMARK_STEP_COUNT;
+      IREE_CHECK_OK(iree_thread_create(iree_task_loop_benchmark_request_thread,
+                                       request, thread_params, host_allocator,
+                                       &threads[i]));
+    }
+    for (iree_host_size_t i = 0; i < request_count; ++i) {
+      iree_thread_join(threads[i]);
+      iree_thread_release(threads[i]);
+    }
+    ++batch_count;
+  }
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     batch_count * request_count);
+
+  iree_task_loop_benchmark_device_stop(&iree_task_loop_benchmark_device);
+  iree_task_loop_benchmark_deinitialize_requests(request_count);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Task loop
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_task_loop_benchmark_request_step(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  IREE_RETURN_IF_ERROR(status);
+  iree_task_loop_benchmark_request_t* request =
+      (iree_task_loop_benchmark_request_t*)user_data;
+  if (request->remaining_steps-- <= 0) return iree_ok_status();
+  iree_task_loop_benchmark_device_submit(&iree_task_loop_benchmark_device,
+                                         &request->fence);
+  return iree_loop_wait_one(loop, iree_event_await(&request->fence),
+                            iree_infinite_timeout(),
+                            iree_task_loop_benchmark_request_step, request);
+}
+
+static void iree_task_loop_benchmark_error(void* user_data,
+                                           iree_status_t status) {
+  IREE_CHECK_OK(status);
+}
+
+// Runs batches of requests multiplexed on a task loop.
+//
+// user_data is the number of concurrent requests in each batch.
+static iree_status_t iree_task_loop_benchmark_task_loop(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_host_size_t request_count =
+      (iree_host_size_t)benchmark_def->user_data;
+  iree_task_loop_benchmark_initialize_requests(request_count);
+  iree_task_loop_benchmark_device_start(host_allocator,
+                                        &iree_task_loop_benchmark_device);
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(
+      IREE_TASK_LOOP_BENCHMARK_WORKER_COUNT, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(
+      iree_task_executor_create(options, &topology, host_allocator, &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_loop_options_t loop_options = {
+      .error_fn = iree_task_loop_benchmark_error,
+      .error_user_data = NULL,
+  };
+  iree_task_loop_t* task_loop = NULL;
+  IREE_CHECK_OK(iree_task_loop_allocate(loop_options, executor, host_allocator,
+                                        &task_loop));
+  iree_loop_t loop = iree_task_loop(task_loop);
+
+  int64_t batch_count = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    for (iree_host_size_t i = 0; i < request_count; ++i) {
+      iree_task_loop_benchmark_request_t* request =
+          &iree_task_loop_benchmark_requests[i];
+      request->remaining_steps = IREE_TASK_LOOP_BENCHMARK_STEP_COUNT;
+      IREE_CHECK_OK(iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT,
+                                   iree_task_loop_benchmark_request_step,
+                                   request));
+    }
+    IREE_CHECK_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+    ++batch_count;
+  }
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     batch_count * request_count);
+
+  iree_task_loop_free(task_loop);
+  iree_task_executor_release(executor);
+  iree_task_loop_benchmark_device_stop(&iree_task_loop_benchmark_device);
+  iree_task_loop_benchmark_deinitialize_requests(request_count);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  {
+    static const iree_host_size_t request_counts[] = {16, 256, 1024};
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MILLISECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+    };
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(request_counts); ++i) {
+      benchmark_def.user_data = (void*)request_counts[i];
+      char name[64];
+
+      benchmark_def.run = iree_task_loop_benchmark_thread_per_request;
+      snprintf(name, sizeof(name), "thread_per_request_%" PRIhsz,
+               request_counts[i]);
+      iree_benchmark_register(iree_make_cstring_view(name), &benchmark_def);
+
+      benchmark_def.run = iree_task_loop_benchmark_task_loop;
+      snprintf(name, sizeof(name), "task_loop_%" PRIhsz, request_counts[i]);
+      iree_benchmark_register(iree_make_cstring_view(name), &benchmark_def);
+    }
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -0,0 +1,338 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/loop.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/task/topology.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+class TaskLoopTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_task_executor_options_t executor_options;
+    iree_task_executor_options_initialize(&executor_options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(4, &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(executor_options, &topology,
+                                             allocator_, &executor_));
+    iree_task_topology_deinitialize(&topology);
+
+    iree_task_loop_options_t options = {0};
+    options.error_fn = +[](void* user_data, iree_status_t status) {
+      iree_status_t* status_ptr = (iree_status_t*)user_data;
+      if (iree_status_is_ok(*status_ptr)) {
+        *status_ptr = status;
+      } else {
+        iree_status_ignore(status);
+      }
+    };
+    options.error_user_data = &loop_status_;
+    IREE_ASSERT_OK(
+        iree_task_loop_allocate(options, executor_, allocator_, &task_loop_));
+    loop_ = iree_task_loop(task_loop_);
+  }
+
+  void TearDown() override {
+    iree_task_loop_free(task_loop_);
+    iree_task_executor_release(executor_);
+    iree_status_ignore(loop_status_);
+  }
+
+  iree_allocator_t allocator_ = iree_allocator_system();
+  iree_task_executor_t* executor_ = NULL;
+  iree_task_loop_t* task_loop_ = NULL;
+  iree_loop_t loop_;
+  iree_status_t loop_status_ = iree_ok_status();
+};
+
+// Tests the simple call interface for running work.
+TEST_F(TaskLoopTest, Call) {
+  IREE_TRACE_SCOPE();
+  std::atomic<bool> called = {false};
+  IREE_ASSERT_OK(iree_loop_call(
+      loop_, IREE_LOOP_PRIORITY_DEFAULT,
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &called));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(called);
+}
+
+// Tests that a failing call is reported to the error handler without aborting
+// other operations.
+TEST_F(TaskLoopTest, CallFailureIsolated) {
+  IREE_TRACE_SCOPE();
+  std::atomic<bool> called = {false};
+  IREE_ASSERT_OK(iree_loop_call(
+      loop_, IREE_LOOP_PRIORITY_DEFAULT,
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        return iree_status_from_code(IREE_STATUS_DATA_LOSS);
+      },
+      NULL));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(iree_loop_call(
+      loop_, IREE_LOOP_PRIORITY_DEFAULT,
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &called));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, loop_status_);
+  EXPECT_TRUE(called);
+}
+
+// Tests a grid dispatch operation and ensures all workgroups are issued.
+TEST_F(TaskLoopTest, DispatchGrid) {
+  IREE_TRACE_SCOPE();
+  struct UserData {
+    std::atomic<int> workgroup_count = {0};
+    std::atomic<bool> completed = {false};
+  } user_data;
+  const uint32_t xyz[3] = {4, 2, 3};
+  IREE_ASSERT_OK(iree_loop_dispatch(
+      loop_, xyz,
+      +[](void* user_data_ptr, iree_loop_t loop, uint32_t workgroup_x,
+          uint32_t workgroup_y, uint32_t workgroup_z) {
+        auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+        ++user_data->workgroup_count;
+        return iree_ok_status();
+      },
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+        user_data->completed = true;
+        return iree_ok_status();
+      },
+      &user_data));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_EQ(user_data.workgroup_count, xyz[0] * xyz[1] * xyz[2]);
+  EXPECT_TRUE(user_data.completed);
+}
+
+// Tests that workgroup failures are passed to the completion callback.
+TEST_F(TaskLoopTest, DispatchWorkgroupFailure) {
+  IREE_TRACE_SCOPE();
+  std::atomic<bool> completed = {false};
+  const uint32_t xyz[3] = {4, 2, 1};
+  IREE_ASSERT_OK(iree_loop_dispatch(
+      loop_, xyz,
+      +[](void* user_data, iree_loop_t loop, uint32_t workgroup_x,
+          uint32_t workgroup_y, uint32_t workgroup_z) {
+        return iree_status_from_code(IREE_STATUS_DATA_LOSS);
+      },
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, status);
+        iree_status_ignore(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &completed));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(completed);
+}
+
+// Tests a wait-until delay.
+TEST_F(TaskLoopTest, WaitUntil) {
+  IREE_TRACE_SCOPE();
+  std::atomic<bool> called = {false};
+  iree_time_t start_ns = iree_time_now();
+  IREE_ASSERT_OK(iree_loop_wait_until(
+      loop_, iree_make_timeout_ms(25),
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &called));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(called);
+  EXPECT_GE(iree_time_now() - start_ns, 10 * 1000000);
+}
+
+// Tests a wait-one that times out passes the failure to its callback and does
+// not impact other loop operations.
+TEST_F(TaskLoopTest, WaitOneTimeout) {
+  IREE_TRACE_SCOPE();
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  std::atomic<bool> called = {false};
+  IREE_ASSERT_OK(iree_loop_wait_one(
+      loop_, iree_event_await(&event), iree_make_timeout_ms(10),
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED, status);
+        iree_status_ignore(status);
+        return iree_loop_call(
+            loop, IREE_LOOP_PRIORITY_DEFAULT,
+            +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+              IREE_EXPECT_OK(status);
+              *(std::atomic<bool>*)user_data = true;
+              return iree_ok_status();
+            },
+            user_data);
+      },
+      &called));
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(called);
+  iree_event_deinitialize(&event);
+}
+
+// Tests a wait-one on a wait handle signaled out-of-band.
+TEST_F(TaskLoopTest, WaitOneBlocking) {
+  IREE_TRACE_SCOPE();
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  std::atomic<bool> called = {false};
+  IREE_ASSERT_OK(iree_loop_wait_one(
+      loop_, iree_event_await(&event), iree_make_timeout_ms(2000),
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &called));
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    iree_event_set(&event);
+  });
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(called);
+  thread.join();
+  iree_event_deinitialize(&event);
+}
+
+// Tests a wait-any where only one of the wait sources resolves.
+TEST_F(TaskLoopTest, WaitAnyBlocking) {
+  IREE_TRACE_SCOPE();
+  iree_event_t events[2];
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[0]));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[1]));
+  iree_wait_source_t wait_sources[2] = {
+      iree_event_await(&events[0]),
+      iree_event_await(&events[1]),
+  };
+  std::atomic<bool> called = {false};
+  IREE_ASSERT_OK(iree_loop_wait_any(
+      loop_, IREE_ARRAYSIZE(wait_sources), wait_sources,
+      iree_make_timeout_ms(2000),
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &called));
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    iree_event_set(&events[1]);
+  });
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(called);
+  thread.join();
+  iree_event_deinitialize(&events[0]);
+  iree_event_deinitialize(&events[1]);
+}
+
+// Tests a wait-all where one wait source is already signaled.
+TEST_F(TaskLoopTest, WaitAllBlocking) {
+  IREE_TRACE_SCOPE();
+  iree_event_t events[2];
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/true, &events[0]));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[1]));
+  iree_wait_source_t wait_sources[2] = {
+      iree_event_await(&events[0]),
+      iree_event_await(&events[1]),
+  };
+  std::atomic<bool> called = {false};
+  IREE_ASSERT_OK(iree_loop_wait_all(
+      loop_, IREE_ARRAYSIZE(wait_sources), wait_sources,
+      iree_make_timeout_ms(2000),
+      +[](void* user_data, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_OK(status);
+        *(std::atomic<bool>*)user_data = true;
+        return iree_ok_status();
+      },
+      &called));
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    iree_event_set(&events[1]);
+  });
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_TRUE(called);
+  thread.join();
+  iree_event_deinitialize(&events[0]);
+  iree_event_deinitialize(&events[1]);
+}
+
+// Tests that many concurrent waits are parked without blocking the workers.
+// Each wait chains a call to a second wait as a program resuming from one
+// fence and awaiting the next would.
+TEST_F(TaskLoopTest, ManyConcurrentWaits) {
+  IREE_TRACE_SCOPE();
+  static constexpr int kWaitCount = 256;
+  iree_event_t events[2];
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[0]));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[1]));
+  struct UserData {
+    iree_event_t* next_event = NULL;
+    std::atomic<int> completed = {0};
+  } user_data;
+  user_data.next_event = &events[1];
+  for (int i = 0; i < kWaitCount; ++i) {
+    IREE_ASSERT_OK(iree_loop_wait_one(
+        loop_, iree_event_await(&events[0]), iree_infinite_timeout(),
+        +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+          IREE_RETURN_IF_ERROR(status);
+          auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+          return iree_loop_wait_one(
+              loop, iree_event_await(user_data->next_event),
+              iree_infinite_timeout(),
+              +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+                IREE_RETURN_IF_ERROR(status);
+                auto* user_data = reinterpret_cast<UserData*>(user_data_ptr);
+                ++user_data->completed;
+                return iree_ok_status();
+              },
+              user_data);
+        },
+        &user_data));
+  }
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    iree_event_set(&events[0]);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    iree_event_set(&events[1]);
+  });
+  IREE_ASSERT_OK(iree_loop_drain(loop_, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status_);
+  EXPECT_EQ(user_data.completed, kWaitCount);
+  thread.join();
+  iree_event_deinitialize(&events[0]);
+  iree_event_deinitialize(&events[1]);
+}
+
+}  // namespace
@@ -41,13 +41,15 @@ iree_status_t iree_task_poller_initialize(
       &out_poller->wake_event);
 
   // Wait set used to batch syscalls for polling/waiting on wait handles.
-  // This is currently limited to a relatively small max to make bad behavior
-  // clearer with nice RESOURCE_EXHAUSTED errors. If we start to hit that limit
-  // (~63+ simultaneous system waits) we'll need to shard out the wait sets -
-  // possibly with multiple wait threads (one per set).
+  // Has room for IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS task waits plus our
+  // wake event. Waits beyond that are polled (see
+  // IREE_TASK_EXECUTOR_WAIT_OVERFLOW_POLL_NS) and if that latency becomes an
+  // issue we'll need to shard out the wait sets - possibly with multiple wait
+  // threads (one per set).
   if (iree_status_is_ok(status)) {
-    status = iree_wait_set_allocate(IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS,
-                                    executor->allocator, &out_poller->wait_set);
+    status = iree_wait_set_allocate(
+        IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS + 1, executor->allocator,
+        &out_poller->wait_set);
   }
   if (iree_status_is_ok(status)) {
     status = iree_wait_set_insert(out_poller->wait_set, out_poller->wake_event);
@@ -291,8 +293,16 @@ static iree_task_poller_prepare_result_t iree_task_poller_prepare_task(
     if (wait_status_code == IREE_STATUS_DEFERRED) {
       if (!iree_all_bits_set(task->header.flags,
                              IREE_TASK_FLAG_WAIT_EXPORTED)) {
-        task->header.flags |= IREE_TASK_FLAG_WAIT_EXPORTED;
         status = iree_task_poller_insert_wait_handle(poller->wait_set, task);
+        if (iree_status_is_ok(status)) {
+          task->header.flags |= IREE_TASK_FLAG_WAIT_EXPORTED;
+        } else if (iree_status_is_resource_exhausted(status)) {
+          // The wait set is full; poll the task until a slot frees up.
+          status = iree_status_ignore(status);
+          *earliest_deadline_ns =
+              iree_min(*earliest_deadline_ns,
+                       now_ns + IREE_TASK_EXECUTOR_WAIT_OVERFLOW_POLL_NS);
+        }
       }
       *earliest_deadline_ns =
           iree_min(*earliest_deadline_ns, task->deadline_ns);
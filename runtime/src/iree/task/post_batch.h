@@ -37,7 +37,7 @@ typedef struct iree_task_post_batch_t {
 
   // A bitmask of workers indicating which have pending tasks in their lists.
   // Used to quickly scan the lists and perform the posts only when required.
-  iree_task_affinity_set_t worker_pending_mask;
+  iree_task_worker_set_t worker_pending_mask;
 
   // A per-worker LIFO task list waiting to be posted.
   iree_task_list_t worker_pending_lifos[0];
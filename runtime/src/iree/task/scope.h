@@ -25,6 +25,10 @@ enum iree_task_scope_flag_bits_e {
   // Hosting applications should properly handle the errors by retrieving the
   // failure status from the appropriate query or wait primitive.
   IREE_TASK_SCOPE_FLAG_ABORT_ON_FAILURE = 1u << 0,
+  // Producers recording dispatches into the scope should issue them with
+  // IREE_TASK_FLAG_DISPATCH_STICKY so that repeated dispatches keep the same
+  // workgroups on the same workers.
+  IREE_TASK_SCOPE_FLAG_STICKY_DISPATCHES = 1u << 1,
 };
 typedef uint32_t iree_task_scope_flags_t;
 
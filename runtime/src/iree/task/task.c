@@ -410,6 +410,7 @@ void iree_task_wait_initialize(iree_task_scope_t* scope,
   out_task->wait_source = wait_source;
   out_task->deadline_ns = deadline_ns;
   out_task->cancellation_flag = NULL;
+  out_task->failure_status = NULL;
 }
 
 void iree_task_wait_initialize_delay(iree_task_scope_t* scope,
@@ -425,6 +426,11 @@ void iree_task_wait_set_wait_any(iree_task_wait_t* task,
   task->cancellation_flag = cancellation_flag;
 }
 
+void iree_task_wait_set_failure_status(iree_task_wait_t* task,
+                                       iree_atomic_intptr_t* failure_status) {
+  task->failure_status = failure_status;
+}
+
 void iree_task_wait_retire(iree_task_wait_t* task,
                            iree_task_submission_t* pending_submission,
                            iree_status_t status) {
@@ -432,6 +438,13 @@ void iree_task_wait_retire(iree_task_wait_t* task,
 
   task->header.flags &= ~IREE_TASK_FLAG_WAIT_COMPLETED;  // reset for future use
 
+  // Route failures to the user-provided status, if any, so that they don't
+  // fail the scope.
+  if (task->failure_status && !iree_status_is_ok(status)) {
+    iree_task_try_set_status(task->failure_status, status);
+    status = iree_ok_status();  // consumed by try_set_status
+  }
+
   // TODO(benvanik): allow deinit'ing the wait handle (if transient/from the
   // executor event pool).
   iree_task_retire(&task->header, pending_submission, status);
@@ -531,6 +544,8 @@ static void iree_task_dispatch_initialize_base(
   out_task->local_memory_size = 0;
   iree_atomic_store(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
+  out_task->partitions = NULL;
+  out_task->partition_capacity = 0;
 
   IREE_TRACE({
     static iree_atomic_int64_t next_dispatch_id = IREE_ATOMIC_VAR_INIT(0);
@@ -558,6 +573,17 @@ void iree_task_dispatch_initialize_indirect(
   out_task->workgroup_count.ptr = workgroup_count_ptr;
 }
 
+// Returns true if |dispatch_task| uses IREE_TASK_FLAG_DISPATCH_STICKY
+// scheduling. Only valid after the dispatch has been issued and its shard count
+// is known.
+static bool iree_task_dispatch_is_sticky(
+    const iree_task_dispatch_t* dispatch_task) {
+  return iree_any_bit_set(dispatch_task->header.flags,
+                          IREE_TASK_FLAG_DISPATCH_STICKY) &&
+         dispatch_task->partitions &&
+         dispatch_task->partition_capacity >= dispatch_task->shard_count;
+}
+
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -574,9 +600,8 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
     // By the task being ready to execute we know any dependencies on the
     // indirection buffer have been satisfied and its safe to read. We perform
     // the indirection here and convert the dispatch to a direct one such that
-    // following code can read the value.
-    // TODO(benvanik): non-one-shot command buffers won't be able to do this as
-    // the intent is that they can be dynamic per execution.
+    // following code can read the value. Users reissuing the same dispatch
+    // (such as reusable command buffers) must restore the pointer and flag.
     const uint32_t* source_ptr = dispatch_task->workgroup_count.ptr;
     memcpy(dispatch_task->workgroup_count.value, source_ptr,
            sizeof(dispatch_task->workgroup_count.value));
@@ -601,10 +626,28 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
       workgroup_count[0] * workgroup_count[1] * workgroup_count[2];
 
   // Compute shard count - almost always worker_count unless we are a very small
-  // dispatch (1x1x1, etc).
+  // dispatch (1x1x1, etc). Sticky dispatches only shard across the workers in
+  // the affinity set of the dispatch so that each partition has a fixed owner.
   iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
+  iree_host_size_t shard_worker_count = worker_count;
+  iree_task_worker_set_t sticky_worker_set;
+  iree_task_worker_set_fill(&sticky_worker_set, worker_count);
+  if (iree_any_bit_set(dispatch_task->header.flags,
+                       IREE_TASK_FLAG_DISPATCH_STICKY)) {
+    iree_task_worker_set_t affinity_worker_set;
+    iree_task_worker_set_and_affinity(&sticky_worker_set,
+                                      dispatch_task->header.affinity_set,
+                                      &affinity_worker_set);
+    // Affinity sets selecting no workers are treated as selecting any worker
+    // as with other tasks.
+    if (!iree_task_worker_set_is_empty(&affinity_worker_set)) {
+      sticky_worker_set = affinity_worker_set;
+      shard_worker_count = iree_task_worker_set_count_ones(&sticky_worker_set);
+    }
+  }
   iree_host_size_t shard_count =
-      iree_min(dispatch_task->tile_count, worker_count);
+      iree_min(dispatch_task->tile_count, shard_worker_count);
+  dispatch_task->shard_count = (uint32_t)shard_count;
 
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
@@ -618,20 +661,41 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
         IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
   }
 
-  // Randomize starting worker.
-  iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
-      post_batch, dispatch_task->header.affinity_set);
+  const bool sticky = iree_task_dispatch_is_sticky(dispatch_task);
+  iree_host_size_t worker_offset = 0;
+  if (sticky) {
+    // Split the grid into one contiguous partition per shard and always post
+    // shard N to the Nth worker in the affinity set so that the worker owns the
+    // same tiles each time the dispatch is issued.
+    worker_offset = iree_task_worker_set_find_next(&sticky_worker_set, 0);
+    for (iree_host_size_t i = 0; i < shard_count; ++i) {
+      const uint64_t begin =
+          (uint64_t)dispatch_task->tile_count * i / shard_count;
+      const uint64_t end =
+          (uint64_t)dispatch_task->tile_count * (i + 1) / shard_count;
+      iree_atomic_store(&dispatch_task->partitions[i],
+                        (int64_t)((end << 32) | begin),
+                        iree_memory_order_relaxed);
+    }
+  } else {
+    // Randomize starting worker.
+    worker_offset = iree_task_post_batch_select_worker(
+        post_batch, dispatch_task->header.affinity_set);
+  }
   iree_host_size_t worker_index = worker_offset;
 
   for (iree_host_size_t i = 0; i < shard_count; ++i) {
     // Allocate and initialize the shard.
     iree_task_dispatch_shard_t* shard_task =
         iree_task_dispatch_shard_allocate(dispatch_task, shard_task_pool);
+    shard_task->partition_ordinal = (uint32_t)i;
 
     // Enqueue on the worker selected for the task.
     iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
                                  &shard_task->header);
-    ++worker_index;
+    worker_index = sticky ? iree_task_worker_set_find_next(&sticky_worker_set,
+                                                           worker_index + 1)
+                          : worker_index + 1;
   }
 
   // NOTE: the dispatch is not retired until all shards complete. Upon the last
@@ -707,6 +771,92 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
+// Reserves the next contiguous range of tiles [out_tile_base, out_tile_range)
+// from the dispatch grid. Returns false if all tiles have been reserved.
+//
+// By default reservations are a fixed |tiles_per_reservation| tiles. When
+// |guided| is set the reservation is sized to a fraction of the remaining
+// tiles split across all shards such that shards take large ranges while the
+// grid is full and progressively smaller ones as it drains. The remaining count
+// is sampled with a relaxed load and may be stale by the time the reservation
+// is made: that only results in a slightly larger range than intended and
+// avoids a compare-and-swap loop contending with the other shards.
+static bool iree_task_dispatch_reserve_tiles(
+    iree_task_dispatch_t* dispatch_task, uint32_t tile_count,
+    uint32_t tiles_per_reservation, bool guided, uint32_t* out_tile_base,
+    uint32_t* out_tile_range) {
+  uint32_t reservation_size = tiles_per_reservation;
+  if (guided) {
+    uint32_t tile_index = (uint32_t)iree_atomic_load(
+        &dispatch_task->tile_index, iree_memory_order_relaxed);
+    if (tile_index >= tile_count) return false;
+    uint32_t guided_size =
+        (tile_count - tile_index) /
+        (iree_max(1u, dispatch_task->shard_count) *
+         IREE_TASK_DISPATCH_GUIDED_RESERVATION_DIVISOR);
+    reservation_size = iree_max(reservation_size, guided_size);
+  }
+  // relaxed order because we only care about atomic increments, not about
+  // ordering of tile_index accesses w.r.t. other memory accesses.
+  uint32_t tile_base =
+      (uint32_t)iree_atomic_fetch_add(&dispatch_task->tile_index,
+                                      (int32_t)reservation_size,
+                                      iree_memory_order_relaxed);
+  if (tile_base >= tile_count) return false;
+  *out_tile_base = tile_base;
+  *out_tile_range = iree_min(tile_base + reservation_size, tile_count);
+  return true;
+}
+
+// Reserves the next contiguous range of tiles [out_tile_base, out_tile_range)
+// from the partitions of a sticky dispatch. Returns false if all partitions
+// have been drained.
+//
+// Shards first take tiles from the head of the partition at
+// |partition_ordinal| and once it has been drained steal from the tails of the
+// following partitions in order. |inout_victim_offset| tracks the partition
+// currently being drained relative to |partition_ordinal| and must start at 0.
+// Partitions only ever shrink so a partition that has been observed empty never
+// needs to be revisited.
+static bool iree_task_dispatch_reserve_partition_tiles(
+    iree_task_dispatch_t* dispatch_task, uint32_t partition_ordinal,
+    uint32_t tiles_per_reservation, uint32_t* inout_victim_offset,
+    uint32_t* out_tile_base, uint32_t* out_tile_range) {
+  const uint32_t partition_count = dispatch_task->shard_count;
+  for (; *inout_victim_offset < partition_count; ++*inout_victim_offset) {
+    const bool is_owner = *inout_victim_offset == 0;
+    iree_atomic_int64_t* partition =
+        &dispatch_task->partitions[(partition_ordinal + *inout_victim_offset) %
+                                   partition_count];
+    int64_t value = iree_atomic_load(partition, iree_memory_order_relaxed);
+    for (;;) {
+      uint32_t begin = (uint32_t)value;
+      uint32_t end = (uint32_t)((uint64_t)value >> 32);
+      if (begin >= end) break;
+      const uint32_t reservation_size =
+          iree_min(tiles_per_reservation, end - begin);
+      uint32_t tile_base = 0;
+      if (is_owner) {
+        tile_base = begin;
+        begin += reservation_size;
+      } else {
+        end -= reservation_size;
+        tile_base = end;
+      }
+      // relaxed order as with the shared tile_index: the tile ranges are
+      // disjoint and only the atomicity of the update matters.
+      if (iree_atomic_compare_exchange_weak(
+              partition, &value, (int64_t)(((uint64_t)end << 32) | begin),
+              iree_memory_order_relaxed, iree_memory_order_relaxed)) {
+        *out_tile_base = tile_base;
+        *out_tile_range = tile_base + reservation_size;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 void iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
@@ -759,25 +909,32 @@ void iree_task_dispatch_shard_execute(
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
   const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
-  // relaxed order because we only care about atomic increments, not about
-  // ordering of tile_index accesses w.r.t. other memory accesses.
-  uint32_t tile_base =
-      iree_atomic_fetch_add(&dispatch_task->tile_index, tiles_per_reservation,
-                            iree_memory_order_relaxed);
-  while (tile_base < tile_count) {
-    const uint32_t tile_range =
-        iree_min(tile_base + tiles_per_reservation, tile_count);
+  const bool guided =
+      iree_any_bit_set(dispatch_task->header.flags,
+                       IREE_TASK_FLAG_DISPATCH_GUIDED);
+  const bool sticky = iree_task_dispatch_is_sticky(dispatch_task);
+  // Sticky dispatches start on the partition of the worker the shard was
+  // posted to. If the shard was stolen the thief takes over that partition.
+  const uint32_t partition_ordinal = sticky ? task->partition_ordinal : 0;
+  uint32_t victim_offset = 0;
+  uint32_t tile_base = 0;
+  uint32_t tile_range = 0;
+  while (sticky ? iree_task_dispatch_reserve_partition_tiles(
+                      dispatch_task, partition_ordinal, tiles_per_reservation,
+                      &victim_offset, &tile_base, &tile_range)
+                : iree_task_dispatch_reserve_tiles(
+                      dispatch_task, tile_count, tiles_per_reservation, guided,
+                      &tile_base, &tile_range)) {
+    // Reservations are contiguous in the linearized grid so we only need to
+    // delinearize the first tile and can then walk the grid incrementally.
+    uint32_t tile_i = tile_base;
+    tile_context.workgroup_xyz[0] = tile_i % workgroup_count_x;
+    tile_i /= workgroup_count_x;
+    tile_context.workgroup_xyz[1] = tile_i % workgroup_count_y;
+    tile_i /= workgroup_count_y;
+    tile_context.workgroup_xyz[2] = tile_i;
     for (uint32_t tile_index = tile_base; tile_index < tile_range;
          ++tile_index) {
-      // TODO(benvanik): faster math here, especially knowing we pull off N
-      // sequential indices per reservation.
-      uint32_t tile_i = tile_index;
-      tile_context.workgroup_xyz[0] = tile_i % workgroup_count_x;
-      tile_i /= workgroup_count_x;
-      tile_context.workgroup_xyz[1] = tile_i % workgroup_count_y;
-      tile_i /= workgroup_count_y;
-      tile_context.workgroup_xyz[2] = tile_i;
-
       IREE_TRACE_ZONE_BEGIN_NAMED(z_tile,
                                   "iree_task_dispatch_shard_execute_tile");
       IREE_TRACE_ZONE_SET_COLOR(z_tile, iree_task_tile_to_color(&tile_context));
@@ -808,12 +965,16 @@ void iree_task_dispatch_shard_execute(
         iree_task_try_set_status(&dispatch_task->status, status);
         goto abort_shard;  // out of the while-for nest
       }
-    }
 
-    // Try to grab the next slice of tiles.
-    tile_base =
-        iree_atomic_fetch_add(&dispatch_task->tile_index, tiles_per_reservation,
-                              iree_memory_order_relaxed);
+      // Advance to the next tile in x-major order.
+      if (++tile_context.workgroup_xyz[0] == workgroup_count_x) {
+        tile_context.workgroup_xyz[0] = 0;
+        if (++tile_context.workgroup_xyz[1] == workgroup_count_y) {
+          tile_context.workgroup_xyz[1] = 0;
+          ++tile_context.workgroup_xyz[2];
+        }
+      }
+    }
   }
 abort_shard:
 
@@ -117,6 +117,27 @@ enum iree_task_flag_bits_t {
   // happens and may be available for querying before all tasks have been
   // cleaned up.
   IREE_TASK_FLAG_ABORTED = 1u << 5,
+
+  // Dispatch shards reserve tiles from the grid using guided scheduling:
+  // each reservation takes a contiguous range of workgroups proportional to
+  // the number of tiles remaining divided across the shards. Reservations
+  // start large and shrink as the grid drains down to the normal reservation
+  // size. Dispatches with many small workgroups spend far less time contending
+  // on the shared tile index at the cost of coarser load balancing early in
+  // the dispatch.
+  IREE_TASK_FLAG_DISPATCH_GUIDED = 1u << 6,
+
+  // Dispatch shards process tiles from fixed per-worker partitions of the grid:
+  // the grid is split into one contiguous range per worker in the affinity set
+  // of the dispatch and the shard starting on range N is always posted to the
+  // Nth worker in the set. Repeatedly issuing the same dispatch (such as from
+  // a reusable command buffer) then keeps each range of workgroups on the same
+  // worker and its caches. Shards that drain
+  // their own partition steal from the tail of the others so load imbalance is
+  // still corrected. Ignored (falling back to the default schedule) if the
+  // dispatch does not have enough partition storage for all shards. Takes
+  // precedence over IREE_TASK_FLAG_DISPATCH_GUIDED.
+  IREE_TASK_FLAG_DISPATCH_STICKY = 1u << 7,
 };
 typedef uint16_t iree_task_flags_t;
 
@@ -449,6 +470,15 @@ typedef iree_alignas(iree_max_align_t) struct {
   // will be set to non-zero after it resolves in order to cancel the sibling
   // waits in the wait-any operation.
   iree_atomic_int32_t* cancellation_flag;
+
+  // Optional pointer to a status that receives the failure of the wait (such
+  // as IREE_STATUS_DEADLINE_EXCEEDED) instead of it failing the scope.
+  // When set a failed wait retires as if it had succeeded and the completion
+  // task is responsible for consuming the status. Only the first failure of
+  // all waits sharing the status is retained.
+  //
+  // If omitted failures propagate to the scope as normal.
+  iree_atomic_intptr_t* failure_status;
 } iree_task_wait_t;
 
 // Initializes |out_task| as a wait task on |wait_source|.
@@ -474,6 +504,12 @@ void iree_task_wait_initialize_delay(iree_task_scope_t* scope,
 void iree_task_wait_set_wait_any(iree_task_wait_t* task,
                                  iree_atomic_int32_t* cancellation_flag);
 
+// Redirects failures of the wait |task| to |failure_status| instead of the task
+// scope. The status must be kept live until after the wait task has retired
+// and ownership of any failure stored in it is transferred to the caller.
+void iree_task_wait_set_failure_status(iree_task_wait_t* task,
+                                       iree_atomic_intptr_t* failure_status);
+
 //==============================================================================
 // IREE_TASK_TYPE_DISPATCH_* structures
 //==============================================================================
@@ -643,9 +679,14 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
 
   // Maximum number of tiles to fetch per tile reservation from the grid.
   // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION and a
-  // reasonable number chosen based on the tile and shard counts.
+  // reasonable number chosen based on the tile and shard counts. With
+  // IREE_TASK_FLAG_DISPATCH_GUIDED this is the minimum reservation size.
   uint32_t tiles_per_reservation;
 
+  // Number of shards the dispatch was issued as. Used to divide the remaining
+  // tiles across shards with IREE_TASK_FLAG_DISPATCH_GUIDED.
+  uint32_t shard_count;
+
   // The tail tile index; the next reservation will start from here.
   // This is used by shards to slice off the work to perform in their inner
   // loop. Ideally we'd have no destructive interference with other shared data
@@ -653,6 +694,13 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // per shard instead of once per slice and are less of a concern.
   iree_atomic_int32_t tile_index;
 
+  // Optional storage for IREE_TASK_FLAG_DISPATCH_STICKY partitions with room
+  // for |partition_capacity| entries. Each entry holds the remaining range of
+  // tiles [begin, end) in the partition packed as (end << 32) | begin. Reset
+  // each time the dispatch is issued and must remain valid until it retires.
+  iree_atomic_int64_t* partitions;
+  uint32_t partition_capacity;
+
   // Incrementing process-lifetime dispatch identifier.
   IREE_TRACE(int64_t dispatch_id;)
 } iree_task_dispatch_t;
@@ -678,6 +726,10 @@ typedef iree_alignas(iree_max_align_t) struct {
 
   // NOTE: the parent dispatch task this shard is applied to is in the
   // header.completion_task field.
+
+  // Partition of an IREE_TASK_FLAG_DISPATCH_STICKY dispatch the shard starts
+  // on. Unused by other dispatches.
+  uint32_t partition_ordinal;
 } iree_task_dispatch_shard_t;
 
 void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
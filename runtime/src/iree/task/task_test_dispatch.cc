@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include "iree/base/api.h"
@@ -70,7 +71,8 @@ class TaskDispatchTest : public TaskTest {
  public:
   void DispatchAndVerifyGrid(const uint32_t workgroup_size[3],
                              const uint32_t workgroup_count[3],
-                             uint32_t dispatch_flags) {
+                             uint32_t dispatch_flags,
+                             uint32_t partition_capacity = 0) {
     IREE_TRACE_SCOPE();
     GridCoverage coverage(workgroup_count);
     iree_task_dispatch_t task;
@@ -79,6 +81,10 @@ class TaskDispatchTest : public TaskTest {
         iree_task_make_dispatch_closure(GridCoverage::Tile, (void*)&coverage),
         workgroup_size, workgroup_count, &task);
     task.header.flags |= dispatch_flags;
+    std::unique_ptr<iree_atomic_int64_t[]> partitions(
+        new iree_atomic_int64_t[partition_capacity]);
+    task.partitions = partitions.get();
+    task.partition_capacity = partition_capacity;
     IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
     EXPECT_TRUE(coverage.Verify());
   }
@@ -112,6 +118,91 @@ TEST_F(TaskDispatchTest, Issue345) {
   DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
 }
 
+TEST_F(TaskDispatchTest, Issue345Guided) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_GUIDED);
+}
+
+// Large enough for guided reservations to span multiple rows and slices.
+TEST_F(TaskDispatchTest, IssueLargeGuided) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {513, 17, 7};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_GUIDED);
+}
+
+TEST_F(TaskDispatchTest, Issue345Sticky) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_STICKY,
+                        IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+}
+
+// Large enough for owners and thieves to each take multiple reservations.
+TEST_F(TaskDispatchTest, IssueLargeSticky) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {513, 17, 7};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_STICKY,
+                        IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+}
+
+// Sticky dispatches without enough partitions for all shards fall back to the
+// default schedule.
+TEST_F(TaskDispatchTest, IssueStickyWithoutPartitions) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {513, 17, 7};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_STICKY);
+}
+
+// Sticky dispatches only partition the grid across the workers in their
+// affinity set.
+TEST_F(TaskDispatchTest, IssueStickyWithAffinity) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {513, 17, 7};
+  GridCoverage coverage(kWorkgroupCount);
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(
+      &scope_,
+      iree_task_make_dispatch_closure(GridCoverage::Tile, (void*)&coverage),
+      kWorkgroupSize, kWorkgroupCount, &task);
+  task.header.flags |= IREE_TASK_FLAG_DISPATCH_STICKY;
+  task.header.affinity_set =
+      iree_task_affinity_for_worker(1) | iree_task_affinity_for_worker(3);
+  const int64_t kUnusedPartition = -1;
+  iree_atomic_int64_t partitions[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(partitions); ++i) {
+    iree_atomic_store(&partitions[i], kUnusedPartition,
+                      iree_memory_order_relaxed);
+  }
+  task.partitions = partitions;
+  task.partition_capacity = IREE_ARRAYSIZE(partitions);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_TRUE(coverage.Verify());
+  EXPECT_EQ(task.shard_count, 2u);
+  for (iree_host_size_t i = 2; i < IREE_ARRAYSIZE(partitions); ++i) {
+    EXPECT_EQ(iree_atomic_load(&partitions[i], iree_memory_order_relaxed),
+              kUnusedPartition);
+  }
+}
+
+TEST_F(TaskDispatchTest, IssueLarge) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {513, 17, 7};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
+}
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   IREE_TRACE_SCOPE();
 
@@ -148,6 +239,62 @@ TEST_F(TaskDispatchTest, IssueIndirect) {
   EXPECT_TRUE(coverage.Verify());
 }
 
+// Dispatches requiring more local memory than workers start with (64KB in the
+// test executor) grow the worker arenas instead of failing.
+TEST_F(TaskDispatchTest, IssueLargeLocalMemory) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {64, 1, 1};
+  static const uint32_t kLocalMemorySize = 4 * 1024 * 1024;
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    IREE_TRACE_SCOPE();
+    if (tile_context->local_memory.data_length < kLocalMemorySize) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "insufficient local memory");
+    }
+    memset(tile_context->local_memory.data, tile_context->workgroup_xyz[0],
+           kLocalMemorySize);
+    return iree_ok_status();
+  };
+
+  for (int i = 0; i < 2; ++i) {
+    iree_task_dispatch_t task;
+    iree_task_dispatch_initialize(&scope_,
+                                  iree_task_make_dispatch_closure(tile, NULL),
+                                  kWorkgroupSize, kWorkgroupCount, &task);
+    task.local_memory_size = kLocalMemorySize;
+    IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  }
+}
+
+// Dispatches requiring more local memory than the worker limit fail instead of
+// growing the worker arenas.
+TEST_F(TaskDispatchTest, IssueLocalMemoryOverLimit) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {4, 1, 1};
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    return iree_ok_status();
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, NULL),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  task.local_memory_size = IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT + 1;
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope_)),
+              StatusIs(StatusCode::kResourceExhausted));
+}
+
 TEST_F(TaskDispatchTest, IssueFailure) {
   IREE_TRACE_SCOPE();
 
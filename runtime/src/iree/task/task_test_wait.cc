@@ -96,6 +96,29 @@ TEST_F(TaskWaitTest, IssueTimeout) {
   iree_event_deinitialize(&event);
 }
 
+// Issues a wait task that times out with its failure redirected to a status
+// owned by the caller. The scope should not fail.
+TEST_F(TaskWaitTest, IssueTimeoutFailureStatus) {
+  IREE_TRACE_SCOPE();
+
+  iree_event_t event;
+  iree_event_initialize(/*initial_state=*/false, &event);
+
+  iree_task_wait_t task;
+  iree_task_wait_initialize(&scope_, iree_event_await(&event),
+                            iree_time_now() + (50 * 1000000), &task);
+  iree_atomic_intptr_t failure_status = IREE_ATOMIC_VAR_INIT(0);
+  iree_task_wait_set_failure_status(&task, &failure_status);
+
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  EXPECT_THAT(Status((iree_status_t)iree_atomic_exchange(
+                  &failure_status, 0, iree_memory_order_acquire)),
+              StatusIs(StatusCode::kDeadlineExceeded));
+
+  iree_event_deinitialize(&event);
+}
+
 // Issues a delay task that should wait until the requested time.
 // NOTE: this kind of test can be flaky - if we have issues we can bump the
 // sleep time up.
@@ -11,23 +11,72 @@
 
 #include "iree/base/api.h"
 
+static_assert(IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT <= UINT8_MAX + 1,
+              "group_index must be able to hold all group indices");
+
 void iree_task_topology_group_initialize(
     uint8_t group_index, iree_task_topology_group_t* out_group) {
   memset(out_group, 0, sizeof(*out_group));
   out_group->group_index = group_index;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "iree-worker-%u",
            group_index);
+  out_group->node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
   out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
+  out_group->llc_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
 }
 
 void iree_task_topology_initialize(iree_task_topology_t* out_topology) {
   IREE_ASSERT_ARGUMENT(out_topology);
   memset(out_topology, 0, sizeof(*out_topology));
+  out_topology->group_storage_capacity =
+      IREE_ARRAYSIZE(out_topology->inline_groups);
+  out_topology->groups = out_topology->inline_groups;
 }
 
 void iree_task_topology_deinitialize(iree_task_topology_t* topology) {
   IREE_ASSERT_ARGUMENT(topology);
+  if (topology->groups != topology->inline_groups) {
+    iree_allocator_free(iree_allocator_system(), topology->groups);
+  }
+  topology->group_count = 0;
+  topology->group_storage_capacity = IREE_ARRAYSIZE(topology->inline_groups);
+  topology->groups = topology->inline_groups;
+}
+
+iree_status_t iree_task_topology_reserve(iree_task_topology_t* topology,
+                                         iree_host_size_t group_count) {
+  IREE_ASSERT_ARGUMENT(topology);
+  if (group_count <= topology->group_storage_capacity) {
+    return iree_ok_status();
+  } else if (group_count > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many groups specified (%" PRIhsz
+                            " provided for a max capacity of %d)",
+                            group_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, group_count);
+
+  // Grow geometrically when pushing one group at a time.
+  iree_host_size_t new_capacity =
+      iree_min(iree_max(group_count, topology->group_storage_capacity * 2),
+               IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
+  iree_task_topology_group_t* new_groups = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(iree_allocator_system(),
+                                new_capacity * sizeof(new_groups[0]),
+                                (void**)&new_groups));
+  memcpy(new_groups, topology->groups,
+         topology->group_count * sizeof(new_groups[0]));
+  if (topology->groups != topology->inline_groups) {
+    iree_allocator_free(iree_allocator_system(), topology->groups);
+  }
+  topology->groups = new_groups;
+  topology->group_storage_capacity = new_capacity;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_task_topology_parse(iree_string_view_t value,
@@ -49,7 +98,7 @@ bool iree_task_topology_format(const iree_task_topology_t* topology,
 
 iree_host_size_t iree_task_topology_group_capacity(
     const iree_task_topology_t* topology) {
-  return IREE_ARRAYSIZE(topology->groups);
+  return IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT;
 }
 
 iree_host_size_t iree_task_topology_group_count(
@@ -65,10 +114,12 @@ const iree_task_topology_group_t* iree_task_topology_get_group(
 
 iree_status_t iree_task_topology_push_group(
     iree_task_topology_t* topology, const iree_task_topology_group_t* group) {
-  if (topology->group_count + 1 > IREE_ARRAYSIZE(topology->groups)) {
+  if (topology->group_count + 1 > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "group capacity exceeded");
   }
+  IREE_RETURN_IF_ERROR(
+      iree_task_topology_reserve(topology, topology->group_count + 1));
   iree_task_topology_group_t* dst_group =
       &topology->groups[topology->group_count];
   memcpy(dst_group, group, sizeof(*group));
@@ -89,13 +140,19 @@ iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
 void iree_task_topology_initialize_from_group_count(
     iree_host_size_t group_count, iree_task_topology_t* out_topology) {
   // Clamp to the maximum we support.
-  group_count = iree_min(group_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  group_count = iree_min(group_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
 
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, group_count);
 
-  // Initialize default groups with no affinities specified.
+  // Initialize default groups with no affinities specified. If the storage
+  // for a large topology can't be allocated we clamp to the inline capacity.
   iree_task_topology_initialize(out_topology);
+  iree_status_t status = iree_task_topology_reserve(out_topology, group_count);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    group_count = out_topology->group_storage_capacity;
+  }
   for (iree_host_size_t i = 0; i < group_count; ++i) {
     iree_task_topology_group_t* group = &out_topology->groups[i];
     iree_task_topology_group_initialize(i, group);
@@ -115,11 +172,11 @@ iree_status_t iree_task_topology_initialize_from_thread_affinities(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (group_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (group_count > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many groups specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
-                            group_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+                            " provided for a max capacity of %d)",
+                            group_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -127,6 +184,8 @@ iree_status_t iree_task_topology_initialize_from_thread_affinities(
 
   // Initialize each group with the given affinities.
   iree_task_topology_initialize(out_topology);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, group_count));
   for (iree_host_size_t i = 0; i < group_count; ++i) {
     iree_task_topology_group_t* group = &out_topology->groups[i];
     iree_task_topology_group_initialize(i, group);
@@ -138,6 +197,9 @@ iree_status_t iree_task_topology_initialize_from_thread_affinities(
   // No-op if the platform support is not available.
   iree_status_t status =
       iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  if (!iree_status_is_ok(status)) {
+    iree_task_topology_deinitialize(out_topology);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
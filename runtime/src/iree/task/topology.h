@@ -43,12 +43,33 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void);
 
 // A bitmask indicating which other groups from 0 to N may constructively share
 // caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
+//
+// Masks only cover groups within the same block of 64 groups: bit N of the mask
+// of group G refers to group iree_task_topology_group_mask_base(G) + N. Caches
+// are only ever shared by nearby processors and groups are assigned in
+// processor order so sharing across blocks is not tracked.
 typedef uint64_t iree_task_topology_group_mask_t;
 
 #define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
 #define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
   (sizeof(iree_task_topology_group_mask_t) * 8)
 
+// Maximum number of groups in a topology.
+#define IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+
+// Number of groups stored inline within iree_task_topology_t. Topologies with
+// more groups spill to a heap allocation so that the structure stays small
+// enough to live on the stack.
+#define IREE_TASK_TOPOLOGY_INLINE_GROUP_COUNT \
+  iree_min(64, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT)
+
+// Returns the index of the first group in the block of groups covered by the
+// constructive sharing mask of group |group_index|.
+static inline iree_host_size_t iree_task_topology_group_mask_base(
+    iree_host_size_t group_index) {
+  return group_index & ~(IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT - 1);
+}
+
 // Total cache sizes (that we care about).
 // More information may be available but we shouldn't be specializing on it
 // unless absolutely required. Values should ideally be a power-of-two if
@@ -64,8 +85,8 @@ typedef struct iree_task_topology_caches_t {
 // Groups may be of varying levels of granularity even within the same topology
 // based on how the topology is defined.
 typedef struct iree_task_topology_group_t {
-  // Group index within the topology matching a particular bit in
-  // iree_task_topology_group_mask_t.
+  // Group index within the topology. Bit (group_index % 64) in the
+  // iree_task_topology_group_mask_t of other groups in the same block.
   uint8_t group_index;
 
   // A name assigned to executor workers used for logging/tracing.
@@ -74,6 +95,11 @@ typedef struct iree_task_topology_group_t {
   // Logical processor index.
   uint32_t processor_index;
 
+  // NUMA node the processor belongs to or IREE_TASK_TOPOLOGY_NODE_ID_ANY if
+  // unknown. Workers in the group bind their memory policy to this node so
+  // that pages they first-touch are allocated from node-local memory.
+  iree_task_topology_node_id_t node_id;
+
   // Total cache sizes (that we care about).
   iree_task_topology_caches_t caches;
 
@@ -88,6 +114,13 @@ typedef struct iree_task_topology_group_t {
   // workers in a group all share an L2 cache then the groups indicated here may
   // all share the same L3 cache.
   iree_task_topology_group_mask_t constructive_sharing_mask;
+
+  // A bitmask of other group indices that share the last level cache (L3 on
+  // most systems). On chiplet-based CPUs this is the core complex (CCX) and
+  // crossing it is significantly more expensive than a cache miss within it.
+  // Work stealing prefers victims in this set after those that constructively
+  // share lower cache levels.
+  iree_task_topology_group_mask_t llc_sharing_mask;
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
@@ -115,17 +148,32 @@ void iree_task_topology_group_initialize(uint8_t group_index,
 // and attempt to derive some (hopefully) useful task system topology from it.
 // We can add the more common heuristics over time to the core and leave the
 // edge cases for applications to construct.
+//
+// Topologies reference their own inline storage and must not be copied by
+// value.
 typedef struct iree_task_topology_t {
   iree_host_size_t group_count;
-  iree_task_topology_group_t groups[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  // Number of groups |groups| can hold without growing.
+  iree_host_size_t group_storage_capacity;
+  // Either |inline_groups| or a heap allocation owned by the topology when more
+  // than IREE_TASK_TOPOLOGY_INLINE_GROUP_COUNT groups have been reserved.
+  iree_task_topology_group_t* groups;
+  iree_task_topology_group_t
+      inline_groups[IREE_TASK_TOPOLOGY_INLINE_GROUP_COUNT];
 } iree_task_topology_t;
 
 // Initializes an empty task topology.
 void iree_task_topology_initialize(iree_task_topology_t* out_topology);
 
-// Deinitializes a topology structure.
+// Deinitializes a topology structure and releases any heap storage.
 void iree_task_topology_deinitialize(iree_task_topology_t* topology);
 
+// Ensures |topology| has storage for at least |group_count| groups.
+// Groups beyond the current group count are left uninitialized. Fails if
+// |group_count| exceeds IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT.
+iree_status_t iree_task_topology_reserve(iree_task_topology_t* topology,
+                                         iree_host_size_t group_count);
+
 // Parses a serialized topology in string form.
 iree_status_t iree_task_topology_parse(iree_string_view_t value,
                                        iree_task_topology_t* out_topology);
@@ -136,7 +184,7 @@ bool iree_task_topology_format(const iree_task_topology_t* topology,
                                iree_host_size_t buffer_capacity, char* buffer,
                                iree_host_size_t* out_buffer_length);
 
-// Returns the group capacity in the topology structure.
+// Returns the maximum number of groups the topology structure can hold.
 iree_host_size_t iree_task_topology_group_capacity(
     const iree_task_topology_t* topology);
 
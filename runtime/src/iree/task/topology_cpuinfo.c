@@ -5,7 +5,6 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include "iree/base/api.h"
-#include "iree/base/internal/math.h"
 #include "iree/task/topology.h"
 
 #if !defined(IREE_PLATFORM_APPLE) && !defined(IREE_PLATFORM_EMSCRIPTEN) && \
@@ -47,17 +46,19 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
-                            cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+                            " provided for a max capacity of %d)",
+                            cpu_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, cpu_count);
 
   iree_task_topology_initialize(out_topology);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, cpu_count));
 
   out_topology->group_count = cpu_count;
   for (iree_host_size_t i = 0; i < cpu_count; ++i) {
@@ -80,6 +81,9 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 
   iree_status_t status =
       iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  if (!iree_status_is_ok(status)) {
+    iree_task_topology_deinitialize(out_topology);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -182,6 +186,9 @@ static void iree_task_topology_group_initialize_from_processor(
   out_group->processor_index =
       processor->core->processor_start + processor->smt_id;
 #endif  // __linux__
+  // NOTE: cpuinfo clusters are the closest thing it exposes to a NUMA node and
+  // on multi-socket systems each package has at least one cluster.
+  out_group->node_id = processor->cluster->cluster_id;
   out_group->caches.l1_data =
       processor->cache.l1d ? processor->cache.l1d->size : 0;
   out_group->caches.l2_data =
@@ -206,33 +213,32 @@ static void iree_task_topology_group_initialize_from_core(
                                                      out_group);
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
-  for (uint32_t processor_i = 0; processor_i < cache->processor_count;
-       ++processor_i) {
-    uint32_t i = cache->processor_start + processor_i;
-    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
-    }
-  }
-  return mask;
+// Returns true if |processor| and |other_processor| share any of the caches
+// that we consider for constructive sharing.
+static bool iree_task_topology_processors_share_cache(
+    const struct cpuinfo_processor* processor,
+    const struct cpuinfo_processor* other_processor) {
+  // NOTE: cpuinfo caches are unique objects shared by all processors attached
+  // to them so comparing pointers is enough and unlike processor bitmasks
+  // works for any number of processors. L3 is tracked separately in the last
+  // level cache sharing mask.
+  return (processor->cache.l1i &&
+          processor->cache.l1i == other_processor->cache.l1i) ||
+         (processor->cache.l1d &&
+          processor->cache.l1d == other_processor->cache.l1d) ||
+         (processor->cache.l2 &&
+          processor->cache.l2 == other_processor->cache.l2);
 }
 
-// Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
-    const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
-  // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
-  // info purely for distribution and focus the group mask on lower-latency
-  // caches?
-  return mask;
+// Returns true if |processor| and |other_processor| share the last level cache.
+// Systems without an L3 fall back to the lower levels.
+static bool iree_task_topology_processors_share_last_level_cache(
+    const struct cpuinfo_processor* processor,
+    const struct cpuinfo_processor* other_processor) {
+  if (processor->cache.l3) {
+    return processor->cache.l3 == other_processor->cache.l3;
+  }
+  return iree_task_topology_processors_share_cache(processor, other_processor);
 }
 
 iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
@@ -242,26 +248,33 @@ iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
     return iree_ok_status();
   }
 
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n*64) as group masks only cover the block of 64 groups each group is in.
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
-
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
 
     iree_task_topology_group_mask_t group_mask = 0;
-    for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
-      const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+    iree_task_topology_group_mask_t llc_group_mask = 0;
+    iree_host_size_t block_base = iree_task_topology_group_mask_base(i);
+    iree_host_size_t block_end =
+        iree_min(topology->group_count,
+                 block_base + IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+    for (iree_host_size_t j = block_base; j < block_end; ++j) {
+      const struct cpuinfo_processor* other_processor =
+          cpuinfo_get_processor(topology->groups[j].processor_index);
+      if (iree_task_topology_processors_share_cache(processor,
+                                                    other_processor)) {
+        group_mask |= 1ull << (j - block_base);
+      }
+      if (iree_task_topology_processors_share_last_level_cache(
+              processor, other_processor)) {
+        llc_group_mask |= 1ull << (j - block_base);
       }
     }
 
     group->constructive_sharing_mask = group_mask;
+    group->llc_sharing_mask = llc_group_mask;
   }
 
   return iree_ok_status();
@@ -278,11 +291,11 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
-                            cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+                            " provided for a max capacity of %d)",
+                            cpu_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
   }
 
   // Validate the CPU IDs provided.
@@ -301,6 +314,8 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, cpu_count);
 
   iree_task_topology_initialize(out_topology);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, cpu_count));
 
   out_topology->group_count = cpu_count;
   for (iree_host_size_t i = 0; i < cpu_count; ++i) {
@@ -312,6 +327,9 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 
   iree_status_t status =
       iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  if (!iree_status_is_ok(status)) {
+    iree_task_topology_deinitialize(out_topology);
+  }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -379,7 +397,8 @@ iree_task_topology_initialize_from_physical_cores_with_filter(
     return iree_ok_status();
   }
 
-  max_core_count = iree_min(max_core_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  max_core_count =
+      iree_min(max_core_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, max_core_count);
 
@@ -392,6 +411,8 @@ iree_task_topology_initialize_from_physical_cores_with_filter(
   core_count = iree_min(core_count, max_core_count);
 
   iree_task_topology_initialize(out_topology);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, core_count));
 
   // Build each core up to the max allowed.
   // TODO(benvanik): if our group_count <= core_count/2 then distribute better;
@@ -415,6 +436,9 @@ iree_task_topology_initialize_from_physical_cores_with_filter(
 
   iree_status_t status =
       iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  if (!iree_status_is_ok(status)) {
+    iree_task_topology_deinitialize(out_topology);
+  }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -27,17 +27,19 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
-                            cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+                            " provided for a max capacity of %d)",
+                            cpu_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, cpu_count);
 
   iree_task_topology_initialize(out_topology);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, cpu_count));
 
   out_topology->group_count = cpu_count;
   for (iree_host_size_t i = 0; i < cpu_count; ++i) {
@@ -60,6 +62,9 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 
   iree_status_t status =
       iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  if (!iree_status_is_ok(status)) {
+    iree_task_topology_deinitialize(out_topology);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
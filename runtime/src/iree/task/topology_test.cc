@@ -60,6 +60,7 @@ TEST(TopologyTest, Construction) {
     const iree_task_topology_group_t* group =
         iree_task_topology_get_group(&topology, i);
     EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY, group->node_id);
   }
 
   iree_task_topology_deinitialize(&topology);
@@ -99,6 +100,37 @@ TEST(TopologyTest, MaxCapacity) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, ReserveBeyondInlineCapacity) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // Groups pushed before spilling to the heap must be preserved.
+  static constexpr iree_host_size_t kGroupCount =
+      IREE_TASK_TOPOLOGY_INLINE_GROUP_COUNT + 1;
+  for (iree_host_size_t i = 0; i < kGroupCount; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.processor_index = i;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+  EXPECT_EQ(kGroupCount, iree_task_topology_group_count(&topology));
+  for (iree_host_size_t i = 0; i < kGroupCount; ++i) {
+    const iree_task_topology_group_t* group =
+        iree_task_topology_get_group(&topology, i);
+    EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(i, group->processor_index);
+  }
+
+  // Reserving beyond the maximum fails and leaves the topology unchanged.
+  iree_status_t status = iree_task_topology_reserve(
+      &topology, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT + 1);
+  EXPECT_TRUE(iree_status_is_resource_exhausted(status));
+  iree_status_ignore(status);
+  EXPECT_EQ(kGroupCount, iree_task_topology_group_count(&topology));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 TEST(TopologyTest, FromGroupCount) {
   static constexpr iree_host_size_t kGroupCount = 4;
   iree_task_topology_t topology;
@@ -117,6 +149,27 @@ TEST(TopologyTest, FromGroupCount) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, FromGroupCountAboveMaskBits) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // More groups than fit in a single group mask are allowed up to capacity.
+  iree_task_topology_initialize_from_group_count(
+      IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT + 1, &topology);
+  EXPECT_EQ(iree_task_topology_group_count(&topology),
+            IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
+  for (iree_host_size_t i = 0; i < iree_task_topology_group_count(&topology);
+       ++i) {
+    const iree_task_topology_group_t* group =
+        iree_task_topology_get_group(&topology, i);
+    EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(i - i % IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT,
+              iree_task_topology_group_mask_base(group->group_index));
+  }
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 // Verifies only that the |topology| is usable.
 // If we actually checked the contents here then we'd just be validating that
 // cpuinfo was working and the tests would become machine-dependent.
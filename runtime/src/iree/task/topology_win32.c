@@ -96,22 +96,36 @@ static void iree_task_topology_assign_cache_info(
   }
 }
 
-// Uses |group_mask| to assign constructive sharing masks to all topology groups
-// that constructively share some level of the cache hierarchy.
-static void iree_task_topology_assign_constructive_sharing(
-    iree_task_topology_t* topology, GROUP_AFFINITY group_mask) {
+// Uses |group_mask| to assign sharing masks to all topology groups that
+// constructively share the cache at |cache_level| of the hierarchy. L1/L2
+// caches populate the constructive sharing mask and L3 caches populate the
+// last level cache sharing mask.
+static void iree_task_topology_assign_cache_sharing(
+    iree_task_topology_t* topology, GROUP_AFFINITY group_mask,
+    BYTE cache_level) {
   // NOTE: O(n^2) but should always be small (~number of NUMA nodes).
   for (iree_host_size_t group_i = 0; group_i < topology->group_count;
        ++group_i) {
     iree_task_topology_group_t* group = &topology->groups[group_i];
     if (group->ideal_thread_affinity.group == group_mask.Group &&
         (group_mask.Mask & (1ull << group->ideal_thread_affinity.id))) {
-      for (iree_host_size_t group_j = 0; group_j < topology->group_count;
+      // Masks only cover the block of groups containing the group.
+      iree_host_size_t block_base = iree_task_topology_group_mask_base(group_i);
+      iree_host_size_t block_end =
+          iree_min(topology->group_count,
+                   block_base + IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+      for (iree_host_size_t group_j = block_base; group_j < block_end;
            ++group_j) {
         iree_task_topology_group_t* other = &topology->groups[group_j];
         if (other->ideal_thread_affinity.group == group_mask.Group &&
             (group_mask.Mask & (1ull << other->ideal_thread_affinity.id))) {
-          group->constructive_sharing_mask |= 1ull << group_j;
+          iree_task_topology_group_mask_t other_bit =
+              1ull << (group_j - block_base);
+          if (cache_level == 3) {
+            group->llc_sharing_mask |= other_bit;
+          } else {
+            group->constructive_sharing_mask |= other_bit;
+          }
         }
       }
     }
@@ -119,7 +133,7 @@ static void iree_task_topology_assign_constructive_sharing(
 }
 
 // Assigns constructive sharing masks to each topology group. These indicate
-// which other topology groups share L3 caches (if any).
+// which other topology groups share L2 and L3 caches (if any).
 static void
 iree_task_topology_fixup_constructive_sharing_masks_from_relationships(
     SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* relationships,
@@ -138,15 +152,15 @@ iree_task_topology_fixup_constructive_sharing_masks_from_relationships(
                                                &p->Cache);
         }
       }
-      if (p->Cache.Level == 3 &&
+      if ((p->Cache.Level == 2 || p->Cache.Level == 3) &&
           (p->Cache.Type == CacheUnified || p->Cache.Type == CacheData)) {
         if (p->Cache.GroupCount == 0) {
-          iree_task_topology_assign_constructive_sharing(topology,
-                                                         p->Cache.GroupMask);
+          iree_task_topology_assign_cache_sharing(topology, p->Cache.GroupMask,
+                                                  p->Cache.Level);
         } else {
           for (WORD i = 0; i < p->Cache.GroupCount; ++i) {
-            iree_task_topology_assign_constructive_sharing(
-                topology, p->Cache.GroupMasks[i]);
+            iree_task_topology_assign_cache_sharing(
+                topology, p->Cache.GroupMasks[i], p->Cache.Level);
           }
         }
       }
@@ -201,11 +215,11 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     iree_task_topology_t* out_topology) {
   // Today we have a fixed limit on the number of groups within a particular
   // topology.
-  if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+  if (cpu_count > IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
-                            cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+                            " provided for a max capacity of %d)",
+                            cpu_count, IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -278,6 +292,9 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
     included_processors[cpu_ids[i]] = 1;
   }
 
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, cpu_count));
+
   // Build an on-stack table for random access into all logical processors.
   // This isn't strictly required but makes it easier to walk the CPU table.
   iree_host_size_t global_processor_count = 0;
@@ -299,6 +316,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
         iree_task_topology_group_initialize(group_index, group);
         group->processor_index = (uint32_t)global_processor_index;
         group->constructive_sharing_mask = 0;  // set below
+        group->llc_sharing_mask = 0;           // set below
 
         // Pin group to the processor.
         iree_thread_affinity_t* affinity = &group->ideal_thread_affinity;
@@ -487,7 +505,10 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
   // Clamp the total number of cores available to the max provided.
   // This is the number of topology groups we'll create.
   iree_host_size_t used_core_count =
-      iree_min(selected_core_count, max_core_count);
+      iree_min(iree_min(selected_core_count, max_core_count),
+               IREE_TASK_TOPOLOGY_MAX_GROUP_COUNT);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_task_topology_reserve(out_topology, used_core_count));
 
   // Check if the current (base) processor is part of the filtered groups.
   // If so we perform rotation to favor cores other than the current one.
@@ -543,6 +564,7 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
     iree_task_topology_group_initialize(group_index, group);
     group->processor_index = (uint32_t)adjusted_core_index;
     group->constructive_sharing_mask = 0;  // set below
+    group->llc_sharing_mask = 0;           // set below
     iree_task_topology_set_affinity_from_processor(
         core, &group->ideal_thread_affinity);
   }
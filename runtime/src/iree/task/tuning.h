@@ -7,15 +7,21 @@
 #ifndef IREE_TASK_TUNING_H_
 #define IREE_TASK_TUNING_H_
 
+#include "iree/base/target_platform.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
-#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+// Workers are tracked in bitsets of one uint64_t word per 64 workers (see
+// iree_task_worker_set_t) and each additional word adds a small amount of
+// overhead to posting and stealing. It's easy to go smaller if it's known that
+// only <=64 will ever be used (such as for devices with 2 cores) and then all
+// worker sets are a single word.
+#if !defined(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
+#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (256)
+#endif  // !IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -33,18 +39,28 @@ extern "C" {
 // waits deeper in the pipeline so long as they don't all become ready
 // simultaneously.
 //
-// Realistically, though, if we have more than 64 outstanding **root** waits
-// it's hard to reason about if/when the executor queue could make forward
-// progress and indicates a possible error in task assignment.
-//
-// Also, the underlying iree_wait_set_t may not support more than 64 handles on
-// certain platforms without emulation. Trying to keep us on the fast-path
-// with a reasonable number seems fine for now until we have a need for more.
+// The underlying iree_wait_set_t is limited to 64 handles on Win32
+// (WaitForMultipleObjects) while the poll-based implementations used elsewhere
+// scale to many more. Programs multiplexed on an iree_task_loop_t may each have
+// a root wait outstanding and the larger limit keeps them all on the fast-path.
 //
 // NOTE: we reserve 1 wait handle for our own internal use. This allows us to
 // wake the coordination worker when new work is submitted from external
 // sources.
+#if !defined(IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS)
+#if defined(IREE_PLATFORM_WINDOWS)
 #define IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS (64 - 1)
+#else
+#define IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS (1024 - 1)
+#endif  // IREE_PLATFORM_WINDOWS
+#endif  // !IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS
+
+// Interval at which the poller queries wait tasks that did not fit in the wait
+// set (see IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS). Waits beyond the
+// capacity of the wait set are polled until a slot frees up such that any
+// number of waits may be outstanding. Overflowed waits are only noticed on the
+// next poll and may resolve up to this much later than they are signaled.
+#define IREE_TASK_EXECUTOR_WAIT_OVERFLOW_POLL_NS (200 /*us*/ * 1000)
 
 // Amount of time that can remain in a delay task while still retiring.
 // This prevents additional system sleeps when the remaining time before the
@@ -77,8 +93,52 @@ extern "C" {
 // In real-time systems too few tasks is better (slightly more work for much
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
-#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT (64)
+
+// Maximum number of tasks stolen in one go from a victim at each level of the
+// cache/memory hierarchy. Work stealing tries victims from the nearest level
+// outward and takes up to the count for the level the victim is found at.
+//
+// Tasks stolen from nearby victims are likely to touch data already in shared
+// caches and are cheap to move. Tasks stolen from victims in another last level
+// cache domain (a different CCX on chiplet CPUs) or on another NUMA node will
+// have to pull all of their data across the interconnect and taking fewer of
+// them at a time leaves more of the work with workers close to its data while
+// still keeping the thief busy.
+//
+// Victims sharing L1/L2 caches (constructive sharing):
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_SHARED_CACHE \
+  IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT
+// Victims sharing the last level cache:
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_SHARED_LLC \
+  IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT
+// Victims on the same NUMA node but in another last level cache domain:
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_SAME_NODE \
+  (IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT / 2)
+// Victims on other NUMA nodes:
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT_REMOTE \
+  (IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT / 4)
+
+// Minimum spin/yield budget used by workers with the adaptive idle policy.
+// Budgets shrinking below this disable spinning entirely until work is observed
+// arriving soon after parking and budgets growing from zero start here.
+#define IREE_TASK_WORKER_ADAPTIVE_IDLE_MIN_BUDGET_NS (1 /*us*/ * 1000)
+
+// Cache coloring of worker local memory arenas.
+// Arenas are page (or large page) aligned and without coloring the same offset
+// in each worker's arena would map to the same cache sets, causing conflict
+// misses in shared caches when workers run the same dispatch over their local
+// memory in lockstep. Each worker offsets the start of its arena by
+// (worker_index % COLOR_COUNT) * COLOR_STRIDE bytes so that workers rotate
+// through the sets. The stride must be a multiple of the destructive
+// interference size and the total span should stay within a normal page.
+#define IREE_TASK_WORKER_LOCAL_MEMORY_COLOR_COUNT (16)
+#define IREE_TASK_WORKER_LOCAL_MEMORY_COLOR_STRIDE (256)
+
+// Default maximum size in bytes each worker local memory arena may grow to when
+// executing dispatches requiring more local memory than it started with.
+// Arenas are never shrunk and this bounds the memory each worker can pin.
+#define IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT (32 * 1024 * 1024)
 
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
@@ -94,6 +154,13 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Divisor applied to the guided scheduling reservation size when dispatches
+// are issued with IREE_TASK_FLAG_DISPATCH_GUIDED. Each reservation takes
+// remaining_tiles / (shard_count * divisor) tiles. A divisor of 1 matches the
+// classic OpenMP guided schedule while larger values leave more tiles for load
+// balancing toward the end of the dispatch when tiles have uneven costs.
+#define IREE_TASK_DISPATCH_GUIDED_RESERVATION_DIVISOR (2)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
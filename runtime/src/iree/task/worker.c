@@ -11,6 +11,7 @@
 
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/memory.h"
 #include "iree/task/executor_impl.h"
 #include "iree/task/post_batch.h"
 #include "iree/task/submission.h"
@@ -21,26 +22,57 @@
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
 
+// Expands a topology |group_mask| into |out_set|.
+// Group masks only cover the block of 64 groups containing the group and that
+// block is the same as the worker set word |worker_word| the worker is in.
+static void iree_task_worker_expand_group_mask(
+    iree_task_executor_t* executor, iree_host_size_t worker_word,
+    iree_task_topology_group_mask_t group_mask,
+    iree_task_worker_set_t* out_set) {
+  if (group_mask == IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
+    iree_task_worker_set_fill(out_set, executor->worker_count);
+  } else {
+    iree_task_worker_set_clear(out_set);
+    out_set->words[worker_word] = group_mask;
+  }
+}
+
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
+    const iree_task_worker_set_t* node_sharing_mask,
+    iree_host_size_t stack_size, iree_host_size_t local_memory_size,
     iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->worker_bit = iree_task_worker_set_word_bit(worker_index);
+  out_worker->worker_word = iree_task_worker_set_word_index(worker_index);
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
-  out_worker->constructive_sharing_mask =
-      topology_group->constructive_sharing_mask;
+  iree_task_worker_expand_group_mask(
+      executor, out_worker->worker_word,
+      topology_group->constructive_sharing_mask,
+      &out_worker->constructive_sharing_mask);
+  iree_task_worker_expand_group_mask(executor, out_worker->worker_word,
+                                     topology_group->llc_sharing_mask,
+                                     &out_worker->llc_sharing_mask);
+  out_worker->node_id = topology_group->node_id;
+  out_worker->node_sharing_mask = *node_sharing_mask;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
-  out_worker->local_memory = local_memory;
+  out_worker->local_memory = iree_make_byte_span(NULL, 0);
+  out_worker->local_memory_allocation = NULL;
+  out_worker->local_memory_allocation_size = 0;
+  out_worker->local_memory_initial_size = local_memory_size;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+  iree_atomic_store(&out_worker->wake_post_time_ns, 0,
+                    iree_memory_order_relaxed);
+  out_worker->idle_budget_ns =
+      executor->worker_spin_ns + executor->worker_yield_ns;
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
@@ -137,38 +169,46 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
   iree_task_queue_deinitialize(&worker->local_task_queue);
 
+  iree_memory_pages_free(worker->local_memory_allocation,
+                         worker->local_memory_allocation_size);
+  worker->local_memory_allocation = NULL;
+  worker->local_memory_allocation_size = 0;
+  worker->local_memory = iree_make_byte_span(NULL, 0);
+
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Plots the percentage of workers in the executor that are active.
+// The idle mask may be changing concurrently and the value is approximate.
+static void iree_task_worker_plot_utilization(iree_task_worker_t* worker) {
+  IREE_TRACE({
+    iree_task_worker_set_t worker_idle_mask;
+    iree_atomic_task_worker_set_load(&worker->executor->worker_idle_mask,
+                                     iree_memory_order_relaxed,
+                                     &worker_idle_mask);
+    IREE_TRACE_PLOT_VALUE_F32(
+        worker->executor->trace_name,
+        100.0f - 100.0f * iree_task_worker_set_count_ones(&worker_idle_mask) /
+                     (float)worker->executor->worker_count);
+  });
+}
+
 // Marks the worker as "active" (scheduling work or executing it).
 // The idle mask is accessed with 'relaxed' order because it's just a hint.
 static void iree_task_worker_mark_active(iree_task_worker_t* worker) {
-  iree_task_affinity_set_t old_idle_mask =
-      iree_atomic_task_affinity_set_fetch_and(
-          &worker->executor->worker_idle_mask, ~worker->worker_bit,
-          iree_memory_order_relaxed);
-  (void)old_idle_mask;
-  IREE_TRACE_PLOT_VALUE_F32(
-      worker->executor->trace_name,
-      old_idle_mask
-          ? (100.0f -
-             100.0f * (iree_task_affinity_set_count_ones(old_idle_mask) - 1) /
-                 (float)worker->executor->worker_count)
-          : 100.0f);
+  iree_atomic_task_affinity_set_fetch_and(
+      &worker->executor->worker_idle_mask.words[worker->worker_word],
+      ~worker->worker_bit, iree_memory_order_relaxed);
+  iree_task_worker_plot_utilization(worker);
 }
 
 // Marks the worker as "idle" (sleeping/spinning waiting to wake).
 // The idle mask is accessed with 'relaxed' order because it's just a hint.
 static void iree_task_worker_mark_idle(iree_task_worker_t* worker) {
-  iree_task_affinity_set_t old_idle_mask =
-      iree_atomic_task_affinity_set_fetch_or(
-          &worker->executor->worker_idle_mask, worker->worker_bit,
-          iree_memory_order_relaxed);
-  (void)old_idle_mask;
-  IREE_TRACE_PLOT_VALUE_F32(
-      worker->executor->trace_name,
-      100.0f - 100.0f * (iree_task_affinity_set_count_ones(old_idle_mask) + 1) /
-                   (float)worker->executor->worker_count);
+  iree_atomic_task_affinity_set_fetch_or(
+      &worker->executor->worker_idle_mask.words[worker->worker_word],
+      worker->worker_bit, iree_memory_order_relaxed);
+  iree_task_worker_plot_utilization(worker);
 }
 
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
@@ -179,6 +219,35 @@ void iree_task_worker_post_tasks(iree_task_worker_t* worker,
   memset(list, 0, sizeof(*list));
 }
 
+void iree_task_worker_record_wake_post(iree_task_worker_t* worker,
+                                       iree_time_t post_time_ns) {
+  iree_atomic_store(&worker->wake_post_time_ns, post_time_ns,
+                    iree_memory_order_relaxed);
+}
+
+void iree_task_worker_consume_idle_statistics(
+    iree_task_worker_t* worker,
+    iree_task_worker_idle_statistics_t* out_statistics) {
+#define IREE_TASK_WORKER_CONSUME_STATISTIC(name) \
+  iree_atomic_exchange(&worker->idle_statistics.name, 0, \
+                       iree_memory_order_relaxed)
+  out_statistics->wait_count =
+      (uint64_t)IREE_TASK_WORKER_CONSUME_STATISTIC(wait_count);
+  out_statistics->spin_wake_count =
+      (uint64_t)IREE_TASK_WORKER_CONSUME_STATISTIC(spin_wake_count);
+  out_statistics->park_count =
+      (uint64_t)IREE_TASK_WORKER_CONSUME_STATISTIC(park_count);
+  out_statistics->spin_duration_ns =
+      IREE_TASK_WORKER_CONSUME_STATISTIC(spin_duration_ns);
+  out_statistics->wake_count =
+      (uint64_t)IREE_TASK_WORKER_CONSUME_STATISTIC(wake_count);
+  out_statistics->total_wake_latency_ns =
+      IREE_TASK_WORKER_CONSUME_STATISTIC(total_wake_latency_ns);
+  out_statistics->max_wake_latency_ns =
+      IREE_TASK_WORKER_CONSUME_STATISTIC(max_wake_latency_ns);
+#undef IREE_TASK_WORKER_CONSUME_STATISTIC
+}
+
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks) {
@@ -195,6 +264,70 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
   return NULL;
 }
 
+// Ensures that the worker local memory arena has at least |minimum_size| bytes
+// available. Fails if |minimum_size| exceeds the executor local memory limit
+// (or the initial size of the worker arena if larger) and leaves the existing
+// arena unchanged. The contents of the arena are not preserved when it grows.
+//
+// Must only be called from the worker thread.
+static iree_status_t iree_task_worker_reserve_local_memory(
+    iree_task_worker_t* worker, iree_host_size_t minimum_size) {
+  if (IREE_LIKELY(worker->local_memory.data_length >= minimum_size)) {
+    return iree_ok_status();
+  }
+  const iree_host_size_t limit =
+      iree_max(worker->executor->worker_local_memory_limit,
+               worker->local_memory_initial_size);
+  if (IREE_UNLIKELY(minimum_size > limit)) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "worker local memory of %" PRIhsz
+                            " bytes requested exceeds the limit of %" PRIhsz
+                            " bytes",
+                            minimum_size, limit);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)minimum_size);
+
+  // Release the existing arena first so that peak usage doesn't double.
+  iree_memory_pages_free(worker->local_memory_allocation,
+                         worker->local_memory_allocation_size);
+  worker->local_memory_allocation = NULL;
+  worker->local_memory_allocation_size = 0;
+  worker->local_memory = iree_make_byte_span(NULL, 0);
+
+  // Round the allocation including the color offset up to the pages backing
+  // it so that the arena covers whole large pages. Arenas smaller than a large
+  // page or that would exceed the limit when rounded to one only round up to
+  // normal pages. Any slack from rounding is usable by dispatches.
+  const iree_host_size_t color_offset =
+      (worker->worker_index % IREE_TASK_WORKER_LOCAL_MEMORY_COLOR_COUNT) *
+      IREE_TASK_WORKER_LOCAL_MEMORY_COLOR_STRIDE;
+  const iree_host_size_t required_size =
+      color_offset +
+      iree_host_align(minimum_size,
+                      iree_hardware_destructive_interference_size);
+  iree_host_size_t page_size = iree_memory_pages_granularity(
+      IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES);
+  if (required_size < page_size ||
+      iree_host_align(required_size, page_size) > color_offset + limit) {
+    page_size = iree_memory_pages_granularity(IREE_MEMORY_PAGE_FLAG_NONE);
+  }
+  const iree_host_size_t allocation_size =
+      iree_host_align(required_size, page_size);
+  void* allocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_memory_pages_allocate(
+              allocation_size, IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES,
+              &allocation));
+  worker->local_memory_allocation = allocation;
+  worker->local_memory_allocation_size = allocation_size;
+  worker->local_memory = iree_make_byte_span(
+      (uint8_t*)allocation + color_offset, allocation_size - color_offset);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 // Executes a task on a worker.
 // Only task types that are scheduled to workers are handled; all others must be
 // handled by the coordinator during scheduling.
@@ -215,6 +348,14 @@ static void iree_task_worker_execute(
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
+      // Grow the local memory arena if the dispatch requires more than any
+      // prior dispatch executed by the worker. Allocation failures and requests
+      // beyond the limit are reported by the shard when it finds the local
+      // memory insufficient.
+      const iree_task_dispatch_t* dispatch_task =
+          (const iree_task_dispatch_t*)task->completion_task;
+      iree_status_ignore(iree_task_worker_reserve_local_memory(
+          worker, dispatch_task->local_memory_size));
       iree_task_dispatch_shard_execute(
           (iree_task_dispatch_shard_t*)task, worker->processor_id,
           worker->worker_index, worker->local_memory, pending_submission);
@@ -229,6 +370,149 @@ static void iree_task_worker_execute(
   task = NULL;
 }
 
+// Polls the wake notification until it has been posted or |deadline_ns| is
+// reached. The processor is hinted that we are spinning between polls or, if
+// |yield_thread| is true, the thread is yielded to the system scheduler.
+// Returns true if the notification was posted.
+static bool iree_task_worker_poll_wake(iree_task_worker_t* worker,
+                                       iree_wait_token_t wait_token,
+                                       iree_time_t deadline_ns,
+                                       bool yield_thread) {
+  do {
+    if (iree_notification_poll_wait(&worker->wake_notification, wait_token)) {
+      return true;
+    }
+    if (yield_thread) {
+      iree_thread_yield();
+    } else {
+      iree_processor_yield();
+    }
+  } while (iree_time_now() < deadline_ns);
+  return iree_notification_poll_wait(&worker->wake_notification, wait_token);
+}
+
+// Waits for the worker to be woken with new work (or to exit) according to
+// the executor idle policy. Consumes the pending |wait_token|.
+//
+// Workers first spin and then yield for their budget and if no work has
+// arrived park in the system until posted. Spinning avoids the system round
+// trip of waking a parked thread (tens of microseconds on most platforms) when
+// new work arrives soon after the worker runs out. With the adaptive policy the
+// budget doubles when spinning would have (or did) catch new work and halves
+// when the worker ends up parked for longer than the budget.
+static void iree_task_worker_wait_for_work(iree_task_worker_t* worker,
+                                           iree_wait_token_t wait_token) {
+  iree_task_executor_t* executor = worker->executor;
+  iree_atomic_fetch_add(&worker->idle_statistics.wait_count, 1,
+                        iree_memory_order_relaxed);
+
+  // Split the budget between the spin and yield phases.
+  iree_duration_t spin_ns = executor->worker_spin_ns;
+  iree_duration_t yield_ns = 0;
+  const iree_duration_t max_budget_ns =
+      executor->worker_spin_ns + executor->worker_yield_ns;
+  switch (executor->worker_idle_policy) {
+    default:
+    case IREE_TASK_WORKER_IDLE_POLICY_PARK:
+      break;
+    case IREE_TASK_WORKER_IDLE_POLICY_SPIN_YIELD_PARK:
+      yield_ns = executor->worker_yield_ns;
+      break;
+    case IREE_TASK_WORKER_IDLE_POLICY_ADAPTIVE:
+      spin_ns = iree_min(worker->idle_budget_ns, executor->worker_spin_ns);
+      yield_ns = worker->idle_budget_ns - spin_ns;
+      break;
+  }
+
+  // Time is only queried when spinning or measuring wake latency so that
+  // workers parking immediately don't pay for it.
+  const bool measure_wake = executor->worker_wake_latency_statistics;
+  const iree_time_t wait_begin_ns =
+      (measure_wake || spin_ns > 0 || yield_ns > 0) ? iree_time_now()
+                                                    : IREE_TIME_INFINITE_PAST;
+
+  // Spin and then yield until woken or the budget is exhausted.
+  bool woken = false;
+  if (spin_ns > 0 || yield_ns > 0) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_spin, "iree_task_worker_main_pump_wake_spin");
+    if (spin_ns > 0) {
+      woken = iree_task_worker_poll_wake(worker, wait_token,
+                                         wait_begin_ns + spin_ns,
+                                         /*yield_thread=*/false);
+    }
+    if (!woken && yield_ns > 0) {
+      woken = iree_task_worker_poll_wake(worker, wait_token,
+                                         wait_begin_ns + spin_ns + yield_ns,
+                                         /*yield_thread=*/true);
+    }
+    IREE_TRACE_ZONE_END(z_spin);
+  }
+  const iree_time_t spin_end_ns =
+      (spin_ns > 0 || yield_ns > 0) ? iree_time_now() : wait_begin_ns;
+  iree_atomic_fetch_add(&worker->idle_statistics.spin_duration_ns,
+                        spin_end_ns - wait_begin_ns, iree_memory_order_relaxed);
+
+  if (woken) {
+    // Work arrived while spinning; the wait must still be committed to release
+    // the token but will return immediately.
+    iree_atomic_fetch_add(&worker->idle_statistics.spin_wake_count, 1,
+                          iree_memory_order_relaxed);
+    iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                  /*spin_ns=*/IREE_DURATION_ZERO,
+                                  /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+  } else {
+    // Park in the kernel. We don't care if the condition fails as we're just
+    // using it as a pulse.
+    iree_atomic_fetch_add(&worker->idle_statistics.park_count, 1,
+                          iree_memory_order_relaxed);
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_main_pump_wake_wait");
+    iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                  /*spin_ns=*/IREE_DURATION_ZERO,
+                                  /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+    IREE_TRACE_ZONE_END(z_wait);
+  }
+  // NOTE: the adaptive policy always measures wakes.
+  if (!measure_wake) return;
+  const iree_time_t wake_ns = iree_time_now();
+
+  // Measure the latency from the post that woke us, ignoring posts that
+  // happened before we started waiting (those were picked up by the prior
+  // pump).
+  const iree_time_t post_time_ns = iree_atomic_exchange(
+      &worker->wake_post_time_ns, 0, iree_memory_order_relaxed);
+  if (post_time_ns >= wait_begin_ns && post_time_ns <= wake_ns) {
+    const iree_duration_t latency_ns = wake_ns - post_time_ns;
+    iree_atomic_fetch_add(&worker->idle_statistics.wake_count, 1,
+                          iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&worker->idle_statistics.total_wake_latency_ns,
+                          latency_ns, iree_memory_order_relaxed);
+    if (latency_ns > iree_atomic_load(
+                         &worker->idle_statistics.max_wake_latency_ns,
+                         iree_memory_order_relaxed)) {
+      // Only the worker updates the max so a tear with a concurrent consume
+      // can at worst drop this sample.
+      iree_atomic_store(&worker->idle_statistics.max_wake_latency_ns,
+                        latency_ns, iree_memory_order_relaxed);
+    }
+  }
+
+  // Adapt the budget for the next wait.
+  if (executor->worker_idle_policy == IREE_TASK_WORKER_IDLE_POLICY_ADAPTIVE) {
+    const iree_duration_t parked_ns = wake_ns - spin_end_ns;
+    const iree_duration_t min_budget_ns =
+        IREE_TASK_WORKER_ADAPTIVE_IDLE_MIN_BUDGET_NS;
+    if (woken || parked_ns < max_budget_ns) {
+      // Spinning caught (or would have caught) the work; spin longer.
+      worker->idle_budget_ns = iree_min(
+          max_budget_ns, iree_max(worker->idle_budget_ns * 2, min_budget_ns));
+    } else {
+      // Parked for longer than we could have spun; spin less.
+      worker->idle_budget_ns /= 2;
+      if (worker->idle_budget_ns < min_budget_ns) worker->idle_budget_ns = 0;
+    }
+  }
+}
+
 // Pumps the worker thread once, processing a single task.
 // Returns true if pumping should continue as there are more tasks remaining or
 // false if the caller should wait for more tasks to be posted.
@@ -262,9 +546,10 @@ static bool iree_task_worker_pump_once(
   // the first task in the queue is popped off and returned.
   if (!task) {
     task = iree_task_executor_try_steal_task(
-        worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->executor, &worker->constructive_sharing_mask,
+        &worker->llc_sharing_mask, &worker->node_sharing_mask,
+        worker->max_theft_attempts,
+        &worker->theft_prng, &worker->local_task_queue);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -358,15 +643,8 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
     } else {
-      // Spin/wait in the kernel. We don't care if the condition fails as we're
-      // just using it as a pulse.
-      IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
-                                  "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
-      IREE_TRACE_ZONE_END(z_wait);
+      // Spin/yield/wait in the kernel based on the idle policy.
+      iree_task_worker_wait_for_work(worker, wait_token);
 
       // Woke from a wait - query the processor ID in case we migrated during
       // the sleep.
@@ -391,6 +669,20 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Prefer allocating pages first-touched by this worker (stacks, scratch
+  // buffers, and outputs of the tasks it runs) from its own NUMA node. This is
+  // best-effort as the platform may not support it or the process may be
+  // restricted from changing its memory policy.
+  if (worker->node_id != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+    iree_status_ignore(iree_memory_bind_thread_to_numa_node(worker->node_id));
+  }
+
+  // Allocate the initial local memory arena now that the memory policy has been
+  // set. Failures are ignored as the arena is reallocated on demand when a
+  // dispatch requires it.
+  iree_status_ignore(iree_task_worker_reserve_local_memory(
+      worker, worker->local_memory_initial_size));
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
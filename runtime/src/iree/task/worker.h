@@ -84,9 +84,10 @@ typedef struct iree_task_worker_t {
   // Globally unique worker index (worker_base_index + local worker_index).
   iree_host_size_t worker_index;
 
-  // Bit the worker represents in the various worker bitsets.
-  // Local to the executor owning the worker.
+  // Bit the worker represents in word |worker_word| of the various worker
+  // sets. Local to the executor owning the worker.
   iree_task_affinity_set_t worker_bit;
+  iree_host_size_t worker_word;
 
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
@@ -96,11 +97,23 @@ typedef struct iree_task_worker_t {
   // some cache levels higher up with these other groups. For example, if the
   // workers in a group all share an L2 cache then the groups indicated here may
   // all share the same L3 cache.
-  iree_task_affinity_set_t constructive_sharing_mask;
+  iree_task_worker_set_t constructive_sharing_mask;
+
+  // A bitmask of other workers sharing the last level cache with this worker.
+  // Work is preferentially stolen from these workers after those in
+  // constructive_sharing_mask and before crossing to other cache domains.
+  iree_task_worker_set_t llc_sharing_mask;
+
+  // NUMA node the worker is placed on or IREE_TASK_TOPOLOGY_NODE_ID_ANY.
+  iree_task_topology_node_id_t node_id;
+
+  // A bitmask of other workers on the same NUMA node. Work is preferentially
+  // stolen from these workers before crossing nodes.
+  iree_task_worker_set_t node_sharing_mask;
 
   // Maximum number of attempts to make when trying to steal tasks from other
-  // workers. This could be 64 (try stealing from all workers) or just a handful
-  // (try stealing from these 3 other cores that share your L3 cache).
+  // workers. This could be all workers (try stealing from everyone) or just a
+  // handful (try stealing from these 3 other cores that share your L3 cache).
   uint32_t max_theft_attempts;
 
   // Rotation counter for work stealing (ensures we don't favor one victim).
@@ -132,10 +145,38 @@ typedef struct iree_task_worker_t {
   // interference) this is the only place padding should be added.
   // uint8_t _padding[8];
 
+  // Time at which work was last posted to the worker while it may have been
+  // waiting. Used to measure wake latency and only written by posters when
+  // worker_wake_latency_statistics is enabled on the executor.
+  iree_atomic_int64_t wake_post_time_ns;
+
+  // Current combined spin and yield budget of the adaptive idle policy.
+  // Only ever touched by the worker thread.
+  iree_duration_t idle_budget_ns;
+
+  // Statistics describing how the worker waited for work. Only updated by the
+  // worker thread but may be consumed from any thread.
+  struct {
+    iree_atomic_int64_t wait_count;
+    iree_atomic_int64_t spin_wake_count;
+    iree_atomic_int64_t park_count;
+    iree_atomic_int64_t spin_duration_ns;
+    iree_atomic_int64_t wake_count;
+    iree_atomic_int64_t total_wake_latency_ns;
+    iree_atomic_int64_t max_wake_latency_ns;
+  } idle_statistics;
+
   // Pointer to local memory available for use exclusively by the worker.
-  // The base address should be aligned to avoid false sharing with other
-  // workers.
+  // The arena is allocated from the worker thread so that it is first-touched
+  // on the worker's NUMA node, is backed by large pages where available, and
+  // grows to the largest local memory required by any dispatch the worker
+  // executes. The usable range starts at the worker's cache color offset
+  // within the allocation (see IREE_TASK_WORKER_LOCAL_MEMORY_COLOR_STRIDE).
   iree_byte_span_t local_memory;
+  void* local_memory_allocation;
+  iree_host_size_t local_memory_allocation_size;
+  // Size of the local memory arena allocated when the worker starts.
+  iree_host_size_t local_memory_initial_size;
 
   // Worker-local FIFO queue containing the tasks that will be processed by the
   // worker. This queue supports work-stealing by other workers if they run out
@@ -159,7 +200,8 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
+    const iree_task_worker_set_t* node_sharing_mask,
+    iree_host_size_t stack_size, iree_host_size_t local_memory_size,
     iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
 
 // Requests that the worker begin exiting (if it hasn't already).
@@ -190,6 +232,21 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list);
 
+// Records that work was posted to the worker at |post_time_ns| for the
+// purposes of measuring wake latency. Must be called prior to waking the
+// worker.
+//
+// May be called from any thread.
+void iree_task_worker_record_wake_post(iree_task_worker_t* worker,
+                                       iree_time_t post_time_ns);
+
+// Returns and resets the idle statistics of the worker.
+//
+// May be called from any thread.
+void iree_task_worker_consume_idle_statistics(
+    iree_task_worker_t* worker,
+    iree_task_worker_idle_statistics_t* out_statistics);
+
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
 // that were at the tail of the worker FIFO will be moved to the |target_queue|
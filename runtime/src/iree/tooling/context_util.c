@@ -15,6 +15,7 @@
 #include "iree/base/internal/path.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/plugins/registration/init.h"
+#include "iree/io/file_handle.h"
 #include "iree/modules/hal/inline/module.h"
 #include "iree/modules/hal/loader/module.h"
 #include "iree/modules/hal/module.h"
@@ -37,12 +38,51 @@ IREE_FLAG_LIST(
     "module. HAL modules are added automatically when required.");
 
 IREE_FLAG(
-    string, module_mode, "preload",
-    "A module I/O mode of ['preload', 'mmap'].\n"
-    "  preload: read entire module into wired memory on startup.\n"
-    "  mmap: maps the module file into discardable memory - can increase\n"
-    "        warm-up time and variance as mapped pages are swapped\n"
-    "        by the OS.");
+    string, module_mode, "mmap",
+    "A module I/O mode of ['mmap', 'preload'].\n"
+    "  mmap: maps the module file read-only and references embedded rodata\n"
+    "        in-place without copying it; pages are faulted in when first\n"
+    "        accessed and may be evicted by the OS under memory pressure.\n"
+    "  preload: read entire module into wired memory on startup - can\n"
+    "           reduce warm-up variance at the cost of startup latency and\n"
+    "           resident memory.");
+
+IREE_FLAG(
+    bool, module_lazy_verification, false,
+    "Verifies bytecode module functions on first use instead of all at once\n"
+    "when the module is loaded. Reduces startup time for large modules but\n"
+    "reports malformed functions only when they are first called.");
+
+// Maps the file at |path| into memory and creates a bytecode module that
+// references the mapped contents directly. Rodata is never copied.
+static iree_status_t iree_tooling_map_bytecode_module(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t module_flags,
+    iree_string_view_t path, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module) {
+  iree_io_file_handle_t* file_handle = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ, path, host_allocator, &file_handle));
+
+  // The module metadata is read front-to-back when loading and verifying and
+  // rodata is read in large contiguous ranges so we hint sequential access.
+  // The mapping retains the file handle.
+  iree_io_file_mapping_t* mapping = NULL;
+  iree_status_t status = iree_io_file_map_view(
+      file_handle, IREE_IO_FILE_ACCESS_READ, 0, IREE_HOST_SIZE_MAX,
+      IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS, host_allocator, &mapping);
+  iree_io_file_handle_release(file_handle);
+
+  // The module takes ownership of the mapping (when successful).
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_bytecode_module_create_with_flags(
+        instance, module_flags, iree_io_file_mapping_contents_ro(mapping),
+        iree_io_file_mapping_deallocator(mapping), host_allocator, out_module);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_io_file_mapping_release(mapping);
+  }
+  return status;
+}
 
 static iree_status_t iree_tooling_load_bytecode_module(
     iree_vm_instance_t* instance, iree_string_view_t path,
@@ -50,38 +90,50 @@ static iree_status_t iree_tooling_load_bytecode_module(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
 
+  iree_vm_bytecode_module_flags_t module_flags =
+      FLAG_module_lazy_verification
+          ? IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION
+          : IREE_VM_BYTECODE_MODULE_FLAG_NONE;
+
+  // Files are mapped by default; stdin can only be read into memory.
+  const bool is_stdin = iree_string_view_equal(path, IREE_SV("-"));
+  bool preload = strcmp(FLAG_module_mode, "preload") == 0;
+  if (!is_stdin && strcmp(FLAG_module_mode, "mmap") == 0) {
+    iree_status_t status = iree_tooling_map_bytecode_module(
+        instance, module_flags, path, host_allocator, out_module);
+    if (!iree_status_is_unimplemented(status)) {
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    // Platforms without file mapping support fall back to preloading.
+    iree_status_ignore(status);
+    preload = true;
+  }
+
   // Fetch the file contents into memory.
-  // We could map the memory here if we wanted to and were coming from a file
-  // on disk.
   iree_file_contents_t* file_contents = NULL;
-  if (iree_string_view_equal(path, IREE_SV("-"))) {
+  if (is_stdin) {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
         z0, iree_stdin_read_contents(host_allocator, &file_contents));
-  } else {
+  } else if (preload) {
     char path_str[2048] = {0};
     iree_string_view_to_cstring(path, path_str, sizeof(path_str));
-    iree_file_read_flags_t read_flags = 0;
-    if (strcmp(FLAG_module_mode, "mmap") == 0) {
-      read_flags |= IREE_FILE_READ_FLAG_MMAP;
-    } else if (strcmp(FLAG_module_mode, "preload") == 0) {
-      read_flags |= IREE_FILE_READ_FLAG_PRELOAD;
-    } else {
-      IREE_TRACE_ZONE_END(z0);
-      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                              "unrecognized --module_mode= value '%s'",
-                              FLAG_module_mode);
-    }
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_file_read_contents(path_str, read_flags, host_allocator,
-                                    &file_contents));
+        z0, iree_file_read_contents(path_str, IREE_FILE_READ_FLAG_PRELOAD,
+                                    host_allocator, &file_contents));
+  } else {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unrecognized --module_mode= value '%s'",
+                            FLAG_module_mode);
   }
 
   // Try to load the module as bytecode (all we have today that we can use).
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
   iree_vm_module_t* module = NULL;
-  iree_status_t status = iree_vm_bytecode_module_create(
-      instance, file_contents->const_buffer,
+  iree_status_t status = iree_vm_bytecode_module_create_with_flags(
+      instance, module_flags, file_contents->const_buffer,
       iree_file_contents_deallocator(file_contents), host_allocator, &module);
 
   if (iree_status_is_ok(status)) {
@@ -8,6 +8,8 @@
 
 #include "iree/base/internal/call_once.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/memory.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/init.h"
 #include "iree/hal/utils/allocators.h"
 #include "iree/hal/utils/mpi_channel_provider.h"
@@ -326,6 +328,98 @@ iree_status_t iree_hal_device_set_default_channel_provider(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Host memory configuration
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(
+    string, device_large_pages, "",
+    "Backs large host allocations made by devices with large pages to reduce\n"
+    "TLB misses. The local-sync and local-task devices allocate all buffers\n"
+    "(weights, activations, etc) this way. One of:\n"
+    "  transparent: transparent large pages (THP) aligned to their size\n"
+    "  explicit: pages from the reserved large page pool (hugetlbfs) with\n"
+    "            transparent large pages used once the pool is exhausted\n"
+    "  explicit_1gb: as explicit but allocations of 1GB or more use the\n"
+    "                1GB page pool\n"
+    "Explicit pools must be reserved on the system beforehand, such as with\n"
+    "/proc/sys/vm/nr_hugepages or `hugepagesz=1G hugepages=N` on the Linux\n"
+    "kernel command line. Ignored on platforms without large page support.");
+
+// Devices may outlive the callers creating them so the page allocator they
+// use is process-global. It is configured by the first caller enabling large
+// pages and later callers must request the same configuration.
+static iree_once_flag iree_hal_device_page_allocator_init_flag =
+    IREE_ONCE_FLAG_INIT;
+static iree_slim_mutex_t iree_hal_device_page_allocator_mutex;
+static bool iree_hal_device_page_allocator_initialized = false;
+static iree_memory_page_allocator_t iree_hal_device_page_allocator;
+static void iree_hal_device_page_allocator_init_mutex(void) {
+  iree_slim_mutex_initialize(&iree_hal_device_page_allocator_mutex);
+}
+
+// Returns the process-global page allocator configured with |flags| that
+// forwards small allocations to |host_allocator|. Fails if it was already
+// configured differently.
+static iree_status_t iree_hal_device_page_allocator_acquire(
+    iree_memory_page_flags_t flags, iree_allocator_t host_allocator,
+    iree_allocator_t* out_allocator) {
+  iree_call_once(&iree_hal_device_page_allocator_init_flag,
+                 iree_hal_device_page_allocator_init_mutex);
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&iree_hal_device_page_allocator_mutex);
+  iree_memory_page_allocator_t* page_allocator =
+      &iree_hal_device_page_allocator;
+  if (!iree_hal_device_page_allocator_initialized) {
+    iree_memory_page_allocator_initialize(flags, host_allocator,
+                                          page_allocator);
+    iree_hal_device_page_allocator_initialized = true;
+  } else if (page_allocator->flags != flags) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "large pages were already configured for devices with a different "
+        "mode; --device_large_pages= must not change within a process");
+  } else if (memcmp(&page_allocator->delegate_allocator, &host_allocator,
+                    sizeof(host_allocator)) != 0) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "large pages were already configured for devices with a different "
+        "host allocator; all devices using large pages must share one");
+  }
+  iree_slim_mutex_unlock(&iree_hal_device_page_allocator_mutex);
+  if (iree_status_is_ok(status)) {
+    *out_allocator = iree_memory_page_allocator(page_allocator);
+  }
+  return status;
+}
+
+// Returns the allocator devices should use for host allocations based on the
+// --device_large_pages= flag. Small allocations are always made from
+// |host_allocator|.
+static iree_status_t iree_hal_device_host_allocator_from_flags(
+    iree_allocator_t host_allocator, iree_allocator_t* out_allocator) {
+  *out_allocator = host_allocator;
+  iree_memory_page_flags_t flags = IREE_MEMORY_PAGE_FLAG_NONE;
+  if (strlen(FLAG_device_large_pages) == 0) {
+    return iree_ok_status();
+  } else if (strcmp(FLAG_device_large_pages, "transparent") == 0) {
+    flags = IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES;
+  } else if (strcmp(FLAG_device_large_pages, "explicit") == 0) {
+    flags = IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES |
+            IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES;
+  } else if (strcmp(FLAG_device_large_pages, "explicit_1gb") == 0) {
+    flags = IREE_MEMORY_PAGE_FLAG_TRANSPARENT_LARGE_PAGES |
+            IREE_MEMORY_PAGE_FLAG_EXPLICIT_LARGE_PAGES |
+            IREE_MEMORY_PAGE_FLAG_GIGANTIC_PAGES;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported large page mode '%s'",
+                            FLAG_device_large_pages);
+  }
+  return iree_hal_device_page_allocator_acquire(flags, host_allocator,
+                                                out_allocator);
+}
+
 //===----------------------------------------------------------------------===//
 // Device selection
 //===----------------------------------------------------------------------===//
@@ -379,6 +473,13 @@ iree_status_t iree_hal_create_devices_from_flags(
     }
   });
 
+  // Devices allocate their buffers from their host allocator (local devices)
+  // or may use it for large host-side allocations.
+  iree_allocator_t device_host_allocator = host_allocator;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_device_host_allocator_from_flags(host_allocator,
+                                                    &device_host_allocator));
+
   iree_hal_device_list_t* device_list = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_device_list_allocate(flag_list.count, host_allocator,
@@ -390,7 +491,7 @@ iree_status_t iree_hal_create_devices_from_flags(
     // dependencies (CUDA, Vulkan, etc).
     iree_hal_device_t* device = NULL;
     status = iree_hal_create_device(driver_registry, flag_list.values[i],
-                                    host_allocator, &device);
+                                    device_host_allocator, &device);
 
     // Optionally wrap the base device allocator with caching/pooling.
     // Doing this here satisfies the requirement that no buffers have been
@@ -435,7 +536,9 @@ IREE_FLAG(
     "HAL device profiling mode (one of ['queue', 'dispatch', 'executable'])\n"
     "or empty to disable profiling. HAL implementations may require\n"
     "additional flags in order to configure profiling support on their\n"
-    "devices.");
+    "devices. The local-sync and local-task devices support 'dispatch'\n"
+    "and write per-export hardware counters to --device_profiling_file\n"
+    "that can be viewed with iree-dump-instruments.");
 IREE_FLAG(
     string, device_profiling_file, "",
     "Optional file path/prefix for profiling file output. Some\n"
@@ -12,6 +12,7 @@
 
 #include "iree/base/internal/flags.h"
 #include "iree/modules/hal/types.h"
+#include "iree/vm/bytecode/module.h"
 
 //===----------------------------------------------------------------------===//
 // Instrument data management
@@ -128,3 +129,69 @@ iree_status_t iree_tooling_process_instrument_data(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// VM execution counters
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(string, vm_counters_file, "",
+          "File to populate with bytecode execution counters from the\n"
+          "program. Requires a runtime built with\n"
+          "IREE_VM_EXECUTION_COUNTERS_ENABLE=1.\n"
+          "Use `iree-dump-module --output=disassembly --counters=<file>` to\n"
+          "annotate the module disassembly with the counts.");
+
+iree_status_t iree_tooling_process_vm_counters(
+    iree_vm_context_t* context, iree_allocator_t host_allocator) {
+  // If no flag was specified we ignore counters.
+  if (strlen(FLAG_vm_counters_file) == 0) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_vm_counters_file);
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(host_allocator, &builder);
+
+  // Append counters from all bytecode modules in the context. Other module
+  // types are rejected as invalid arguments and skipped.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < iree_vm_context_module_count(context);
+       ++i) {
+    iree_vm_module_t* module = iree_vm_context_module_at(context, i);
+    if (!module) continue;
+    iree_vm_module_state_t* module_state = NULL;
+    status =
+        iree_vm_context_resolve_module_state(context, module, &module_state);
+    if (!iree_status_is_ok(status)) break;
+    status = iree_vm_bytecode_module_append_counters(module, module_state,
+                                                     &builder);
+    if (iree_status_is_invalid_argument(status)) {
+      status = iree_status_ignore(status);
+    } else if (!iree_status_is_ok(status)) {
+      break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    FILE* file = fopen(FLAG_vm_counters_file, "wb");
+    if (file) {
+      if (fwrite(iree_string_builder_buffer(&builder), 1,
+                 iree_string_builder_size(&builder),
+                 file) != iree_string_builder_size(&builder)) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "failed to write VM counters file '%s'",
+                                  FLAG_vm_counters_file);
+      }
+      fclose(file);
+    } else {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to open VM counters file '%s' for "
+                                "writing",
+                                FLAG_vm_counters_file);
+    }
+  }
+
+  iree_string_builder_deinitialize(&builder);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -23,6 +23,13 @@ extern "C" {
 iree_status_t iree_tooling_process_instrument_data(
     iree_vm_context_t* context, iree_allocator_t host_allocator);
 
+// Writes the execution counters of all bytecode modules in |context| to the
+// file specified by the command line flags.
+// No-op if no file was specified. Fails if the runtime was built without
+// IREE_VM_EXECUTION_COUNTERS_ENABLE.
+iree_status_t iree_tooling_process_vm_counters(
+    iree_vm_context_t* context, iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,149 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/latency_histogram.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+
+//===----------------------------------------------------------------------===//
+// iree_tooling_latency_histogram_t
+//===----------------------------------------------------------------------===//
+
+// Returns the index of the bucket containing |value|.
+static iree_host_size_t iree_tooling_latency_histogram_bucket_index(
+    uint32_t precision_bits, uint64_t value) {
+  const uint64_t sub_bucket_count = 1ull << precision_bits;
+  if (value < sub_bucket_count) return (iree_host_size_t)value;
+  const uint32_t magnitude =
+      63 - (uint32_t)iree_math_count_leading_zeros_u64(value);
+  const uint32_t shift = magnitude - precision_bits;
+  return (iree_host_size_t)(sub_bucket_count + shift * sub_bucket_count +
+                            ((value >> shift) - sub_bucket_count));
+}
+
+// Returns the largest value that maps to the bucket at |index|.
+static uint64_t iree_tooling_latency_histogram_bucket_upper_value(
+    uint32_t precision_bits, iree_host_size_t index) {
+  const uint64_t sub_bucket_count = 1ull << precision_bits;
+  if (index < sub_bucket_count) return (uint64_t)index;
+  const uint64_t linear_index = index - sub_bucket_count;
+  const uint32_t shift = (uint32_t)(linear_index >> precision_bits);
+  const uint64_t sub_bucket = linear_index & (sub_bucket_count - 1);
+  const uint64_t lower_value = (sub_bucket_count + sub_bucket) << shift;
+  return lower_value + ((1ull << shift) - 1);
+}
+
+iree_status_t iree_tooling_latency_histogram_initialize(
+    uint32_t precision_bits, iree_allocator_t host_allocator,
+    iree_tooling_latency_histogram_t* out_histogram) {
+  IREE_ASSERT_ARGUMENT(out_histogram);
+  memset(out_histogram, 0, sizeof(*out_histogram));
+  if (precision_bits < 1 || precision_bits > 16) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "histogram precision must be in [1, 16] bits but "
+                            "got %u",
+                            precision_bits);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_host_size_t sub_bucket_count = 1ull << precision_bits;
+  const iree_host_size_t bucket_count =
+      sub_bucket_count + (64 - precision_bits) * sub_bucket_count;
+  uint64_t* counts = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, bucket_count * sizeof(*counts),
+                                (void**)&counts));
+
+  out_histogram->host_allocator = host_allocator;
+  out_histogram->precision_bits = precision_bits;
+  out_histogram->bucket_count = bucket_count;
+  out_histogram->counts = counts;
+  iree_tooling_latency_histogram_reset(out_histogram);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_tooling_latency_histogram_deinitialize(
+    iree_tooling_latency_histogram_t* histogram) {
+  IREE_ASSERT_ARGUMENT(histogram);
+  iree_allocator_free(histogram->host_allocator, histogram->counts);
+  memset(histogram, 0, sizeof(*histogram));
+}
+
+void iree_tooling_latency_histogram_reset(
+    iree_tooling_latency_histogram_t* histogram) {
+  IREE_ASSERT_ARGUMENT(histogram);
+  memset(histogram->counts, 0,
+         histogram->bucket_count * sizeof(histogram->counts[0]));
+  histogram->total_count = 0;
+  histogram->total_sum = 0;
+  histogram->min_value = UINT64_MAX;
+  histogram->max_value = 0;
+}
+
+void iree_tooling_latency_histogram_record(
+    iree_tooling_latency_histogram_t* histogram, uint64_t value) {
+  ++histogram->counts[iree_tooling_latency_histogram_bucket_index(
+      histogram->precision_bits, value)];
+  ++histogram->total_count;
+  histogram->total_sum += value;
+  histogram->min_value = iree_min(histogram->min_value, value);
+  histogram->max_value = iree_max(histogram->max_value, value);
+}
+
+iree_status_t iree_tooling_latency_histogram_merge(
+    iree_tooling_latency_histogram_t* target,
+    const iree_tooling_latency_histogram_t* source) {
+  IREE_ASSERT_ARGUMENT(target);
+  IREE_ASSERT_ARGUMENT(source);
+  if (target->precision_bits != source->precision_bits) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "histogram precision mismatch (%u != %u)",
+                            target->precision_bits, source->precision_bits);
+  }
+  for (iree_host_size_t i = 0; i < target->bucket_count; ++i) {
+    target->counts[i] += source->counts[i];
+  }
+  target->total_count += source->total_count;
+  target->total_sum += source->total_sum;
+  target->min_value = iree_min(target->min_value, source->min_value);
+  target->max_value = iree_max(target->max_value, source->max_value);
+  return iree_ok_status();
+}
+
+uint64_t iree_tooling_latency_histogram_value_at_percentile(
+    const iree_tooling_latency_histogram_t* histogram, double percentile) {
+  IREE_ASSERT_ARGUMENT(histogram);
+  if (!histogram->total_count) return 0;
+
+  // Rank of the sample at the percentile (1-based).
+  percentile = iree_min(iree_max(percentile, 0.0), 100.0);
+  uint64_t target_rank =
+      (uint64_t)ceil(percentile / 100.0 * (double)histogram->total_count);
+  target_rank = iree_min(iree_max(target_rank, 1ull), histogram->total_count);
+
+  uint64_t rank = 0;
+  for (iree_host_size_t i = 0; i < histogram->bucket_count; ++i) {
+    rank += histogram->counts[i];
+    if (rank >= target_rank) {
+      return iree_min(iree_tooling_latency_histogram_bucket_upper_value(
+                          histogram->precision_bits, i),
+                      histogram->max_value);
+    }
+  }
+  return histogram->max_value;
+}
+
+double iree_tooling_latency_histogram_mean(
+    const iree_tooling_latency_histogram_t* histogram) {
+  IREE_ASSERT_ARGUMENT(histogram);
+  if (!histogram->total_count) return 0.0;
+  return (double)histogram->total_sum / (double)histogram->total_count;
+}
@@ -0,0 +1,87 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TOOLING_LATENCY_HISTOGRAM_H_
+#define IREE_TOOLING_LATENCY_HISTOGRAM_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_tooling_latency_histogram_t
+//===----------------------------------------------------------------------===//
+
+// Log-linear histogram of non-negative integer samples (such as nanosecond
+// latencies) in the style of HdrHistogram.
+//
+// Samples are bucketed by their power-of-two magnitude and then linearly into
+// 2^|precision_bits| sub-buckets within each magnitude. Values below
+// 2^|precision_bits| are recorded exactly and all others with a relative error
+// of at most 2^-|precision_bits| (7 bits is <1%). Recording is O(1) and does
+// not allocate so it can be used on measurement hot paths.
+//
+// Thread-compatible; use one histogram per thread and merge them after
+// recording has finished.
+typedef struct iree_tooling_latency_histogram_t {
+  iree_allocator_t host_allocator;
+  // Number of linear sub-buckets per power of two as log2.
+  uint32_t precision_bits;
+  // Total number of buckets in |counts|.
+  iree_host_size_t bucket_count;
+  // Per-bucket sample counts.
+  uint64_t* counts;
+  // Total number of samples recorded.
+  uint64_t total_count;
+  // Sum of all samples recorded used for computing the mean.
+  uint64_t total_sum;
+  // Exact minimum and maximum samples recorded.
+  uint64_t min_value;
+  uint64_t max_value;
+} iree_tooling_latency_histogram_t;
+
+// Initializes an empty |out_histogram| with 2^|precision_bits| sub-buckets per
+// power-of-two magnitude. |precision_bits| must be in [1, 16].
+iree_status_t iree_tooling_latency_histogram_initialize(
+    uint32_t precision_bits, iree_allocator_t host_allocator,
+    iree_tooling_latency_histogram_t* out_histogram);
+
+// Deinitializes |histogram| and releases its storage.
+void iree_tooling_latency_histogram_deinitialize(
+    iree_tooling_latency_histogram_t* histogram);
+
+// Removes all samples from |histogram|.
+void iree_tooling_latency_histogram_reset(
+    iree_tooling_latency_histogram_t* histogram);
+
+// Records a single |value| sample in |histogram|.
+void iree_tooling_latency_histogram_record(
+    iree_tooling_latency_histogram_t* histogram, uint64_t value);
+
+// Adds all samples from |source| into |target|.
+// Both histograms must have been initialized with the same precision.
+iree_status_t iree_tooling_latency_histogram_merge(
+    iree_tooling_latency_histogram_t* target,
+    const iree_tooling_latency_histogram_t* source);
+
+// Returns the value at or below which |percentile| (in [0, 100]) of the
+// recorded samples fall. The value returned is the largest value equivalent to
+// the bucket containing the percentile clamped to the recorded range so that
+// reported tail latencies are never optimistic. Returns 0 if empty.
+uint64_t iree_tooling_latency_histogram_value_at_percentile(
+    const iree_tooling_latency_histogram_t* histogram, double percentile);
+
+// Returns the mean of all recorded samples or 0 if empty.
+double iree_tooling_latency_histogram_mean(
+    const iree_tooling_latency_histogram_t* histogram);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,128 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/latency_histogram.h"
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+class LatencyHistogramTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_tooling_latency_histogram_initialize(
+        /*precision_bits=*/7, iree_allocator_system(), &histogram_));
+  }
+  void TearDown() override {
+    iree_tooling_latency_histogram_deinitialize(&histogram_);
+  }
+  iree_tooling_latency_histogram_t histogram_;
+};
+
+TEST_F(LatencyHistogramTest, Empty) {
+  EXPECT_EQ(histogram_.total_count, 0u);
+  EXPECT_EQ(iree_tooling_latency_histogram_value_at_percentile(&histogram_,
+                                                               50.0),
+            0u);
+  EXPECT_EQ(iree_tooling_latency_histogram_mean(&histogram_), 0.0);
+}
+
+TEST_F(LatencyHistogramTest, InvalidPrecision) {
+  iree_tooling_latency_histogram_t histogram;
+  EXPECT_THAT(Status(iree_tooling_latency_histogram_initialize(
+                  /*precision_bits=*/0, iree_allocator_system(), &histogram)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(Status(iree_tooling_latency_histogram_initialize(
+                  /*precision_bits=*/17, iree_allocator_system(), &histogram)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+// Values below 2^precision_bits are recorded exactly.
+TEST_F(LatencyHistogramTest, SmallValuesExact) {
+  for (uint64_t i = 1; i <= 100; ++i) {
+    iree_tooling_latency_histogram_record(&histogram_, i);
+  }
+  EXPECT_EQ(histogram_.total_count, 100u);
+  EXPECT_EQ(histogram_.min_value, 1u);
+  EXPECT_EQ(histogram_.max_value, 100u);
+  EXPECT_EQ(iree_tooling_latency_histogram_mean(&histogram_), 50.5);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 0.0), 1u);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 50.0),
+      50u);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 99.0),
+      99u);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 100.0),
+      100u);
+}
+
+// Large values are recorded within the relative error bound and percentiles
+// are never reported below the true value.
+TEST_F(LatencyHistogramTest, LargeValuesBoundedError) {
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    iree_tooling_latency_histogram_record(&histogram_, i * 1000003ull);
+  }
+  for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+    uint64_t expected = (uint64_t)(percentile * 10.0 + 0.5) * 1000003ull;
+    uint64_t actual = iree_tooling_latency_histogram_value_at_percentile(
+        &histogram_, percentile);
+    EXPECT_GE(actual, expected) << percentile;
+    EXPECT_LE(actual - expected, expected / 128) << percentile;
+  }
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 100.0),
+      1000ull * 1000003ull);
+}
+
+TEST_F(LatencyHistogramTest, MaxValue) {
+  iree_tooling_latency_histogram_record(&histogram_, UINT64_MAX);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 50.0),
+      UINT64_MAX);
+}
+
+TEST_F(LatencyHistogramTest, Merge) {
+  iree_tooling_latency_histogram_t other;
+  IREE_ASSERT_OK(iree_tooling_latency_histogram_initialize(
+      /*precision_bits=*/7, iree_allocator_system(), &other));
+  for (uint64_t i = 1; i <= 50; ++i) {
+    iree_tooling_latency_histogram_record(&histogram_, i);
+    iree_tooling_latency_histogram_record(&other, 50 + i);
+  }
+  IREE_ASSERT_OK(iree_tooling_latency_histogram_merge(&histogram_, &other));
+  iree_tooling_latency_histogram_deinitialize(&other);
+  EXPECT_EQ(histogram_.total_count, 100u);
+  EXPECT_EQ(histogram_.min_value, 1u);
+  EXPECT_EQ(histogram_.max_value, 100u);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 75.0),
+      75u);
+
+  IREE_ASSERT_OK(iree_tooling_latency_histogram_initialize(
+      /*precision_bits=*/8, iree_allocator_system(), &other));
+  EXPECT_THAT(Status(iree_tooling_latency_histogram_merge(&histogram_, &other)),
+              StatusIs(StatusCode::kInvalidArgument));
+  iree_tooling_latency_histogram_deinitialize(&other);
+}
+
+TEST_F(LatencyHistogramTest, Reset) {
+  iree_tooling_latency_histogram_record(&histogram_, 123);
+  iree_tooling_latency_histogram_reset(&histogram_);
+  EXPECT_EQ(histogram_.total_count, 0u);
+  EXPECT_EQ(
+      iree_tooling_latency_histogram_value_at_percentile(&histogram_, 50.0),
+      0u);
+}
+
+}  // namespace
+}  // namespace iree
@@ -118,6 +118,13 @@ IREE_FLAG_LIST(
     "- .gguf (https://github.com/ggerganov/ggml/blob/master/docs/gguf.md)\n"
     "- .safetensors (https://github.com/huggingface/safetensors)");
 
+IREE_FLAG(
+    int32_t, parameter_concurrency,
+    IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
+    "Maximum number of parameter file operations that may be in-flight at a\n"
+    "time while loading/gathering/scattering parameters. Higher values can\n"
+    "improve I/O utilization at the cost of transient memory.");
+
 // Appends the parameter file located at |path| to |index|.
 static iree_status_t iree_io_append_parameter_file_to_index(
     iree_string_view_t path, iree_io_parameter_index_t* index,
@@ -193,7 +200,7 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
     for (iree_host_size_t i = 0; i < scope_map.count; ++i) {
       status = iree_io_parameter_index_provider_create(
           scope_map.entries[i]->scope, scope_map.entries[i]->index,
-          IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
+          (iree_host_size_t)iree_max(1, FLAG_parameter_concurrency),
           host_allocator, &providers[i]);
       if (!iree_status_is_ok(status)) break;
       ++provider_count;
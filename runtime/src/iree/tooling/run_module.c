@@ -277,6 +277,11 @@ static iree_status_t iree_tooling_run_function(
         iree_tooling_process_instrument_data(context, host_allocator),
         "processing instrument data");
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(
+        iree_tooling_process_vm_counters(context, host_allocator),
+        "processing VM execution counters");
+  }
 
   // Transfer outputs to the host so they can be processed. Only required when
   // using full HAL device-based execution.
@@ -172,6 +172,45 @@ static iree_status_t iree_vm_bytecode_disassembler_emit_type_name(
     return iree_string_builder_append_cstring(b, "*");
   }
 }
+
+// Emits the name of the function called by a vm.call op to |function_ordinal|.
+// Imports are printed with the name of the function they resolved to in
+// |module_state| or their declared name if no state is available.
+static iree_status_t iree_vm_bytecode_disassembler_emit_callee_name(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_bytecode_module_state_t* module_state, int32_t function_ordinal,
+    iree_string_builder_t* b) {
+  int is_import = (function_ordinal & 0x80000000u) != 0;
+  iree_vm_function_t function;
+  if (is_import && !module_state) {
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_ordinal(
+        &module->interface, IREE_VM_FUNCTION_LINKAGE_IMPORT,
+        function_ordinal & 0x7FFFFFFFu, &function));
+    return iree_string_builder_append_string(b,
+                                             iree_vm_function_name(&function));
+  } else if (is_import) {
+    const iree_vm_bytecode_import_t* import =
+        &module_state->import_table[function_ordinal & 0x7FFFFFFFu];
+    function = import->call_cache.function;
+  } else {
+    function.module = &module->interface;
+    function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
+    function.ordinal = function_ordinal;
+  }
+  if (!function.module) {
+    return iree_string_builder_append_cstring(b, "{{UNRESOLVED}}");
+  }
+  iree_string_view_t module_name = iree_vm_module_name(function.module);
+  iree_string_view_t func_name = iree_vm_function_name(&function);
+  if (iree_string_view_is_empty(func_name)) {
+    return iree_string_builder_append_format(
+        b, "%.*s:%u", (int)module_name.size, module_name.data,
+        function.ordinal);
+  }
+  return iree_string_builder_append_format(
+      b, "%.*s.%.*s", (int)module_name.size, module_name.data,
+      (int)func_name.size, func_name.data);
+}
 #define EMIT_TYPE_NAME(type_def) \
   IREE_RETURN_IF_ERROR(          \
       iree_vm_bytecode_disassembler_emit_type_name(type_def, b))
@@ -466,7 +505,8 @@ iree_status_t iree_vm_bytecode_disassemble_op(
     iree_vm_bytecode_module_t* module,
     iree_vm_bytecode_module_state_t* module_state, uint16_t function_ordinal,
     iree_vm_source_offset_t pc, const iree_vm_registers_t* regs,
-    iree_vm_bytecode_disassembly_format_t format, iree_string_builder_t* b) {
+    iree_vm_bytecode_disassembly_format_t format, iree_string_builder_t* b,
+    iree_vm_source_offset_t* out_next_pc) {
   const uint8_t* IREE_RESTRICT bytecode_data =
       module->bytecode_data.data +
       module->function_descriptor_table[function_ordinal].bytecode_offset;
@@ -1702,33 +1742,8 @@ iree_status_t iree_vm_bytecode_disassemble_op(
         IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, " = "));
       }
       IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, "vm.call @"));
-      int is_import = (function_ordinal & 0x80000000u) != 0;
-      iree_vm_function_t function;
-      if (is_import) {
-        const iree_vm_bytecode_import_t* import =
-            &module_state->import_table[function_ordinal & 0x7FFFFFFFu];
-        function = import->function;
-      } else {
-        function.module = &module->interface;
-        function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
-        function.ordinal = function_ordinal;
-      }
-      if (function.module) {
-        iree_string_view_t module_name = iree_vm_module_name(function.module);
-        iree_string_view_t func_name = iree_vm_function_name(&function);
-        if (iree_string_view_is_empty(func_name)) {
-          IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
-              b, "%.*s:%u", (int)module_name.size, module_name.data,
-              function.ordinal));
-        } else {
-          IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
-              b, "%.*s.%.*s", (int)module_name.size, module_name.data,
-              (int)func_name.size, func_name.data));
-        }
-      } else {
-        IREE_RETURN_IF_ERROR(
-            iree_string_builder_append_cstring(b, "{{UNRESOLVED}}"));
-      }
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_disassembler_emit_callee_name(
+          module, module_state, function_ordinal, b));
       IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, "("));
       EMIT_OPERAND_REG_LIST(src_reg_list);
       IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));
@@ -1750,28 +1765,8 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       }
       IREE_RETURN_IF_ERROR(
           iree_string_builder_append_cstring(b, "vm.call.varadic @"));
-      int is_import = (function_ordinal & 0x80000000u) != 0;
-      iree_vm_function_t function;
-      if (is_import) {
-        const iree_vm_bytecode_import_t* import =
-            &module_state->import_table[function_ordinal & 0x7FFFFFFFu];
-        function = import->function;
-      } else {
-        function.module = &module->interface;
-        function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
-        function.ordinal = function_ordinal;
-      }
-      iree_string_view_t module_name = iree_vm_module_name(function.module);
-      iree_string_view_t func_name = iree_vm_function_name(&function);
-      if (iree_string_view_is_empty(func_name)) {
-        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
-            b, "%.*s:%u", (int)module_name.size, module_name.data,
-            function.ordinal));
-      } else {
-        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
-            b, "%.*s.%.*s", (int)module_name.size, module_name.data,
-            (int)func_name.size, func_name.data));
-      }
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_disassembler_emit_callee_name(
+          module, module_state, function_ordinal, b));
       IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, "("));
       EMIT_OPERAND_REG_LIST(src_reg_list);
       IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));
@@ -1811,7 +1806,8 @@ iree_status_t iree_vm_bytecode_disassemble_op(
         break;
       }
       uint32_t import_ordinal = function_ordinal & 0x7FFFFFFFu;
-      if (IREE_UNLIKELY(import_ordinal >= module_state->import_count)) {
+      if (IREE_UNLIKELY(module_state &&
+                        import_ordinal >= module_state->import_count)) {
         IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
             b, "{{OUT OF RANGE ORDINAL %u}}", import_ordinal));
         break;
@@ -1822,11 +1818,14 @@ iree_status_t iree_vm_bytecode_disassemble_op(
           import_ordinal, &decl_function));
       IREE_RETURN_IF_ERROR(iree_string_builder_append_string(
           b, iree_vm_function_name(&decl_function)));
-      const iree_vm_bytecode_import_t* import =
-          &module_state->import_table[import_ordinal];
-      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(
-          b, import->function.module != NULL ? " // (resolved)"
-                                             : " // (unresolved)"));
+      if (module_state) {
+        const iree_vm_bytecode_import_t* import =
+            &module_state->import_table[import_ordinal];
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(
+            b, import->call_cache.function.module != NULL
+                   ? " // (resolved)"
+                   : " // (unresolved)"));
+      }
       break;
     }
 
@@ -2724,13 +2723,189 @@ iree_status_t iree_vm_bytecode_disassemble_op(
     UNHANDLED_DISASM_PREFIX(PrefixExtF64, EXT_F64)
 #endif  // IREE_VM_EXT_F64_ENABLE
 
+#if IREE_VM_EXT_FUSED_ENABLE
+    BEGIN_DISASM_PREFIX(PrefixExtFused, EXT_FUSED)
+
+    //===----------------------------------------------------------------===//
+    // ExtFused: Compare and branch
+    //===----------------------------------------------------------------===//
+
+#define DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(op_name, op_mnemonic, width)    \
+  DISASM_OP(EXT_FUSED, op_name) {                                           \
+    uint16_t lhs_reg = VM_ParseOperandRegI##width("lhs");                   \
+    uint16_t rhs_reg = VM_ParseOperandRegI##width("rhs");                   \
+    int32_t true_block_pc = VM_ParseBranchTarget("true_dest");              \
+    const iree_vm_register_remap_list_t* true_remap_list =                  \
+        VM_ParseBranchOperands("true_operands");                            \
+    int32_t false_block_pc = VM_ParseBranchTarget("false_dest");            \
+    const iree_vm_register_remap_list_t* false_remap_list =                 \
+        VM_ParseBranchOperands("false_operands");                           \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, "%s ", op_mnemonic));          \
+    EMIT_I##width##_REG_NAME(lhs_reg);                                      \
+    EMIT_OPTIONAL_VALUE_I##width(regs->i32[lhs_reg]);                       \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));      \
+    EMIT_I##width##_REG_NAME(rhs_reg);                                      \
+    EMIT_OPTIONAL_VALUE_I##width(regs->i32[rhs_reg]);                       \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, ", ^%08X(", true_block_pc));   \
+    EMIT_REMAP_LIST(true_remap_list);                                       \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, "), ^%08X(", false_block_pc)); \
+    EMIT_REMAP_LIST(false_remap_list);                                      \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));       \
+    break;                                                                  \
+  }
+
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpEQI32CondBranch,
+                                        "vm.cmp.eq.i32+vm.cond_br", 32);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpNEI32CondBranch,
+                                        "vm.cmp.ne.i32+vm.cond_br", 32);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI32SCondBranch,
+                                        "vm.cmp.lt.i32.s+vm.cond_br", 32);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI32UCondBranch,
+                                        "vm.cmp.lt.i32.u+vm.cond_br", 32);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpEQI64CondBranch,
+                                        "vm.cmp.eq.i64+vm.cond_br", 64);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpNEI64CondBranch,
+                                        "vm.cmp.ne.i64+vm.cond_br", 64);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI64SCondBranch,
+                                        "vm.cmp.lt.i64.s+vm.cond_br", 64);
+    DISASM_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI64UCondBranch,
+                                        "vm.cmp.lt.i64.u+vm.cond_br", 64);
+
+    //===----------------------------------------------------------------===//
+    // ExtFused: Arithmetic with immediates
+    //===----------------------------------------------------------------===//
+
+    DISASM_OP(EXT_FUSED, AddI32Imm) {
+      uint16_t lhs_reg = VM_ParseOperandRegI32("lhs");
+      int32_t rhs = VM_ParseAttrI32("rhs");
+      uint16_t result_reg = VM_ParseResultRegI32("result");
+      EMIT_I32_REG_NAME(result_reg);
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_cstring(b, " = vm.const.i32+vm.add.i32 "));
+      EMIT_I32_REG_NAME(lhs_reg);
+      EMIT_OPTIONAL_VALUE_I32(regs->i32[lhs_reg]);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(b, ", %d", rhs));
+      break;
+    }
+    DISASM_OP(EXT_FUSED, AddI64Imm) {
+      uint16_t lhs_reg = VM_ParseOperandRegI64("lhs");
+      int64_t rhs = VM_ParseAttrI64("rhs");
+      uint16_t result_reg = VM_ParseResultRegI64("result");
+      EMIT_I64_REG_NAME(result_reg);
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_cstring(b, " = vm.const.i64+vm.add.i64 "));
+      EMIT_I64_REG_NAME(lhs_reg);
+      EMIT_OPTIONAL_VALUE_I64(regs->i32[lhs_reg]);
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_format(b, ", %" PRId64, rhs));
+      break;
+    }
+
+    //===----------------------------------------------------------------===//
+    // ExtFused: Buffers
+    //===----------------------------------------------------------------===//
+
+#define DISASM_OP_EXT_FUSED_BUFFER_LOAD_I32_EXT_I64(op_name, op_mnemonic) \
+  DISASM_OP(EXT_FUSED, op_name) {                                         \
+    bool buffer_is_move;                                                  \
+    uint16_t buffer_reg =                                                 \
+        VM_ParseOperandRegRef("source_buffer", &buffer_is_move);          \
+    uint16_t offset_reg = VM_ParseOperandRegI64("source_offset");         \
+    uint16_t result_reg = VM_ParseResultRegI64("result");                 \
+    EMIT_I64_REG_NAME(result_reg);                                        \
+    IREE_RETURN_IF_ERROR(                                                 \
+        iree_string_builder_append_format(b, " = %s ", op_mnemonic));     \
+    EMIT_REF_REG_NAME(buffer_reg);                                        \
+    EMIT_OPTIONAL_VALUE_REF(&regs->ref[buffer_reg]);                      \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));    \
+    EMIT_I64_REG_NAME(offset_reg);                                        \
+    EMIT_OPTIONAL_VALUE_I64(regs->i32[offset_reg]);                       \
+    break;                                                                \
+  }
+
+    DISASM_OP_EXT_FUSED_BUFFER_LOAD_I32_EXT_I64(
+        BufferLoadI32ExtI64S, "vm.buffer.load.i32+vm.ext.i32.i64.s");
+    DISASM_OP_EXT_FUSED_BUFFER_LOAD_I32_EXT_I64(
+        BufferLoadI32ExtI64U, "vm.buffer.load.i32+vm.ext.i32.i64.u");
+
+    END_DISASM_PREFIX()
+#else
+    UNHANDLED_DISASM_PREFIX(PrefixExtFused, EXT_FUSED)
+#endif  // IREE_VM_EXT_FUSED_ENABLE
+
     default:
       return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                               "unhandled core opcode");
   }
+  if (out_next_pc) *out_next_pc = pc;
+  return iree_ok_status();
+}
+
+iree_status_t iree_vm_bytecode_disassemble_function(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_bytecode_module_state_t* module_state, uint16_t function_ordinal,
+    const uint64_t* block_counters, iree_string_builder_t* b) {
+  const iree_vm_FunctionDescriptor_t* function_descriptor =
+      &module->function_descriptor_table[function_ordinal];
+  const uint8_t* IREE_RESTRICT bytecode_data =
+      module->bytecode_data.data + function_descriptor->bytecode_offset;
+  const iree_vm_source_offset_t bytecode_length =
+      function_descriptor->bytecode_length;
+  iree_vm_source_offset_t pc = 0;
+  while (pc < bytecode_length) {
+    if (bytecode_data[pc] == IREE_VM_OP_CORE_Block) {
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_format(b, "  ^%08" PRIX64 ":", pc));
+      if (block_counters) {
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+            b, "  // count: %" PRIu64,
+            block_counters[iree_vm_bytecode_block_counter_index(
+                function_descriptor, pc)]));
+      }
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, "\n"));
+      ++pc;
+      continue;
+    }
+    IREE_RETURN_IF_ERROR(
+        iree_string_builder_append_format(b, "    %08" PRIX64 "  ", pc));
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_disassemble_op(
+        module, module_state, function_ordinal, pc, /*regs=*/NULL,
+        IREE_VM_BYTECODE_DISASSEMBLY_FORMAT_DEFAULT, b, &pc));
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, "\n"));
+  }
   return iree_ok_status();
 }
 
+iree_status_t iree_vm_bytecode_find_next_block(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
+    iree_vm_source_offset_t pc, iree_vm_source_offset_t* out_block_pc) {
+  const iree_vm_FunctionDescriptor_t* function_descriptor =
+      &module->function_descriptor_table[function_ordinal];
+  const uint8_t* IREE_RESTRICT bytecode_data =
+      module->bytecode_data.data + function_descriptor->bytecode_offset;
+  const iree_vm_source_offset_t bytecode_length =
+      function_descriptor->bytecode_length;
+
+  // Ops are variable length so we step over them by disassembling them into a
+  // builder that only calculates sizes.
+  iree_string_builder_t b;
+  iree_string_builder_initialize(iree_allocator_null(), &b);
+  iree_status_t status = iree_ok_status();
+  while (pc < bytecode_length && bytecode_data[pc] != IREE_VM_OP_CORE_Block) {
+    status = iree_vm_bytecode_disassemble_op(
+        module, /*module_state=*/NULL, function_ordinal, pc, /*regs=*/NULL,
+        IREE_VM_BYTECODE_DISASSEMBLY_FORMAT_DEFAULT, &b, &pc);
+    if (!iree_status_is_ok(status)) break;
+  }
+  iree_string_builder_deinitialize(&b);
+
+  *out_block_pc = iree_min(pc, bytecode_length);
+  return status;
+}
+
 iree_status_t iree_vm_bytecode_trace_disassembly(
     iree_vm_stack_frame_t* frame, iree_vm_source_offset_t pc,
     const iree_vm_registers_t* regs, FILE* file) {
@@ -2798,7 +2973,8 @@ iree_status_t iree_vm_bytecode_trace_disassembly(
         (iree_vm_bytecode_module_t*)frame->function.module,
         (iree_vm_bytecode_module_state_t*)frame->module_state,
         frame->function.ordinal, pc, regs,
-        IREE_VM_BYTECODE_DISASSEMBLY_FORMAT_INLINE_VALUES, &b);
+        IREE_VM_BYTECODE_DISASSEMBLY_FORMAT_INLINE_VALUES, &b,
+        /*out_next_pc=*/NULL);
   }
 
   if (iree_status_is_ok(status)) {
@@ -25,6 +25,9 @@ typedef enum iree_vm_bytecode_disassembly_format_e {
 // Disassembles the bytecode operation at |pc| using the provided module state.
 // Appends the disasembled op to |string_builder| in a format based on |format|.
 // If |regs| are available then values can be added using the format mode.
+// If provided |out_next_pc| is set to the pc of the following operation.
+// |module_state| may be NULL if |regs| are not provided in which case imported
+// functions are printed with their declared names.
 //
 // Example: `%i0 <= ShrI32U %i2, %i3`
 //
@@ -36,7 +39,27 @@ iree_status_t iree_vm_bytecode_disassemble_op(
     iree_vm_bytecode_module_state_t* module_state, uint16_t function_ordinal,
     iree_vm_source_offset_t pc, const iree_vm_registers_t* regs,
     iree_vm_bytecode_disassembly_format_t format,
-    iree_string_builder_t* string_builder);
+    iree_string_builder_t* string_builder,
+    iree_vm_source_offset_t* out_next_pc);
+
+// Disassembles all operations in the function at |function_ordinal| and
+// appends them to |string_builder| one per line with their function-relative
+// pc. Blocks are labeled with their pc and if |block_counters| (indexed as in
+// the module state) are provided annotated with their execution count.
+//
+// WARNING: as with iree_vm_bytecode_disassemble_op this assumes the function
+// bytecode has been verified.
+iree_status_t iree_vm_bytecode_disassemble_function(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_bytecode_module_state_t* module_state, uint16_t function_ordinal,
+    const uint64_t* block_counters, iree_string_builder_t* string_builder);
+
+// Finds the pc of the first block at or after |pc| in the function at
+// |function_ordinal|. |out_block_pc| is set to the function bytecode length if
+// no blocks remain.
+iree_status_t iree_vm_bytecode_find_next_block(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
+    iree_vm_source_offset_t pc, iree_vm_source_offset_t* out_block_pc);
 
 iree_status_t iree_vm_bytecode_trace_disassembly(
     iree_vm_stack_frame_t* frame, iree_vm_source_offset_t pc,
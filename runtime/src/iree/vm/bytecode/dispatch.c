@@ -14,6 +14,7 @@
 #include "iree/vm/bytecode/disassembler.h"
 #include "iree/vm/bytecode/dispatch_util.h"
 #include "iree/vm/bytecode/module_impl.h"
+#include "iree/vm/bytecode/verifier.h"
 #include "iree/vm/ops.h"
 
 //===----------------------------------------------------------------------===//
@@ -102,6 +103,15 @@ static iree_status_t iree_vm_bytecode_function_enter(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "import ordinal out of range");
   }
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  // Verify the function on first entry if the module is verifying lazily.
+  // This is a single load when the function has already been verified.
+  if (IREE_UNLIKELY(iree_vm_bytecode_function_requires_verification(
+          module, (uint16_t)function.ordinal))) {
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_function_ensure_verified(
+        module, (uint16_t)function.ordinal));
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
   const iree_vm_FunctionDescriptor_t* target_descriptor =
       &module->function_descriptor_table[function.ordinal];
 
@@ -448,14 +458,15 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
 
 // Issues a populated import call and marshals the results into |dst_reg_list|.
 static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+    iree_vm_stack_t* stack, iree_vm_bytecode_import_t* import,
+    const iree_vm_function_call_t call,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
     iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
-  // Call external function.
-  iree_status_t call_status =
-      call.function.module->begin_call(call.function.module->self, stack, call);
+  // Call external function. Native callees are invoked directly and all others
+  // route through their module begin_call.
+  iree_status_t call_status = iree_vm_function_call_cache_begin_call(
+      &import->call_cache, stack, call.arguments, call.results);
   if (iree_status_is_deferred(call_status)) {
     if (!iree_byte_span_is_empty(call.results)) {
       iree_status_ignore(call_status);
@@ -478,6 +489,7 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
 
   // Marshal outputs from the ABI results buffer to registers.
   iree_vm_registers_t caller_registers = *out_caller_registers;
+  iree_string_view_t cconv_results = import->results;
   uint8_t* IREE_RESTRICT p = call.results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
        ++i) {
@@ -510,16 +522,16 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
 // Verifies that the requested import is valid and returns its table entry.
 static iree_status_t iree_vm_bytecode_verify_import(
     iree_vm_stack_t* stack, const iree_vm_bytecode_module_state_t* module_state,
-    uint32_t import_ordinal, const iree_vm_bytecode_import_t** out_import) {
+    uint32_t import_ordinal, iree_vm_bytecode_import_t** out_import) {
   *out_import = NULL;
 
   // Ordinal has been checked as in-bounds during verification.
   import_ordinal &= 0x7FFFFFFFu;
   IREE_ASSERT(import_ordinal < module_state->import_count);
 
-  const iree_vm_bytecode_import_t* import =
+  iree_vm_bytecode_import_t* import =
       &module_state->import_table[import_ordinal];
-  if (!import->function.module) {
+  if (!import->call_cache.function.module) {
 #if IREE_STATUS_MODE
     iree_vm_function_t decl_function;
     IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_ordinal(
@@ -551,13 +563,13 @@ static iree_status_t iree_vm_bytecode_call_import(
     iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
   // Prepare |call| by looking up the import information.
-  const iree_vm_bytecode_import_t* import = NULL;
+  iree_vm_bytecode_import_t* import = NULL;
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(stack, module_state,
                                                       import_ordinal, &import));
 
   iree_vm_function_call_t call;
   memset(&call, 0, sizeof(call));
-  call.function = import->function;
+  call.function = import->call_cache.function;
 
   // Marshal inputs from registers to the ABI arguments buffer.
   call.arguments.data_length = import->argument_buffer_size;
@@ -571,8 +583,8 @@ static iree_status_t iree_vm_bytecode_call_import(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, import, call, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -588,13 +600,13 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
     iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
   // Prepare |call| by looking up the import information.
-  const iree_vm_bytecode_import_t* import = NULL;
+  iree_vm_bytecode_import_t* import = NULL;
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(stack, module_state,
                                                       import_ordinal, &import));
 
   iree_vm_function_call_t call;
   memset(&call, 0, sizeof(call));
-  call.function = import->function;
+  call.function = import->call_cache.function;
 
   // Allocate ABI argument/result storage taking into account the variadic
   // segments.
@@ -612,8 +624,8 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, import, call, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -686,6 +698,12 @@ static iree_status_t iree_vm_bytecode_dispatch(
       module->bytecode_data.data +
       module->function_descriptor_table[current_frame->function.ordinal]
           .bytecode_offset;
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+  // Block counts recorded by this thread; see IREE_DISPATCH_COUNT_BLOCK.
+  iree_atomic_int64_t* IREE_RESTRICT block_counts = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_state_thread_block_counts(
+      (iree_vm_bytecode_module_state_t*)module_state, &block_counts));
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
 
   int32_t* IREE_RESTRICT regs_i32 = regs.i32;
   IREE_BUILTIN_ASSUME_ALIGNED(regs_i32, 16);
@@ -1621,13 +1639,13 @@ static iree_status_t iree_vm_bytecode_dispatch(
     //===------------------------------------------------------------------===//
 
     // No-op in the interpreter.
-    DISPATCH_OP(CORE, Block, {});
+    DISPATCH_OP(CORE, Block, { IREE_DISPATCH_COUNT_BLOCK(); });
 
     DISPATCH_OP(CORE, Branch, {
       int32_t block_pc = VM_DecBranchTarget("dest");
       const iree_vm_register_remap_list_t* remap_list =
           VM_DecBranchOperands("operands");
-      pc = block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+      pc = IREE_VM_BRANCH_TARGET_PC(block_pc);
       if (IREE_UNLIKELY(remap_list->size > 0)) {
         iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                          remap_list);
@@ -1643,13 +1661,13 @@ static iree_status_t iree_vm_bytecode_dispatch(
       const iree_vm_register_remap_list_t* false_remap_list =
           VM_DecBranchOperands("false_operands");
       if (condition) {
-        pc = true_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        pc = IREE_VM_BRANCH_TARGET_PC(true_block_pc);
         if (IREE_UNLIKELY(true_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            true_remap_list);
         }
       } else {
-        pc = false_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        pc = IREE_VM_BRANCH_TARGET_PC(false_block_pc);
         if (IREE_UNLIKELY(false_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            false_remap_list);
@@ -1665,7 +1683,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       uint16_t table_size = VM_DecConstI16("table_size");
       if (index < 0 || index >= table_size) {
         // Out-of-bounds index; jump to default block.
-        pc = default_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        pc = IREE_VM_BRANCH_TARGET_PC(default_block_pc);
         if (IREE_UNLIKELY(default_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            default_remap_list);
@@ -1680,7 +1698,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
         int32_t case_block_pc = VM_DecBranchTarget("case_dest");
         const iree_vm_register_remap_list_t* case_remap_list =
             VM_DecBranchOperands("case_operands");
-        pc = case_block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+        pc = IREE_VM_BRANCH_TARGET_PC(case_block_pc);
         if (IREE_UNLIKELY(case_remap_list->size > 0)) {
           iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                            case_remap_list);
@@ -1808,7 +1826,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       IREE_ASSERT(import_ordinal < module_state->import_count);
       const iree_vm_bytecode_import_t* import =
           &module_state->import_table[import_ordinal];
-      *result = import->function.module != NULL ? 1 : 0;
+      *result = import->call_cache.function.module != NULL ? 1 : 0;
     });
 
     //===------------------------------------------------------------------===//
@@ -1823,8 +1841,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
           VM_DecBranchOperands("operands");
       iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                        remap_list);
-      current_frame->pc =
-          block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+      current_frame->pc = IREE_VM_BRANCH_TARGET_PC(block_pc);
 
       // Return magic status code indicating a yield.
       // This isn't an error, though callers not supporting coroutines will
@@ -1874,7 +1891,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
           VM_DecBranchOperands("operands");
       iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                        remap_list);
-      pc = block_pc + IREE_VM_BLOCK_MARKER_SIZE;  // skip block marker
+      pc = IREE_VM_BRANCH_TARGET_PC(block_pc);
     });
 
     //===------------------------------------------------------------------===//
@@ -2481,6 +2498,107 @@ static iree_status_t iree_vm_bytecode_dispatch(
     UNHANDLED_DISPATCH_PREFIX(PrefixExtF64, EXT_F64);
 #endif  // IREE_VM_EXT_F64_ENABLE
 
+#if IREE_VM_EXT_FUSED_ENABLE
+    BEGIN_DISPATCH_PREFIX(PrefixExtFused, EXT_FUSED) {
+      //===----------------------------------------------------------------===//
+      // ExtFused: Compare and branch
+      //===----------------------------------------------------------------===//
+
+#define DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(op_name, type, dec_operand,    \
+                                              op_func)                       \
+  DISPATCH_OP(EXT_FUSED, op_name, {                                          \
+    type lhs = dec_operand("lhs");                                           \
+    type rhs = dec_operand("rhs");                                           \
+    int32_t true_block_pc = VM_DecBranchTarget("true_dest");                 \
+    const iree_vm_register_remap_list_t* true_remap_list =                   \
+        VM_DecBranchOperands("true_operands");                               \
+    int32_t false_block_pc = VM_DecBranchTarget("false_dest");               \
+    const iree_vm_register_remap_list_t* false_remap_list =                  \
+        VM_DecBranchOperands("false_operands");                              \
+    if (op_func(lhs, rhs)) {                                                 \
+      pc = IREE_VM_BRANCH_TARGET_PC(true_block_pc);                          \
+      if (IREE_UNLIKELY(true_remap_list->size > 0)) {                        \
+        iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref, \
+                                                         true_remap_list);   \
+      }                                                                      \
+    } else {                                                                 \
+      pc = IREE_VM_BRANCH_TARGET_PC(false_block_pc);                         \
+      if (IREE_UNLIKELY(false_remap_list->size > 0)) {                       \
+        iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref, \
+                                                         false_remap_list);  \
+      }                                                                      \
+    }                                                                        \
+  });
+
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpEQI32CondBranch, int32_t,
+                                            VM_DecOperandRegI32, vm_cmp_eq_i32);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpNEI32CondBranch, int32_t,
+                                            VM_DecOperandRegI32, vm_cmp_ne_i32);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI32SCondBranch, int32_t,
+                                            VM_DecOperandRegI32,
+                                            vm_cmp_lt_i32s);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI32UCondBranch, int32_t,
+                                            VM_DecOperandRegI32,
+                                            vm_cmp_lt_i32u);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpEQI64CondBranch, int64_t,
+                                            VM_DecOperandRegI64, vm_cmp_eq_i64);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpNEI64CondBranch, int64_t,
+                                            VM_DecOperandRegI64, vm_cmp_ne_i64);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI64SCondBranch, int64_t,
+                                            VM_DecOperandRegI64,
+                                            vm_cmp_lt_i64s);
+      DISPATCH_OP_EXT_FUSED_CMP_COND_BRANCH(CmpLTI64UCondBranch, int64_t,
+                                            VM_DecOperandRegI64,
+                                            vm_cmp_lt_i64u);
+
+      //===----------------------------------------------------------------===//
+      // ExtFused: Arithmetic with immediates
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_FUSED, AddI32Imm, {
+        int32_t lhs = VM_DecOperandRegI32("lhs");
+        int32_t rhs = VM_DecAttrI32("rhs");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = vm_add_i32(lhs, rhs);
+      });
+      DISPATCH_OP(EXT_FUSED, AddI64Imm, {
+        int64_t lhs = VM_DecOperandRegI64("lhs");
+        int64_t rhs = VM_DecAttrI64("rhs");
+        int64_t* result = VM_DecResultRegI64("result");
+        *result = vm_add_i64(lhs, rhs);
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtFused: Buffers
+      //===----------------------------------------------------------------===//
+
+#define DISPATCH_OP_EXT_FUSED_BUFFER_LOAD_I32_EXT_I64(op_name, ext_func)    \
+  DISPATCH_OP(EXT_FUSED, op_name, {                                         \
+    bool buffer_is_move;                                                    \
+    iree_vm_ref_t* buffer_ref =                                             \
+        VM_DecOperandRegRef("source_buffer", &buffer_is_move);              \
+    iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);           \
+    if (IREE_UNLIKELY(!buffer)) {                                           \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                 \
+                              "source_buffer is null");                     \
+    }                                                                       \
+    iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset"); \
+    int64_t* result = VM_DecResultRegI64("result");                         \
+    int32_t value = 0;                                                      \
+    vm_buffer_load_i32_inline(buffer, offset, &value);                      \
+    *result = ext_func(value);                                              \
+  });
+
+      DISPATCH_OP_EXT_FUSED_BUFFER_LOAD_I32_EXT_I64(BufferLoadI32ExtI64S,
+                                                    vm_ext_i32i64s);
+      DISPATCH_OP_EXT_FUSED_BUFFER_LOAD_I32_EXT_I64(BufferLoadI32ExtI64U,
+                                                    vm_ext_i32i64u);
+    }
+    END_DISPATCH_PREFIX();
+#else
+    UNHANDLED_DISPATCH_PREFIX(PrefixExtFused, EXT_FUSED);
+#endif  // IREE_VM_EXT_FUSED_ENABLE
+
     // NOLINTNEXTLINE(misc-static-assert)
     DISPATCH_UNHANDLED_CORE();
   }
@@ -116,6 +116,25 @@ static inline iree_vm_type_def_t iree_vm_map_type(
 #define IREE_DISPATCH_TRACE_INSTRUCTION(...)
 #endif  // IREE_VM_EXECUTION_TRACING_ENABLE
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+// Counts an execution of the block whose vm.block marker op was just decoded.
+// |block_counts| is owned by the dispatching thread so a plain relaxed
+// load/store pair suffices.
+#define IREE_DISPATCH_COUNT_BLOCK()                                          \
+  {                                                                          \
+    iree_host_size_t block_offset = (iree_host_size_t)(                      \
+        &bytecode_data[pc - 1] - module->bytecode_data.data);                \
+    iree_atomic_int64_t* block_count =                                       \
+        &block_counts[block_offset >> IREE_VM_BYTECODE_BLOCK_COUNTER_SHIFT]; \
+    iree_atomic_store(                                                       \
+        block_count,                                                         \
+        iree_atomic_load(block_count, iree_memory_order_relaxed) + 1,        \
+        iree_memory_order_relaxed);                                          \
+  }
+#else
+#define IREE_DISPATCH_COUNT_BLOCK()
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 #if defined(IREE_COMPILER_CLANG) && \
     IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 #define IREE_DISPATCH_MODE_COMPUTED_GOTO 1
@@ -226,6 +245,16 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
 
 #define IREE_VM_BLOCK_MARKER_SIZE 1
 
+// Returns the pc to continue at when branching to the block at |block_pc|.
+// The vm.block marker is a no-op and skipped unless execution counters are
+// enabled, in which case branches land on it so that the target is counted.
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+#define IREE_VM_BRANCH_TARGET_PC(block_pc) (block_pc)
+#else
+#define IREE_VM_BRANCH_TARGET_PC(block_pc) \
+  ((block_pc) + IREE_VM_BLOCK_MARKER_SIZE)
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 //===----------------------------------------------------------------------===//
 // Dispatch table structure
 //===----------------------------------------------------------------------===//
@@ -277,11 +306,22 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
 #else
 #define DEFINE_DISPATCH_TABLE_EXT_F64()
 #endif  // IREE_VM_EXT_F64_ENABLE
+#if IREE_VM_EXT_FUSED_ENABLE
+#define DECLARE_DISPATCH_EXT_FUSED_OPC(ordinal, name) \
+  &&_dispatch_EXT_FUSED_##name,
+#define DEFINE_DISPATCH_TABLE_EXT_FUSED()                        \
+  static const void* kDispatchTable_EXT_FUSED[256] = {           \
+      IREE_VM_OP_EXT_FUSED_TABLE(DECLARE_DISPATCH_EXT_FUSED_OPC, \
+                                 DECLARE_DISPATCH_EXT_RSV)};
+#else
+#define DEFINE_DISPATCH_TABLE_EXT_FUSED()
+#endif  // IREE_VM_EXT_FUSED_ENABLE
 
 #define DEFINE_DISPATCH_TABLES()   \
   DEFINE_DISPATCH_TABLE_CORE();    \
   DEFINE_DISPATCH_TABLE_EXT_F32(); \
-  DEFINE_DISPATCH_TABLE_EXT_F64();
+  DEFINE_DISPATCH_TABLE_EXT_F64(); \
+  DEFINE_DISPATCH_TABLE_EXT_FUSED();
 
 #define DISPATCH_UNHANDLED_CORE()                                           \
   _dispatch_unhandled /*verifier should prevent this*/ : {                  \
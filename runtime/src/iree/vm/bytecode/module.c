@@ -6,11 +6,13 @@
 
 #include "iree/vm/bytecode/module.h"
 
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "iree/vm/bytecode/archive.h"
+#include "iree/vm/bytecode/disassembler.h"
 #include "iree/vm/bytecode/module_impl.h"
 #include "iree/vm/bytecode/verifier.h"
 
@@ -304,7 +306,10 @@ static iree_status_t iree_vm_bytecode_module_lookup_function(
       if (iree_vm_flatbuffer_strcmp(
               iree_vm_ExportFunctionDef_local_name(export_def), name) == 0) {
         out_function->ordinal = ordinal;
-        return iree_ok_status();
+        // Resolving an export is the first indication a function will be used
+        // and verifying it here reports malformed bytecode before any call.
+        return iree_vm_bytecode_function_ensure_verified(
+            module, iree_vm_ExportFunctionDef_internal_ordinal(export_def));
       }
     }
   }
@@ -605,6 +610,20 @@ static iree_status_t iree_vm_bytecode_module_resolve_source_location(
   return iree_ok_status();
 }
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+// Last ID assigned to a module state for keying block counter caches.
+static iree_atomic_int64_t iree_vm_bytecode_module_state_last_block_counter_id =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Returns a new process-unique non-zero module state ID.
+static uint64_t iree_vm_bytecode_module_state_next_block_counter_id(void) {
+  return (uint64_t)iree_atomic_fetch_add(
+             &iree_vm_bytecode_module_state_last_block_counter_id, 1,
+             iree_memory_order_relaxed) +
+         1;
+}
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 // Lays out the nested tables within a |state| structure.
 // Returns the total size of the structure and all tables with padding applied.
 // |state| may be null if only the structure size is required for allocation.
@@ -647,6 +666,19 @@ static iree_host_size_t iree_vm_bytecode_module_layout_state(
   offset +=
       iree_host_align(import_function_count * sizeof(*state->import_table), 16);
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+  // Counter tables are allocated per thread on first use.
+  if (state) {
+    state->block_counter_state_id =
+        iree_vm_bytecode_module_state_next_block_counter_id();
+    state->block_counter_count = iree_vm_bytecode_block_counter_count(
+        flatbuffers_uint8_vec_len(
+            iree_vm_BytecodeModuleDef_bytecode_data(module_def)));
+    iree_slim_mutex_initialize(&state->block_counter_mutex);
+    state->block_counter_tables = NULL;
+  }
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
   return offset;
 }
 
@@ -692,6 +724,16 @@ static void iree_vm_bytecode_module_free_state(
     iree_vm_ref_release(&state->global_ref_table[i]);
   }
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+  iree_vm_bytecode_block_counter_table_t* table = state->block_counter_tables;
+  while (table) {
+    iree_vm_bytecode_block_counter_table_t* next_table = table->next;
+    iree_allocator_free(state->allocator, table);
+    table = next_table;
+  }
+  iree_slim_mutex_deinitialize(&state->block_counter_mutex);
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
   iree_allocator_free(state->allocator, module_state);
 
   IREE_TRACE_ZONE_END(z0);
@@ -718,10 +760,12 @@ static iree_status_t IREE_API_PTR iree_vm_bytecode_module_fork_state(
       iree_vm_bytecode_module_layout_state(module_def, NULL);
 
   // Allocate the storage for the structure and all its nested tables.
+  // Every table is fully overwritten below so we skip zero-initializing the
+  // storage; this keeps forks cheap for modules with large rwdata.
   iree_vm_bytecode_module_state_t* child_state = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, total_state_struct_size,
-                                (void**)&child_state));
+      z0, iree_allocator_malloc_uninitialized(
+              allocator, total_state_struct_size, (void**)&child_state));
   child_state->allocator = allocator;
 
   // Perform layout to get the pointers into the storage for each nested table.
@@ -733,20 +777,28 @@ static iree_status_t IREE_API_PTR iree_vm_bytecode_module_fork_state(
   memcpy(child_state->rwdata_storage.data, parent_state->rwdata_storage.data,
          child_state->rwdata_storage.data_length);
 
-  // Retain all global refs by default. The fork signal handler in the child
-  // state may clear/reinitialize ones it doesn't want to retain from the
-  // parent. Note that some of these may be null.
-  for (iree_host_size_t i = 0; i < parent_state->global_ref_count; ++i) {
-    iree_vm_ref_retain(&parent_state->global_ref_table[i],
-                       &child_state->global_ref_table[i]);
+  // Share all global refs by default. The referenced objects (buffers,
+  // executables, etc) are immutable or internally synchronized and only the
+  // ref table itself is per-state. The fork signal handler in the child state
+  // may clear/reinitialize ones it doesn't want to retain from the parent.
+  // Note that some of these may be null.
+  memcpy(child_state->global_ref_table, parent_state->global_ref_table,
+         parent_state->global_ref_count *
+             sizeof(child_state->global_ref_table[0]));
+  for (iree_host_size_t i = 0; i < child_state->global_ref_count; ++i) {
+    iree_vm_ref_retain_inplace(&child_state->global_ref_table[i]);
   }
 
   // Reuse the resolved imports directly as the context is being forked and all
   // must resolve to the same exact functions. Note that the import table
   // entries have pointers but those are referencing the shared flatbuffer data
-  // that exists in the module instead of in the parent state.
+  // that exists in the module instead of in the parent state. Any callee
+  // module states cached by the parent must be re-resolved in the child.
   memcpy(child_state->import_table, parent_state->import_table,
          parent_state->import_count * sizeof(child_state->import_table[0]));
+  for (iree_host_size_t i = 0; i < child_state->import_count; ++i) {
+    iree_vm_function_call_cache_reset(&child_state->import_table[i].call_cache);
+  }
 
   *out_child_state = (iree_vm_module_state_t*)child_state;
 
@@ -754,6 +806,96 @@ static iree_status_t IREE_API_PTR iree_vm_bytecode_module_fork_state(
   return iree_ok_status();
 }
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+
+// Number of module states whose block counter tables each thread caches.
+// Dispatch alternates between the states of modules calling each other and
+// the cache is direct-mapped by state ID.
+#define IREE_VM_BYTECODE_BLOCK_COUNTER_CACHE_SIZE 4
+
+// A thread-local cache entry mapping a module state to its counter table.
+typedef struct iree_vm_bytecode_block_counter_cache_entry_t {
+  // iree_vm_bytecode_module_state_t::block_counter_state_id or 0 if unused.
+  uint64_t state_id;
+  // Counts of the calling thread in the state.
+  iree_atomic_int64_t* counts;
+} iree_vm_bytecode_block_counter_cache_entry_t;
+
+// Counter tables recently used by the calling thread. The address of the
+// cache also uniquely identifies each live thread. A new thread reusing the
+// address of an exited one adopts its counter tables, which is harmless as
+// the exited thread can no longer update them.
+static iree_thread_local iree_vm_bytecode_block_counter_cache_entry_t
+    iree_vm_bytecode_block_counter_cache
+        [IREE_VM_BYTECODE_BLOCK_COUNTER_CACHE_SIZE];
+
+// Looks up or allocates the table of the calling thread in |state|.
+static iree_status_t iree_vm_bytecode_module_state_lookup_block_counts(
+    iree_vm_bytecode_module_state_t* state, const void* thread_key,
+    iree_atomic_int64_t** out_counts) {
+  // Tables are only ever prepended and only this thread can add its own so
+  // the lookup result remains valid after the lock is released.
+  iree_slim_mutex_lock(&state->block_counter_mutex);
+  iree_vm_bytecode_block_counter_table_t* table = state->block_counter_tables;
+  while (table && table->thread_key != thread_key) table = table->next;
+  iree_status_t status = iree_ok_status();
+  if (!table) {
+    const iree_host_size_t header_size =
+        iree_host_align(sizeof(*table), iree_alignof(iree_atomic_int64_t));
+    status = iree_allocator_malloc(
+        state->allocator,
+        header_size + state->block_counter_count * sizeof(table->counts[0]),
+        (void**)&table);
+    if (iree_status_is_ok(status)) {
+      table->next = state->block_counter_tables;
+      table->thread_key = thread_key;
+      table->counts = (iree_atomic_int64_t*)((uint8_t*)table + header_size);
+      state->block_counter_tables = table;
+    }
+  }
+  iree_slim_mutex_unlock(&state->block_counter_mutex);
+  if (iree_status_is_ok(status)) *out_counts = table->counts;
+  return status;
+}
+
+iree_status_t iree_vm_bytecode_module_state_thread_block_counts(
+    iree_vm_bytecode_module_state_t* state, iree_atomic_int64_t** out_counts) {
+  // States are keyed by their unique ID instead of their address as a new
+  // state may be allocated where a freed one (and its tables) used to be.
+  iree_vm_bytecode_block_counter_cache_entry_t* entry =
+      &iree_vm_bytecode_block_counter_cache
+          [state->block_counter_state_id &
+           (IREE_VM_BYTECODE_BLOCK_COUNTER_CACHE_SIZE - 1)];
+  if (IREE_LIKELY(entry->state_id == state->block_counter_state_id)) {
+    *out_counts = entry->counts;
+    return iree_ok_status();
+  }
+  *out_counts = NULL;
+  iree_atomic_int64_t* counts = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_state_lookup_block_counts(
+      state, &iree_vm_bytecode_block_counter_cache[0], &counts));
+  entry->state_id = state->block_counter_state_id;
+  entry->counts = counts;
+  *out_counts = counts;
+  return iree_ok_status();
+}
+
+// Returns the count of the block at counter |index| summed across all threads.
+// Must be called with the block counter mutex held.
+static uint64_t iree_vm_bytecode_module_state_block_count(
+    iree_vm_bytecode_module_state_t* state, iree_host_size_t index) {
+  uint64_t count = 0;
+  for (iree_vm_bytecode_block_counter_table_t* table =
+           state->block_counter_tables;
+       table; table = table->next) {
+    count += (uint64_t)iree_atomic_load(&table->counts[index],
+                                        iree_memory_order_relaxed);
+  }
+  return count;
+}
+
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -769,7 +911,7 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
   }
 
   iree_vm_bytecode_import_t* import = &state->import_table[ordinal];
-  import->function = *function;
+  iree_vm_function_call_cache_initialize(function, &import->call_cache);
 
   // Split up arguments/results into fragments so that we can avoid scanning
   // during calling.
@@ -862,6 +1004,15 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  return iree_vm_bytecode_module_create_with_flags(
+      instance, IREE_VM_BYTECODE_MODULE_FLAG_NONE, archive_contents,
+      archive_allocator, allocator, out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_flags(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t flags,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
@@ -902,12 +1053,25 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  // When verifying lazily we track which functions have been verified with a
+  // bitmap stored at the end of the module allocation.
+  const bool verify_lazily =
+      IREE_VM_BYTECODE_VERIFICATION_ENABLE &&
+      iree_all_bits_set(flags, IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION);
+  iree_host_size_t function_count = iree_vm_FunctionDescriptor_vec_len(
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def));
+  size_t verified_function_bits_size =
+      verify_lazily ? iree_host_align(iree_host_align(function_count, 32) / 8,
+                                      16)
+                    : 0;
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size +
+                                    verified_function_bits_size,
+                                (void**)&module));
   module->allocator = allocator;
 
   iree_vm_FunctionDescriptor_vec_t function_descriptors =
@@ -987,10 +1151,17 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   }
 
   // Verify functions in the module now that we've verified the metadata that we
-  // need to do so.
+  // need to do so. When verifying lazily the bitmap starts zeroed (no functions
+  // verified) and each function is verified on first use.
   iree_status_t verify_status = iree_ok_status();
+  module->verified_function_bits =
+      verify_lazily
+          ? (iree_atomic_uint32_t*)((uint8_t*)module + sizeof(*module) +
+                                    type_table_size + rodata_ref_table_size)
+          : NULL;
 #if IREE_VM_BYTECODE_VERIFICATION_ENABLE
-  for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
+  for (uint16_t i = 0; !verify_lazily && i < module->function_descriptor_count;
+       ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
     verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
     IREE_TRACE_ZONE_END(z1);
@@ -1006,3 +1177,235 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   IREE_TRACE_ZONE_END(z0);
   return verify_status;
 }
+
+//===----------------------------------------------------------------------===//
+// Execution counters
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_vm_bytecode_module_cast(
+    iree_vm_module_t* base_module, iree_vm_bytecode_module_t** out_module) {
+  if (IREE_UNLIKELY(base_module->destroy != iree_vm_bytecode_module_destroy)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "module is not a bytecode module");
+  }
+  *out_module = (iree_vm_bytecode_module_t*)base_module->self;
+  return iree_ok_status();
+}
+
+// Appends the name of the internal function at |function_ordinal| or its
+// ordinal if the module has no debug information.
+static iree_status_t iree_vm_bytecode_module_append_function_name(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
+    iree_string_builder_t* builder) {
+  iree_vm_function_t function = {
+      .module = &module->interface,
+      .linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL,
+      .ordinal = function_ordinal,
+  };
+  iree_string_view_t function_name = iree_vm_function_name(&function);
+  if (iree_string_view_is_empty(function_name)) {
+    return iree_string_builder_append_format(builder, "@%u", function_ordinal);
+  }
+  return iree_string_builder_append_string(builder, function_name);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_append_counters(
+    iree_vm_module_t* base_module, iree_vm_module_state_t* base_module_state,
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(base_module);
+  IREE_ASSERT_ARGUMENT(base_module_state);
+  IREE_ASSERT_ARGUMENT(builder);
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+  iree_vm_bytecode_module_t* module = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_cast(base_module, &module));
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)base_module_state;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Counts are merged across the tables of all threads that have executed
+  // the state. Threads still executing may record concurrently with the read.
+  iree_slim_mutex_lock(&state->block_counter_mutex);
+
+  iree_string_view_t module_name = iree_vm_module_name(base_module);
+  iree_status_t status = iree_string_builder_append_format(
+      builder, "# iree-vm-counters v1\nmodule %.*s\n", (int)module_name.size,
+      module_name.data);
+  for (uint16_t i = 0;
+       iree_status_is_ok(status) && i < module->function_descriptor_count;
+       ++i) {
+    const iree_vm_FunctionDescriptor_t* function_descriptor =
+        &module->function_descriptor_table[i];
+    const iree_vm_source_offset_t bytecode_length =
+        function_descriptor->bytecode_length;
+
+    // Functions are always entered at their first block.
+    uint64_t entry_count = iree_vm_bytecode_module_state_block_count(
+        state, iree_vm_bytecode_block_counter_index(function_descriptor,
+                                                    /*block_pc=*/0));
+    if (!entry_count) continue;
+    status = iree_string_builder_append_format(
+        builder, "function %u %" PRIu64 " ", i, entry_count);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_vm_bytecode_module_append_function_name(module, i, builder);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_cstring(builder, "\n");
+    }
+
+    iree_vm_source_offset_t block_pc = 0;
+    while (iree_status_is_ok(status)) {
+      status =
+          iree_vm_bytecode_find_next_block(module, i, block_pc, &block_pc);
+      if (!iree_status_is_ok(status) || block_pc >= bytecode_length) break;
+      uint64_t count = iree_vm_bytecode_module_state_block_count(
+          state,
+          iree_vm_bytecode_block_counter_index(function_descriptor, block_pc));
+      if (count) {
+        status = iree_string_builder_append_format(
+            builder, "block %u %" PRId64 " %" PRIu64 "\n", i, block_pc,
+            count);
+      }
+      ++block_pc;  // skip vm.block marker
+    }
+  }
+
+  iree_slim_mutex_unlock(&state->block_counter_mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "execution counters not enabled in this build; "
+                          "define IREE_VM_EXECUTION_COUNTERS_ENABLE=1");
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+}
+
+// Accumulates the block counts recorded for |module| in |counters| (in the
+// iree-vm-counters format) into |block_counters|.
+static iree_status_t iree_vm_bytecode_module_parse_counters(
+    iree_vm_bytecode_module_t* module, iree_string_view_t counters,
+    uint64_t* block_counters) {
+  iree_string_view_t module_name = iree_vm_module_name(&module->interface);
+  bool in_module = false;
+  while (!iree_string_view_is_empty(counters)) {
+    iree_string_view_t line = iree_string_view_empty();
+    iree_string_view_split(counters, '\n', &line, &counters);
+    line = iree_string_view_trim(line);
+    if (iree_string_view_is_empty(line) ||
+        iree_string_view_starts_with(line, IREE_SV("#"))) {
+      continue;
+    }
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t value = iree_string_view_empty();
+    iree_string_view_split(line, ' ', &key, &value);
+    if (iree_string_view_equal(key, IREE_SV("module"))) {
+      in_module = iree_string_view_equal(value, module_name);
+      continue;
+    } else if (!in_module || !iree_string_view_equal(key, IREE_SV("block"))) {
+      // Function entry counts are derived from their entry blocks.
+      continue;
+    }
+
+    // block <function ordinal> <block pc> <count>
+    iree_string_view_t ordinal_str = iree_string_view_empty();
+    iree_string_view_t pc_str = iree_string_view_empty();
+    iree_string_view_t count_str = iree_string_view_empty();
+    iree_string_view_split(value, ' ', &ordinal_str, &value);
+    iree_string_view_split(value, ' ', &pc_str, &count_str);
+    uint32_t function_ordinal = 0;
+    uint64_t block_pc = 0;
+    uint64_t count = 0;
+    if (!iree_string_view_atoi_uint32(ordinal_str, &function_ordinal) ||
+        !iree_string_view_atoi_uint64(pc_str, &block_pc) ||
+        !iree_string_view_atoi_uint64(count_str, &count)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "malformed counter line `%.*s`", (int)line.size,
+                              line.data);
+    }
+    const iree_vm_FunctionDescriptor_t* function_descriptor =
+        function_ordinal < module->function_descriptor_count
+            ? &module->function_descriptor_table[function_ordinal]
+            : NULL;
+    if (!function_descriptor ||
+        block_pc >= (uint64_t)function_descriptor->bytecode_length) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "counter line `%.*s` does not match the module; counters must be "
+          "recorded with the same module binary",
+          (int)line.size, line.data);
+    }
+    block_counters[iree_vm_bytecode_block_counter_index(
+        function_descriptor, (iree_vm_source_offset_t)block_pc)] += count;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_module_append_function_disassembly(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
+    const uint64_t* block_counters, iree_string_builder_t* builder) {
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "func "));
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_append_function_name(
+      module, function_ordinal, builder));
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder, "  // ordinal: %u", function_ordinal));
+  if (block_counters) {
+    const iree_vm_FunctionDescriptor_t* function_descriptor =
+        &module->function_descriptor_table[function_ordinal];
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, ", entries: %" PRIu64,
+        block_counters[iree_vm_bytecode_block_counter_index(
+            function_descriptor, /*block_pc=*/0)]));
+  }
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "\n"));
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_disassemble_function(
+      module, /*module_state=*/NULL, function_ordinal, block_counters,
+      builder));
+  return iree_string_builder_append_cstring(builder, "\n");
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_append_disassembly(
+    iree_vm_module_t* base_module, iree_string_view_t counters,
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(base_module);
+  IREE_ASSERT_ARGUMENT(builder);
+  iree_vm_bytecode_module_t* module = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_cast(base_module, &module));
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Functions must be verified before they can be walked.
+  iree_status_t status = iree_ok_status();
+  for (uint16_t i = 0;
+       iree_status_is_ok(status) && i < module->function_descriptor_count;
+       ++i) {
+    status = iree_vm_bytecode_function_ensure_verified(module, i);
+  }
+
+  uint64_t* block_counters = NULL;
+  if (iree_status_is_ok(status) && !iree_string_view_is_empty(counters)) {
+    iree_host_size_t block_counter_count =
+        iree_vm_bytecode_block_counter_count(module->bytecode_data.data_length);
+    status = iree_allocator_malloc(module->allocator,
+                                   block_counter_count * sizeof(uint64_t),
+                                   (void**)&block_counters);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_bytecode_module_parse_counters(module, counters,
+                                                      block_counters);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_string_view_t module_name = iree_vm_module_name(base_module);
+    status = iree_string_builder_append_format(
+        builder, "module @%.*s\n\n", (int)module_name.size, module_name.data);
+  }
+  for (uint16_t i = 0;
+       iree_status_is_ok(status) && i < module->function_descriptor_count;
+       ++i) {
+    status = iree_vm_bytecode_module_append_function_disassembly(
+        module, i, block_counters, builder);
+  }
+
+  iree_allocator_free(module->allocator, block_counters);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
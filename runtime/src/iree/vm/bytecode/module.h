@@ -14,15 +14,72 @@
 extern "C" {
 #endif  // __cplusplus
 
+enum iree_vm_bytecode_module_flag_bits_t {
+  IREE_VM_BYTECODE_MODULE_FLAG_NONE = 0u,
+
+  // Defers verification of function bytecode until each function is first
+  // looked up by name or entered instead of verifying all functions when the
+  // module is created. This reduces cold start time for large modules where
+  // only a few functions are called but moves verification failures from
+  // module creation to the first call of the malformed function.
+  // Has no effect if bytecode verification is disabled; see
+  // IREE_VM_BYTECODE_VERIFICATION_ENABLE.
+  IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION = 1u << 0,
+};
+typedef uint32_t iree_vm_bytecode_module_flags_t;
+
 // Creates a VM module from an in-memory ModuleDef FlatBuffer archive.
 // If a |archive_allocator| is provided then it will be used to free the
 // |archive_contents| when the module is destroyed and otherwise the ownership
 // of the memory remains with the caller.
+//
+// Rodata is referenced in-place from |archive_contents| and never copied or
+// read during creation. When the archive is a mapped file (see
+// iree_io_file_map_view and iree_io_file_mapping_deallocator) the pages of
+// large constants are only faulted in when first accessed.
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module from an in-memory ModuleDef FlatBuffer archive with the
+// given |flags| controlling how the module is loaded.
+// See iree_vm_bytecode_module_create for more information.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_flags(
+    iree_vm_instance_t* instance, iree_vm_bytecode_module_flags_t flags,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
+//===----------------------------------------------------------------------===//
+// Execution counters
+//===----------------------------------------------------------------------===//
+
+// Appends the execution counters recorded in |module_state| of the bytecode
+// |module| to |builder| in the iree-vm-counters text format:
+//   # iree-vm-counters v1
+//   module <module name>
+//   function <function ordinal> <entry count> <function name>
+//   block <function ordinal> <block pc> <count>
+// Only functions and blocks that have executed are included. Block pcs are
+// relative to the start of the function and match those printed by
+// iree_vm_bytecode_module_append_disassembly.
+//
+// Counters are only recorded when IREE_VM_EXECUTION_COUNTERS_ENABLE is set and
+// otherwise IREE_STATUS_UNAVAILABLE is returned. |module_state| must not be in
+// use by any invocation while the counters are read.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_append_counters(
+    iree_vm_module_t* module, iree_vm_module_state_t* module_state,
+    iree_string_builder_t* builder);
+
+// Appends the disassembly of all functions in the bytecode |module| to
+// |builder|. If |counters| contains data in the format produced by
+// iree_vm_bytecode_module_append_counters then each function and block is
+// annotated with the counts recorded for the module of the same name. Counts
+// from multiple dumps of the same module are summed.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_append_disassembly(
+    iree_vm_module_t* module, iree_string_view_t counters,
+    iree_string_builder_t* builder);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -5,12 +5,15 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <array>
+#include <cstdio>
+#include <utility>
 #include <vector>
 
 #include "iree/base/api.h"
 #include "iree/testing/benchmark.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/module.h"
+#include "iree/vm/bytecode/module_benchmark_fused_module_c.h"
 #include "iree/vm/bytecode/module_benchmark_module_c.h"
 
 namespace {
@@ -70,11 +73,12 @@ static iree_status_t native_import_module_create(
                                       instance, allocator, out_module);
 }
 
-// Benchmarks the given exported function, optionally passing in arguments.
-static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
-                                 iree_string_view_t function_name,
-                                 std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+// Benchmarks the given exported function in the module compiled to
+// |module_file_toc|, optionally passing in arguments.
+static iree_status_t RunFunctionInModule(
+    iree_benchmark_state_t* benchmark_state,
+    const iree_file_toc_t* module_file_toc, iree_string_view_t function_name,
+    std::vector<int32_t> i32_args, int result_count, int64_t batch_size) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
@@ -83,8 +87,6 @@ static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
   IREE_CHECK_OK(native_import_module_create(instance, iree_allocator_system(),
                                             &import_module));
 
-  const auto* module_file_toc =
-      iree_vm_bytecode_module_benchmark_module_create();
   iree_vm_module_t* bytecode_module = nullptr;
   IREE_CHECK_OK(iree_vm_bytecode_module_create(
       instance,
@@ -133,6 +135,29 @@ static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
   return iree_ok_status();
 }
 
+// Benchmarks the given exported function, optionally passing in arguments.
+static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
+                                 iree_string_view_t function_name,
+                                 std::vector<int32_t> i32_args,
+                                 int result_count, int64_t batch_size = 1) {
+  return RunFunctionInModule(benchmark_state,
+                             iree_vm_bytecode_module_benchmark_module_create(),
+                             function_name, std::move(i32_args), result_count,
+                             batch_size);
+}
+
+// Benchmarks the given exported function in the module compiled with fused
+// superinstructions, optionally passing in arguments.
+static iree_status_t RunFusedFunction(iree_benchmark_state_t* benchmark_state,
+                                      iree_string_view_t function_name,
+                                      std::vector<int32_t> i32_args,
+                                      int result_count,
+                                      int64_t batch_size = 1) {
+  return RunFunctionInModule(
+      benchmark_state, iree_vm_bytecode_module_benchmark_fused_module_create(),
+      function_name, std::move(i32_args), result_count, batch_size);
+}
+
 IREE_BENCHMARK_FN(BM_ModuleCreate) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
@@ -222,6 +247,166 @@ IREE_BENCHMARK_FN(BM_FullModuleInit) {
 }
 IREE_BENCHMARK_REGISTER(BM_FullModuleInit);
 
+// Measures the cold start latency of loading the module into a new context and
+// calling a single function with the given module |flags|. Only the called
+// function is verified when verifying lazily while all functions are verified
+// during module creation otherwise.
+static iree_status_t RunColdStart(iree_benchmark_state_t* benchmark_state,
+                                  iree_vm_bytecode_module_flags_t flags) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+
+  iree_vm_module_t* import_module = NULL;
+  IREE_CHECK_OK(native_import_module_create(instance, iree_allocator_system(),
+                                            &import_module));
+
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    const auto* module_file_toc =
+        iree_vm_bytecode_module_benchmark_module_create();
+    iree_vm_module_t* bytecode_module = nullptr;
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_flags(
+        instance, flags,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module));
+
+    std::array<iree_vm_module_t*, 2> modules = {import_module,
+                                                bytecode_module};
+    iree_vm_context_t* context = NULL;
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context));
+
+    iree_vm_function_t function;
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context,
+        iree_make_cstring_view("bytecode_module_benchmark.empty_func"),
+        &function));
+    IREE_CHECK_OK(iree_vm_invoke(context, function,
+                                 IREE_VM_INVOCATION_FLAG_NONE,
+                                 /*policy=*/nullptr, /*inputs=*/nullptr,
+                                 /*outputs=*/nullptr, iree_allocator_system()));
+
+    iree_vm_context_release(context);
+    iree_vm_module_release(bytecode_module);
+  }
+
+  iree_vm_module_release(import_module);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+
+IREE_BENCHMARK_FN(BM_ColdStartEagerVerification) {
+  return RunColdStart(benchmark_state, IREE_VM_BYTECODE_MODULE_FLAG_NONE);
+}
+IREE_BENCHMARK_REGISTER(BM_ColdStartEagerVerification);
+
+IREE_BENCHMARK_FN(BM_ColdStartLazyVerification) {
+  return RunColdStart(benchmark_state,
+                      IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION);
+}
+IREE_BENCHMARK_REGISTER(BM_ColdStartLazyVerification);
+
+// Allocator wrapping the system allocator that tallies the allocations made
+// through it so that benchmarks can report memory usage per iteration.
+struct CountingAllocator {
+  iree_host_size_t allocation_count = 0;
+  iree_host_size_t allocation_bytes = 0;
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    auto* counter = reinterpret_cast<CountingAllocator*>(self);
+    if (command == IREE_ALLOCATOR_COMMAND_MALLOC ||
+        command == IREE_ALLOCATOR_COMMAND_CALLOC) {
+      ++counter->allocation_count;
+      counter->allocation_bytes +=
+          reinterpret_cast<const iree_allocator_alloc_params_t*>(params)
+              ->byte_length;
+    }
+    iree_allocator_t system_allocator = iree_allocator_system();
+    return system_allocator.ctl(system_allocator.self, command, params,
+                                inout_ptr);
+  }
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  void Reset() {
+    allocation_count = 0;
+    allocation_bytes = 0;
+  }
+};
+
+// Measures the cost of giving each request an isolated context by either
+// creating a new context with the loaded modules (rerunning state allocation,
+// import resolution, and initializers) or forking a fully initialized parent
+// context. The label reports the host memory allocated per context.
+static iree_status_t RunContextPerRequest(
+    iree_benchmark_state_t* benchmark_state, bool fork) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+
+  iree_vm_module_t* import_module = NULL;
+  IREE_CHECK_OK(native_import_module_create(instance, iree_allocator_system(),
+                                            &import_module));
+
+  const auto* module_file_toc =
+      iree_vm_bytecode_module_benchmark_module_create();
+  iree_vm_module_t* bytecode_module = nullptr;
+  IREE_CHECK_OK(iree_vm_bytecode_module_create(
+      instance,
+      iree_const_byte_span_t{
+          reinterpret_cast<const uint8_t*>(module_file_toc->data),
+          static_cast<iree_host_size_t>(module_file_toc->size)},
+      iree_allocator_null(), iree_allocator_system(), &bytecode_module));
+
+  std::array<iree_vm_module_t*, 2> modules = {import_module, bytecode_module};
+  iree_vm_context_t* parent_context = NULL;
+  IREE_CHECK_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+      iree_allocator_system(), &parent_context));
+
+  CountingAllocator counting_allocator;
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    counting_allocator.Reset();
+    iree_vm_context_t* context = NULL;
+    if (fork) {
+      IREE_CHECK_OK(iree_vm_context_fork(
+          parent_context, counting_allocator.allocator(), &context));
+    } else {
+      IREE_CHECK_OK(iree_vm_context_create_with_modules(
+          instance, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+          counting_allocator.allocator(), &context));
+    }
+    iree_optimization_barrier(context);
+    iree_vm_context_release(context);
+  }
+
+  char label[64];
+  snprintf(label, sizeof(label), "%" PRIhsz " bytes in %" PRIhsz " allocs",
+           counting_allocator.allocation_bytes,
+           counting_allocator.allocation_count);
+  iree_benchmark_set_label(benchmark_state, label);
+
+  iree_vm_context_release(parent_context);
+  iree_vm_module_release(bytecode_module);
+  iree_vm_module_release(import_module);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+
+IREE_BENCHMARK_FN(BM_ContextCreate) {
+  return RunContextPerRequest(benchmark_state, /*fork=*/false);
+}
+IREE_BENCHMARK_REGISTER(BM_ContextCreate);
+
+IREE_BENCHMARK_FN(BM_ContextFork) {
+  return RunContextPerRequest(benchmark_state, /*fork=*/true);
+}
+IREE_BENCHMARK_REGISTER(BM_ContextFork);
+
 IREE_ATTRIBUTE_NOINLINE static int empty_fn(void) {
   int ret = 1;
   iree_optimization_barrier(ret);
@@ -335,6 +520,16 @@ IREE_BENCHMARK_FN(BM_LoopSumBytecode) {
 }
 IREE_BENCHMARK_REGISTER(BM_LoopSumBytecode);
 
+IREE_BENCHMARK_FN(BM_LoopSumBytecodeFused) {
+  static const int batch = 100000;
+  return RunFusedFunction(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.loop_sum"), {batch},
+      /*result_count=*/1,
+      /*batch_size=*/batch);
+}
+IREE_BENCHMARK_REGISTER(BM_LoopSumBytecodeFused);
+
 IREE_BENCHMARK_FN(BM_BufferReduceReference) {
   static const int batch = 100000;
   static auto work = +[](int32_t* buffer, int i, int sum) {
@@ -374,6 +569,39 @@ IREE_BENCHMARK_FN(BM_BufferReduceBytecode) {
 }
 IREE_BENCHMARK_REGISTER(BM_BufferReduceBytecode);
 
+IREE_BENCHMARK_FN(BM_BufferReduceBytecodeFused) {
+  static const int batch = 100000;
+  return RunFusedFunction(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.buffer_reduce"),
+      {batch},
+      /*result_count=*/1,
+      /*batch_size=*/batch);
+}
+IREE_BENCHMARK_REGISTER(BM_BufferReduceBytecodeFused);
+
+IREE_BENCHMARK_FN(BM_BufferReduceI64Bytecode) {
+  static const int batch = 100000;
+  return RunFunction(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.buffer_reduce_i64"),
+      {batch},
+      /*result_count=*/1,
+      /*batch_size=*/batch);
+}
+IREE_BENCHMARK_REGISTER(BM_BufferReduceI64Bytecode);
+
+IREE_BENCHMARK_FN(BM_BufferReduceI64BytecodeFused) {
+  static const int batch = 100000;
+  return RunFusedFunction(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.buffer_reduce_i64"),
+      {batch},
+      /*result_count=*/1,
+      /*batch_size=*/batch);
+}
+IREE_BENCHMARK_REGISTER(BM_BufferReduceI64BytecodeFused);
+
 // NOTE: unrolled 8x, requires %count to be % 8 = 0.
 IREE_BENCHMARK_FN(BM_BufferReduceBytecodeUnrolled) {
   static const int batch = 100000;
@@ -101,6 +101,31 @@ vm.module @bytecode_module_benchmark {
     vm.return %result : i32
   }
 
+  // Measures the cost of lots of buffer loads that are widened before use.
+  vm.export @buffer_reduce_i64
+  vm.func @buffer_reduce_i64(%count : i32) -> i32 {
+    %c0 = vm.const.i64.zero
+    %pattern = vm.const.i32 1
+    %c1 = vm.const.i64 1
+    %c4 = vm.const.i64 4
+    %count_i64 = vm.ext.i32.i64.u %count : i32 -> i64
+    %count_bytes = vm.mul.i64 %count_i64, %c4 : i64
+    %alignment = vm.const.i32 16
+    %buf = vm.buffer.alloc %count_bytes, %alignment : !vm.buffer
+    vm.buffer.fill.i32 %buf, %c0, %count_i64, %pattern : i32 -> !vm.buffer
+    vm.br ^loop(%c0, %c0 : i64, i64)
+  ^loop(%i : i64, %sum : i64):
+    %element = vm.buffer.load.i32 %buf[%i] : !vm.buffer -> i32
+    %element_i64 = vm.ext.i32.i64.s %element : i32 -> i64
+    %new_sum = vm.add.i64 %sum, %element_i64 : i64
+    %ip1 = vm.add.i64 %i, %c1 : i64
+    %cmp = vm.cmp.lt.i64.s %ip1, %count_i64 : i64
+    vm.cond_br %cmp, ^loop(%ip1, %new_sum : i64, i64), ^loop_exit(%new_sum : i64)
+  ^loop_exit(%result : i64):
+    %result_i32 = vm.trunc.i64.i32 %result : i64 -> i32
+    vm.return %result_i32 : i32
+  }
+
   // Measures the cost of lots of buffer loads when somewhat unrolled.
   // NOTE: unrolled 8x, requires %count to be % 8 = 0.
   vm.export @buffer_reduce_unrolled
@@ -11,6 +11,8 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
@@ -48,11 +50,29 @@ typedef struct iree_vm_bytecode_module_t {
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
 
+  // Bitmap with one bit per internal function indicating whether the function
+  // has been verified. Only present when the module was created with
+  // IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION and otherwise NULL as all
+  // functions were verified when the module was created. Bits are only ever
+  // set and concurrent callers may race to verify the same function.
+  iree_atomic_uint32_t* verified_function_bits;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
 } iree_vm_bytecode_module_t;
 
+// Returns true if the function with the internal |function_ordinal| must be
+// verified before it can be executed.
+static inline bool iree_vm_bytecode_function_requires_verification(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  if (IREE_LIKELY(!module->verified_function_bits)) return false;
+  uint32_t word = iree_atomic_load(
+      &module->verified_function_bits[function_ordinal / 32],
+      iree_memory_order_acquire);
+  return (word & (1u << (function_ordinal % 32))) == 0;
+}
+
 // A resolved and split import in the module state table.
 //
 // NOTE: a table of these are stored per module per context so ideally we'd
@@ -60,8 +80,9 @@ typedef struct iree_vm_bytecode_module_t {
 // There's a big tradeoff though as a few extra bytes here can avoid non-trivial
 // work per import function invocation.
 typedef struct iree_vm_bytecode_import_t {
-  // Import function in the source module.
-  iree_vm_function_t function;
+  // Import function in the source module and its cached call target.
+  // The cached callee module state is specific to the owning context.
+  iree_vm_function_call_cache_t call_cache;
 
   // Pre-parsed argument/result calling convention string fragments.
   // For example, 0ii.r will be split to arguments=ii and results=r.
@@ -75,6 +96,42 @@ typedef struct iree_vm_bytecode_import_t {
   uint16_t result_buffer_size;
 } iree_vm_bytecode_import_t;
 
+// Blocks are at least 4 bytes (a vm.block marker and a 3 byte vm.return) and
+// no two blocks can share a block counter when indexed by their bytecode
+// offset shifted by this amount.
+#define IREE_VM_BYTECODE_BLOCK_COUNTER_SHIFT 2
+
+// Returns the number of block counters required for |bytecode_length| bytes of
+// module bytecode.
+static inline iree_host_size_t iree_vm_bytecode_block_counter_count(
+    iree_host_size_t bytecode_length) {
+  return (bytecode_length >> IREE_VM_BYTECODE_BLOCK_COUNTER_SHIFT) + 1;
+}
+
+// Returns the index of the counter of the block at |block_pc| in the function
+// described by |function_descriptor|.
+static inline iree_host_size_t iree_vm_bytecode_block_counter_index(
+    const iree_vm_FunctionDescriptor_t* function_descriptor,
+    iree_vm_source_offset_t block_pc) {
+  return ((iree_host_size_t)function_descriptor->bytecode_offset +
+          (iree_host_size_t)block_pc) >>
+         IREE_VM_BYTECODE_BLOCK_COUNTER_SHIFT;
+}
+
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+// Block execution counts recorded by a single thread against a module state.
+// Only the owning thread updates the counts so no read-modify-write atomics
+// are required; readers merge all tables of a state with relaxed loads.
+typedef struct iree_vm_bytecode_block_counter_table_t {
+  // Next table in the module state list.
+  struct iree_vm_bytecode_block_counter_table_t* next;
+  // Unique per-thread key of the owning thread.
+  const void* thread_key;
+  // Execution counts indexed as iree_vm_bytecode_block_counter_index.
+  iree_atomic_int64_t* counts;
+} iree_vm_bytecode_block_counter_table_t;
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 // Per-instance module state.
 // This is allocated with a provided allocator as a single flat allocation.
 // This struct is a prefix to the allocation pointing into the dynamic offsets
@@ -92,10 +149,32 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_host_size_t import_count;
   iree_vm_bytecode_import_t* import_table;
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+  // Number of block counters in each table, indexed by the module bytecode
+  // offset of the block shifted by IREE_VM_BYTECODE_BLOCK_COUNTER_SHIFT.
+  // Function entry counts are the counts of their entry blocks.
+  iree_host_size_t block_counter_count;
+  // Process-unique non-zero ID keying thread-local caches of the tables.
+  uint64_t block_counter_state_id;
+  // Guards the block counter table list. Contexts created with
+  // IREE_VM_CONTEXT_FLAG_CONCURRENT may execute on multiple threads at once
+  // and each thread records into its own table.
+  iree_slim_mutex_t block_counter_mutex;
+  iree_vm_bytecode_block_counter_table_t* block_counter_tables;
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
   // Allocator used for the state itself and any runtime allocations needed.
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+#if IREE_VM_EXECUTION_COUNTERS_ENABLE
+// Returns the block counts of the calling thread in |state|, allocating the
+// thread table on first use. Lookups of recently used states hit a
+// thread-local cache and take no locks.
+iree_status_t iree_vm_bytecode_module_state_thread_block_counts(
+    iree_vm_bytecode_module_state_t* state, iree_atomic_int64_t** out_counts);
+#endif  // IREE_VM_EXECUTION_COUNTERS_ENABLE
+
 // Begins execution of the current frame and continues until either a yield or
 // return.
 iree_status_t iree_vm_bytecode_dispatch_begin(
@@ -0,0 +1,187 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures module startup latency and resident memory growth when loading a
+// module with a large constant from a file by either preloading the file into
+// memory or mapping it.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/io/file_handle.h"
+#include "iree/testing/benchmark.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode/module.h"
+#include "iree/vm/bytecode/module_load_benchmark_module_c.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <unistd.h>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+namespace {
+
+static char module_path_[512] = {0};
+
+static void DeleteModuleFile() { remove(module_path_); }
+
+// Writes the embedded module to a temporary file on first use and returns its
+// path.
+static const char* GetModulePath() {
+  if (module_path_[0]) return module_path_;
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TMPDIR");
+  if (!tmpdir) tmpdir = "/tmp";
+  snprintf(module_path_, sizeof(module_path_),
+           "%s/iree_module_load_benchmark_%" PRIu64 ".vmfb", tmpdir,
+           (uint64_t)iree_time_now());
+  const auto* module_file_toc =
+      iree_vm_bytecode_module_load_benchmark_module_create();
+  IREE_CHECK_OK(iree_file_write_contents(
+      module_path_,
+      iree_make_const_byte_span(module_file_toc->data, module_file_toc->size)));
+  atexit(DeleteModuleFile);
+  return module_path_;
+}
+
+// Returns the resident set size of the process in bytes or 0 if unavailable.
+static int64_t QueryResidentBytes() {
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (!file) return 0;
+  long total_pages = 0;
+  long resident_pages = 0;
+  int count = fscanf(file, "%ld %ld", &total_pages, &resident_pages);
+  fclose(file);
+  return count == 2 ? (int64_t)resident_pages * sysconf(_SC_PAGESIZE) : 0;
+#else
+  return 0;
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+}
+
+static iree_status_t PreloadModule(iree_vm_instance_t* instance,
+                                   iree_allocator_t host_allocator,
+                                   iree_vm_module_t** out_module) {
+  iree_file_contents_t* file_contents = NULL;
+  IREE_RETURN_IF_ERROR(iree_file_read_contents(GetModulePath(),
+                                               IREE_FILE_READ_FLAG_PRELOAD,
+                                               host_allocator, &file_contents));
+  iree_status_t status = iree_vm_bytecode_module_create(
+      instance, file_contents->const_buffer,
+      iree_file_contents_deallocator(file_contents), host_allocator,
+      out_module);
+  if (!iree_status_is_ok(status)) iree_file_contents_free(file_contents);
+  return status;
+}
+
+static iree_status_t MapModule(iree_vm_instance_t* instance,
+                               iree_allocator_t host_allocator,
+                               iree_vm_module_t** out_module) {
+  iree_io_file_handle_t* file_handle = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_io_file_handle_open(IREE_IO_FILE_MODE_READ,
+                               iree_make_cstring_view(GetModulePath()),
+                               host_allocator, &file_handle));
+  iree_io_file_mapping_t* mapping = NULL;
+  iree_status_t status = iree_io_file_map_view(
+      file_handle, IREE_IO_FILE_ACCESS_READ, 0, IREE_HOST_SIZE_MAX,
+      IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS, host_allocator, &mapping);
+  iree_io_file_handle_release(file_handle);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_bytecode_module_create(
+        instance, iree_io_file_mapping_contents_ro(mapping),
+        iree_io_file_mapping_deallocator(mapping), host_allocator, out_module);
+  }
+  if (!iree_status_is_ok(status)) iree_io_file_mapping_release(mapping);
+  return status;
+}
+
+// Calls the function reading the first byte of the large constant.
+static iree_status_t InvokeFirstWeight(iree_vm_instance_t* instance,
+                                       iree_vm_module_t* module,
+                                       iree_allocator_t host_allocator) {
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, /*module_count=*/1, &module,
+      host_allocator, &context));
+  iree_vm_function_t function;
+  iree_status_t status = iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("first_weight"),
+      &function);
+  iree_vm_list_t* outputs = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                 host_allocator, &outputs);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                            /*policy=*/NULL, /*inputs=*/NULL, outputs,
+                            host_allocator);
+  }
+  iree_vm_list_release(outputs);
+  iree_vm_context_release(context);
+  return status;
+}
+
+typedef iree_status_t (*LoadModuleFn)(iree_vm_instance_t* instance,
+                                      iree_allocator_t host_allocator,
+                                      iree_vm_module_t** out_module);
+
+// Loads the module (and optionally reads the constant) each iteration and
+// reports the resident memory growth observed while the module was loaded.
+static iree_status_t RunModuleLoad(iree_benchmark_state_t* benchmark_state,
+                                   LoadModuleFn load_module, bool invoke) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        host_allocator, &instance));
+  GetModulePath();  // write the file outside of the timed region
+
+  int64_t max_resident_delta = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    int64_t resident_bytes = QueryResidentBytes();
+    iree_vm_module_t* module = NULL;
+    IREE_CHECK_OK(load_module(instance, host_allocator, &module));
+    if (invoke) {
+      IREE_CHECK_OK(InvokeFirstWeight(instance, module, host_allocator));
+    }
+    max_resident_delta = iree_max(max_resident_delta,
+                                  QueryResidentBytes() - resident_bytes);
+    iree_vm_module_release(module);
+  }
+
+  char label[64];
+  snprintf(label, sizeof(label), "max_rss_delta=%" PRId64 "KB",
+           max_resident_delta / 1024);
+  iree_benchmark_set_label(benchmark_state, label);
+
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+
+IREE_BENCHMARK_FN(BM_ModuleLoadPreload) {
+  return RunModuleLoad(benchmark_state, PreloadModule, /*invoke=*/false);
+}
+IREE_BENCHMARK_REGISTER(BM_ModuleLoadPreload);
+
+IREE_BENCHMARK_FN(BM_ModuleLoadMapped) {
+  return RunModuleLoad(benchmark_state, MapModule, /*invoke=*/false);
+}
+IREE_BENCHMARK_REGISTER(BM_ModuleLoadMapped);
+
+IREE_BENCHMARK_FN(BM_ModuleLoadPreloadFirstAccess) {
+  return RunModuleLoad(benchmark_state, PreloadModule, /*invoke=*/true);
+}
+IREE_BENCHMARK_REGISTER(BM_ModuleLoadPreloadFirstAccess);
+
+IREE_BENCHMARK_FN(BM_ModuleLoadMappedFirstAccess) {
+  return RunModuleLoad(benchmark_state, MapModule, /*invoke=*/true);
+}
+IREE_BENCHMARK_REGISTER(BM_ModuleLoadMappedFirstAccess);
+
+}  // namespace
@@ -0,0 +1,13 @@
+vm.module @bytecode_module_load_benchmark {
+  // Large constant stored in the module archive. Loading the module should not
+  // require its pages to be resident.
+  vm.rodata private @weights dense<1> : tensor<8388608xi8>
+
+  vm.export @first_weight
+  vm.func @first_weight() -> i32 {
+    %weights = vm.const.ref.rodata @weights : !vm.buffer
+    %c0 = vm.const.i64 0
+    %v = vm.buffer.load.i8.u %weights[%c0] : !vm.buffer -> i32
+    vm.return %v : i32
+  }
+}
@@ -11,6 +11,7 @@
 #include "iree/vm/bytecode/module.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -107,15 +108,18 @@ using iree::testing::status::StatusIs;
 using iree::vm::ref;
 using testing::Eq;
 
-class VMBytecodeModuleTest : public ::testing::Test {
+// Parameterized on the module creation flags so that all functions are tested
+// both with eager and lazy verification.
+class VMBytecodeModuleTest
+    : public ::testing::TestWithParam<iree_vm_bytecode_module_flags_t> {
  protected:
   virtual void SetUp() {
     IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                           iree_allocator_system(), &instance_));
 
     const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
-    IREE_CHECK_OK(iree_vm_bytecode_module_create(
-        instance_,
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_flags(
+        instance_, GetParam(),
         iree_const_byte_span_t{
             reinterpret_cast<const uint8_t*>(module_file_toc->data),
             static_cast<iree_host_size_t>(module_file_toc->size)},
@@ -208,24 +212,104 @@ class VMBytecodeModuleTest : public ::testing::Test {
   iree_vm_module_t* bytecode_module_ = nullptr;
 };
 
-TEST_F(VMBytecodeModuleTest, FuncIOEmpty) {
+TEST_P(VMBytecodeModuleTest, FuncIOEmpty) {
   EXPECT_THAT(RunFunction("FuncIOEmpty", std::vector<iree_vm_value_t>()),
               IsOkAndHolds(Eq(std::vector<iree_vm_value_t>())));
 }
 
-TEST_F(VMBytecodeModuleTest, FuncIO1) {
+TEST_P(VMBytecodeModuleTest, FuncIO1) {
   EXPECT_THAT(RunFunction("FuncIO1", MakeValuesList({1})),
               IsOkAndHolds(Eq(MakeValuesList({1}))));
 }
 
-TEST_F(VMBytecodeModuleTest, FuncIO8) {
+TEST_P(VMBytecodeModuleTest, FuncIO8) {
   EXPECT_THAT(RunFunction("FuncIO8", MakeValueRangeList(0, 7)),
               IsOkAndHolds(Eq(MakeValueRangeList(7, 0))));
 }
 
-TEST_F(VMBytecodeModuleTest, FuncIO600) {
+TEST_P(VMBytecodeModuleTest, FuncIO600) {
   EXPECT_THAT(RunFunction("FuncIO600", MakeNullRefList(600)),
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+TEST_P(VMBytecodeModuleTest, FuncLoop) {
+  EXPECT_THAT(RunFunction("FuncLoop", MakeValuesList({4})),
+              IsOkAndHolds(Eq(MakeValuesList({4}))));
+}
+
+TEST_P(VMBytecodeModuleTest, Disassembly) {
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_ASSERT_OK(iree_vm_bytecode_module_append_disassembly(
+      bytecode_module_, iree_string_view_empty(), &builder));
+  std::string disassembly(iree_string_builder_buffer(&builder),
+                          iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+  EXPECT_NE(disassembly.find("module @bytecode_module_test"),
+            std::string::npos);
+  EXPECT_NE(disassembly.find("func "), std::string::npos);
+  EXPECT_NE(disassembly.find("vm.return"), std::string::npos);
+  EXPECT_EQ(disassembly.find("// count:"), std::string::npos);
+}
+
+TEST_P(VMBytecodeModuleTest, Counters) {
+  for (int i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK(RunFunction("FuncIO1", MakeValuesList({i})).status());
+  }
+  // Blocks entered by branches must be counted as well as entry blocks: each
+  // FuncLoop(4) call enters the loop header 5 times and the body 4 times.
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(RunFunction("FuncLoop", MakeValuesList({4})).status());
+  }
+
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_ASSERT_OK(iree_vm_context_resolve_module_state(
+      context_, bytecode_module_, &module_state));
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  iree_status_t status = iree_vm_bytecode_module_append_counters(
+      bytecode_module_, module_state, &builder);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_free(status);
+    iree_string_builder_deinitialize(&builder);
+    GTEST_SKIP() << "execution counters not enabled";
+  }
+  IREE_ASSERT_OK(status);
+  std::string counters(iree_string_builder_buffer(&builder),
+                       iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+  EXPECT_NE(counters.find("module bytecode_module_test\n"), std::string::npos);
+  // Function names are only available with debug information so only the
+  // entry count is checked.
+  EXPECT_NE(counters.find("\nfunction "), std::string::npos);
+  EXPECT_NE(counters.find(" 3 "), std::string::npos);
+  EXPECT_NE(counters.find(" 10\n"), std::string::npos);  // loop header
+  EXPECT_NE(counters.find(" 8\n"), std::string::npos);   // loop body
+
+  // Counts from multiple dumps are summed when annotating the disassembly.
+  std::string merged_counters = counters + counters;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_ASSERT_OK(iree_vm_bytecode_module_append_disassembly(
+      bytecode_module_,
+      iree_make_string_view(merged_counters.data(), merged_counters.size()),
+      &builder));
+  std::string disassembly(iree_string_builder_buffer(&builder),
+                          iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+  EXPECT_NE(disassembly.find("entries: 6"), std::string::npos);
+  EXPECT_NE(disassembly.find("// count: 6"), std::string::npos);
+  EXPECT_NE(disassembly.find("// count: 20"), std::string::npos);
+  EXPECT_NE(disassembly.find("// count: 16"), std::string::npos);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    VMBytecodeModuleTests, VMBytecodeModuleTest,
+    ::testing::Values(IREE_VM_BYTECODE_MODULE_FLAG_NONE,
+                      IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION),
+    [](const ::testing::TestParamInfo<iree_vm_bytecode_module_flags_t>& info) {
+      return info.param & IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION
+                 ? "lazy_verification"
+                 : "eager_verification";
+    });
+
 }  // namespace
@@ -11,6 +11,23 @@ vm.module @bytecode_module_test {
     vm.return %0 : i32
   }
 
+  // Tests a loop: the loop header and body blocks are entered via branches.
+  // Returns the number of iterations taken to count %n down to zero.
+  vm.export @FuncLoop
+  vm.func @FuncLoop(%n: i32) -> i32 {
+    %c0 = vm.const.i32.zero
+    %c1 = vm.const.i32 1
+    vm.br ^loop(%n, %c0 : i32, i32)
+  ^loop(%i : i32, %count : i32):
+    vm.cond_br %i, ^body, ^exit(%count : i32)
+  ^body:
+    %next_i = vm.sub.i32 %i, %c1 : i32
+    %next_count = vm.add.i32 %count, %c1 : i32
+    vm.br ^loop(%next_i, %next_count : i32, i32)
+  ^exit(%result : i32):
+    vm.return %result : i32
+  }
+
   // Tests a reasonable set of arguments and results.
   vm.export @FuncIO8
   vm.func @FuncIO8(%0: i32, %1: i32, %2: i32, %3: i32, %4: i32, %5: i32, %6: i32, %7: i32) -> (i32, i32, i32, i32, i32, i32, i32, i32) {
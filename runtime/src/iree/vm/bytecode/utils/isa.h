@@ -71,6 +71,7 @@
 #define IREE_VM_PC_OFFSET_EXT_I32 2
 #define IREE_VM_PC_OFFSET_EXT_F32 2
 #define IREE_VM_PC_OFFSET_EXT_F64 2
+#define IREE_VM_PC_OFFSET_EXT_FUSED 2
 
 // Interleaved src-dst register sets for branch register remapping.
 // This structure is an overlay for the bytecode that is serialized in a
@@ -427,6 +427,30 @@ iree_status_t iree_vm_bytecode_function_verify(
   return status;
 }
 
+iree_status_t iree_vm_bytecode_function_ensure_verified(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  if (IREE_LIKELY(!iree_vm_bytecode_function_requires_verification(
+          module, function_ordinal))) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_vm_bytecode_function_verify");
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, function_ordinal);
+
+  // Multiple threads may get here for the same function and each will verify
+  // it. Verification is deterministic and has no side-effects on the module so
+  // the redundant work is harmless and this is a one-time cost.
+  iree_status_t status = iree_vm_bytecode_function_verify(
+      module, function_ordinal, module->allocator);
+  if (iree_status_is_ok(status)) {
+    iree_atomic_fetch_or(&module->verified_function_bits[function_ordinal / 32],
+                         1u << (function_ordinal % 32),
+                         iree_memory_order_release);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // Utilities matching the tablegen op encoding scheme
 //===----------------------------------------------------------------------===//
@@ -803,6 +827,28 @@ iree_status_t iree_vm_bytecode_function_verify(
     VM_VerifyResultRegF64(result);             \
   });
 
+#define VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I32(op_name) \
+  VERIFY_OP(EXT_FUSED, op_name, {                        \
+    VM_VerifyOperandRegI32(lhs);                         \
+    VM_VerifyOperandRegI32(rhs);                         \
+    VM_VerifyBranchTarget(true_dest_pc);                 \
+    VM_VerifyBranchOperands(true_operands);              \
+    VM_VerifyBranchTarget(false_dest_pc);                \
+    VM_VerifyBranchOperands(false_operands);             \
+    verify_state->in_block = 0; /* terminator */         \
+  });
+
+#define VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I64(op_name) \
+  VERIFY_OP(EXT_FUSED, op_name, {                        \
+    VM_VerifyOperandRegI64(lhs);                         \
+    VM_VerifyOperandRegI64(rhs);                         \
+    VM_VerifyBranchTarget(true_dest_pc);                 \
+    VM_VerifyBranchOperands(true_operands);              \
+    VM_VerifyBranchTarget(false_dest_pc);                \
+    VM_VerifyBranchOperands(false_operands);             \
+    verify_state->in_block = 0; /* terminator */         \
+  });
+
 //===----------------------------------------------------------------------===//
 // Call verification
 //===----------------------------------------------------------------------===//
@@ -2129,6 +2175,57 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
     UNHANDLED_VERIFY_PREFIX(PrefixExtF64, iree_vm_FeatureBits_EXT_F64);
 #endif  // IREE_VM_EXT_F64_ENABLE
 
+#if IREE_VM_EXT_FUSED_ENABLE
+    BEGIN_VERIFY_PREFIX(PrefixExtFused, iree_vm_FeatureBits_EXT_FUSED)
+
+    //===----------------------------------------------------------------===//
+    // ExtFused: Compare and branch
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I32(CmpEQI32CondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I32(CmpNEI32CondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I32(CmpLTI32SCondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I32(CmpLTI32UCondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I64(CmpEQI64CondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I64(CmpNEI64CondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I64(CmpLTI64SCondBranch);
+    VERIFY_OP_EXT_FUSED_CMP_COND_BRANCH_I64(CmpLTI64UCondBranch);
+
+    //===----------------------------------------------------------------===//
+    // ExtFused: Arithmetic with immediates
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_FUSED, AddI32Imm, {
+      VM_VerifyOperandRegI32(lhs);
+      VM_VerifyAttrI32(rhs);
+      VM_VerifyResultRegI32(result);
+    });
+    VERIFY_OP(EXT_FUSED, AddI64Imm, {
+      VM_VerifyOperandRegI64(lhs);
+      VM_VerifyAttrI64(rhs);
+      VM_VerifyResultRegI64(result);
+    });
+
+    //===----------------------------------------------------------------===//
+    // ExtFused: Buffers
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_FUSED, BufferLoadI32ExtI64S, {
+      VM_VerifyOperandRegRef(source_buffer);
+      VM_VerifyOperandRegI64HostSize(source_offset);
+      VM_VerifyResultRegI64(result);
+    });
+    VERIFY_OP(EXT_FUSED, BufferLoadI32ExtI64U, {
+      VM_VerifyOperandRegRef(source_buffer);
+      VM_VerifyOperandRegI64HostSize(source_offset);
+      VM_VerifyResultRegI64(result);
+    });
+
+    END_VERIFY_PREFIX(PrefixExtFused, iree_vm_FeatureBits_EXT_FUSED);
+#else
+    UNHANDLED_VERIFY_PREFIX(PrefixExtFused, iree_vm_FeatureBits_EXT_FUSED);
+#endif  // IREE_VM_EXT_FUSED_ENABLE
+
     default:
       return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                               "unrecognized opcode %u", bytecode_data[pc - 1]);
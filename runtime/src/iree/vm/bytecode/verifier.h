@@ -35,4 +35,14 @@ iree_status_t iree_vm_bytecode_function_verify(
     iree_vm_bytecode_module_t* module, uint16_t function_ordinal,
     iree_allocator_t scratch_allocator);
 
+// Verifies the bytecode of the given |function_ordinal| if the module was
+// created with IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION and the function
+// has not yet been verified. Successful verification is cached on the module
+// and subsequent calls are a single atomic load. Failed verification is not
+// cached and will be repeated (and fail again) on the next call.
+//
+// Thread-safe.
+iree_status_t iree_vm_bytecode_function_ensure_verified(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal);
+
 #endif  // IREE_VM_BYTECODE_VERIFIER_H_
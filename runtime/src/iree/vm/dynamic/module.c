@@ -292,3 +292,42 @@ IREE_API_EXPORT iree_status_t iree_vm_dynamic_module_load_from_file(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+IREE_API_EXPORT iree_status_t iree_vm_dynamic_module_load_from_memory(
+    iree_vm_instance_t* instance, iree_string_view_t identifier,
+    iree_const_byte_span_t library_data, iree_string_view_t export_name,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(!param_count || params);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
+
+  // Default name for the export.
+  if (iree_string_view_is_empty(export_name)) {
+    export_name = iree_make_cstring_view(IREE_VM_DYNAMIC_MODULE_EXPORT_NAME);
+  }
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, export_name.data, export_name.size);
+
+  // Load the library from memory. Depending on the platform this may be
+  // performed by staging the contents to a temporary file that is then loaded
+  // by the system loader and has all of the same failure modes.
+  iree_dynamic_library_t* handle = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_dynamic_library_load_from_memory(identifier, library_data,
+                                                IREE_DYNAMIC_LIBRARY_FLAG_NONE,
+                                                allocator, &handle));
+
+  // Create the module wrapper and then ask the library for its
+  // implementation.
+  iree_status_t status =
+      iree_vm_dynamic_module_create(instance, handle, export_name, param_count,
+                                    params, allocator, out_module);
+
+  iree_dynamic_library_release(handle);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
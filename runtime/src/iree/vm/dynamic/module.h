@@ -31,6 +31,20 @@ IREE_API_EXPORT iree_status_t iree_vm_dynamic_module_load_from_file(
     const iree_string_pair_t* params, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module from a shared library image in memory.
+// This allows natively compiled modules (such as those produced by the C/EmitC
+// target) to be shipped alongside or embedded within other artifacts like
+// bytecode module archives and loaded without recompiling the hosting
+// application. |identifier| is used as the library name in debugging and
+// profiling tools. |library_data| must remain valid for the lifetime of the
+// returned module. See iree_vm_dynamic_module_load_from_file for details on
+// the remaining arguments.
+IREE_API_EXPORT iree_status_t iree_vm_dynamic_module_load_from_memory(
+    iree_vm_instance_t* instance, iree_string_view_t identifier,
+    iree_const_byte_span_t library_data, iree_string_view_t export_name,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
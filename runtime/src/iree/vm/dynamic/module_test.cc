@@ -0,0 +1,90 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/dynamic/module.h"
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/dynamic/module_test_library_embed.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+class VMDynamicModuleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                           iree_allocator_system(),
+                                           &instance_));
+  }
+
+  void TearDown() override { iree_vm_instance_release(instance_); }
+
+  // Returns the embedded shared library image of module_test_library.
+  static iree_const_byte_span_t LibraryData() {
+    const struct iree_file_toc_t* file_toc = module_test_library_create();
+    return iree_make_const_byte_span(file_toc->data, file_toc->size);
+  }
+
+  iree_vm_instance_t* instance_ = NULL;
+};
+
+TEST_F(VMDynamicModuleTest, LoadFromMemory) {
+  iree_vm_module_t* module = NULL;
+  IREE_ASSERT_OK(iree_vm_dynamic_module_load_from_memory(
+      instance_, iree_make_cstring_view("module_test_library"), LibraryData(),
+      iree_string_view_empty(), /*param_count=*/0, /*params=*/NULL,
+      iree_allocator_system(), &module));
+  EXPECT_TRUE(iree_string_view_equal(iree_vm_module_name(module),
+                                     iree_make_cstring_view("test")));
+
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance_, IREE_VM_CONTEXT_FLAG_NONE, /*module_count=*/1, &module,
+      iree_allocator_system(), &context));
+  iree_vm_module_release(module);
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("test.times_two"), &function));
+
+  iree_vm_list_t* inputs = NULL;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_value_t arg0 = iree_vm_value_make_i32(21);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs, &arg0));
+  iree_vm_list_t* outputs = NULL;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(), &outputs));
+  IREE_ASSERT_OK(iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/NULL, inputs, outputs,
+                                iree_allocator_system()));
+  iree_vm_value_t ret0;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs, 0, &ret0));
+  EXPECT_EQ(iree_vm_value_get_i32(&ret0), 42);
+
+  iree_vm_list_release(outputs);
+  iree_vm_list_release(inputs);
+  iree_vm_context_release(context);
+}
+
+TEST_F(VMDynamicModuleTest, LoadFromMemoryMissingExport) {
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(iree_vm_dynamic_module_load_from_memory(
+                  instance_, iree_make_cstring_view("module_test_library"),
+                  LibraryData(), iree_make_cstring_view("missing_export"),
+                  /*param_count=*/0, /*params=*/NULL, iree_allocator_system(),
+                  &module)),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_EQ(module, nullptr);
+}
+
+}  // namespace
+}  // namespace iree
@@ -0,0 +1,72 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Dynamic module used by module_test exporting a single stateless function:
+//   test.times_two(i32) -> i32
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+#include "iree/vm/dynamic/api.h"
+
+typedef iree_status_t (*call_i32_i32_t)(iree_vm_stack_t* stack,
+                                        void* module_ptr, void* module_state,
+                                        int32_t arg0, int32_t* out_ret0);
+
+static iree_status_t call_shim_i32_i32(iree_vm_stack_t* stack,
+                                       iree_vm_native_function_flags_t flags,
+                                       iree_byte_span_t args_storage,
+                                       iree_byte_span_t rets_storage,
+                                       call_i32_i32_t target_fn, void* module,
+                                       void* module_state) {
+  const int32_t* args = (const int32_t*)args_storage.data;
+  int32_t* results = (int32_t*)rets_storage.data;
+  return target_fn(stack, module, module_state, args[0], &results[0]);
+}
+
+static iree_status_t test_times_two(iree_vm_stack_t* stack, void* module,
+                                    void* module_state, int32_t arg0,
+                                    int32_t* out_ret0) {
+  *out_ret0 = arg0 * 2;
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t test_exports_[] = {
+    {IREE_SVL("times_two"), IREE_SVL("0i_i"), 0, NULL},
+};
+static const iree_vm_native_function_ptr_t test_funcs_[] = {
+    {(iree_vm_native_function_shim_t)call_shim_i32_i32,
+     (iree_vm_native_function_target_t)test_times_two},
+};
+static const iree_vm_native_module_descriptor_t test_descriptor_ = {
+    /*name=*/IREE_SVL("test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(test_exports_),
+    /*exports=*/test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(test_funcs_),
+    /*functions=*/test_funcs_,
+};
+
+IREE_VM_DYNAMIC_MODULE_EXPORT iree_status_t iree_vm_dynamic_module_create(
+    iree_vm_dynamic_module_version_t max_version, iree_vm_instance_t* instance,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
+  if (max_version != IREE_VM_DYNAMIC_MODULE_VERSION_LATEST) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "unsupported runtime version %u, module compiled "
+                            "with version %u",
+                            max_version, IREE_VM_DYNAMIC_MODULE_VERSION_LATEST);
+  }
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  return iree_vm_native_module_create(&interface, &test_descriptor_, instance,
+                                      allocator, out_module);
+}
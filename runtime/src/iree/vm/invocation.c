@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/debugging.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
@@ -999,3 +1000,282 @@ static iree_status_t iree_vm_async_complete_invoke(
   iree_vm_list_t* outputs = state->outputs;
   return state->callback(state->user_data, loop, status, outputs);
 }
+
+//===----------------------------------------------------------------------===//
+// Reusable invocation
+//===----------------------------------------------------------------------===//
+
+struct iree_vm_invocation_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t allocator;
+
+  // Retains the context the function is invoked within.
+  iree_vm_context_t* context;
+  // Target function.
+  iree_vm_function_t function;
+  // Flags controlling invocation behavior.
+  iree_vm_invocation_flags_t flags;
+  // ID used for fiber tracing allocated once for all invocations.
+  iree_vm_invocation_id_t invocation_id;
+
+  // Parsed calling convention arguments string for marshaling.
+  iree_string_view_t cconv_arguments;
+  // Argument storage in the trailing allocation of the invocation.
+  iree_byte_span_t arguments;
+
+  // Input list sized to the function arguments and populated by the caller.
+  iree_vm_list_t* inputs;
+  // Output list receiving the results of each invocation.
+  iree_vm_list_t* outputs;
+
+  // Invoke state reused across invocations. The stack is initialized once over
+  // the inline stack storage and only reset between invocations so that any
+  // storage it grows into is retained. The results span points into the
+  // trailing allocation of the invocation.
+  iree_vm_invoke_state_t state;
+
+  // + trailing argument and result storage
+};
+
+static void iree_vm_invocation_destroy(iree_vm_invocation_t* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t allocator = invocation->allocator;
+  if (invocation->state.stack) {
+    iree_vm_stack_deinitialize(invocation->state.stack);
+  }
+  iree_vm_list_release(invocation->outputs);
+  iree_vm_list_release(invocation->inputs);
+  iree_vm_context_release(invocation->context);
+  iree_allocator_free(allocator, invocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    iree_allocator_t allocator, iree_vm_invocation_t** out_invocation) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_invocation);
+  *out_invocation = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Force tracing if specified on the context.
+  if (iree_vm_context_flags(context) & IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION) {
+    flags |= IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION;
+  }
+
+  // Grab function metadata used for marshaling inputs/outputs. We do this once
+  // here instead of on each invocation.
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  if (iree_vm_function_call_is_variadic_cconv(signature.calling_convention)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "reusable invocations of variadic functions are not supported");
+  }
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_get_cconv_fragments(
+              &signature, &cconv_arguments, &cconv_results));
+  iree_host_size_t argument_count = 0;
+  iree_host_size_t result_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_count_arguments_and_results(
+              &signature, &argument_count, &result_count));
+  iree_host_size_t arguments_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_compute_cconv_fragment_size(
+              cconv_arguments, /*segment_size_list=*/NULL, &arguments_size));
+  iree_host_size_t results_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_compute_cconv_fragment_size(
+              cconv_results, /*segment_size_list=*/NULL, &results_size));
+
+  // Allocate the invocation with trailing argument and result storage so that
+  // invocations don't need to allocate either.
+  iree_vm_invocation_t* invocation = NULL;
+  const iree_host_size_t arguments_offset =
+      iree_host_align(sizeof(*invocation), iree_max_align_t);
+  const iree_host_size_t results_offset =
+      arguments_offset + iree_host_align(arguments_size, iree_max_align_t);
+  const iree_host_size_t total_size = results_offset + results_size;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&invocation));
+  iree_atomic_ref_count_init(&invocation->ref_count);
+  invocation->allocator = allocator;
+  invocation->context = context;
+  iree_vm_context_retain(context);
+  invocation->function = function;
+  invocation->flags = flags;
+  invocation->cconv_arguments = cconv_arguments;
+  invocation->arguments = iree_make_byte_span(
+      (uint8_t*)invocation + arguments_offset, arguments_size);
+  invocation->state.cconv_results = cconv_results;
+  invocation->state.results =
+      iree_make_byte_span((uint8_t*)invocation + results_offset, results_size);
+  invocation->state.status = iree_ok_status();
+
+  // Create the I/O lists with enough capacity that invocations never need to
+  // grow them.
+  iree_status_t status =
+      iree_vm_list_create(iree_vm_make_undefined_type_def(), argument_count,
+                          allocator, &invocation->inputs);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_resize(invocation->inputs, argument_count);
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_vm_list_create(iree_vm_make_undefined_type_def(), result_count,
+                            allocator, &invocation->outputs);
+  }
+
+  // Initialize the stack over the inline storage. It'll grow from the
+  // allocator if needed and keep the grown storage until destroyed.
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_stack_initialize(
+        iree_make_byte_span(invocation->state.stack_storage,
+                            sizeof(invocation->state.stack_storage)),
+        flags, iree_vm_context_state_resolver(context), allocator,
+        &invocation->state.stack);
+  }
+
+  // Allocate the tracing ID once such that concurrent contexts don't allocate
+  // a new one per invocation.
+  IREE_TRACE({
+    invocation->invocation_id =
+        iree_any_bit_set(flags, IREE_VM_INVOCATION_FLAG_TRACE_INLINE)
+            ? 0
+            : iree_vm_invoke_allocate_id(context, &function);
+  });
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    iree_vm_invocation_destroy(invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation) {
+  if (invocation) {
+    iree_atomic_ref_count_inc(&invocation->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation) {
+  if (invocation && iree_atomic_ref_count_dec(&invocation->ref_count) == 1) {
+    iree_vm_invocation_destroy(invocation);
+  }
+}
+
+IREE_API_EXPORT iree_vm_list_t* iree_vm_invocation_inputs(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  return invocation->inputs;
+}
+
+IREE_API_EXPORT iree_vm_list_t* iree_vm_invocation_outputs(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  return invocation->outputs;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_invoke(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_invoke_state_t* state = &invocation->state;
+  iree_vm_invocation_id_t invocation_id = invocation->invocation_id;
+  (void)invocation_id;  // unused when tracing is disabled
+
+  // Marshal the inputs into the retained argument storage. This is the same as
+  // iree_vm_begin_invoke but without needing to recompute the storage sizes.
+  memset(invocation->arguments.data, 0, invocation->arguments.data_length);
+  memset(state->results.data, 0, state->results.data_length);
+  iree_status_t status = iree_vm_invoke_marshal_inputs(
+      invocation->cconv_arguments, invocation->inputs, invocation->arguments);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_invoke_release_io_refs(invocation->cconv_arguments,
+                                   invocation->arguments);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Begin a zone outside the fiber to represent one tick of the loop.
+  IREE_TRACE_ZONE_BEGIN_NAMED(zi, "iree_vm_invoke_tick");
+  // Enter the fiber to start attributing zones to the invocation.
+  IREE_TRACE(iree_vm_invoke_fiber_enter(invocation_id));
+
+  // Execute the target function on the retained stack. As with iree_vm_invoke
+  // we synchronously perform any waits it yields on until it completes.
+  iree_vm_function_call_t call = {
+      .function = invocation->function,
+      .arguments = invocation->arguments,
+      .results = state->results,
+  };
+  state->status = invocation->function.module->begin_call(
+      invocation->function.module->self, state->stack, call);
+  iree_vm_invoke_release_io_refs(invocation->cconv_arguments,
+                                 invocation->arguments);
+  status = iree_status_is_deferred(state->status)
+               ? iree_status_from_code(IREE_STATUS_DEFERRED)
+               : iree_ok_status();
+  while (iree_status_is_deferred(status)) {
+    iree_vm_stack_frame_t* current_frame =
+        iree_vm_stack_current_frame(state->stack);
+    if (IREE_UNLIKELY(!current_frame)) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "unbalanced stack after yield");
+      break;
+    } else if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+      IREE_TRACE(iree_vm_invoke_fiber_leave(invocation_id, state->stack));
+      IREE_TRACE_ZONE_END(zi);
+      iree_vm_wait_frame_t* wait_frame =
+          (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame);
+      status =
+          iree_vm_wait_invoke(state, wait_frame, IREE_TIME_INFINITE_FUTURE);
+      IREE_TRACE_ZONE_BEGIN_NAMED(zi_next, "iree_vm_invoke_tick");
+      zi = zi_next;
+      IREE_TRACE(iree_vm_invoke_fiber_reenter(invocation_id, state->stack));
+      if (!iree_status_is_ok(status)) break;
+    }
+    status = iree_vm_resume_invoke(state);
+  }
+
+  // Leave the fiber and drop any trace zones of frames still on the stack (if
+  // the invocation failed) before we reset it below.
+  iree_vm_stack_suspend_trace_zones(state->stack);
+  IREE_TRACE(iree_vm_invoke_fiber_leave(invocation_id, NULL));
+  IREE_TRACE_ZONE_END(zi);
+
+  // Take the result of the invocation and marshal the outputs if it succeeded.
+  // Unlike iree_vm_end_invoke failures to invoke are treated the same as
+  // failures in the invocation as in both cases the state is reset below.
+  if (iree_status_is_ok(status)) {
+    status = state->status;
+    state->status = iree_ok_status();
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invoke_marshal_outputs(
+          state->cconv_results, state->results, invocation->outputs);
+    } else {
+      status =
+          IREE_VM_STACK_ANNOTATE_BACKTRACE_IF_ENABLED(state->stack, status);
+    }
+  } else {
+    iree_status_free(state->status);
+    state->status = iree_ok_status();
+  }
+
+  // Reset the stack and results for reuse by the next invocation. Any storage
+  // the stack grew into is retained.
+  iree_vm_stack_reset(state->stack);
+  iree_vm_invoke_release_io_refs(state->cconv_results, state->results);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
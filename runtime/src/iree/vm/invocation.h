@@ -291,55 +291,70 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
     iree_vm_async_invoke_callback_fn_t callback, void* user_data);
 
 //===----------------------------------------------------------------------===//
-// Asynchronous stateful invocation
+// Reusable invocation
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): document and implement.
+// Creates a reusable invocation of |function| in |context|.
+//
+// The invocation owns the VM stack, argument/result marshaling storage, and
+// input/output lists used to call the function and reuses them across each
+// iree_vm_invocation_invoke. This is intended for hosts making many calls to
+// the same function (such as servers handling requests at a high rate) where
+// the per-call setup performed by iree_vm_invoke and the allocation of
+// transient I/O lists would otherwise dominate. Once the stack has grown to the
+// size required by the function invocations perform no allocations beyond
+// those made by the function itself.
+//
+// Thread-compatible: an invocation may be invoked from any thread but not
+// concurrently. Hosts issuing calls from multiple threads should create one
+// invocation per thread (and a context with IREE_VM_CONTEXT_FLAG_CONCURRENT).
+//
+// Usage:
+//  iree_vm_invocation_t* invocation = NULL;
+//  iree_vm_invocation_create(context, function, ..., &invocation);
+//  iree_vm_list_t* inputs = iree_vm_invocation_inputs(invocation);
+//  for (each request) {
+//    iree_vm_list_set_value(inputs, 0, &request_value);
+//    iree_vm_invocation_invoke(invocation);
+//    consume(iree_vm_invocation_outputs(invocation));
+//  }
+//  iree_vm_invocation_release(invocation);
 IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    const iree_vm_list_t* inputs, iree_allocator_t allocator,
-    iree_vm_invocation_t** out_invocation);
+    iree_allocator_t allocator, iree_vm_invocation_t** out_invocation);
 
 // Retains the given |invocation| for the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_retain(iree_vm_invocation_t* invocation);
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation);
 
 // Releases the given |invocation| from the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_release(iree_vm_invocation_t* invocation);
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation);
 
-// Queries the completion status of the invocation.
-// Returns one of the following:
-//   IREE_STATUS_OK: the invocation completed successfully.
-//   IREE_STATUS_DEFERRED: the invocation has not yet completed.
-//   IREE_STATUS_CANCELLED: the invocation was cancelled by the user.
-//   IREE_STATUS_ABORTED: the invocation was aborted by the executor.
-//   IREE_STATUS_*: an error occurred during invocation.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_query_status(iree_vm_invocation_t* invocation);
+// Returns the list used to pass arguments to the function.
+// The list is sized to the number of function arguments and callers should set
+// the values for each invocation with iree_vm_list_set_* by index. Values
+// remain in the list (and refs remain retained) across invocations until
+// overwritten.
+IREE_API_EXPORT iree_vm_list_t* iree_vm_invocation_inputs(
+    iree_vm_invocation_t* invocation);
 
-// Returns a reference to the outputs of the invocation.
-// The returned structure is valid for the lifetime of the invocation and
-// callers must retain any refs they want to outlive the invocation once
-// released.
-//
-// Returns NULL if the invocation has not yet completed or if it failed.
-IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
+// Returns the list receiving the results of the last successful invocation.
+// The list is valid for the lifetime of the invocation and its contents are
+// replaced by each invocation; callers must retain any refs they want to
+// outlive the next invocation.
+IREE_API_EXPORT iree_vm_list_t* iree_vm_invocation_outputs(
     iree_vm_invocation_t* invocation);
 
-// Blocks the caller until the invocation completes (successfully or otherwise).
+// Synchronously invokes the function with the current contents of the
+// invocation inputs and stores the results in the invocation outputs.
+// The function will be run to completion and may block on external resources.
 //
-// Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses before the
-// invocation completes and otherwise returns iree_vm_invocation_query_status.
-IREE_API_EXPORT iree_status_t iree_vm_invocation_await(
-    iree_vm_invocation_t* invocation, iree_time_t deadline);
-
-// Attempts to cancel the invocation if it is in-flight.
-// Cancellation is not guaranteed to work and should be considered a hint.
-// A no-op if the invocation has already completed.
-IREE_API_EXPORT void iree_vm_invocation_cancel(
-    iree_vm_invocation_t* invocation);
+// Returns the status of the invocation as with iree_vm_invoke. Failures leave
+// the invocation in a reusable state.
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_invoke(iree_vm_invocation_t* invocation);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -784,6 +784,149 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+// Verifies that [i, i + count) is within the current size of |list|.
+static iree_status_t iree_vm_list_verify_range(const iree_vm_list_t* list,
+                                               iree_host_size_t i,
+                                               iree_host_size_t count) {
+  if (IREE_UNLIKELY(count > list->count || i > list->count - count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%" PRIhsz ", %" PRIhsz
+                            ") out of bounds (%" PRIhsz ")",
+                            i, i + count, list->count);
+  }
+  return iree_ok_status();
+}
+
+// Verifies that |value_type| is a primitive type and that |byte_length| is
+// large enough to contain |count| packed elements of it.
+static iree_status_t iree_vm_list_verify_packed_values(
+    iree_vm_value_type_t value_type, iree_host_size_t count,
+    iree_host_size_t byte_length, iree_host_size_t* out_element_size) {
+  iree_host_size_t element_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+  if (IREE_UNLIKELY(value_type == IREE_VM_VALUE_TYPE_NONE ||
+                    element_size == 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "value type %d is not a primitive type",
+                            (int)value_type);
+  }
+  if (IREE_UNLIKELY(count > byte_length / element_size)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "%" PRIhsz " values of %" PRIhsz
+                            " bytes each do not fit in %" PRIhsz " bytes",
+                            count, element_size, byte_length);
+  }
+  *out_element_size = element_size;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, iree_byte_span_t out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  iree_host_size_t element_size = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_packed_values(
+      value_type, count, out_values.data_length, &element_size));
+
+  // Primitive lists are either copied directly when the types match or
+  // converted element by element. Since all value types start at the same
+  // address in the value storage union we can copy the leading bytes in/out.
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE) {
+    const uint8_t* element_ptr =
+        (const uint8_t*)list->storage + i * list->element_size;
+    iree_vm_value_type_t element_type =
+        iree_vm_type_def_as_value(list->element_type);
+    if (element_type == value_type) {
+      memcpy(out_values.data, element_ptr, count * element_size);
+      return iree_ok_status();
+    }
+    for (iree_host_size_t j = 0; j < count; ++j) {
+      iree_vm_value_t value;
+      value.type = element_type;
+      value.i64 = 0;
+      memcpy(value.value_storage, element_ptr + j * list->element_size,
+             list->element_size);
+      iree_vm_value_t converted_value;
+      iree_vm_list_convert_value_type(&value, value_type, &converted_value);
+      memcpy(out_values.data + j * element_size,
+             converted_value.value_storage, element_size);
+    }
+    return iree_ok_status();
+  }
+
+  // Variant lists must check and convert each element.
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value_as(list, i + j, value_type, &value));
+    memcpy(out_values.data + j * element_size, value.value_storage,
+           element_size);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, iree_const_byte_span_t values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  iree_host_size_t element_size = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_packed_values(
+      value_type, count, values.data_length, &element_size));
+
+  // Primitive lists are either copied directly when the types match or
+  // converted element by element.
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE) {
+    uint8_t* element_ptr = (uint8_t*)list->storage + i * list->element_size;
+    iree_vm_value_type_t element_type =
+        iree_vm_type_def_as_value(list->element_type);
+    if (element_type == value_type) {
+      memcpy(element_ptr, values.data, count * element_size);
+      return iree_ok_status();
+    }
+    for (iree_host_size_t j = 0; j < count; ++j) {
+      iree_vm_value_t value;
+      value.type = value_type;
+      value.i64 = 0;
+      memcpy(value.value_storage, values.data + j * element_size,
+             element_size);
+      iree_vm_value_t converted_value;
+      iree_vm_list_convert_value_type(&value, element_type, &converted_value);
+      memcpy(element_ptr + j * list->element_size,
+             converted_value.value_storage, list->element_size);
+    }
+    return iree_ok_status();
+  }
+
+  // Variant lists store each value with its own type.
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    value.type = value_type;
+    value.i64 = 0;
+    memcpy(value.value_storage, values.data + j * element_size, element_size);
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, i + j, &value));
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_vm_value_type_t value_type,
+    iree_byte_span_t* out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(out_values);
+  *out_values = iree_byte_span_empty();
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE ||
+      iree_vm_type_def_as_value(list->element_type) != value_type) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "only primitive lists of the requested value type can be mapped");
+  }
+  *out_values =
+      iree_make_byte_span(list->storage, list->count * list->element_size);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
                                                  iree_host_size_t i,
                                                  iree_vm_ref_type_t type) {
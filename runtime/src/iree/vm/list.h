@@ -157,6 +157,34 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Copies |count| values starting at index |i| into |out_values| as a packed
+// array of |value_type| elements. |out_values| must have capacity for at least
+// |count| elements. Primitive lists of the same |value_type| are copied
+// directly while other primitive types are converted using the value type
+// semantics (such as sign/zero extend, etc). Variant lists are supported but
+// require each element to be a value and are copied element by element.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, iree_byte_span_t out_values);
+
+// Sets |count| values starting at index |i| from |values| containing a packed
+// array of |value_type| elements. The range must be within the current list
+// size; use iree_vm_list_resize to extend the list prior to setting values.
+// If |value_type| differs from the list storage type the values will be
+// converted using the value type semantics (such as sign/zero extend, etc).
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, iree_const_byte_span_t values);
+
+// Returns a view of the primitive element storage of |list| in |out_values|.
+// The list must store primitive elements of exactly |value_type| and the view
+// will contain the current list size worth of packed elements that may be
+// read and written in-place. The view is invalidated when the list is resized,
+// reserved, has its storage swapped, or is released.
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_vm_value_type_t value_type,
+    iree_byte_span_t* out_values);
+
 // Returns a dereferenced pointer to the given type if the element at the
 // given index |i| matches the |type|. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
@@ -0,0 +1,153 @@
+// Copyright 2025 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/benchmark.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/list.h"
+#include "iree/vm/value.h"
+
+namespace {
+
+// Number of elements transferred per iteration. This approximates the token
+// and logit lists exchanged with hosts during tokenization and sampling.
+static constexpr iree_host_size_t kElementCount = 4096;
+
+// Creates an instance with the builtin types registered and an i32 list sized
+// to |kElementCount| elements.
+static void CreateI32List(iree_vm_instance_t** out_instance,
+                          iree_vm_list_t** out_list) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  iree_vm_list_t* list = NULL;
+  IREE_CHECK_OK(
+      iree_vm_list_create(iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32),
+                          kElementCount, iree_allocator_system(), &list));
+  IREE_CHECK_OK(iree_vm_list_resize(list, kElementCount));
+  *out_instance = instance;
+  *out_list = list;
+}
+
+// Sets each element with iree_vm_list_set_value as most hosts do today.
+IREE_BENCHMARK_FN(BM_ListSetValueI32) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_list_t* list = NULL;
+  CreateI32List(&instance, &list);
+  std::vector<int32_t> values(kElementCount, 1);
+  while (iree_benchmark_keep_running(benchmark_state, kElementCount)) {
+    for (iree_host_size_t i = 0; i < kElementCount; ++i) {
+      iree_vm_value_t value = iree_vm_value_make_i32(values[i]);
+      IREE_CHECK_OK(iree_vm_list_set_value(list, i, &value));
+    }
+    iree_optimization_barrier(list);
+  }
+  iree_vm_list_release(list);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ListSetValueI32);
+
+// Sets all elements with a single iree_vm_list_set_values call.
+IREE_BENCHMARK_FN(BM_ListSetValuesI32) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_list_t* list = NULL;
+  CreateI32List(&instance, &list);
+  std::vector<int32_t> values(kElementCount, 1);
+  while (iree_benchmark_keep_running(benchmark_state, kElementCount)) {
+    IREE_CHECK_OK(iree_vm_list_set_values(
+        list, 0, kElementCount, IREE_VM_VALUE_TYPE_I32,
+        iree_make_const_byte_span(values.data(),
+                                  values.size() * sizeof(int32_t))));
+    iree_optimization_barrier(list);
+  }
+  iree_vm_list_release(list);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ListSetValuesI32);
+
+// Sets all elements while converting from i64 to the i32 storage type.
+IREE_BENCHMARK_FN(BM_ListSetValuesI64ToI32) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_list_t* list = NULL;
+  CreateI32List(&instance, &list);
+  std::vector<int64_t> values(kElementCount, 1);
+  while (iree_benchmark_keep_running(benchmark_state, kElementCount)) {
+    IREE_CHECK_OK(iree_vm_list_set_values(
+        list, 0, kElementCount, IREE_VM_VALUE_TYPE_I64,
+        iree_make_const_byte_span(values.data(),
+                                  values.size() * sizeof(int64_t))));
+    iree_optimization_barrier(list);
+  }
+  iree_vm_list_release(list);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ListSetValuesI64ToI32);
+
+// Gets each element with iree_vm_list_get_value as most hosts do today.
+IREE_BENCHMARK_FN(BM_ListGetValueI32) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_list_t* list = NULL;
+  CreateI32List(&instance, &list);
+  std::vector<int32_t> values(kElementCount);
+  while (iree_benchmark_keep_running(benchmark_state, kElementCount)) {
+    for (iree_host_size_t i = 0; i < kElementCount; ++i) {
+      iree_vm_value_t value;
+      IREE_CHECK_OK(iree_vm_list_get_value(list, i, &value));
+      values[i] = value.i32;
+    }
+    iree_optimization_barrier(values.data());
+  }
+  iree_vm_list_release(list);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ListGetValueI32);
+
+// Gets all elements with a single iree_vm_list_get_values call.
+IREE_BENCHMARK_FN(BM_ListGetValuesI32) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_list_t* list = NULL;
+  CreateI32List(&instance, &list);
+  std::vector<int32_t> values(kElementCount);
+  while (iree_benchmark_keep_running(benchmark_state, kElementCount)) {
+    IREE_CHECK_OK(iree_vm_list_get_values(
+        list, 0, kElementCount, IREE_VM_VALUE_TYPE_I32,
+        iree_make_byte_span(values.data(), values.size() * sizeof(int32_t))));
+    iree_optimization_barrier(values.data());
+  }
+  iree_vm_list_release(list);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ListGetValuesI32);
+
+// Sums all elements in-place through the storage view without any copies.
+IREE_BENCHMARK_FN(BM_ListMapValuesI32) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_list_t* list = NULL;
+  CreateI32List(&instance, &list);
+  while (iree_benchmark_keep_running(benchmark_state, kElementCount)) {
+    iree_byte_span_t storage = iree_byte_span_empty();
+    IREE_CHECK_OK(
+        iree_vm_list_map_values(list, IREE_VM_VALUE_TYPE_I32, &storage));
+    const int32_t* values = reinterpret_cast<const int32_t*>(storage.data);
+    int32_t sum = 0;
+    for (iree_host_size_t i = 0; i < kElementCount; ++i) sum += values[i];
+    iree_optimization_barrier(sum);
+  }
+  iree_vm_list_release(list);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ListMapValuesI32);
+
+}  // namespace
@@ -1253,6 +1253,183 @@ TEST_F(VMListTest, PushPopRef) {
   iree_vm_list_release(list);
 }
 
+TEST_F(VMListTest, GetSetValues) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(element_type, /*initial_capacity=*/8,
+                                     iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  // Set all values at once: [0, 1, 2, 3].
+  int32_t values[4] = {0, 1, 2, 3};
+  IREE_ASSERT_OK(iree_vm_list_set_values(
+      list, 0, 4, IREE_VM_VALUE_TYPE_I32,
+      iree_make_const_byte_span(values, sizeof(values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0, 1, 2, 3})));
+
+  // Set a subrange: [0, 5, 6, 3].
+  int32_t subrange_values[2] = {5, 6};
+  IREE_ASSERT_OK(iree_vm_list_set_values(
+      list, 1, 2, IREE_VM_VALUE_TYPE_I32,
+      iree_make_const_byte_span(subrange_values, sizeof(subrange_values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0, 5, 6, 3})));
+
+  // Get a subrange.
+  int32_t out_values[4] = {-1, -1, -1, -1};
+  IREE_ASSERT_OK(iree_vm_list_get_values(
+      list, 1, 3, IREE_VM_VALUE_TYPE_I32,
+      iree_make_byte_span(out_values, sizeof(out_values))));
+  EXPECT_EQ(out_values[0], 5);
+  EXPECT_EQ(out_values[1], 6);
+  EXPECT_EQ(out_values[2], 3);
+  EXPECT_EQ(out_values[3], -1);
+
+  // Empty ranges are no-ops.
+  IREE_EXPECT_OK(iree_vm_list_get_values(list, 4, 0, IREE_VM_VALUE_TYPE_I32,
+                                         iree_byte_span_empty()));
+
+  iree_vm_list_release(list);
+}
+
+// Tests that bulk operations with a different value type than the list storage
+// convert values the same way as the per-element accessors.
+TEST_F(VMListTest, GetSetValuesConvert) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(element_type, /*initial_capacity=*/4,
+                                     iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 3));
+
+  int64_t values[3] = {-1, 2, INT64_C(0x100000003)};
+  IREE_ASSERT_OK(iree_vm_list_set_values(
+      list, 0, 3, IREE_VM_VALUE_TYPE_I64,
+      iree_make_const_byte_span(values, sizeof(values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({-1, 2, 3})));
+
+  int8_t out_values[3] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values(
+      list, 0, 3, IREE_VM_VALUE_TYPE_I8,
+      iree_make_byte_span(out_values, sizeof(out_values))));
+  EXPECT_EQ(out_values[0], -1);
+  EXPECT_EQ(out_values[1], 2);
+  EXPECT_EQ(out_values[2], 3);
+
+  iree_vm_list_release(list);
+}
+
+TEST_F(VMListTest, GetSetValuesVariant) {
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                     /*initial_capacity=*/4,
+                                     iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 3));
+
+  float values[3] = {0.0f, 1.5f, 2.5f};
+  IREE_ASSERT_OK(iree_vm_list_set_values(
+      list, 0, 3, IREE_VM_VALUE_TYPE_F32,
+      iree_make_const_byte_span(values, sizeof(values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0.0f, 1.5f, 2.5f})));
+
+  float out_values[3] = {0.0f};
+  IREE_ASSERT_OK(iree_vm_list_get_values(
+      list, 0, 3, IREE_VM_VALUE_TYPE_F32,
+      iree_make_byte_span(out_values, sizeof(out_values))));
+  EXPECT_EQ(out_values[0], 0.0f);
+  EXPECT_EQ(out_values[1], 1.5f);
+  EXPECT_EQ(out_values[2], 2.5f);
+
+  // Refs cannot be read as values.
+  iree_vm_ref_t ref_a = MakeRef<A>(1.0f);
+  IREE_ASSERT_OK(iree_vm_list_set_ref_move(list, 1, &ref_a));
+  EXPECT_THAT(Status(iree_vm_list_get_values(
+                  list, 0, 3, IREE_VM_VALUE_TYPE_F32,
+                  iree_make_byte_span(out_values, sizeof(out_values)))),
+              StatusIs(StatusCode::kFailedPrecondition));
+
+  // Setting values over refs releases them.
+  IREE_ASSERT_OK(iree_vm_list_set_values(
+      list, 0, 3, IREE_VM_VALUE_TYPE_F32,
+      iree_make_const_byte_span(values, sizeof(values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0.0f, 1.5f, 2.5f})));
+
+  iree_vm_list_release(list);
+}
+
+TEST_F(VMListTest, GetSetValuesOutOfRange) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(element_type, /*initial_capacity=*/8,
+                                     iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  int32_t values[4] = {0, 1, 2, 3};
+  iree_byte_span_t values_span = iree_make_byte_span(values, sizeof(values));
+
+  // Ranges extending past the list size (but within capacity) fail.
+  EXPECT_THAT(Status(iree_vm_list_get_values(list, 1, 4, IREE_VM_VALUE_TYPE_I32,
+                                             values_span)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(
+      Status(iree_vm_list_set_values(list, 4, 1, IREE_VM_VALUE_TYPE_I32,
+                                     iree_make_const_byte_span(values, 4))),
+      StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_vm_list_get_values(list, 1, IREE_HOST_SIZE_MAX,
+                                             IREE_VM_VALUE_TYPE_I32,
+                                             values_span)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  // Packed buffers too small to hold the range fail.
+  EXPECT_THAT(Status(iree_vm_list_get_values(list, 0, 4, IREE_VM_VALUE_TYPE_I64,
+                                             values_span)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  // Non-primitive value types fail.
+  EXPECT_THAT(Status(iree_vm_list_get_values(
+                  list, 0, 4, IREE_VM_VALUE_TYPE_NONE, values_span)),
+              StatusIs(StatusCode::kInvalidArgument));
+
+  iree_vm_list_release(list);
+}
+
+TEST_F(VMListTest, MapValues) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(element_type, /*initial_capacity=*/8,
+                                     iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  // Write through the mapped storage and read back via the list.
+  iree_byte_span_t storage = iree_byte_span_empty();
+  IREE_ASSERT_OK(
+      iree_vm_list_map_values(list, IREE_VM_VALUE_TYPE_I32, &storage));
+  ASSERT_EQ(storage.data_length, 4 * sizeof(int32_t));
+  int32_t* values = reinterpret_cast<int32_t*>(storage.data);
+  for (int32_t i = 0; i < 4; ++i) values[i] = i * 10;
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0, 10, 20, 30})));
+
+  // Only the exact storage type can be mapped.
+  EXPECT_THAT(
+      Status(iree_vm_list_map_values(list, IREE_VM_VALUE_TYPE_F32, &storage)),
+      StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(storage.data, nullptr);
+
+  iree_vm_list_release(list);
+
+  // Variant lists have no packed storage to map.
+  iree_vm_list_t* variant_list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                     /*initial_capacity=*/4,
+                                     iree_allocator_system(), &variant_list));
+  EXPECT_THAT(Status(iree_vm_list_map_values(variant_list,
+                                             IREE_VM_VALUE_TYPE_I32, &storage)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  iree_vm_list_release(variant_list);
+}
+
 // TODO(benvanik): test primitive variant get/set.
 
 // TODO(benvanik): test ref variant get/set.
@@ -350,19 +350,12 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_notify(
   return iree_ok_status();
 }
 
-static iree_status_t iree_vm_native_module_issue_call(
+// Completes a call to the function at |function_ordinal| that returned
+// |status| by either preserving the stack for deferred calls or leaving the
+// callee frame.
+static iree_status_t iree_vm_native_module_complete_call(
     iree_vm_native_module_t* module, iree_vm_stack_t* stack,
-    iree_vm_stack_frame_t* callee_frame, iree_vm_native_function_flags_t flags,
-    iree_byte_span_t args_storage, iree_byte_span_t rets_storage) {
-  iree_vm_module_state_t* module_state = callee_frame->module_state;
-
-  // Call the target function using the shim.
-  const uint16_t function_ordinal = callee_frame->function.ordinal;
-  const iree_vm_native_function_ptr_t* function_ptr =
-      &module->descriptor->functions[function_ordinal];
-  iree_status_t status =
-      function_ptr->shim(stack, flags, args_storage, rets_storage,
-                         function_ptr->target, module->self, module_state);
+    uint16_t function_ordinal, iree_status_t status) {
   if (iree_status_is_deferred(status)) {
     // Call deferred; bail and return to the scheduler.
     // Note that we preserve the stack.
@@ -390,6 +383,23 @@ static iree_status_t iree_vm_native_module_issue_call(
   return iree_vm_stack_function_leave(stack);
 }
 
+static iree_status_t iree_vm_native_module_issue_call(
+    iree_vm_native_module_t* module, iree_vm_stack_t* stack,
+    iree_vm_stack_frame_t* callee_frame, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage) {
+  iree_vm_module_state_t* module_state = callee_frame->module_state;
+
+  // Call the target function using the shim.
+  const uint16_t function_ordinal = callee_frame->function.ordinal;
+  const iree_vm_native_function_ptr_t* function_ptr =
+      &module->descriptor->functions[function_ordinal];
+  iree_status_t status =
+      function_ptr->shim(stack, flags, args_storage, rets_storage,
+                         function_ptr->target, module->self, module_state);
+  return iree_vm_native_module_complete_call(module, stack, function_ordinal,
+                                             status);  // tail
+}
+
 static iree_status_t IREE_API_PTR iree_vm_native_module_begin_call(
     void* self, iree_vm_stack_t* stack, iree_vm_function_call_t call) {
   iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
@@ -553,3 +563,78 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
 
   return iree_ok_status();
 }
+
+//===----------------------------------------------------------------------===//
+// iree_vm_function_call_cache_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_vm_function_call_cache_initialize(
+    const iree_vm_function_t* function,
+    iree_vm_function_call_cache_t* out_cache) {
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(out_cache);
+  memset(out_cache, 0, sizeof(*out_cache));
+  out_cache->function = *function;
+
+  // Only exports from native modules using the default call support can be
+  // called directly. Anything else (user-provided begin_call, bytecode
+  // modules, wrapped dynamic modules, etc) routes through the module.
+  iree_vm_module_t* callee_module = function->module;
+  if (!callee_module ||
+      callee_module->begin_call != iree_vm_native_module_begin_call) {
+    return;
+  }
+  iree_vm_native_module_t* module =
+      (iree_vm_native_module_t*)callee_module->self;
+  if (module->user_interface.begin_call ||
+      (function->linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT &&
+       function->linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT_OPTIONAL) ||
+      function->ordinal >= module->descriptor->function_count) {
+    return;
+  }
+  out_cache->native_function = module->descriptor->functions[function->ordinal];
+  out_cache->native_self = module->self;
+}
+
+IREE_API_EXPORT void iree_vm_function_call_cache_reset(
+    iree_vm_function_call_cache_t* cache) {
+  IREE_ASSERT_ARGUMENT(cache);
+  iree_atomic_store(&cache->module_state, 0, iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_function_call_cache_begin_call(
+    iree_vm_function_call_cache_t* cache, iree_vm_stack_t* stack,
+    iree_byte_span_t arguments, iree_byte_span_t results) {
+  iree_vm_module_t* callee_module = cache->function.module;
+  if (!cache->native_function.shim) {
+    iree_vm_function_call_t call;
+    call.function = cache->function;
+    call.arguments = arguments;
+    call.results = results;
+    return callee_module->begin_call(callee_module->self, stack, call);
+  }
+
+  // Resolve the callee state on first use. The cache is stored in per-context
+  // state so the resolved state remains valid for the lifetime of the cache.
+  iree_vm_module_state_t* module_state = (iree_vm_module_state_t*)
+      iree_atomic_load(&cache->module_state, iree_memory_order_relaxed);
+  if (IREE_UNLIKELY(!module_state)) {
+    IREE_RETURN_IF_ERROR(iree_vm_stack_query_module_state(stack, callee_module,
+                                                          &module_state));
+    iree_atomic_store(&cache->module_state, (intptr_t)module_state,
+                      iree_memory_order_relaxed);
+  }
+
+  IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter_with_state(
+      stack, &cache->function, module_state, IREE_VM_STACK_FRAME_NATIVE,
+      /*frame_size=*/0, /*frame_cleanup_fn=*/NULL, /*out_callee_frame=*/NULL));
+  iree_status_t status = cache->native_function.shim(
+      stack, IREE_VM_NATIVE_FUNCTION_CALL_BEGIN, arguments, results,
+      cache->native_function.target, cache->native_self, module_state);
+  if (IREE_LIKELY(iree_status_is_ok(status))) {
+    return iree_vm_stack_function_leave(stack);
+  }
+  return iree_vm_native_module_complete_call(
+      (iree_vm_native_module_t*)callee_module->self, stack,
+      cache->function.ordinal, status);  // tail
+}
@@ -146,6 +146,57 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
     iree_vm_instance_t* instance, iree_allocator_t allocator,
     iree_vm_module_t* module);
 
+//===----------------------------------------------------------------------===//
+// iree_vm_function_call_cache_t
+//===----------------------------------------------------------------------===//
+
+// Cached call target for a function that is resolved once and called many
+// times, such as an import stored in a module state.
+//
+// Calls to functions exported from native modules using the default call
+// support (a function pointer table in the descriptor) bypass the generic
+// iree_vm_module_t begin_call routing and invoke the function shim directly.
+// The callee module state is resolved on the first call and reused after.
+// All other functions are called through their module begin_call as usual.
+//
+// The cached module state is specific to the context the cache is used with.
+// Caches must be stored in per-context state and must be reset with
+// iree_vm_function_call_cache_reset when the owning state is forked.
+typedef struct iree_vm_function_call_cache_t {
+  // Function being called.
+  iree_vm_function_t function;
+  // Native function pointer used for direct calls. If the shim is NULL the
+  // function is called through the generic module begin_call.
+  iree_vm_native_function_ptr_t native_function;
+  // Self pointer passed to the |native_function| shim.
+  void* native_self;
+  // Callee module state (iree_vm_module_state_t*) resolved on first call or
+  // NULL if not yet resolved. Atomic as contexts created with
+  // IREE_VM_CONTEXT_FLAG_CONCURRENT may resolve it from multiple threads at
+  // once. All threads resolve the same state which was fully initialized
+  // before the context was usable and relaxed ordering is sufficient.
+  iree_atomic_intptr_t module_state;
+} iree_vm_function_call_cache_t;
+
+// Initializes |out_cache| for calling |function|.
+IREE_API_EXPORT void iree_vm_function_call_cache_initialize(
+    const iree_vm_function_t* function,
+    iree_vm_function_call_cache_t* out_cache);
+
+// Resets any state cached from previous calls such as the callee module state.
+// Must be called when the cache is copied to a new context (such as when
+// forking).
+IREE_API_EXPORT void iree_vm_function_call_cache_reset(
+    iree_vm_function_call_cache_t* cache);
+
+// Begins a call to the cached function with the given |arguments| and
+// |results| storage in the cconv ABI format. Behaves the same as the function
+// module begin_call including support for deferred (yielding) calls that must
+// be resumed with the module resume_call.
+IREE_API_EXPORT iree_status_t iree_vm_function_call_cache_begin_call(
+    iree_vm_function_call_cache_t* cache, iree_vm_stack_t* stack,
+    iree_byte_span_t arguments, iree_byte_span_t results);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
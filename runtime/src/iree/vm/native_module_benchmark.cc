@@ -4,15 +4,200 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <array>
+
 #include "iree/base/api.h"
 #include "iree/testing/benchmark.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/list.h"
 #include "iree/vm/module.h"
 #include "iree/vm/native_module.h"
 #include "iree/vm/native_module_test.h"
 #include "iree/vm/stack.h"
+#include "iree/vm/value.h"
 
 namespace {
 
-// TODO(benvanik): native module benchmarks.
+// Creates a context with module_a and module_b from native_module_test.h and
+// resolves the module_b.entry function.
+static void CreateContext(iree_vm_instance_t** out_instance,
+                          iree_vm_context_t** out_context,
+                          iree_vm_function_t* out_function) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  iree_vm_module_t* module_a = NULL;
+  IREE_CHECK_OK(module_a_create(instance, iree_allocator_system(), &module_a));
+  iree_vm_module_t* module_b = NULL;
+  IREE_CHECK_OK(module_b_create(instance, iree_allocator_system(), &module_b));
+  std::array<iree_vm_module_t*, 2> modules = {module_a, module_b};
+  iree_vm_context_t* context = NULL;
+  IREE_CHECK_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+      iree_allocator_system(), &context));
+  iree_vm_module_release(module_a);
+  iree_vm_module_release(module_b);
+  IREE_CHECK_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_b.entry"), out_function));
+  *out_instance = instance;
+  *out_context = context;
+}
+
+// Invokes module_b.entry with new I/O lists allocated for each call as most
+// hosts do today.
+IREE_BENCHMARK_FN(BM_InvokeTransientLists) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_context_t* context = NULL;
+  iree_vm_function_t function;
+  CreateContext(&instance, &context, &function);
+
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    iree_vm_list_t* inputs = NULL;
+    IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                      iree_allocator_system(), &inputs));
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32(1);
+    IREE_CHECK_OK(iree_vm_list_push_value(inputs, &arg0_value));
+    iree_vm_list_t* outputs = NULL;
+    IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                      iree_allocator_system(), &outputs));
+    IREE_CHECK_OK(iree_vm_invoke(context, function,
+                                 IREE_VM_INVOCATION_FLAG_NONE,
+                                 /*policy=*/NULL, inputs, outputs,
+                                 iree_allocator_system()));
+    iree_optimization_barrier(outputs);
+    iree_vm_list_release(inputs);
+    iree_vm_list_release(outputs);
+  }
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_InvokeTransientLists);
+
+// Invokes module_b.entry with I/O lists reused across calls.
+IREE_BENCHMARK_FN(BM_InvokeReusedLists) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_context_t* context = NULL;
+  iree_vm_function_t function;
+  CreateContext(&instance, &context, &function);
+
+  iree_vm_list_t* inputs = NULL;
+  IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                    iree_allocator_system(), &inputs));
+  IREE_CHECK_OK(iree_vm_list_resize(inputs, 1));
+  iree_vm_list_t* outputs = NULL;
+  IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                    iree_allocator_system(), &outputs));
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32(1);
+    IREE_CHECK_OK(iree_vm_list_set_value(inputs, 0, &arg0_value));
+    IREE_CHECK_OK(iree_vm_invoke(context, function,
+                                 IREE_VM_INVOCATION_FLAG_NONE,
+                                 /*policy=*/NULL, inputs, outputs,
+                                 iree_allocator_system()));
+    iree_optimization_barrier(outputs);
+  }
+  iree_vm_list_release(inputs);
+  iree_vm_list_release(outputs);
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_InvokeReusedLists);
+
+// Invokes module_b.entry with a reusable iree_vm_invocation_t.
+IREE_BENCHMARK_FN(BM_InvocationReuse) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_context_t* context = NULL;
+  iree_vm_function_t function;
+  CreateContext(&instance, &context, &function);
+
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_CHECK_OK(iree_vm_invocation_create(
+      context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/NULL,
+      iree_allocator_system(), &invocation));
+  iree_vm_list_t* inputs = iree_vm_invocation_inputs(invocation);
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32(1);
+    IREE_CHECK_OK(iree_vm_list_set_value(inputs, 0, &arg0_value));
+    IREE_CHECK_OK(iree_vm_invocation_invoke(invocation));
+    iree_optimization_barrier(iree_vm_invocation_outputs(invocation));
+  }
+  iree_vm_invocation_release(invocation);
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_InvocationReuse);
+
+// Calls module_a.add_1 through the generic module begin_call as done for
+// imports that are not cached.
+IREE_BENCHMARK_FN(BM_ImportCallGeneric) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_context_t* context = NULL;
+  iree_vm_function_t function;
+  CreateContext(&instance, &context, &function);
+  IREE_CHECK_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_a.add_1"), &function));
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context),
+                                  iree_allocator_system());
+  int32_t arg0 = 0;
+  int32_t ret0 = 0;
+  iree_vm_function_call_t call;
+  call.function = function;
+  call.arguments = iree_make_byte_span(&arg0, sizeof(arg0));
+  call.results = iree_make_byte_span(&ret0, sizeof(ret0));
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    IREE_CHECK_OK(function.module->begin_call(function.module->self, stack,
+                                              call));
+    arg0 = ret0;
+  }
+  iree_optimization_barrier(ret0);
+  iree_vm_stack_deinitialize(stack);
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ImportCallGeneric);
+
+// Calls module_a.add_1 through an iree_vm_function_call_cache_t as done for
+// bytecode imports.
+IREE_BENCHMARK_FN(BM_ImportCallCached) {
+  iree_vm_instance_t* instance = NULL;
+  iree_vm_context_t* context = NULL;
+  iree_vm_function_t function;
+  CreateContext(&instance, &context, &function);
+  IREE_CHECK_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_a.add_1"), &function));
+  iree_vm_function_call_cache_t cache;
+  iree_vm_function_call_cache_initialize(&function, &cache);
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context),
+                                  iree_allocator_system());
+  int32_t arg0 = 0;
+  int32_t ret0 = 0;
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    IREE_CHECK_OK(iree_vm_function_call_cache_begin_call(
+        &cache, stack, iree_make_byte_span(&arg0, sizeof(arg0)),
+        iree_make_byte_span(&ret0, sizeof(ret0))));
+    arg0 = ret0;
+  }
+  iree_optimization_barrier(ret0);
+  iree_vm_stack_deinitialize(stack);
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ImportCallCached);
 
 }  // namespace
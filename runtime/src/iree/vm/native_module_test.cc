@@ -120,6 +120,36 @@ TEST_F(VMNativeModuleTest, Example) {
   iree_vm_context_release(context);
 }
 
+TEST_F(VMNativeModuleTest, ReusableInvocation) {
+  iree_vm_context_t* context = CreateContext();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_b.entry"), &function));
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_ASSERT_OK(iree_vm_invocation_create(
+      context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+      iree_allocator_system(), &invocation));
+
+  // The invocation should be reusable with new inputs each time and produce
+  // the same results as iree_vm_invoke (including module state changes).
+  const int32_t expected_values[] = {1, 4, 8};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(expected_values); ++i) {
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32((int32_t)i + 1);
+    IREE_ASSERT_OK(iree_vm_list_set_value(
+        iree_vm_invocation_inputs(invocation), 0, &arg0_value));
+    IREE_ASSERT_OK(iree_vm_invocation_invoke(invocation));
+    iree_vm_list_t* outputs = iree_vm_invocation_outputs(invocation);
+    ASSERT_EQ(iree_vm_list_size(outputs), 1);
+    iree_vm_value_t ret0_value;
+    IREE_ASSERT_OK(iree_vm_list_get_value(outputs, 0, &ret0_value));
+    EXPECT_EQ(ret0_value.i32, expected_values[i]);
+  }
+
+  iree_vm_invocation_release(invocation);
+  iree_vm_context_release(context);
+}
+
 TEST_F(VMNativeModuleTest, Fork) {
   iree_vm_context_t* parent_context = CreateContext();
 
@@ -159,5 +189,47 @@ TEST_F(VMNativeModuleTest, Fork) {
   iree_vm_context_release(child_context);
 }
 
+// Calls module_a.add_1 through a call cache directly from the host.
+TEST_F(VMNativeModuleTest, CallCache) {
+  iree_vm_context_t* context = CreateContext();
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_a.add_1"), &function));
+
+  // module_a uses the default native call support so the shim is cached.
+  iree_vm_function_call_cache_t cache;
+  iree_vm_function_call_cache_initialize(&function, &cache);
+  EXPECT_NE(cache.native_function.shim, nullptr);
+  EXPECT_EQ(iree_atomic_load(&cache.module_state, iree_memory_order_relaxed),
+            0);
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context),
+                                  iree_allocator_system());
+  for (int32_t i = 0; i < 3; ++i) {
+    int32_t arg0 = i;
+    int32_t ret0 = -1;
+    IREE_ASSERT_OK(iree_vm_function_call_cache_begin_call(
+        &cache, stack, iree_make_byte_span(&arg0, sizeof(arg0)),
+        iree_make_byte_span(&ret0, sizeof(ret0))));
+    EXPECT_EQ(ret0, i + 1);
+    EXPECT_EQ(iree_vm_stack_current_frame(stack), nullptr);
+  }
+
+  // Resetting drops the resolved state and the next call re-resolves it.
+  iree_vm_function_call_cache_reset(&cache);
+  EXPECT_EQ(iree_atomic_load(&cache.module_state, iree_memory_order_relaxed),
+            0);
+  int32_t arg0 = 10;
+  int32_t ret0 = -1;
+  IREE_ASSERT_OK(iree_vm_function_call_cache_begin_call(
+      &cache, stack, iree_make_byte_span(&arg0, sizeof(arg0)),
+      iree_make_byte_span(&ret0, sizeof(ret0))));
+  EXPECT_EQ(ret0, 11);
+
+  iree_vm_stack_deinitialize(stack);
+  iree_vm_context_release(context);
+}
+
 }  // namespace
 }  // namespace iree
@@ -543,14 +543,6 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
     iree_vm_stack_frame_t* IREE_RESTRICT* out_callee_frame) {
   if (out_callee_frame) *out_callee_frame = NULL;
 
-  // Allocate stack space and grow stack, if required.
-  iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
-  iree_host_size_t new_top =
-      stack->frame_storage_size + header_size + frame_size;
-  if (IREE_UNLIKELY(new_top > stack->frame_storage_capacity)) {
-    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
-  }
-
   // Try to reuse the same module state if the caller and callee are from the
   // same module. Otherwise, query the state from the registered handler.
   iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
@@ -564,6 +556,30 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
         stack->state_resolver.self, function->module, &module_state));
   }
 
+  return iree_vm_stack_function_enter_with_state(
+      stack, function, module_state, frame_type, frame_size, frame_cleanup_fn,
+      out_callee_frame);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter_with_state(
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    iree_vm_module_state_t* module_state, iree_vm_stack_frame_type_t frame_type,
+    iree_host_size_t frame_size,
+    iree_vm_stack_frame_cleanup_fn_t frame_cleanup_fn,
+    iree_vm_stack_frame_t* IREE_RESTRICT* out_callee_frame) {
+  if (out_callee_frame) *out_callee_frame = NULL;
+
+  // Allocate stack space and grow stack, if required.
+  iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
+  iree_host_size_t new_top =
+      stack->frame_storage_size + header_size + frame_size;
+  if (IREE_UNLIKELY(new_top > stack->frame_storage_capacity)) {
+    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
+  }
+  iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
+  iree_vm_stack_frame_t* caller_frame =
+      caller_frame_header ? &caller_frame_header->frame : NULL;
+
   // Bump pointer and get real stack pointer offsets.
   iree_vm_stack_frame_header_t* frame_header =
       (iree_vm_stack_frame_header_t*)((uintptr_t)stack->frame_storage +
@@ -0,0 +1,130 @@
+// Compiled with --iree-vm-target-extension-fused so that the bytecode encoder
+// selects fused superinstructions for the sequences below. The same checks
+// must hold with or without fusion.
+vm.module @fused_ops {
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.* + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.func private @cmp_eq_i32(%lhs : i32, %rhs : i32) -> i32 attributes {inlining_policy = #util.inline.never} {
+    %cmp = vm.cmp.eq.i32 %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1
+    vm.return %c1 : i32
+  ^false:
+    %c2 = vm.const.i32 2
+    vm.return %c2 : i32
+  }
+
+  vm.func private @cmp_lt_i32_u(%lhs : i32, %rhs : i32) -> i32 attributes {inlining_policy = #util.inline.never} {
+    %cmp = vm.cmp.lt.i32.u %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1
+    vm.return %c1 : i32
+  ^false:
+    %c2 = vm.const.i32 2
+    vm.return %c2 : i32
+  }
+
+  vm.export @test_cmp_cond_br_i32
+  vm.func @test_cmp_cond_br_i32() {
+    %c1 = vm.const.i32 1
+    %c2 = vm.const.i32 2
+    %cn1 = vm.const.i32 -1
+    %c1dno = util.optimization_barrier %c1 : i32
+    %c2dno = util.optimization_barrier %c2 : i32
+    %cn1dno = util.optimization_barrier %cn1 : i32
+    %eq_true = vm.call @cmp_eq_i32(%c2dno, %c2dno) : (i32, i32) -> i32
+    vm.check.eq %eq_true, %c1, "2 == 2" : i32
+    %eq_false = vm.call @cmp_eq_i32(%c1dno, %c2dno) : (i32, i32) -> i32
+    vm.check.eq %eq_false, %c2, "1 != 2" : i32
+    %lt_u_true = vm.call @cmp_lt_i32_u(%c1dno, %cn1dno) : (i32, i32) -> i32
+    vm.check.eq %lt_u_true, %c1, "1 <u -1" : i32
+    %lt_u_false = vm.call @cmp_lt_i32_u(%cn1dno, %c1dno) : (i32, i32) -> i32
+    vm.check.eq %lt_u_false, %c2, "-1 >=u 1" : i32
+    vm.return
+  }
+
+  // Counts up to a limit with the loop-carried value passed along both edges.
+  vm.export @test_cmp_cond_br_loop_i64
+  vm.func @test_cmp_cond_br_loop_i64() {
+    %c0 = vm.const.i64 0
+    %c10 = vm.const.i64 10
+    %c0dno = util.optimization_barrier %c0 : i64
+    %c10dno = util.optimization_barrier %c10 : i64
+    vm.br ^loop(%c0dno : i64)
+  ^loop(%i : i64):
+    %c1 = vm.const.i64 1
+    %next = vm.add.i64 %i, %c1 : i64
+    %cmp = vm.cmp.lt.i64.s %next, %c10dno : i64
+    vm.cond_br %cmp, ^loop(%next : i64), ^exit(%next : i64)
+  ^exit(%result : i64):
+    vm.check.eq %result, %c10, "loop count" : i64
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.const.* + vm.add.*
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_add_i32_imm
+  vm.func @test_add_i32_imm() {
+    %c7 = vm.const.i32 7
+    %c7dno = util.optimization_barrier %c7 : i32
+    %cn9 = vm.const.i32 -9
+    %v = vm.add.i32 %c7dno, %cn9 : i32
+    %expected = vm.const.i32 -2
+    vm.check.eq %v, %expected, "7 + -9" : i32
+    vm.return
+  }
+
+  vm.export @test_add_i64_imm
+  vm.func @test_add_i64_imm() {
+    %c1 = vm.const.i64 1
+    %c1dno = util.optimization_barrier %c1 : i64
+    %big = vm.const.i64 0x100000000
+    %v = vm.add.i64 %big, %c1dno : i64
+    %expected = vm.const.i64 0x100000001
+    vm.check.eq %v, %expected, "0x100000000 + 1" : i64
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.buffer.load.i32 + vm.ext.i32.i64.*
+  //===--------------------------------------------------------------------===//
+
+  vm.rodata private @test_load_ext_data dense<[0x7FFFFFFF, 0xFFFFFFFF]> : tensor<2xui32>
+
+  vm.export @test_buffer_load_i32_ext_i64_s
+  vm.func @test_buffer_load_i32_ext_i64_s() {
+    %rodata = vm.const.ref.rodata @test_load_ext_data : !vm.buffer
+    %rodata_dno = util.optimization_barrier %rodata : !vm.buffer
+    %c0 = vm.const.i64 0
+    %c1 = vm.const.i64 1
+    %v0 = vm.buffer.load.i32 %rodata_dno[%c0] : !vm.buffer -> i32
+    %w0 = vm.ext.i32.i64.s %v0 : i32 -> i64
+    %e0 = vm.const.i64 0x7FFFFFFF
+    vm.check.eq %w0, %e0, "0x7FFFFFFF" : i64
+    %v1 = vm.buffer.load.i32 %rodata_dno[%c1] : !vm.buffer -> i32
+    %w1 = vm.ext.i32.i64.s %v1 : i32 -> i64
+    %e1 = vm.const.i64 -1
+    vm.check.eq %w1, %e1, "0xFFFFFFFF sext" : i64
+    vm.return
+  }
+
+  vm.export @test_buffer_load_i32_ext_i64_u
+  vm.func @test_buffer_load_i32_ext_i64_u() {
+    %rodata = vm.const.ref.rodata @test_load_ext_data : !vm.buffer
+    %rodata_dno = util.optimization_barrier %rodata : !vm.buffer
+    %c1 = vm.const.i64 1
+    %v1 = vm.buffer.load.i32 %rodata_dno[%c1] : !vm.buffer -> i32
+    %w1 = vm.ext.i32.i64.u %v1 : i32 -> i64
+    %e1 = vm.const.i64 0xFFFFFFFF
+    vm.check.eq %w1, %e1, "0xFFFFFFFF zext" : i64
+    vm.return
+  }
+
+}
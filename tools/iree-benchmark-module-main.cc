@@ -51,11 +51,29 @@
 // how the full program will run, though, and YMMV. Always verify timings with
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
+//
+// The benchmarks above are closed-loop: a new invocation is only issued once
+// the previous one completes and slow invocations delay all that follow
+// (coordinated omission). To measure latency under a target request rate the
+// --load_qps= flag switches to an open-loop load generator: --load_clients=
+// client threads each with their own fork of the context issue invocations of
+// --function= at arrival times drawn from a Poisson (or uniform) process and
+// latency is measured from the scheduled arrival time so that queueing behind
+// slow invocations is included. Arrivals still waiting when the run ends are
+// reported as dropped and recorded with the time they had waited so far.
+// Percentiles of latency, queueing delay, and service time along with the
+// achieved rate are printed and optionally written as JSON with
+// --load_report_json= for automated gating.
 
 #include <array>
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
 #include <cstdio>
 #include <iterator>
+#include <random>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -68,6 +86,8 @@
 #include "iree/tooling/context_util.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/function_io.h"
+#include "iree/tooling/function_util.h"
+#include "iree/tooling/latency_histogram.h"
 #include "iree/vm/api.h"
 
 constexpr char kNanosecondsUnitString[] = "ns";
@@ -91,6 +111,25 @@ IREE_FLAG(string, function, "",
 IREE_FLAG(bool, print_statistics, false,
           "Prints runtime statistics to stderr on exit.");
 
+IREE_FLAG(double, load_qps, 0.0,
+          "Target rate of invocations per second across all clients. When\n"
+          "set the function specified by --function= is run with an open-loop\n"
+          "load generator instead of as a closed-loop benchmark.");
+IREE_FLAG(int32_t, load_clients, 1,
+          "Number of client threads issuing invocations in open-loop mode.\n"
+          "Each client beyond the first uses its own fork of the context.");
+IREE_FLAG(double, load_duration, 10.0,
+          "Duration in seconds of the measured open-loop load.");
+IREE_FLAG(double, load_warmup, 1.0,
+          "Duration in seconds of open-loop load issued before measuring.");
+IREE_FLAG(string, load_arrivals, "poisson",
+          "Open-loop arrival process of ['poisson', 'uniform'].");
+IREE_FLAG(int64_t, load_seed, 0,
+          "Seed for the open-loop arrival process random number generator.");
+IREE_FLAG(string, load_report_json, "",
+          "Writes the open-loop report as JSON to the given file path or\n"
+          "stdout if '-'.");
+
 IREE_FLAG_LIST(
     string, input,
     "An input value or buffer of the format:\n"
@@ -167,18 +206,23 @@ static void BenchmarkGenericFunction(const std::string& benchmark_name,
                                       benchmark_name.size());
   IREE_TRACE_FRAME_MARK();
 
-  vm::ref<iree_vm_list_t> outputs;
-  IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 16,
-                                    iree_allocator_system(), &outputs));
+  // Reuse the same invocation state for all iterations so that we measure the
+  // function and not the per-call setup.
+  vm::ref<iree_vm_invocation_t> invocation;
+  IREE_CHECK_OK(iree_vm_invocation_create(
+      context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+      iree_allocator_system(), &invocation));
+  IREE_CHECK_OK(iree_vm_list_copy(inputs, 0,
+                                  iree_vm_invocation_inputs(invocation.get()),
+                                  0, iree_vm_list_size(inputs)));
+  iree_vm_list_t* outputs = iree_vm_invocation_outputs(invocation.get());
 
   // Benchmarking loop.
   while (state.KeepRunningBatch(batch_size)) {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "BenchmarkIteration");
     IREE_TRACE_FRAME_MARK_NAMED("Iteration");
-    IREE_CHECK_OK(iree_vm_invoke(
-        context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
-        inputs, outputs.get(), iree_allocator_system()));
-    IREE_CHECK_OK(iree_vm_list_resize(outputs.get(), 0));
+    IREE_CHECK_OK(iree_vm_invocation_invoke(invocation.get()));
+    IREE_CHECK_OK(iree_vm_list_resize(outputs, 0));
     IREE_TRACE_ZONE_END(z1);
     if (device) {
       state.PauseTiming();
@@ -423,6 +467,250 @@ void RegisterDispatchBenchmark(const std::string& function_name,
                                   : benchmark::kMicrosecond);
 }
 
+//===----------------------------------------------------------------------===//
+// Open-loop load generation
+//===----------------------------------------------------------------------===//
+
+// Precision of the latency histograms; 7 bits gives <1% relative error.
+constexpr uint32_t kLoadHistogramPrecisionBits = 7;
+
+// Per-client measurements merged after the run.
+struct LoadClient {
+  int32_t index = 0;
+  iree_vm_context_t* context = nullptr;
+  // Time from the scheduled arrival until completion. Dropped arrivals are
+  // recorded with the time they had waited when the run ended as a lower
+  // bound on their latency.
+  iree_tooling_latency_histogram_t latency = {};
+  // Time from the scheduled arrival until the invocation was issued. Includes
+  // dropped arrivals the same as |latency|.
+  iree_tooling_latency_histogram_t queueing = {};
+  // Time from issue until completion of invocations that were issued.
+  iree_tooling_latency_histogram_t service = {};
+  // Arrivals scheduled within the run that could not be issued before it
+  // ended because the client was still busy.
+  uint64_t dropped_count = 0;
+  // Time the last measured invocation completed.
+  iree_time_t last_completion_ns = 0;
+  iree_status_t status = iree_ok_status();
+};
+
+struct LoadParams {
+  iree_hal_device_t* device = nullptr;
+  iree_vm_function_t function;
+  iree_vm_list_t* inputs = nullptr;
+  bool is_async = false;
+  bool poisson = true;
+  // Arrival rate of each individual client.
+  double client_qps = 0.0;
+  // Arrivals before |measure_start_ns| are issued but not recorded.
+  iree_time_t start_ns = 0;
+  iree_time_t measure_start_ns = 0;
+  iree_time_t end_ns = 0;
+};
+
+static iree_status_t RunLoadClient(const LoadParams& params,
+                                   LoadClient* client) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  vm::ref<iree_vm_list_t> inputs;
+  if (params.inputs) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_list_clone(params.inputs, host_allocator, &inputs));
+  } else {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_list_create(iree_vm_make_undefined_type_def(), 2,
+                                host_allocator, &inputs));
+  }
+  const iree_host_size_t input_count = iree_vm_list_size(inputs.get());
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_list_create(iree_vm_make_undefined_type_def(), 16,
+                              host_allocator, &outputs));
+
+  // Superimposed Poisson processes are a Poisson process so each client
+  // independently draws arrivals at its share of the total rate. Uniform
+  // arrivals are staggered across clients.
+  std::mt19937_64 rng((uint64_t)FLAG_load_seed * 7919 + client->index);
+  std::exponential_distribution<double> poisson_interval(params.client_qps);
+  const double uniform_interval_ns = 1e9 / params.client_qps;
+  double arrival_ns = (double)params.start_ns;
+  if (!params.poisson) {
+    arrival_ns += uniform_interval_ns * client->index / FLAG_load_clients;
+  }
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    arrival_ns += params.poisson ? poisson_interval(rng) * 1e9
+                                 : uniform_interval_ns;
+    const iree_time_t arrival_time_ns = (iree_time_t)arrival_ns;
+    if (arrival_time_ns >= params.end_ns) break;
+
+    // Wait until the scheduled arrival. If the client is behind schedule the
+    // invocation is issued immediately and the lag is the queueing delay.
+    iree_time_t issue_time_ns = iree_time_now();
+    if (issue_time_ns < arrival_time_ns) {
+      iree_wait_until(arrival_time_ns);
+      issue_time_ns = iree_time_now();
+    }
+    if (issue_time_ns >= params.end_ns) {
+      // Overloaded: the remaining scheduled arrivals can't be issued in time.
+      // They are still recorded so that percentiles don't omit the slowest
+      // requests; each has waited at least until now and would have taken
+      // longer had it been issued.
+      iree_time_t dropped_arrival_ns = arrival_time_ns;
+      do {
+        ++client->dropped_count;
+        if (dropped_arrival_ns >= params.measure_start_ns) {
+          iree_tooling_latency_histogram_record(
+              &client->latency, issue_time_ns - dropped_arrival_ns);
+          iree_tooling_latency_histogram_record(
+              &client->queueing, issue_time_ns - dropped_arrival_ns);
+        }
+        arrival_ns += params.poisson ? poisson_interval(rng) * 1e9
+                                     : uniform_interval_ns;
+        dropped_arrival_ns = (iree_time_t)arrival_ns;
+      } while (dropped_arrival_ns < params.end_ns);
+      break;
+    }
+
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "LoadInvocation");
+    vm::ref<iree_hal_fence_t> signal_fence;
+    if (params.is_async) {
+      status = iree_tooling_append_async_fences(
+          inputs.get(), params.function, params.device, /*wait_fence=*/NULL,
+          &signal_fence);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invoke(client->context, params.function,
+                              IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+                              inputs.get(), outputs.get(), host_allocator);
+    }
+    if (iree_status_is_ok(status) && signal_fence) {
+      status =
+          iree_hal_fence_wait(signal_fence.get(), iree_infinite_timeout());
+    }
+    const iree_time_t completion_time_ns = iree_time_now();
+    IREE_TRACE_ZONE_END(z1);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_resize(inputs.get(), input_count);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_resize(outputs.get(), 0);
+    }
+
+    if (arrival_time_ns >= params.measure_start_ns) {
+      iree_tooling_latency_histogram_record(
+          &client->latency, completion_time_ns - arrival_time_ns);
+      iree_tooling_latency_histogram_record(&client->queueing,
+                                            issue_time_ns - arrival_time_ns);
+      iree_tooling_latency_histogram_record(
+          &client->service, completion_time_ns - issue_time_ns);
+      client->last_completion_ns = completion_time_ns;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns |value_ns| in the --time_unit= (default milliseconds).
+static double ConvertLoadTime(double value_ns) {
+  switch (FLAG_time_unit.first ? FLAG_time_unit.second
+                               : benchmark::kMillisecond) {
+    case benchmark::kNanosecond:
+      return value_ns;
+    case benchmark::kMicrosecond:
+      return value_ns / 1e3;
+    default:
+      return value_ns / 1e6;
+  }
+}
+
+static const char* LoadTimeUnitString() {
+  switch (FLAG_time_unit.first ? FLAG_time_unit.second
+                               : benchmark::kMillisecond) {
+    case benchmark::kNanosecond:
+      return kNanosecondsUnitString;
+    case benchmark::kMicrosecond:
+      return kMicrosecondsUnitString;
+    default:
+      return kMillisecondsUnitString;
+  }
+}
+
+static const std::array<std::pair<const char*, double>, 4> kLoadPercentiles =
+    {{{"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p999", 99.9}}};
+
+static void PrintLoadHistogramRow(
+    const char* name, const iree_tooling_latency_histogram_t* histogram) {
+  fprintf(stdout, "%-10s", name);
+  for (const auto& percentile : kLoadPercentiles) {
+    uint64_t value_ns = iree_tooling_latency_histogram_value_at_percentile(
+        histogram, percentile.second);
+    fprintf(stdout, " %12.3f", ConvertLoadTime((double)value_ns));
+  }
+  fprintf(stdout, " %12.3f %12.3f\n",
+          ConvertLoadTime((double)histogram->max_value),
+          ConvertLoadTime(iree_tooling_latency_histogram_mean(histogram)));
+}
+
+// Writes |value| to |file| as a quoted JSON string.
+static void WriteJsonString(FILE* file, const std::string& value) {
+  fputc('"', file);
+  for (unsigned char c : value) {
+    switch (c) {
+      case '"':
+        fputs("\\\"", file);
+        break;
+      case '\\':
+        fputs("\\\\", file);
+        break;
+      case '\b':
+        fputs("\\b", file);
+        break;
+      case '\f':
+        fputs("\\f", file);
+        break;
+      case '\n':
+        fputs("\\n", file);
+        break;
+      case '\r':
+        fputs("\\r", file);
+        break;
+      case '\t':
+        fputs("\\t", file);
+        break;
+      default:
+        if (c < 0x20) {
+          fprintf(file, "\\u%04x", c);
+        } else {
+          fputc(c, file);
+        }
+        break;
+    }
+  }
+  fputc('"', file);
+}
+
+static void WriteLoadHistogramJson(
+    FILE* file, const char* name,
+    const iree_tooling_latency_histogram_t* histogram) {
+  fprintf(file, "  \"%s_ns\": {\n", name);
+  fprintf(file, "    \"min\": %" PRIu64 ",\n",
+          histogram->total_count ? histogram->min_value : 0);
+  fprintf(file, "    \"mean\": %.1f,\n",
+          iree_tooling_latency_histogram_mean(histogram));
+  for (const auto& percentile : kLoadPercentiles) {
+    fprintf(file, "    \"%s\": %" PRIu64 ",\n", percentile.first,
+            iree_tooling_latency_histogram_value_at_percentile(
+                histogram, percentile.second));
+  }
+  fprintf(file, "    \"max\": %" PRIu64 "\n", histogram->max_value);
+  fprintf(file, "  }");
+}
+
 // The lifetime of IREEBenchmark should be as long as
 // ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
 // benchmarking.
@@ -466,6 +754,168 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
+  // Runs the function specified by --function= with an open-loop load
+  // generator and reports the measured latency distribution.
+  iree_status_t RunOpenLoop() {
+    IREE_TRACE_SCOPE_NAMED("IREEBenchmark::RunOpenLoop");
+
+    auto function_name = std::string(FLAG_function);
+    if (function_name.empty()) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "--load_qps= requires a --function= to run");
+    }
+    const bool poisson = strcmp(FLAG_load_arrivals, "poisson") == 0;
+    if (!poisson && strcmp(FLAG_load_arrivals, "uniform") != 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unsupported --load_arrivals= value '%s'",
+                              FLAG_load_arrivals);
+    }
+    if (FLAG_load_clients < 1 || FLAG_load_duration <= 0.0 ||
+        FLAG_load_warmup < 0.0) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "--load_clients= must be >= 1, --load_duration= must be > 0, and "
+          "--load_warmup= must be >= 0");
+    }
+
+    if (!instance_ || !device_allocator_ || !context_ || !module_list_.count) {
+      IREE_RETURN_IF_ERROR(Init());
+    }
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(PrepareFunction(function_name, &function));
+    iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
+        &function, IREE_SV("iree.abi.model"));
+
+    // Each client gets its own context so that invocations don't race on
+    // module state. The first client uses the primary context.
+    iree_allocator_t host_allocator = iree_allocator_system();
+    std::vector<LoadClient> clients(FLAG_load_clients);
+    std::vector<vm::ref<iree_vm_context_t>> client_contexts;
+    iree_status_t status = iree_ok_status();
+    for (int32_t i = 0; i < FLAG_load_clients && iree_status_is_ok(status);
+         ++i) {
+      LoadClient& client = clients[i];
+      client.index = i;
+      if (i == 0) {
+        client.context = context_.get();
+      } else {
+        vm::ref<iree_vm_context_t> client_context;
+        status = iree_status_annotate(
+            iree_vm_context_fork(context_.get(), host_allocator,
+                                 &client_context),
+            IREE_SV("forking context for open-loop client; all modules must "
+                    "support forking when --load_clients= > 1"));
+        client.context = client_context.get();
+        client_contexts.push_back(std::move(client_context));
+      }
+    }
+    for (auto& client : clients) {
+      if (!iree_status_is_ok(status)) break;
+      status = iree_tooling_latency_histogram_initialize(
+          kLoadHistogramPrecisionBits, host_allocator, &client.latency);
+      if (iree_status_is_ok(status)) {
+        status = iree_tooling_latency_histogram_initialize(
+            kLoadHistogramPrecisionBits, host_allocator, &client.queueing);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_tooling_latency_histogram_initialize(
+            kLoadHistogramPrecisionBits, host_allocator, &client.service);
+      }
+    }
+
+    LoadParams params;
+    params.device = device_.get();
+    params.function = function;
+    params.inputs = inputs_.get();
+    params.is_async =
+        iree_string_view_equal(invocation_model, IREE_SV("coarse-fences"));
+    params.poisson = poisson;
+    params.client_qps = FLAG_load_qps / FLAG_load_clients;
+    params.start_ns = iree_time_now();
+    params.measure_start_ns =
+        params.start_ns + (iree_duration_t)(FLAG_load_warmup * 1e9);
+    params.end_ns =
+        params.measure_start_ns + (iree_duration_t)(FLAG_load_duration * 1e9);
+
+    // Issue load from all clients and wait for them to finish.
+    if (iree_status_is_ok(status)) {
+      std::vector<std::thread> threads;
+      for (auto& client : clients) {
+        threads.emplace_back([&params, &client]() {
+          client.status = RunLoadClient(params, &client);
+        });
+      }
+      for (auto& thread : threads) thread.join();
+      for (auto& client : clients) {
+        if (iree_status_is_ok(status)) {
+          status = client.status;
+        } else {
+          iree_status_ignore(client.status);
+        }
+        client.status = iree_ok_status();
+      }
+    }
+
+    // Merge all client measurements into the first.
+    uint64_t dropped_count = 0;
+    iree_time_t last_completion_ns = params.end_ns;
+    for (auto& client : clients) {
+      dropped_count += client.dropped_count;
+      last_completion_ns =
+          iree_max(last_completion_ns, client.last_completion_ns);
+      if (iree_status_is_ok(status) && &client != &clients[0]) {
+        status = iree_tooling_latency_histogram_merge(&clients[0].latency,
+                                                      &client.latency);
+        if (iree_status_is_ok(status)) {
+          status = iree_tooling_latency_histogram_merge(&clients[0].queueing,
+                                                        &client.queueing);
+        }
+        if (iree_status_is_ok(status)) {
+          status = iree_tooling_latency_histogram_merge(&clients[0].service,
+                                                        &client.service);
+        }
+      }
+    }
+
+    if (iree_status_is_ok(status)) {
+      const LoadClient& totals = clients[0];
+      const double elapsed_s =
+          (double)(last_completion_ns - params.measure_start_ns) / 1e9;
+      // Dropped arrivals are included in the latency histograms but only
+      // issued invocations count toward the achieved rate.
+      const uint64_t invocation_count = totals.service.total_count;
+      const double achieved_qps =
+          (double)invocation_count / iree_max(elapsed_s, 1e-9);
+      fprintf(stdout,
+              "open-loop %s: %s arrivals from %d client(s); target %.2f qps, "
+              "achieved %.2f qps (%" PRIu64 " invocations in %.3fs, %" PRIu64
+              " dropped)\n",
+              function_name.c_str(), FLAG_load_arrivals, FLAG_load_clients,
+              FLAG_load_qps, achieved_qps, invocation_count, elapsed_s,
+              dropped_count);
+      fprintf(stdout, "%-10s", LoadTimeUnitString());
+      for (const auto& percentile : kLoadPercentiles) {
+        fprintf(stdout, " %12s", percentile.first);
+      }
+      fprintf(stdout, " %12s %12s\n", "max", "mean");
+      PrintLoadHistogramRow("latency", &totals.latency);
+      PrintLoadHistogramRow("queueing", &totals.queueing);
+      PrintLoadHistogramRow("service", &totals.service);
+
+      if (strlen(FLAG_load_report_json) > 0) {
+        status = WriteLoadReportJson(function_name, achieved_qps, elapsed_s,
+                                     dropped_count, totals);
+      }
+    }
+
+    for (auto& client : clients) {
+      iree_tooling_latency_histogram_deinitialize(&client.latency);
+      iree_tooling_latency_histogram_deinitialize(&client.queueing);
+      iree_tooling_latency_histogram_deinitialize(&client.service);
+    }
+    return status;
+  }
+
  private:
   iree_status_t Init() {
     IREE_TRACE_SCOPE_NAMED("IREEBenchmark::Init");
@@ -487,19 +937,18 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
-  iree_status_t RegisterSpecificFunction(const std::string& function_name) {
-    IREE_TRACE_SCOPE_NAMED("IREEBenchmark::RegisterSpecificFunction");
-
+  // Looks up |function_name| in the main module and parses its --input=s.
+  iree_status_t PrepareFunction(const std::string& function_name,
+                                iree_vm_function_t* out_function) {
     iree_vm_module_t* main_module =
         iree_tooling_module_list_back(&module_list_);
-    iree_vm_function_t function;
     IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
         main_module, IREE_VM_FUNCTION_LINKAGE_EXPORT,
         iree_string_view_t{function_name.data(),
                            (iree_host_size_t)function_name.size()},
-        &function));
+        out_function));
     iree_vm_function_signature_t signature =
-        iree_vm_function_signature(&function);
+        iree_vm_function_signature(out_function);
     iree_string_view_t arguments_cconv, results_cconv;
     IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
         &signature, &arguments_cconv, &results_cconv));
@@ -508,6 +957,47 @@ class IREEBenchmark {
         arguments_cconv, FLAG_input_list(), device_.get(),
         device_allocator_.get(), iree_vm_instance_allocator(instance_.get()),
         &inputs_));
+    return iree_ok_status();
+  }
+
+  iree_status_t WriteLoadReportJson(const std::string& function_name,
+                                    double achieved_qps, double elapsed_s,
+                                    uint64_t dropped_count,
+                                    const LoadClient& totals) {
+    const bool to_stdout = strcmp(FLAG_load_report_json, "-") == 0;
+    FILE* file = to_stdout ? stdout : fopen(FLAG_load_report_json, "w");
+    if (!file) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to open '%s' for writing",
+                              FLAG_load_report_json);
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"function\": ");
+    WriteJsonString(file, function_name);
+    fprintf(file, ",\n");
+    fprintf(file, "  \"arrivals\": \"%s\",\n", FLAG_load_arrivals);
+    fprintf(file, "  \"clients\": %d,\n", FLAG_load_clients);
+    fprintf(file, "  \"target_qps\": %.3f,\n", FLAG_load_qps);
+    fprintf(file, "  \"achieved_qps\": %.3f,\n", achieved_qps);
+    fprintf(file, "  \"duration_s\": %.6f,\n", elapsed_s);
+    fprintf(file, "  \"invocations\": %" PRIu64 ",\n",
+            totals.service.total_count);
+    fprintf(file, "  \"dropped\": %" PRIu64 ",\n", dropped_count);
+    WriteLoadHistogramJson(file, "latency", &totals.latency);
+    fprintf(file, ",\n");
+    WriteLoadHistogramJson(file, "queueing", &totals.queueing);
+    fprintf(file, ",\n");
+    WriteLoadHistogramJson(file, "service", &totals.service);
+    fprintf(file, "\n}\n");
+    if (!to_stdout) fclose(file);
+    return iree_ok_status();
+  }
+
+  iree_status_t RegisterSpecificFunction(const std::string& function_name) {
+    IREE_TRACE_SCOPE_NAMED("IREEBenchmark::RegisterSpecificFunction");
+
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(PrepareFunction(function_name, &function));
 
     iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
         &function, IREE_SV("iree.abi.model"));
@@ -621,6 +1111,16 @@ static int runMain(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   iree::IREEBenchmark iree_benchmark;
+  if (FLAG_load_qps > 0.0) {
+    iree_status_t status = iree_benchmark.RunOpenLoop();
+    int exit_code = EXIT_SUCCESS;
+    if (!iree_status_is_ok(status)) {
+      exit_code = static_cast<int>(iree_status_code(status));
+      printf("%s\n", iree::Status(std::move(status)).ToString().c_str());
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return exit_code;
+  }
   iree_status_t status = iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
     int exit_code = static_cast<int>(iree_status_code(status));
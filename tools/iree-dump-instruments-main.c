@@ -221,6 +221,72 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
   return iree_ok_status();
 }
 
+// Returns |numerator| / |denominator| scaled by |scale| or 0 if undefined.
+static double iree_tooling_ratio(uint64_t numerator, uint64_t denominator,
+                                 double scale) {
+  return denominator ? scale * (double)numerator / (double)denominator : 0.0;
+}
+
+static iree_status_t iree_tooling_dump_dispatch_counters(
+    const uint8_t* data_ptr, iree_host_size_t data_size, FILE* stream) {
+  fprintf(stream,
+          "//"
+          "===---------------------------------------------------------------"
+          "-------===//\n");
+  fprintf(stream, "// dispatch counters\n");
+  fprintf(stream,
+          "//"
+          "===---------------------------------------------------------------"
+          "-------===//\n");
+  for (iree_host_size_t i = 0; i < data_size;) {
+    const iree_instrument_dispatch_counters_t* record =
+        (const iree_instrument_dispatch_counters_t*)(data_ptr + i);
+    if (i + sizeof(*record) > data_size ||
+        i + sizeof(*record) + record->name_length > data_size) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "dispatch counter record truncated");
+    }
+    const uint64_t* values = record->values;
+    if (record->name_length) {
+      fprintf(stream, "%.*s\n", (int)record->name_length, record->name);
+    } else {
+      fprintf(stream, "export[%u]\n", record->export_ordinal);
+    }
+    fprintf(stream,
+            "  dispatches: %" PRIu64 "  workgroups: %" PRIu64
+            "  time: %.3fms (%.3fus/workgroup)\n",
+            record->dispatch_count, record->workgroup_count,
+            record->duration_ns / 1000000.0,
+            iree_tooling_ratio(record->duration_ns, record->workgroup_count,
+                               1 / 1000.0));
+    fprintf(stream,
+            "  cycles: %" PRIu64 "  instructions: %" PRIu64 " (%.2f IPC)\n",
+            values[IREE_INSTRUMENT_DISPATCH_COUNTER_CPU_CYCLES],
+            values[IREE_INSTRUMENT_DISPATCH_COUNTER_INSTRUCTIONS],
+            iree_tooling_ratio(
+                values[IREE_INSTRUMENT_DISPATCH_COUNTER_INSTRUCTIONS],
+                values[IREE_INSTRUMENT_DISPATCH_COUNTER_CPU_CYCLES], 1.0));
+    fprintf(stream,
+            "  cache references: %" PRIu64 "  misses: %" PRIu64 " (%.2f%%)\n",
+            values[IREE_INSTRUMENT_DISPATCH_COUNTER_CACHE_REFERENCES],
+            values[IREE_INSTRUMENT_DISPATCH_COUNTER_CACHE_MISSES],
+            iree_tooling_ratio(
+                values[IREE_INSTRUMENT_DISPATCH_COUNTER_CACHE_MISSES],
+                values[IREE_INSTRUMENT_DISPATCH_COUNTER_CACHE_REFERENCES],
+                100.0));
+    fprintf(stream,
+            "  branches: %" PRIu64 "  misses: %" PRIu64 " (%.2f%%)\n",
+            values[IREE_INSTRUMENT_DISPATCH_COUNTER_BRANCH_INSTRUCTIONS],
+            values[IREE_INSTRUMENT_DISPATCH_COUNTER_BRANCH_MISSES],
+            iree_tooling_ratio(
+                values[IREE_INSTRUMENT_DISPATCH_COUNTER_BRANCH_MISSES],
+                values[IREE_INSTRUMENT_DISPATCH_COUNTER_BRANCH_INSTRUCTIONS],
+                100.0));
+    i += iree_host_align(sizeof(*record) + record->name_length, 16);
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_tooling_dump_instrument_file(
     iree_const_byte_span_t file_contents, FILE* stream) {
   const uint8_t* file_ptr = file_contents.data;
@@ -242,6 +308,11 @@ static iree_status_t iree_tooling_dump_instrument_file(
             payload, header->content_length, &dispatch_metadata, stream));
         break;
       }
+      case IREE_IDBTS_CHUNK_TYPE_DISPATCH_COUNTERS: {
+        IREE_RETURN_IF_ERROR(iree_tooling_dump_dispatch_counters(
+            payload, header->content_length, stream));
+        break;
+      }
       default:
         return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                 "unimplemented chunk type: %u",
@@ -276,6 +347,17 @@ int main(int argc, char** argv) {
             "        --input=4xf32=4 \\n"
             "        --instrument_file=instrument.bin\n"
             "  $ iree-dump-instruments instrument.bin\n"
+            "\n"
+            "Per-dispatch hardware counters from the local CPU devices:\n"
+            "  $ iree-run-module \\n"
+            "        --device=local-task \\n"
+            "        --module=simple_mul.vmfb \\n"
+            "        --function=simple_mul \\n"
+            "        --input=4xf32=2 \\n"
+            "        --input=4xf32=4 \\n"
+            "        --device_profiling_mode=dispatch \\n"
+            "        --device_profiling_file=counters.bin\n"
+            "  $ iree-dump-instruments counters.bin\n"
             "\n");
     IREE_TRACE_APP_EXIT(EXIT_FAILURE);
     return EXIT_FAILURE;
@@ -11,6 +11,8 @@
 //   --output=metadata: module metadata and size breakdown.
 //   --output=flatbuffer-binary: module flatbuffer in binary format.
 //   --output=flatbuffer-json: module flatbuffer in JSON format.
+//   --output=disassembly: bytecode disassembly optionally annotated with
+//                         execution counts from --counters=.
 
 #include <ctype.h>
 #include <stdio.h>
@@ -18,6 +20,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
+#include "iree/tooling/context_util.h"
 #include "iree/vm/bytecode/archive.h"
 #include "iree/vm/bytecode/module.h"
 
@@ -538,6 +541,56 @@ static iree_status_t iree_tooling_dump_module_flatbuffer_json(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// --output=disassembly
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(string, counters, "",
+          "Execution counters file produced by\n"
+          "`iree-run-module --vm_counters_file=` used to annotate the\n"
+          "disassembly with function and block counts.");
+
+static iree_status_t iree_tooling_dump_module_disassembly(
+    iree_const_byte_span_t archive_contents, iree_allocator_t host_allocator) {
+  // Types used by the module must be registered for it to load.
+  iree_vm_instance_t* instance = NULL;
+  IREE_RETURN_IF_ERROR(iree_tooling_create_instance(host_allocator, &instance));
+
+  iree_vm_module_t* module = NULL;
+  iree_status_t status = iree_vm_bytecode_module_create(
+      instance, archive_contents, iree_allocator_null(), host_allocator,
+      &module);
+
+  iree_file_contents_t* counters_contents = NULL;
+  if (iree_status_is_ok(status) && strlen(FLAG_counters) > 0) {
+    status = iree_file_read_contents(FLAG_counters, IREE_FILE_READ_FLAG_DEFAULT,
+                                     host_allocator, &counters_contents);
+  }
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(host_allocator, &builder);
+  if (iree_status_is_ok(status)) {
+    iree_string_view_t counters =
+        counters_contents
+            ? iree_make_string_view(
+                  (const char*)counters_contents->const_buffer.data,
+                  counters_contents->const_buffer.data_length)
+            : iree_string_view_empty();
+    status =
+        iree_vm_bytecode_module_append_disassembly(module, counters, &builder);
+  }
+  if (iree_status_is_ok(status)) {
+    fwrite(iree_string_builder_buffer(&builder), 1,
+           iree_string_builder_size(&builder), stdout);
+  }
+
+  iree_string_builder_deinitialize(&builder);
+  iree_file_contents_free(counters_contents);
+  iree_vm_module_release(module);
+  iree_vm_instance_release(instance);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // main
 //===----------------------------------------------------------------------===//
@@ -546,7 +599,8 @@ IREE_FLAG(string, output, "metadata",
           "Output mode:\n"
           "  'metadata': module metadata and size breakdown.\n"
           "  'flatbuffer-binary': module flatbuffer in binary format.\n"
-          "  'flatbuffer-json': module flatbuffer in JSON format.\n");
+          "  'flatbuffer-json': module flatbuffer in JSON format.\n"
+          "  'disassembly': bytecode disassembly (see --counters=).\n");
 
 int main(int argc, char** argv) {
   IREE_TRACE_APP_ENTER();
@@ -597,6 +651,9 @@ int main(int argc, char** argv) {
       status = iree_tooling_dump_module_flatbuffer_binary(flatbuffer_contents);
     } else if (strcmp(FLAG_output, "flatbuffer-json") == 0) {
       status = iree_tooling_dump_module_flatbuffer_json(flatbuffer_contents);
+    } else if (strcmp(FLAG_output, "disassembly") == 0) {
+      status = iree_tooling_dump_module_disassembly(file_contents->const_buffer,
+                                                    host_allocator);
     } else {
       status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                                 "unrecognized --output= flag value '%s'",